@@ -76,11 +76,11 @@ class OpServerProxy::OpServerImpl {
                 rinfo_.set_conn_call_failed(0);
             }
 
-            void RedisUveUpdate() {
-                rinfo_.set_update_succeeded(rinfo_.get_update_succeeded()+1);
+            void RedisUveUpdate(uint64_t count = 1) {
+                rinfo_.set_update_succeeded(rinfo_.get_update_succeeded()+count);
             }
-            void RedisUveUpdateFail() {
-                rinfo_.set_update_failed(rinfo_.get_update_failed()+1);
+            void RedisUveUpdateFail(uint64_t count = 1) {
+                rinfo_.set_update_failed(rinfo_.get_update_failed()+count);
             }
             void RedisUveUpdateNoConn() {
                 rinfo_.set_update_no_conn(rinfo_.get_update_no_conn()+1);
@@ -121,6 +121,44 @@ class OpServerProxy::OpServerImpl {
                 redis_uve_info.set_conn_cb_failed(to_ops_conn_->CallbackFailed());
                 redis_uve_info.set_conn_cb_succeeded(to_ops_conn_->CallbackSucceeded());
             }
+
+            RedisUveBatcher::Stats stats;
+            uve_batcher_->GetStats(&stats);
+            RedisUveBatchInfo batch_info;
+            batch_info.set_batch_size(uve_batcher_->batch_size());
+            batch_info.set_batch_latency_msec(uve_batcher_->latency_msec());
+            batch_info.set_updates(stats.updates);
+            batch_info.set_batches(stats.batches);
+            batch_info.set_size_flushes(stats.size_flushes);
+            batch_info.set_timer_flushes(stats.timer_flushes);
+            batch_info.set_forced_flushes(stats.forced_flushes);
+            batch_info.set_failed_batches(stats.failed_batches);
+            batch_info.set_max_batch_size(stats.max_batch_size);
+            batch_info.set_pending(uve_batcher_->pending());
+            redis_uve_info.set_batch_info(batch_info);
+        }
+
+        // Flush function for the UVE batcher. Invoked with the batcher lock
+        // held, so it must not call back into the batcher.
+        bool UVEUpdateBatch(const RedisUveGenerator &generator,
+                            const RedisUveBatcher::UpdateList &updates) {
+            shared_ptr<RedisAsyncConnection> prac = to_ops_conn();
+            if (!prac) {
+                for (size_t idx = 0; idx < updates.size(); idx++)
+                    redis_uve_.RedisUveUpdateNoConn();
+                return false;
+            }
+
+            bool ret = RedisProcessorExec::UVEUpdateBatch(prac.get(), NULL,
+                    generator.source, generator.node_type, generator.module,
+                    generator.instance_id, updates);
+            ret ? redis_uve_.RedisUveUpdate(updates.size()) :
+                  redis_uve_.RedisUveUpdateFail(updates.size());
+            return ret;
+        }
+
+        RedisUveBatcher *uve_batcher() {
+            return uve_batcher_.get();
         }
 
         void ToOpsConnUpPostProcess() {
@@ -132,7 +170,7 @@ class OpServerProxy::OpServerImpl {
             string instance_id = Sandesh::instance_id();
             string node_type = Sandesh::node_type();
             
-            if (!started_) {
+            if (!started_ && !uve_only_) {
                 RedisProcessorExec::SyncDeleteUVEs(redis_uve_.GetIp(), 
                                                    redis_uve_.GetPort(),
                                                    source, node_type,
@@ -140,7 +178,7 @@ class OpServerProxy::OpServerImpl {
                 started_=true;
             }
             if (collector_) 
-                collector_->RedisUpdate(true);
+                collector_->RedisUpdate(true, shard_);
         }
 
         void ToOpsConnUp() {
@@ -179,7 +217,7 @@ class OpServerProxy::OpServerImpl {
                 tbb::mutex::scoped_lock lock(rac_mutex_);
                 redis_uve_.RedisStatusUpdate(RAC_DOWN);
             }
-            collector_->RedisUpdate(false);
+            collector_->RedisUpdate(false, shard_);
             evm_->io_service()->post(boost::bind(&OpServerProxy::OpServerImpl::RAC_ConnectProcess,
                         this, RAC_CONN_TYPE_TO_OPS));
         }
@@ -288,18 +326,28 @@ class OpServerProxy::OpServerImpl {
 
         OpServerImpl(EventManager *evm, VizCollector *collector,
                      const std::string redis_uve_ip, 
-                     unsigned short redis_uve_port) :
+                     unsigned short redis_uve_port,
+                     size_t uve_batch_size, int uve_batch_latency_msec,
+                     int shard) :
             redis_uve_(redis_uve_ip, redis_uve_port),
             evm_(evm),
             collector_(collector),
             started_(false),
+            shard_(shard),
+            uve_only_(shard >= 0),
             analytics_cb_proc_fn(NULL),
-            processor_cb_proc_fn(NULL) {
+            processor_cb_proc_fn(NULL),
+            uve_batcher_(new RedisUveBatcher(evm,
+                boost::bind(&OpServerImpl::UVEUpdateBatch, this, _1, _2),
+                uve_batch_size, uve_batch_latency_msec)) {
             to_ops_conn_.reset(new RedisAsyncConnection(evm_, 
                 redis_uve_ip, redis_uve_port, 
                 boost::bind(&OpServerProxy::OpServerImpl::ToOpsConnUp, this),
                 boost::bind(&OpServerProxy::OpServerImpl::ToOpsConnDown, this)));
             to_ops_conn_.get()->RAC_Connect();
+            if (uve_only_) {
+                return;
+            }
             from_ops_conn_.reset(new RedisAsyncConnection(evm_, 
                 redis_uve_ip, redis_uve_port, 
                 boost::bind(&OpServerProxy::OpServerImpl::FromOpsConnUp, this),
@@ -316,17 +364,25 @@ class OpServerProxy::OpServerImpl {
         EventManager *evm_;
         VizCollector *collector_;
         bool started_;
+        const int shard_;
+        const bool uve_only_;
         shared_ptr<RedisAsyncConnection> to_ops_conn_;
         shared_ptr<RedisAsyncConnection> from_ops_conn_;
         RedisAsyncConnection::ClientAsyncCmdCbFn analytics_cb_proc_fn;
         RedisAsyncConnection::ClientAsyncCmdCbFn processor_cb_proc_fn;
+        boost::scoped_ptr<RedisUveBatcher> uve_batcher_;
         tbb::mutex rac_mutex_;
 };
 
 OpServerProxy::OpServerProxy(EventManager *evm, VizCollector *collector,
                              const std::string& redis_uve_ip,
-                             unsigned short redis_uve_port) {
-    impl_ = new OpServerImpl(evm, collector, redis_uve_ip, redis_uve_port);
+                             unsigned short redis_uve_port,
+                             size_t uve_batch_size,
+                             int uve_batch_latency_msec,
+                             int shard) {
+    impl_ = new OpServerImpl(evm, collector, redis_uve_ip, redis_uve_port,
+                             uve_batch_size, uve_batch_latency_msec,
+                             shard);
 }
 
 OpServerProxy::~OpServerProxy() {
@@ -349,6 +405,16 @@ OpServerProxy::UVEUpdate(const std::string &type, const std::string &attr,
         return false;
     }
 
+    RedisUveBatcher *batcher = impl_->uve_batcher();
+    RedisUveGenerator generator(source, node_type, module, instance_id);
+    if (agg != "stats" && batcher->enabled()) {
+        return batcher->Enqueue(generator,
+                RedisUveUpdate(type, attr, key, message, seq));
+    }
+
+    // Stats updates use a different script and are not batched. Flush the
+    // pending updates of the generator first to keep them in order.
+    batcher->Flush(generator);
     bool ret = RedisProcessorExec::UVEUpdate(prac.get(), NULL, type, attr,
             source, node_type, module, instance_id, key, message, seq, agg, atyp, ts);
     ret ? impl_->redis_uve_.RedisUveUpdate() : impl_->redis_uve_.RedisUveUpdateFail(); 
@@ -368,6 +434,10 @@ OpServerProxy::UVEDelete(const std::string &type,
         return false;
     }
 
+    // The delete must be applied after any pending update of the generator
+    impl_->uve_batcher()->Flush(
+            RedisUveGenerator(source, node_type, module, instance_id));
+
     bool ret = RedisProcessorExec::UVEDelete(prac.get(), NULL, type, source, 
             node_type, module, instance_id, key, seq);
     ret ? impl_->redis_uve_.RedisUveDelete() : impl_->redis_uve_.RedisUveDeleteFail(); 
@@ -396,9 +466,18 @@ OpServerProxy::DeleteUVEs(const string &source, const string &module,
     shared_ptr<RedisAsyncConnection> prac = impl_->to_ops_conn();
     if  (!(prac && prac->IsConnUp())) return false;
 
-    return RedisProcessorExec::SyncDeleteUVEs(impl_->redis_uve_.GetIp(), 
+    // Pending updates of the generator would only be deleted, drop them.
+    // The synchronous delete is not ordered after batches the batcher has
+    // already handed to the async connection, so the delete is repeated on
+    // that connection behind them.
+    impl_->uve_batcher()->Discard(
+            RedisUveGenerator(source, node_type, module, instance_id));
+    bool ret = RedisProcessorExec::SyncDeleteUVEs(impl_->redis_uve_.GetIp(), 
             impl_->redis_uve_.GetPort(), source, node_type, 
             module, instance_id);
+    RedisProcessorExec::DeleteUVEs(prac.get(), NULL, source, node_type,
+                                   module, instance_id);
+    return ret;
 }
 
 void 
@@ -9,6 +9,7 @@
 #include "io/event_manager.h"
 #include <sandesh/sandesh.h>
 #include "redis_types.h"
+#include "redis_uve_batch.h"
 
 // This class can be used to send UVE Traces from vizd to the OpSever(s)
 // Currently, this is done via Redis. 
@@ -24,9 +25,18 @@ public:
         STATUS_PRESENT = 3,
     };
 
-    // To construct this interface, pass in the hostname and port for Redis
+    // To construct this interface, pass in the hostname and port for Redis.
+    // UVE updates are batched per generator, up to uve_batch_size updates
+    // or uve_batch_latency_msec. A batch size of 0 or 1 disables batching.
+    // The proxy of a collector shard (shard >= 0) only carries the UVEs of
+    // the generators of that shard: it does not subscribe to the analytics
+    // channel and does not delete the collector's own UVEs on startup. Its
+    // redis up/down only resyncs the generators of the shard.
     OpServerProxy(EventManager *evm, VizCollector *collector,
-            const std::string& redis_uve_ip, unsigned short redis_uve_port);
+            const std::string& redis_uve_ip, unsigned short redis_uve_port,
+            size_t uve_batch_size = RedisUveBatcher::kDefaultBatchSize,
+            int uve_batch_latency_msec = RedisUveBatcher::kDefaultLatencyMsec,
+            int shard = -1);
     OpServerProxy() : impl_(NULL) { }
     virtual ~OpServerProxy();
 
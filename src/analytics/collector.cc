@@ -27,6 +27,7 @@
 #include <discovery_client_stats_types.h>
 
 #include "collector.h"
+#include "collector_shard.h"
 #include "viz_collector.h"
 #include "ruleeng.h"
 #include "viz_sandesh.h"
@@ -64,7 +65,7 @@ Collector::Collector(EventManager *evm, short server_port,
         db_handler_(db_handler),
         osp_(ruleeng->GetOSP()),
         evm_(evm),
-        cb_(boost::bind(&Ruleeng::rule_execute, ruleeng, _1, _2, _3)),
+        cb_(boost::bind(&Ruleeng::rule_execute, ruleeng, _1, _2, _3, _4)),
         cassandra_ip_(cassandra_ip),
         cassandra_port_(cassandra_port),
         analytics_ttl_(analytics_ttl),
@@ -98,15 +99,46 @@ void Collector::SessionShutdown() {
 
 void Collector::Shutdown() {
     SandeshServer::Shutdown();
+    for (ShardList::iterator it = shards_.begin(); it != shards_.end(); ++it) {
+        it->Shutdown();
+    }
 }
 
-void Collector::RedisUpdate(bool rsc) {
-    LOG(INFO, "RedisUpdate " << rsc);
+void Collector::AddShard(CollectorShard *shard) {
+    shards_.push_back(shard);
+}
 
+CollectorShard *Collector::SelectShard(const std::string &name) {
+    if (shards_.empty()) {
+        return NULL;
+    }
+    return &shards_[CollectorShard::Select(name, shards_.size())];
+}
+
+void Collector::GetShardInfo(vector<CollectorShardInfo> &shardlist) const {
+    shardlist.clear();
+    for (ShardList::const_iterator it = shards_.begin(); it != shards_.end();
+         ++it) {
+        CollectorShardInfo info;
+        it->GetShardInfo(info);
+        shardlist.push_back(info);
+    }
+}
+
+void Collector::RedisUpdate(bool rsc, int shard) {
+    LOG(INFO, "RedisUpdate " << rsc << " Shard " << shard);
+
+    if (shard >= 0 && static_cast<size_t>(shard) < shards_.size()) {
+        shards_[shard].set_redis_up(rsc);
+    }
     tbb::mutex::scoped_lock lock(gen_map_mutex_);
     for (GeneratorMap::iterator gen_it = gen_map_.begin();
             gen_it != gen_map_.end(); gen_it++) {
         SandeshGenerator *gen = gen_it->second;
+        int gen_shard = gen->shard() ? gen->shard()->index() : -1;
+        if (gen_shard != shard) {
+            continue;
+        }
         if (gen->session()) gen->get_state_machine()->ResourceUpdate(rsc);
     }
     return;
@@ -126,7 +158,7 @@ bool Collector::ReceiveResourceUpdate(SandeshSession *session,
 
         std::vector<UVETypeInfo> vu;
         std::map<std::string, int32_t> seqReply;
-        bool retc = osp_->GetSeq(gen->source(), gen->node_type(),
+        bool retc = gen->GetOSP()->GetSeq(gen->source(), gen->node_type(),
                         gen->module(), gen->instance_id(), seqReply);
         if (retc) {
             for (map<string,int32_t>::const_iterator it = seqReply.begin();
@@ -224,8 +256,10 @@ bool Collector::ReceiveSandeshCtrlMsg(SandeshStateMachine *state_machine,
     tbb::mutex::scoped_lock lock(gen_map_mutex_);
     GeneratorMap::iterator gen_it = gen_map_.find(id);
     if (gen_it == gen_map_.end()) {
+        CollectorShard *shard = SelectShard(id.get<0>() + ":" +
+                id.get<3>() + ":" + id.get<1>() + ":" + id.get<2>());
         gen = new SandeshGenerator(this, vsession, state_machine, id.get<0>(),
-                id.get<1>(), id.get<2>(), id.get<3>());
+                id.get<1>(), id.get<2>(), id.get<3>(), shard);
         gen_map_.insert(id, gen);
     } else {
         // Update the generator if needed
@@ -252,7 +286,8 @@ bool Collector::ReceiveSandeshCtrlMsg(SandeshStateMachine *state_machine,
     
     std::vector<UVETypeInfo> vu;
     std::map<std::string, int32_t> seqReply;
-    bool retc = osp_->GetSeq(snh->get_source(), snh->get_node_type_name(),
+    bool retc = gen->GetOSP()->GetSeq(snh->get_source(),
+                             snh->get_node_type_name(),
                              snh->get_module_name(), snh->get_instance_id_name(),
                              seqReply);
     if (retc) {
@@ -319,10 +354,15 @@ void Collector::GetGeneratorStats(vector<SandeshMessageStat> &smslist,
         gen->GetDbStats(vdbti, dbe);
         vector<GenDb::DbErrors> vdbe;
         vdbe.push_back(dbe);
+        GenDb::DbBatchInfo dbbi;
+        gen->GetDbBatchStats(dbbi);
+        vector<GenDb::DbBatchInfo> vdbbi;
+        vdbbi.push_back(dbbi);
         GeneratorDbStats gdbstats;
         gdbstats.set_name(gen->ToString());
         gdbstats.set_table_info(vdbti);
         gdbstats.set_errors(vdbe); 
+        gdbstats.set_batch_info(vdbbi);
     }
 }
 
@@ -458,6 +498,10 @@ void Collector::SetQueueWaterMarkInfo(QueueType::type type,
         }
     }
     if (type == QueueType::Db) {
+        for (ShardList::iterator it = shards_.begin(); it != shards_.end();
+             ++it) {
+            it->SetDbQueueWaterMarkInfo(wm);
+        }
         db_queue_wm_info_.push_back(wm);
     } else if (type == QueueType::Sm) {
         sm_queue_wm_info_.push_back(wm);
@@ -484,6 +528,10 @@ void Collector::ResetQueueWaterMarkInfo(QueueType::type type) {
         } 
     }
     if (type == QueueType::Db) {
+        for (ShardList::iterator it = shards_.begin(); it != shards_.end();
+             ++it) {
+            it->ResetDbQueueWaterMarkInfo();
+        }
         db_queue_wm_info_.clear();
     } else if (type == QueueType::Sm) {
         sm_queue_wm_info_.clear();
@@ -545,6 +593,10 @@ public:
         vector<GeneratorSummaryInfo> generators;
         vsc->Analytics()->GetCollector()->GetGeneratorSummaryInfo(generators);
         resp->set_generators(generators);
+        // Collector shard info
+        vector<CollectorShardInfo> shards;
+        vsc->Analytics()->GetCollector()->GetShardInfo(shards);
+        resp->set_shards(shards);
         // Send the response
         resp->set_context(req->context());
         resp->Response();
@@ -690,3 +742,20 @@ void DiscoveryClientPublisherStatsReq::HandleRequest() const {
     resp->set_more(false);
     resp->Response();
 }
+
+void DiscoveryClientHttpStatsReq::HandleRequest() const {
+
+    DiscoveryClientHttpStatsResponse *resp =
+        new DiscoveryClientHttpStatsResponse();
+    resp->set_context(context());
+
+    DiscoveryClientHttpStats stats;
+    DiscoveryServiceClient *ds = Collector::GetCollectorDiscoveryServiceClient();
+    if (ds) {
+        ds->FillDiscoveryServiceHttpStats(stats);
+    }
+
+    resp->set_http(stats);
+    resp->set_more(false);
+    resp->Response();
+}
@@ -7,6 +7,7 @@
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/ptr_container/ptr_map.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/tuple/tuple_comparison.hpp>
 
@@ -32,6 +33,7 @@
 #include <string>
 #include "collector_uve_types.h"
 
+class CollectorShard;
 class DbHandler;
 class Ruleeng;
 class OpServerProxy;
@@ -42,7 +44,8 @@ class Collector : public SandeshServer {
 public:
     const static std::string kDbTask;
 
-    typedef boost::function<bool(const VizMsg*, bool, DbHandler *)> VizCallback;
+    typedef boost::function<bool(const VizMsg*, bool, DbHandler *,
+        OpServerProxy *)> VizCallback;
 
     Collector(EventManager *evm, short server_port,
               DbHandler *db_handler, Ruleeng *ruleeng,
@@ -62,6 +65,7 @@ public:
     void GetGeneratorStats(std::vector<SandeshMessageStat> &smslist,
         std::vector<GeneratorDbStats> &gdbslist);
     void GetGeneratorUVEInfo(std::vector<ModuleServerState> &genlist);
+    void GetShardInfo(std::vector<CollectorShardInfo> &shardlist) const;
     bool SendRemote(const std::string& destination,
             const std::string &dec_sandesh);
 
@@ -85,7 +89,16 @@ public:
     OpServerProxy * GetOSP() const { return osp_; }
     EventManager * event_manager() const { return evm_; }
     VizCallback ProcessSandeshMsgCb() const { return cb_; }
-    void RedisUpdate(bool rsc);
+    // Resyncs the generators of the given shard, or the generators without
+    // a shard if shard is -1, after their redis connection went up or down.
+    void RedisUpdate(bool rsc, int shard = -1);
+
+    // Generators are hashed onto the shards by name. Without shards, every
+    // generator has a database connection of its own and shares the redis
+    // connection of the collector.
+    void AddShard(CollectorShard *shard);
+    CollectorShard *SelectShard(const std::string &name);
+    size_t shard_count() const { return shards_.size(); }
 
     static const std::string &GetProgramName() { return prog_name_; };
     static void SetProgramName(const char *name) { prog_name_ = name; };
@@ -141,6 +154,11 @@ private:
     int analytics_ttl_;
     int db_task_id_;
 
+    // Collector shards, only modified before the server is started. The
+    // generators refer to their shard, so the shards are destroyed last.
+    typedef boost::ptr_vector<CollectorShard> ShardList;
+    ShardList shards_;
+
     // SandeshGenerator map
     typedef boost::ptr_map<SandeshGenerator::GeneratorId, SandeshGenerator> GeneratorMap;
     mutable tbb::mutex gen_map_mutex_;
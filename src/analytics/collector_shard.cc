@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "collector_shard.h"
+
+#include <vector>
+#include <boost/asio/ip/host_name.hpp>
+#include <boost/bind.hpp>
+
+#include "base/logging.h"
+#include "base/task.h"
+#include "base/timer.h"
+#include "io/event_manager.h"
+
+#include "OpServerProxy.h"
+#include "collector.h"
+#include "collector_uve_types.h"
+#include "db_handler.h"
+
+using std::string;
+using std::vector;
+
+CollectorShard::CollectorShard(Collector *collector, int index,
+                               OpServerProxy *osp) :
+    collector_(collector),
+    index_(index),
+    name_(ShardName(index)),
+    osp_(osp),
+    db_handler_(new DbHandler(collector->event_manager(),
+        boost::bind(&CollectorShard::StartDbifReinit, this),
+        collector->cassandra_ip(), collector->cassandra_port(),
+        collector->analytics_ttl(), name_)),
+    db_connect_timer_(TimerManager::CreateTimer(
+        *collector->event_manager()->io_service(),
+        "CollectorShard db connect timer: " + name_,
+        TaskScheduler::GetInstance()->GetTaskId(Collector::kDbTask),
+        index)),
+    started_(false),
+    shutdown_(false) {
+    generators_ = 0;
+    redis_up_ = false;
+}
+
+CollectorShard::~CollectorShard() {
+    Shutdown();
+}
+
+std::string CollectorShard::ShardName(int index) {
+    boost::system::error_code error;
+    return boost::asio::ip::host_name(error) + ":Shard" +
+        integerToString(index);
+}
+
+//
+// FNV-1a of the generator name.
+//
+size_t CollectorShard::Select(const string &name, size_t count) {
+    uint32_t hash = 2166136261U;
+    for (string::const_iterator it = name.begin(); it != name.end(); ++it) {
+        hash ^= static_cast<uint8_t>(*it);
+        hash *= 16777619U;
+    }
+    return hash % count;
+}
+
+void CollectorShard::AddGenerator() {
+    generators_++;
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (started_ || shutdown_) {
+        return;
+    }
+    started_ = true;
+    if (!Db_Connection_Init()) {
+        db_connect_timer_->Start(kDbConnectTimerSec * 1000,
+            boost::bind(&CollectorShard::DbConnectTimerExpired, this),
+            boost::bind(&CollectorShard::TimerErrorHandler, this, _1, _2));
+    }
+}
+
+void CollectorShard::DeleteGenerator() {
+    generators_--;
+}
+
+void CollectorShard::Shutdown() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (shutdown_) {
+        return;
+    }
+    shutdown_ = true;
+    TimerManager::DeleteTimer(db_connect_timer_);
+    db_connect_timer_ = NULL;
+    if (started_) {
+        db_handler_->UnInit(index_);
+    }
+}
+
+bool CollectorShard::IsShutdown() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return shutdown_;
+}
+
+void CollectorShard::StartDbifReinit() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (shutdown_) {
+        return;
+    }
+    db_handler_->UnInit(index_);
+    db_connect_timer_->Start(kDbConnectTimerSec * 1000,
+        boost::bind(&CollectorShard::DbConnectTimerExpired, this),
+        boost::bind(&CollectorShard::TimerErrorHandler, this, _1, _2));
+}
+
+bool CollectorShard::DbConnectTimerExpired() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (shutdown_) {
+        return false;
+    }
+    return !Db_Connection_Init();
+}
+
+void CollectorShard::TimerErrorHandler(string name, string error) {
+    LOG(ERROR, name_ << ": " << name << " error: " << error);
+}
+
+bool CollectorShard::Db_Connection_Init() {
+    if (!db_handler_->Init(false, index_)) {
+        LOG(ERROR, name_ << ": Database setup FAILED");
+        return false;
+    }
+    // Watermarks are kept by the database interface across reconnects
+    db_handler_->ResetDbQueueWaterMarkInfo();
+    vector<Sandesh::QueueWaterMarkInfo> wm_info;
+    collector_->GetDbQueueWaterMarkInfo(wm_info);
+    for (size_t i = 0; i < wm_info.size(); i++) {
+        db_handler_->SetDbQueueWaterMarkInfo(wm_info[i]);
+    }
+    return true;
+}
+
+void CollectorShard::SetDbQueueWaterMarkInfo(Sandesh::QueueWaterMarkInfo &wm) {
+    db_handler_->SetDbQueueWaterMarkInfo(wm);
+}
+
+void CollectorShard::ResetDbQueueWaterMarkInfo() {
+    db_handler_->ResetDbQueueWaterMarkInfo();
+}
+
+void CollectorShard::GetShardInfo(CollectorShardInfo &info) const {
+    info.set_name(name_);
+    info.set_generators(generators_);
+    info.set_redis_up(redis_up_);
+    uint64_t db_queue_count;
+    uint64_t db_enqueues;
+    string db_drop_level;
+    vector<SandeshStats> vdropmstats;
+    if (db_handler_->GetStats(db_queue_count, db_enqueues, db_drop_level,
+                              vdropmstats)) {
+        info.set_db_queue_count(db_queue_count);
+        info.set_db_enqueues(db_enqueues);
+        info.set_db_drop_level(db_drop_level);
+        info.set_db_dropped_msg_stats(vdropmstats);
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef COLLECTOR_SHARD_H_
+#define COLLECTOR_SHARD_H_
+
+#include <string>
+#include <boost/scoped_ptr.hpp>
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+
+#include <sandesh/sandesh.h>
+#include "base/util.h"
+
+class Collector;
+class CollectorShardInfo;
+class DbHandler;
+class OpServerProxy;
+class Timer;
+
+//
+// A collector shard owns a database connection and a redis connection,
+// which are shared by all the generators that hash onto the shard. The
+// database queue of a shard runs in the analytics::DbHandler task with the
+// shard index as task instance. Shards therefore insert in parallel, while
+// the messages of the generators of a shard are serialized on its queue.
+//
+// The database connection is setup when the first generator is added and
+// is kept until the collector is shutdown. Generators that are hashed onto
+// a shard do not open a database connection of their own.
+//
+class CollectorShard {
+public:
+    CollectorShard(Collector *collector, int index, OpServerProxy *osp);
+    ~CollectorShard();
+
+    // Stable across restarts, so that a generator reconnecting to the same
+    // collector lands on the same shard.
+    static size_t Select(const std::string &name, size_t count);
+
+    void AddGenerator();
+    void DeleteGenerator();
+    void Shutdown();
+
+    void SetDbQueueWaterMarkInfo(Sandesh::QueueWaterMarkInfo &wm);
+    void ResetDbQueueWaterMarkInfo();
+    void GetShardInfo(CollectorShardInfo &info) const;
+
+    int index() const { return index_; }
+    const std::string &name() const { return name_; }
+    uint32_t generators() const { return generators_; }
+    bool redis_up() const { return redis_up_; }
+    void set_redis_up(bool redis_up) { redis_up_ = redis_up; }
+    bool IsShutdown() const;
+    DbHandler *GetDbHandler() const { return db_handler_.get(); }
+    OpServerProxy *GetOSP() const { return osp_.get(); }
+
+private:
+    static std::string ShardName(int index);
+    void StartDbifReinit();
+    bool DbConnectTimerExpired();
+    void TimerErrorHandler(std::string name, std::string error);
+    bool Db_Connection_Init();
+
+    static const uint32_t kDbConnectTimerSec = 10;
+
+    Collector * const collector_;
+    const int index_;
+    const std::string name_;
+    boost::scoped_ptr<OpServerProxy> osp_;
+    boost::scoped_ptr<DbHandler> db_handler_;
+    Timer *db_connect_timer_;
+    tbb::atomic<uint32_t> generators_;
+    tbb::atomic<bool> redis_up_;
+    bool started_;
+    bool shutdown_;
+    mutable tbb::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(CollectorShard);
+};
+
+#endif /* COLLECTOR_SHARD_H_ */
@@ -252,6 +252,10 @@ bool DbHandler::GetStats(std::vector<GenDb::DbTableInfo> &vdbti,
     return dbif_->Db_GetStats(vdbti, dbe);
 }
 
+bool DbHandler::GetBatchStats(GenDb::DbBatchInfo &dbbi) const {
+    return dbif_->Db_GetBatchStats(dbbi);
+}
+
 bool DbHandler::AllowMessageTableInsert(const SandeshHeader &header) {
     return header.get_Type() != SandeshType::FLOW;
 }
@@ -831,9 +835,10 @@ static bool PopulateFlowIndexTables(FlowValueArray &fvalues,
     return true;
 }
 
-template <typename T>
-bool FlowDataIpv4ObjectWalker<T>::for_each(pugi::xml_node& node) {
-    std::string col_name(node.name());
+static void PopulateFlowValue(FlowValueArray &values,
+    boost::uuids::string_generator &s_gen, const char *name,
+    const char *value) {
+    std::string col_name(name);
     FlowTypeMap::const_iterator it = flow_msg2type_map.find(col_name);
     if (it != flow_msg2type_map.end()) {
         // Extract the values and populate the value array
@@ -842,47 +847,47 @@ bool FlowDataIpv4ObjectWalker<T>::for_each(pugi::xml_node& node) {
         case GenDb::DbDataType::Unsigned8Type:
             {
                 int8_t val;
-                stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint8_t>(val);
+                stringToInteger(value, val);
+                values[ftinfo.get<0>()] = static_cast<uint8_t>(val);
                 break;
             }
         case GenDb::DbDataType::Unsigned16Type:
             {
                 int16_t val;
-                stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint16_t>(val);
+                stringToInteger(value, val);
+                values[ftinfo.get<0>()] = static_cast<uint16_t>(val);
                 break;
             }
         case GenDb::DbDataType::Unsigned32Type:
             {
                 int32_t val;
-                stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint32_t>(val);
+                stringToInteger(value, val);
+                values[ftinfo.get<0>()] = static_cast<uint32_t>(val);
                 break;
             }
         case GenDb::DbDataType::Unsigned64Type:
             {
                 int64_t val;
-                stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = static_cast<uint64_t>(val);
+                stringToInteger(value, val);
+                values[ftinfo.get<0>()] = static_cast<uint64_t>(val);
                 break;
             }
         case GenDb::DbDataType::DoubleType:
             {
                 double val;
-                stringToInteger(node.child_value(), val);
-                values_[ftinfo.get<0>()] = val;
+                stringToInteger(value, val);
+                values[ftinfo.get<0>()] = val;
                 break;
             }
         case GenDb::DbDataType::LexicalUUIDType:
         case GenDb::DbDataType::TimeUUIDType:
             {
-                values_[ftinfo.get<0>()] = s_gen_(node.child_value());
+                values[ftinfo.get<0>()] = s_gen(value);
                 break;
             }
         case GenDb::DbDataType::AsciiType:
             {
-                values_[ftinfo.get<0>()] = node.child_value();
+                values[ftinfo.get<0>()] = value;
                 break;
             }
         default:
@@ -890,7 +895,6 @@ bool FlowDataIpv4ObjectWalker<T>::for_each(pugi::xml_node& node) {
             break;
         }
     }
-    return true;
 }
 
 /*
@@ -898,13 +902,18 @@ bool FlowDataIpv4ObjectWalker<T>::for_each(pugi::xml_node& node) {
  */
 bool DbHandler::FlowTableInsert(const pugi::xml_node &parent,
     const SandeshHeader& header) {
-    // Traverse and populate the flow entry values
+    VizMsgFields::FlowFieldList fields;
+    VizMsgFields::GetFlowFields(parent, &fields);
+    return FlowTableInsert(fields, header);
+}
+
+bool DbHandler::FlowTableInsert(const VizMsgFields::FlowFieldList &fields,
+    const SandeshHeader& header) {
+    // Populate the flow entry values
     FlowValueArray flow_entry_values;
-    FlowDataIpv4ObjectWalker<FlowValueArray> flow_msg_walker(flow_entry_values,
-        s_gen_);
-    pugi::xml_node &mnode = const_cast<pugi::xml_node &>(parent);
-    if (!mnode.traverse(flow_msg_walker)) {
-        VIZD_ASSERT(0);
+    for (VizMsgFields::FlowFieldList::const_iterator it = fields.begin();
+         it != fields.end(); ++it) {
+        PopulateFlowValue(flow_entry_values, s_gen_, it->first, it->second);
     }
     // Populate FLOWREC_VROUTER from SandeshHeader source
     flow_entry_values[FlowRecordFields::FLOWREC_VROUTER] = header.get_Source();
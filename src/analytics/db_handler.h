@@ -86,10 +86,13 @@ public:
 
     bool FlowTableInsert(const pugi::xml_node& parent,
         const SandeshHeader &header);
+    bool FlowTableInsert(const VizMsgFields::FlowFieldList &fields,
+        const SandeshHeader &header);
     bool GetStats(uint64_t &queue_count, uint64_t &enqueues,
         std::string &drop_level, std::vector<SandeshStats> &vdropmstats) const;
     bool GetStats(std::vector<GenDb::DbTableInfo> &vdbti,
         GenDb::DbErrors &dbe);
+    bool GetBatchStats(GenDb::DbBatchInfo &dbbi) const;
 
     void SetDbQueueWaterMarkInfo(Sandesh::QueueWaterMarkInfo &wm);
     void ResetDbQueueWaterMarkInfo();
@@ -114,35 +117,4 @@ private:
     DISALLOW_COPY_AND_ASSIGN(DbHandler);
 };
 
-/*
- * pugi walker to process flow message
- */
-template <typename T>
-class FlowDataIpv4ObjectWalker : public pugi::xml_tree_walker {
-public:
-    FlowDataIpv4ObjectWalker(T &values,
-        boost::uuids::string_generator &s_gen) :
-        values_(values),
-        s_gen_(s_gen) {
-    }
-    ~FlowDataIpv4ObjectWalker() {}
-
-    // Callback that is called when traversal begins
-    virtual bool begin(pugi::xml_node& node) {
-        return true;
-    }
-
-    // Callback that is called for each node traversed
-    virtual bool for_each(pugi::xml_node& node);
-
-    // Callback that is called when traversal ends
-    virtual bool end(pugi::xml_node& node) {
-        return true;
-    }
-
-private:
-    T &values_;
-    boost::uuids::string_generator &s_gen_;
-};
-
 #endif /* DB_HANDLER_H_ */
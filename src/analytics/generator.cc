@@ -24,6 +24,7 @@
 #include "OpServerProxy.h"
 #include "db_handler.h"
 #include "collector.h"
+#include "collector_shard.h"
 #include "generator.h"
 #include "viz_collector.h"
 #include "viz_sandesh.h"
@@ -79,7 +80,7 @@ bool Generator::ReceiveSandeshMsg(const VizMsg *vmsg, bool rsc) {
 SandeshGenerator::SandeshGenerator(Collector * const collector, VizSession *session,
         SandeshStateMachine *state_machine, const string &source,
         const string &module, const string &instance_id,
-        const string &node_type) :
+        const string &node_type, CollectorShard *shard) :
         Generator(),
         collector_(collector),
         state_machine_(state_machine),
@@ -91,7 +92,8 @@ SandeshGenerator::SandeshGenerator(Collector * const collector, VizSession *sess
         name_(source + ":" + node_type_ + ":" + module + ":" + instance_id_),
         instance_(session->GetSessionInstance()),
         db_connect_timer_(NULL),
-        db_handler_(new DbHandler(
+        shard_(shard),
+        db_handler_(shard ? NULL : new DbHandler(
             collector->event_manager(), boost::bind(
                 &SandeshGenerator::StartDbifReinit, this),
             collector->cassandra_ip(), collector->cassandra_port(),
@@ -102,14 +104,38 @@ SandeshGenerator::SandeshGenerator(Collector * const collector, VizSession *sess
     gen_attr_.set_connect_time(UTCTimestampUsec());
     // Update state machine
     state_machine_->SetGeneratorKey(name_);
-    Create_Db_Connect_Timer();
+    if (shard_) {
+        shard_->AddGenerator();
+    } else {
+        Create_Db_Connect_Timer();
+    }
 }
 
 SandeshGenerator::~SandeshGenerator() {
+    if (shard_) {
+        if (!disconnected_) {
+            shard_->DeleteGenerator();
+        }
+        return;
+    }
     Delete_Db_Connect_Timer();
     GetDbHandler()->UnInit(instance_);
 }
 
+DbHandler *SandeshGenerator::db_handler() const {
+    if (shard_) {
+        return shard_->GetDbHandler();
+    }
+    return db_handler_.get();
+}
+
+OpServerProxy *SandeshGenerator::GetOSP() const {
+    if (shard_) {
+        return shard_->GetOSP();
+    }
+    return collector_->GetOSP();
+}
+
 void SandeshGenerator::set_session(VizSession *session) {
     viz_session_ = session;
     instance_ = session->GetSessionInstance();
@@ -195,7 +221,10 @@ void SandeshGenerator::ReceiveSandeshCtrlMsg(uint32_t connects) {
     for (size_t i = 0; i < wm_info.size(); i++) {
         state_machine_->SetQueueWaterMarkInfo(wm_info[i]);
     }
-    // Initialize DB connection
+    // Initialize DB connection, the one of a shard is already setup
+    if (shard_) {
+        return;
+    }
     if (!Db_Connection_Init()) {
         Start_Db_Connect_Timer();
     }
@@ -215,12 +244,15 @@ void SandeshGenerator::DisconnectSession(VizSession *vsession) {
         viz_session_ = NULL;
         state_machine_ = NULL;
         vsession->set_generator(NULL);
-        collector_->GetOSP()->DeleteUVEs(source_, module_, 
-                                         node_type_, instance_id_);
+        GetOSP()->DeleteUVEs(source_, module_, node_type_, instance_id_);
         ModuleServerState ginfo;
         GetGeneratorInfo(ginfo);
         SandeshModuleServerTrace::Send(ginfo);
-        Db_Connection_Uninit();
+        if (shard_) {
+            shard_->DeleteGenerator();
+        } else {
+            Db_Connection_Uninit();
+        }
     } else {
         GENERATOR_LOG(ERROR, "Disconnect for session:" << vsession->ToString() <<
                 ", generator session:" << viz_session_->ToString());
@@ -228,7 +260,8 @@ void SandeshGenerator::DisconnectSession(VizSession *vsession) {
 }
 
 bool SandeshGenerator::ProcessRules(const VizMsg *vmsg, bool rsc) {
-    return collector_->ProcessSandeshMsgCb()(vmsg, rsc, GetDbHandler());
+    return collector_->ProcessSandeshMsgCb()(vmsg, rsc, GetDbHandler(),
+                                             GetOSP());
 }
 
 bool SandeshGenerator::GetSandeshStateMachineQueueCount(
@@ -260,13 +293,17 @@ bool SandeshGenerator::GetSandeshStateMachineStats(
 
 bool SandeshGenerator::GetDbStats(uint64_t &queue_count, uint64_t &enqueues,
     std::string &drop_level, std::vector<SandeshStats> &vdropmstats) const {
-    return db_handler_->GetStats(queue_count, enqueues, drop_level,
+    return db_handler()->GetStats(queue_count, enqueues, drop_level,
                vdropmstats);
 }
 
 bool SandeshGenerator::GetDbStats(std::vector<GenDb::DbTableInfo> &vdbti,
     GenDb::DbErrors &dbe) {
-    return db_handler_->GetStats(vdbti, dbe);
+    return db_handler()->GetStats(vdbti, dbe);
+}
+
+bool SandeshGenerator::GetDbBatchStats(GenDb::DbBatchInfo &dbbi) const {
+    return db_handler()->GetBatchStats(dbbi);
 }
 
 void SandeshGenerator::GetGeneratorInfo(ModuleServerState &genlist) const {
@@ -296,15 +333,26 @@ void SandeshGenerator::ConnectSession(VizSession *session,
     uint32_t tmp = gen_attr_.get_connects();
     gen_attr_.set_connects(tmp+1);
     gen_attr_.set_connect_time(UTCTimestampUsec());
-    Create_Db_Connect_Timer();
+    if (shard_) {
+        shard_->AddGenerator();
+    } else {
+        Create_Db_Connect_Timer();
+    }
 }
 
 void SandeshGenerator::SetDbQueueWaterMarkInfo(
     Sandesh::QueueWaterMarkInfo &wm) {
+    // The watermarks of a shard are set by the collector
+    if (shard_) {
+        return;
+    }
     GetDbHandler()->SetDbQueueWaterMarkInfo(wm);
 }
 
 void SandeshGenerator::ResetDbQueueWaterMarkInfo() {
+    if (shard_) {
+        return;
+    }
     GetDbHandler()->ResetDbQueueWaterMarkInfo();
 }
 
@@ -21,6 +21,8 @@ class DbHandler;
 class Sandesh;
 class VizSession;
 class Collector;
+class CollectorShard;
+class OpServerProxy;
 class SandeshStateMachineStats;
 
 class Generator {
@@ -48,10 +50,13 @@ public:
     typedef boost::tuple<std::string /* Source */, std::string /* Module */,
         std::string /* Instance id */, std::string /* Node type */> GeneratorId;
 
+    // If a shard is given, the database and redis connections of the shard
+    // are used instead of a database connection of the generator's own.
     SandeshGenerator(Collector * const collector, VizSession *session,
             SandeshStateMachine *state_machine,
             const std::string &source, const std::string &module,
-            const std::string &instance_id, const std::string &node_type);
+            const std::string &instance_id, const std::string &node_type,
+            CollectorShard *shard = NULL);
     ~SandeshGenerator();
 
     void ReceiveSandeshCtrlMsg(uint32_t connects);
@@ -66,6 +71,7 @@ public:
         std::string &drop_level, std::vector<SandeshStats> &vdropmstats) const;
     bool GetDbStats(std::vector<GenDb::DbTableInfo> &vdbti,
         GenDb::DbErrors &dbe);
+    bool GetDbBatchStats(GenDb::DbBatchInfo &dbbi) const;
 
     const std::string &instance_id() const { return instance_id_; }
     const std::string &node_type() const { return node_type_; }
@@ -87,9 +93,12 @@ public:
     void SetSmQueueWaterMarkInfo(Sandesh::QueueWaterMarkInfo &wm);
     void ResetSmQueueWaterMarkInfo();
     void StartDbifReinit();
-    virtual DbHandler *GetDbHandler() { return db_handler_.get (); }
+    virtual DbHandler *GetDbHandler() { return db_handler(); }
+    CollectorShard *shard() const { return shard_; }
 
 private:
+    DbHandler *db_handler() const;
+    OpServerProxy *GetOSP() const;
     virtual bool ProcessRules(const VizMsg *vmsg, bool rsc);
     void set_session(VizSession *session);
 
@@ -127,6 +136,7 @@ private:
 
     Timer *db_connect_timer_;
     tbb::atomic<bool> disconnected_;
+    CollectorShard * const shard_;
     boost::scoped_ptr<DbHandler> db_handler_;
     mutable tbb::mutex mutex_;
 };
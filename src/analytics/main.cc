@@ -118,6 +118,12 @@ bool CollectorSummaryLogger(Collector *collector, const string & hostname,
 
     state.set_generator_infos(infos);
 
+    if (collector->shard_count()) {
+        std::vector<CollectorShardInfo> shard_infos;
+        collector->GetShardInfo(shard_infos);
+        state.set_shard_infos(shard_infos);
+    }
+
     // Get socket stats
     TcpServerSocketStats rx_stats;
     collector->GetRxSocketStats(rx_stats);
@@ -250,6 +256,7 @@ int main(int argc, char *argv[])
     stringToInteger(port, cassandra_port);
 
     LOG(INFO, "COLLECTOR LISTEN PORT: " << options.collector_port());
+    LOG(INFO, "COLLECTOR SHARDS: " << options.collector_shards());
     LOG(INFO, "COLLECTOR REDIS UVE PORT: " << options.redis_port());
     LOG(INFO, "COLLECTOR CASSANDRA SERVER: " << cassandra_ip);
     LOG(INFO, "COLLECTOR CASSANDRA PORT: " << cassandra_port);
@@ -262,7 +269,10 @@ int main(int argc, char *argv[])
             options.redis_port(),
             options.syslog_port(),
             options.dup(),
-            options.analytics_data_ttl());
+            options.analytics_data_ttl(),
+            options.redis_uve_batch_size(),
+            options.redis_uve_batch_latency_msec(),
+            options.collector_shards());
 
 #if 0
     // initialize python/c++ API
@@ -7,6 +7,7 @@
 #include <boost/asio/ip/host_name.hpp>
 
 #include "analytics/buildinfo.h"
+#include "analytics/redis_uve_batch.h"
 #include "base/contrail_ports.h"
 #include "base/logging.h"
 #include "base/misc_utils.h"
@@ -54,6 +55,8 @@ void Options::Initialize(EventManager &evm,
     uint16_t default_collector_port = ContrailPorts::CollectorPort;
     uint16_t default_http_server_port = ContrailPorts::HttpPortCollector;
     uint16_t default_discovery_port = ContrailPorts::DiscoveryServerPort;
+    uint32_t default_uve_batch_size = RedisUveBatcher::kDefaultBatchSize;
+    int default_uve_batch_latency_msec = RedisUveBatcher::kDefaultLatencyMsec;
 
     vector<string> default_cassandra_server_list;
     default_cassandra_server_list.push_back("127.0.0.1:9160");
@@ -67,6 +70,9 @@ void Options::Initialize(EventManager &evm,
         ("COLLECTOR.server",
              opt::value<string>()->default_value("0.0.0.0"),
              "IP address of sandesh collector server")
+        ("COLLECTOR.shards", opt::value<uint32_t>()->default_value(0),
+             "Number of shards the generators are hashed onto, each with "
+             "its own database and redis connection, 0 to disable")
 
         ("DEFAULT.analytics_data_ttl",
              opt::value<int>()->default_value(ANALYTICS_DATA_TTL_DEFAULT),
@@ -116,6 +122,14 @@ void Options::Initialize(EventManager &evm,
              "Port of Redis-uve server")
         ("REDIS.server", opt::value<string>()->default_value("127.0.0.1"),
              "IP address of Redis Server")
+        ("REDIS.uve_batch_size",
+             opt::value<uint32_t>()->default_value(default_uve_batch_size),
+             "Maximum number of UVE updates per generator sent to Redis "
+             "in one command, 0 or 1 to disable batching")
+        ("REDIS.uve_batch_latency_msec",
+             opt::value<int>()->default_value(
+                 default_uve_batch_latency_msec),
+             "Maximum time (msec) a UVE update is held for batching")
         ;
 
     config_file_options_.add(config);
@@ -167,6 +181,7 @@ void Options::Process(int argc, char *argv[],
     // Retrieve the options.
     GetOptValue<uint16_t>(var_map, collector_port_, "COLLECTOR.port");
     GetOptValue<string>(var_map, collector_server_, "COLLECTOR.server");
+    GetOptValue<uint32_t>(var_map, collector_shards_, "COLLECTOR.shards");
     GetOptValue<int>(var_map, analytics_data_ttl_,
                      "DEFAULT.analytics_data_ttl");
 
@@ -189,4 +204,8 @@ void Options::Process(int argc, char *argv[],
 
     GetOptValue<uint16_t>(var_map, redis_port_, "REDIS.port");
     GetOptValue<string>(var_map, redis_server_, "REDIS.server");
+    GetOptValue<uint32_t>(var_map, redis_uve_batch_size_,
+                          "REDIS.uve_batch_size");
+    GetOptValue<int>(var_map, redis_uve_batch_latency_msec_,
+                     "REDIS.uve_batch_latency_msec");
 }
@@ -18,11 +18,18 @@ public:
     }
     const std::string collector_server() const { return collector_server_; }
     const uint16_t collector_port() const { return collector_port_; };
+    const uint32_t collector_shards() const { return collector_shards_; }
     const std::string config_file() const { return config_file_; };
     const std::string discovery_server() const { return discovery_server_; }
     const uint16_t discovery_port() const { return discovery_port_; }
     const std::string redis_server() const { return redis_server_; }
     const uint16_t redis_port() const { return redis_port_; }
+    const uint32_t redis_uve_batch_size() const {
+        return redis_uve_batch_size_;
+    }
+    const int redis_uve_batch_latency_msec() const {
+        return redis_uve_batch_latency_msec_;
+    }
     const std::string hostname() const { return hostname_; }
     const std::string host_ip() const { return host_ip_; }
     const uint16_t http_server_port() const { return http_server_port_; }
@@ -50,11 +57,14 @@ private:
 
     std::string collector_server_;
     uint16_t collector_port_;
+    uint32_t collector_shards_;
     std::string config_file_;
     std::string discovery_server_;
     uint16_t discovery_port_;
     std::string redis_server_;
     uint16_t redis_port_;
+    uint32_t redis_uve_batch_size_;
+    int redis_uve_batch_latency_msec_;
     std::string hostname_;
     std::string host_ip_;
     uint16_t http_server_port_;
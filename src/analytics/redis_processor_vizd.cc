@@ -5,6 +5,7 @@
 #include "base/logging.h"
 #include "redis_processor_vizd.h"
 #include "redis_connection.h"
+#include "redis_uve_batch.h"
 #include <boost/assign/list_of.hpp>
 #include "hiredis/hiredis.h"
 #include "hiredis/boostasio.hpp"
@@ -13,6 +14,7 @@
 #include "delrequest_lua.cpp"
 #include "uveupdate_lua.cpp"
 #include "uveupdate_st_lua.cpp"
+#include "uveupdate_batch_lua.cpp"
 #include "uvedelete_lua.cpp"
 
 using std::string;
@@ -90,6 +92,61 @@ RedisProcessorExec::UVEUpdate(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
     return ret;
 }
 
+bool
+RedisProcessorExec::UVEUpdateBatch(RedisAsyncConnection * rac,
+        RedisProcessorIf *rpi,
+        const std::string &source, const std::string &node_type,
+        const std::string &module, const std::string &instance_id,
+        const std::vector<RedisUveUpdate> &updates) {
+
+    if (updates.empty()) return true;
+
+    string gen = source + ":" + node_type + ":" + module + ":" + instance_id;
+    vector<string> keys;
+    vector<string> args;
+    keys.reserve(1 + updates.size() * 4);
+    args.reserve(4 + updates.size() * 5);
+
+    keys.push_back(string("TYPES:") + gen);
+    args.push_back(source);
+    args.push_back(node_type);
+    args.push_back(module);
+    args.push_back(instance_id);
+
+    for (vector<RedisUveUpdate>::const_iterator it = updates.begin();
+            it != updates.end(); ++it) {
+        size_t sep = it->key.find(":");
+        string table = it->key.substr(0, sep);
+        std::ostringstream seqstr;
+        seqstr << it->seq;
+
+        keys.push_back(string("ORIGINS:") + it->key);
+        keys.push_back(string("TABLE:") + table);
+        keys.push_back(string("UVES:") + gen + ":" + it->type);
+        keys.push_back(string("VALUES:") + it->key + ":" + gen + ":" +
+                       it->type);
+
+        args.push_back(it->type);
+        args.push_back(it->attr);
+        args.push_back(it->key);
+        args.push_back(seqstr.str());
+        args.push_back(it->message);
+    }
+
+    std::ostringstream numkeys;
+    numkeys << keys.size();
+
+    vector<string> cmd;
+    cmd.reserve(3 + keys.size() + args.size());
+    cmd.push_back(string("EVAL"));
+    cmd.push_back(string(reinterpret_cast<char *>(uveupdate_batch_lua),
+                         uveupdate_batch_lua_len));
+    cmd.push_back(numkeys.str());
+    cmd.insert(cmd.end(), keys.begin(), keys.end());
+    cmd.insert(cmd.end(), args.begin(), args.end());
+    return rac->RedisAsyncArgCmd(rpi, cmd);
+}
+
 bool
 RedisProcessorExec::UVEDelete(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
         const std::string &type,
@@ -119,6 +176,18 @@ RedisProcessorExec::UVEDelete(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
 
 }
 
+bool
+RedisProcessorExec::DeleteUVEs(RedisAsyncConnection * rac,
+        RedisProcessorIf *rpi,
+        const std::string &source, const std::string &node_type,
+        const std::string &module, const std::string &instance_id) {
+
+    string lua_scr(reinterpret_cast<char *>(delrequest_lua), delrequest_lua_len);
+    return rac->RedisAsyncArgCmd(rpi,
+        list_of(string("EVAL"))(lua_scr)("0")(
+            source)(node_type)(module)(instance_id));
+}
+
 
 bool
 RedisProcessorExec::SyncGetSeq(const std::string & redis_ip, unsigned short redis_port,  
@@ -14,6 +14,7 @@
 
 class RedisAsyncConnection; 
 class RedisProcessorIf;
+struct RedisUveUpdate;
 
 class RedisProcessorExec {
 public:
@@ -26,6 +27,13 @@ public:
                        int32_t seq, const std::string &agg,
                        const std::string &atyp, int64_t ts);
 
+    // Apply non-stats updates from a single generator with one command
+    static bool
+    UVEUpdateBatch(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
+            const std::string &source, const std::string &node_type,
+            const std::string &module, const std::string &instance_id,
+            const std::vector<RedisUveUpdate> &updates);
+
     static bool
     UVEDelete(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
             const std::string &type,
@@ -33,6 +41,13 @@ public:
             const std::string &module, const std::string &instance_id,
             const std::string &key, int32_t seq);
 
+    // Delete all the UVEs of a generator, ordered behind the commands
+    // already queued on rac
+    static bool
+    DeleteUVEs(RedisAsyncConnection * rac, RedisProcessorIf *rpi,
+            const std::string &source, const std::string &node_type,
+            const std::string &module, const std::string &instance_id);
+
     static bool
     SyncGetSeq(const std::string & redis_ip, unsigned short redis_port,  
             const std::string &source, const std::string &node_type,
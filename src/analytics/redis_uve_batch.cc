@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "redis_uve_batch.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include "io/event_manager.h"
+
+const size_t RedisUveBatcher::kDefaultBatchSize;
+const int RedisUveBatcher::kDefaultLatencyMsec;
+
+bool RedisUveGenerator::operator<(const RedisUveGenerator &rhs) const {
+    if (source != rhs.source) return source < rhs.source;
+    if (node_type != rhs.node_type) return node_type < rhs.node_type;
+    if (module != rhs.module) return module < rhs.module;
+    return instance_id < rhs.instance_id;
+}
+
+RedisUveBatcher::RedisUveBatcher(EventManager *evm, FlushFn flush_fn,
+                                 size_t batch_size, int latency_msec) :
+    flush_fn_(flush_fn),
+    batch_size_(batch_size),
+    latency_msec_(latency_msec),
+    pending_(0),
+    timer_(*evm->io_service()),
+    timer_running_(false),
+    timer_guard_(new TimerGuard(this)) {
+}
+
+// Waits for a timer handler that is running, and turns the ones still
+// queued into no-ops
+RedisUveBatcher::~RedisUveBatcher() {
+    {
+        tbb::mutex::scoped_lock lock(timer_guard_->mutex);
+        timer_guard_->batcher = NULL;
+    }
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+}
+
+bool RedisUveBatcher::Enqueue(const RedisUveGenerator &generator,
+                              const RedisUveUpdate &update) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    stats_.updates++;
+
+    if (!enabled()) {
+        UpdateList updates(1, update);
+        stats_.batches++;
+        stats_.max_batch_size = std::max<uint64_t>(stats_.max_batch_size, 1);
+        if (!flush_fn_(generator, updates)) {
+            stats_.failed_batches++;
+            return false;
+        }
+        return true;
+    }
+
+    BatchMap::iterator it = batches_.find(generator);
+    if (it == batches_.end()) {
+        it = batches_.insert(std::make_pair(generator, UpdateList())).first;
+        it->second.reserve(batch_size_);
+    }
+    it->second.push_back(update);
+    pending_++;
+
+    if (it->second.size() >= batch_size_) {
+        return FlushLocked(it, &stats_.size_flushes);
+    }
+    StartTimerLocked();
+    return true;
+}
+
+void RedisUveBatcher::Flush(const RedisUveGenerator &generator) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    BatchMap::iterator it = batches_.find(generator);
+    if (it != batches_.end()) {
+        FlushLocked(it, &stats_.forced_flushes);
+    }
+}
+
+void RedisUveBatcher::FlushAll() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    while (!batches_.empty()) {
+        FlushLocked(batches_.begin(), &stats_.forced_flushes);
+    }
+}
+
+void RedisUveBatcher::Discard(const RedisUveGenerator &generator) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    BatchMap::iterator it = batches_.find(generator);
+    if (it != batches_.end()) {
+        pending_ -= it->second.size();
+        batches_.erase(it);
+    }
+}
+
+size_t RedisUveBatcher::pending() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return pending_;
+}
+
+void RedisUveBatcher::GetStats(Stats *stats) const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    *stats = stats_;
+}
+
+//
+// Hand the batch of a generator to the flush function and remove it. The
+// counter tells what triggered the flush.
+//
+bool RedisUveBatcher::FlushLocked(BatchMap::iterator it, uint64_t *counter) {
+    const UpdateList &updates = it->second;
+    (*counter)++;
+    stats_.batches++;
+    stats_.max_batch_size =
+        std::max<uint64_t>(stats_.max_batch_size, updates.size());
+    pending_ -= updates.size();
+
+    bool ret = flush_fn_(it->first, updates);
+    if (!ret) {
+        stats_.failed_batches++;
+    }
+    batches_.erase(it);
+    return ret;
+}
+
+void RedisUveBatcher::StartTimerLocked() {
+    if (timer_running_) {
+        return;
+    }
+    timer_running_ = true;
+    boost::system::error_code ec;
+    timer_.expires_from_now(boost::posix_time::milliseconds(latency_msec_),
+                            ec);
+    timer_.async_wait(boost::bind(&RedisUveBatcher::TimerHandler,
+                                  timer_guard_,
+                                  boost::asio::placeholders::error));
+}
+
+void RedisUveBatcher::TimerHandler(boost::shared_ptr<TimerGuard> guard,
+                                   const boost::system::error_code &error) {
+    tbb::mutex::scoped_lock lock(guard->mutex);
+    if (guard->batcher == NULL) {
+        return;
+    }
+    guard->batcher->TimerExpired(error);
+}
+
+void RedisUveBatcher::TimerExpired(const boost::system::error_code &error) {
+    if (error == boost::asio::error::operation_aborted) {
+        return;
+    }
+
+    tbb::mutex::scoped_lock lock(mutex_);
+    timer_running_ = false;
+    while (!batches_.empty()) {
+        FlushLocked(batches_.begin(), &stats_.timer_flushes);
+    }
+}
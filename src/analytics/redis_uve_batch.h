@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __REDIS_UVE_BATCH_H__
+#define __REDIS_UVE_BATCH_H__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <tbb/mutex.h>
+#include "base/util.h"
+
+class EventManager;
+
+// A single UVE attribute update, as passed to uveupdate.lua
+struct RedisUveUpdate {
+    RedisUveUpdate() : seq(0) { }
+    RedisUveUpdate(const std::string &type, const std::string &attr,
+                   const std::string &key, const std::string &message,
+                   int32_t seq) :
+        type(type), attr(attr), key(key), message(message), seq(seq) { }
+
+    std::string type;
+    std::string attr;
+    std::string key;
+    std::string message;
+    int32_t seq;
+};
+
+// Identifies the generator that the UVE updates are from
+struct RedisUveGenerator {
+    RedisUveGenerator() { }
+    RedisUveGenerator(const std::string &source, const std::string &node_type,
+                      const std::string &module,
+                      const std::string &instance_id) :
+        source(source), node_type(node_type), module(module),
+        instance_id(instance_id) { }
+
+    bool operator<(const RedisUveGenerator &rhs) const;
+
+    std::string source;
+    std::string node_type;
+    std::string module;
+    std::string instance_id;
+};
+
+//
+// Accumulates UVE updates per generator and hands them to the flush function
+// as a batch, so that they can be written to redis with a single command.
+// A generator's batch is flushed when it reaches batch_size updates. A timer
+// flushes all pending batches, so no update waits more than latency_msec.
+// Flush() and FlushAll() can be used to force the pending updates out before
+// a command that must be ordered after them, e.g. a UVE delete. Discard()
+// drops the pending updates of a generator whose UVEs are all being deleted.
+//
+// The flush function is always invoked with the batcher lock held, so the
+// batches of a generator are handed over in the order the updates were
+// added. It should only queue the command and not wait for the reply.
+//
+// Batching is disabled if batch_size is 0 or 1. Every update is then handed
+// to the flush function as a batch of one right away.
+//
+class RedisUveBatcher {
+public:
+    typedef std::vector<RedisUveUpdate> UpdateList;
+    typedef boost::function<bool (const RedisUveGenerator &,
+                                  const UpdateList &)> FlushFn;
+
+    static const size_t kDefaultBatchSize = 32;
+    static const int kDefaultLatencyMsec = 10;
+
+    struct Stats {
+        Stats() : updates(0), batches(0), size_flushes(0), timer_flushes(0),
+            forced_flushes(0), failed_batches(0), max_batch_size(0) { }
+        uint64_t updates;
+        uint64_t batches;
+        uint64_t size_flushes;
+        uint64_t timer_flushes;
+        uint64_t forced_flushes;
+        uint64_t failed_batches;
+        uint64_t max_batch_size;
+    };
+
+    RedisUveBatcher(EventManager *evm, FlushFn flush_fn,
+                    size_t batch_size = kDefaultBatchSize,
+                    int latency_msec = kDefaultLatencyMsec);
+    ~RedisUveBatcher();
+
+    // Returns false if the update was flushed right away and the flush
+    // function failed.
+    bool Enqueue(const RedisUveGenerator &generator,
+                 const RedisUveUpdate &update);
+    void Flush(const RedisUveGenerator &generator);
+    void FlushAll();
+    void Discard(const RedisUveGenerator &generator);
+
+    bool enabled() const { return batch_size_ > 1; }
+    size_t batch_size() const { return batch_size_; }
+    int latency_msec() const { return latency_msec_; }
+    size_t pending() const;
+    void GetStats(Stats *stats) const;
+
+private:
+    typedef std::map<RedisUveGenerator, UpdateList> BatchMap;
+
+    // Shared with the timer handler, which can still be queued on the
+    // io_service when the batcher is destroyed
+    struct TimerGuard {
+        explicit TimerGuard(RedisUveBatcher *batcher) : batcher(batcher) { }
+        tbb::mutex mutex;
+        RedisUveBatcher *batcher;
+    };
+
+    bool FlushLocked(BatchMap::iterator it, uint64_t *counter);
+    void StartTimerLocked();
+    static void TimerHandler(boost::shared_ptr<TimerGuard> guard,
+                             const boost::system::error_code &error);
+    void TimerExpired(const boost::system::error_code &error);
+
+    FlushFn flush_fn_;
+    const size_t batch_size_;
+    const int latency_msec_;
+    mutable tbb::mutex mutex_;
+    BatchMap batches_;
+    size_t pending_;
+    boost::asio::deadline_timer timer_;
+    bool timer_running_;
+    boost::shared_ptr<TimerGuard> timer_guard_;
+    Stats stats_;
+
+    DISALLOW_COPY_AND_ASSIGN(RedisUveBatcher);
+};
+
+#endif
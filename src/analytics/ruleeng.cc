@@ -83,55 +83,18 @@ bool Ruleeng::rule_present(const VizMsg *vmsgp) {
 }
 
 /*
- * Check if any handling is needed for the message wrt to ObjectLog
- * Looks for the 'key' annotations for the table name and inserts
- * the object trace with the rowkey corresponding to the value of the
- * field
+ * Insert the object trace for the rowkeys that were found for the 'key'
+ * annotations of the message. The keys are only extracted if the message
+ * has the key hint.
  */
-void Ruleeng::handle_object_log(const pugi::xml_node& parent, const VizMsg *rmsg,
+void Ruleeng::handle_object_log(const VizMsgFields &fields, const VizMsg *rmsg,
         DbHandler *db, const SandeshHeader &header) {
-    if (!(header.get_Hints() & g_sandesh_constants.SANDESH_KEY_HINT)) {
-        return;
-    }
-
-    std::map<std::string, std::string> keymap;
-    std::map<std::string, std::string>::iterator it;
-    const char *table, *rowkey;
-
-    for (pugi::xml_node node = parent.first_child(); node;
-         node = node.next_sibling()) {
-        table = node.attribute("key").value();
-        if (strcmp(table, "")) {
-            rowkey = node.child_value();
-            it = keymap.find(table);
-            if (it != keymap.end()) {
-                std::string tempstr(it->second);
-                tempstr.append(":");
-                tempstr.append(rowkey);
-                keymap.erase(it);
-                keymap.insert(std::pair<std::string, std::string>(table, tempstr));
-            } else {
-                keymap.insert(std::pair<std::string, std::string>(table, rowkey));
-            }
-        }
-    }
     uint64_t timestamp(header.get_Timestamp());
-    for (it = keymap.begin(); it != keymap.end(); it++) {
+    for (VizMsgFields::ObjectKeyList::const_iterator it =
+         fields.object_keys.begin(); it != fields.object_keys.end(); ++it) {
         db->ObjectTableInsert(it->first, it->second, 
             timestamp, rmsg->unm);
     }
-    for (pugi::xml_node node = parent.first_child(); node;
-         node = node.next_sibling()) {
-        handle_object_log(node, rmsg, db, header);
-    }
-}
-
-void Ruleeng::remove_identifier(const pugi::xml_node &parent) {
-    for (pugi::xml_node node = parent.first_child(); node;
-         node = node.next_sibling()) {
-        node.remove_attribute("identifier");
-        remove_identifier(node);
-    }
 }
 
 static DbHandler::Var ParseNode(const pugi::xml_node& node) {
@@ -150,7 +113,8 @@ static DbHandler::Var ParseNode(const pugi::xml_node& node) {
 }
 
 bool Ruleeng::handle_uve_publish(const pugi::xml_node& parent,
-    const VizMsg *rmsg, DbHandler *db, const SandeshHeader& header) {
+    const VizMsgFields &fields, const VizMsg *rmsg, DbHandler *db,
+    OpServerProxy *osp, const SandeshHeader& header) {
     if (header.get_Type() != SandeshType::UVE) {
         return true;
     }
@@ -163,75 +127,27 @@ bool Ruleeng::handle_uve_publish(const pugi::xml_node& parent,
     int32_t seq(header.get_SequenceNum());
     int64_t ts(header.get_Timestamp());
 
-    pugi::xml_node object(parent);
-    if (!object) {
+    if (!parent) {
         LOG(ERROR, __func__ << " Message: " << type << " : " << source <<
             ":" << node_type << ":" << module << ":" << instance_id <<
             " object NOT PRESENT: " << rmsg->msg->ExtractMessage());
         return false;
     }
 
-    object = object.child("data");
-    object = object.first_child();
-
-    std::string barekey;
-    const char *tempstr, *rowkey;
-    std::string table;
+    const pugi::xml_node &object(fields.uve_object);
+    const std::string &key(fields.uve_key);
+    const char *tempstr;
 
-    for (pugi::xml_node node = object.first_child(); node;
-            node = node.next_sibling()) {
-        tempstr = node.attribute("key").value();
-        if (strcmp(tempstr, "")) {
-            rowkey = node.child_value();
-            if (!barekey.empty()) {
-                barekey.append(":");
-                barekey.append(rowkey);
-            } else {
-                table = std::string(tempstr);
-                barekey.append(rowkey);
-                
-            }
-        }
-    }
-
-    std::string key = table + ":" + barekey;
-
-    if (table.empty()) {
+    if (fields.uve_table.empty()) {
         LOG(ERROR, __func__ << " Message: " << type << " : " << source <<
             ":" << node_type << ":" << module << ":" << instance_id <<
             " key NOT PRESENT");
         return false;
     }
 
-    bool deleted = false;
-    for (pugi::xml_node node = object.first_child(); node;
-           node = node.next_sibling()) {
-        std::ostringstream ostr; 
-        node.print(ostr, "", pugi::format_raw);
-        std::string agg;
-        std::string atyp;
-        if (!strcmp(node.name(), "deleted")) {
-            if (!strcmp(node.child_value(), "true")) {
-                deleted = true;
-                continue;
-            }
-            continue;
-        }
-        tempstr = node.attribute("key").value();
-        if (strcmp(tempstr, "")) {
-            continue;
-        }
-        tempstr = node.attribute("aggtype").value();
-        if (strcmp(tempstr, "")) {
-            agg = std::string(tempstr);
-            if (!strcmp(tempstr,"stats")) {
-                ostr.str("");
-                ostr.clear();
-                ostr << node.child_value();
-            }
-        } else {
-            agg = std::string("None");
-        }
+    for (std::vector<pugi::xml_node>::const_iterator it =
+         fields.uve_attrs.begin(); it != fields.uve_attrs.end(); ++it) {
+        const pugi::xml_node &node(*it);
 
         if (!node.attribute("tags").empty()) {
 
@@ -369,8 +285,24 @@ bool Ruleeng::handle_uve_publish(const pugi::xml_node& parent,
             }
             continue;
         }
-        
-        if (!osp_->UVEUpdate(object.name(), node.name(),
+
+        // Stats are aggregated from the value, everything else is stored
+        // as the serialized attribute
+        std::ostringstream ostr; 
+        std::string agg;
+        tempstr = node.attribute("aggtype").value();
+        if (strcmp(tempstr, "")) {
+            agg = std::string(tempstr);
+        } else {
+            agg = std::string("None");
+        }
+        if (agg == "stats") {
+            ostr << node.child_value();
+        } else {
+            node.print(ostr, "", pugi::format_raw);
+        }
+
+        if (!osp->UVEUpdate(object.name(), node.name(),
                              source, node_type, module, instance_id,
                              key, ostr.str(), seq,
                              agg, node.attribute("hbin").value(), ts)) {
@@ -385,8 +317,8 @@ bool Ruleeng::handle_uve_publish(const pugi::xml_node& parent,
         }
     }
 
-    if (deleted) {
-        if (!osp_->UVEDelete(object.name(), source, node_type, module, 
+    if (fields.uve_deleted) {
+        if (!osp->UVEDelete(object.name(), source, node_type, module, 
                              instance_id, key, seq)) {
             LOG(ERROR, __func__ << " Cannot Delete " << key);
             PUBLISH_UVE_DELETE_TRACE(UVETraceBuf, source, module, type, key,
@@ -402,19 +334,20 @@ bool Ruleeng::handle_uve_publish(const pugi::xml_node& parent,
 }
 
 // handle flow message
-bool Ruleeng::handle_flow_object(const pugi::xml_node &parent,
+bool Ruleeng::handle_flow_object(const VizMsgFields &fields,
     DbHandler *db, const SandeshHeader &header) {
     if (header.get_Type() != SandeshType::FLOW) {
         return true;
     }
 
-    if (!(db->FlowTableInsert(parent, header))) {
+    if (!(db->FlowTableInsert(fields.flow_fields, header))) {
         return false;
     }
     return true;
 }
 
-bool Ruleeng::rule_execute(const VizMsg *vmsgp, bool uveproc, DbHandler *db) {
+bool Ruleeng::rule_execute(const VizMsg *vmsgp, bool uveproc, DbHandler *db,
+                           OpServerProxy *osp) {
     const SandeshHeader &header(vmsgp->msg->GetHeader());
     if (db->DropMessage(header, vmsgp)) {
         return true;
@@ -428,13 +361,14 @@ bool Ruleeng::rule_execute(const VizMsg *vmsgp, bool uveproc, DbHandler *db) {
         static_cast<const SandeshXMLMessage *>(vmsgp->msg);
     const pugi::xml_node &parent(sxmsg->GetMessageNode());
 
-    remove_identifier(parent);
+    VizMsgFields fields;
+    fields.Extract(parent, header);
 
-    handle_object_log(parent, vmsgp, db, header);
+    handle_object_log(fields, vmsgp, db, header);
 
-    if (uveproc) handle_uve_publish(parent, vmsgp, db, header);
+    if (uveproc) handle_uve_publish(parent, fields, vmsgp, db, osp, header);
 
-    handle_flow_object(parent, db, header);
+    handle_flow_object(fields, db, header);
 
     RuleMsg rmsg(vmsgp); 
     rulelist_->rule_execute(rmsg);
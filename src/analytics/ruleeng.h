@@ -32,7 +32,10 @@ class Ruleeng {
 
         bool rule_present(const VizMsg *vmsgp);
 
-        bool rule_execute(const VizMsg *vmsgp, bool uveproc, DbHandler *db);
+        // UVEs are published through osp, which is either the proxy of
+        // the rule engine or the one of the collector shard of the generator
+        bool rule_execute(const VizMsg *vmsgp, bool uveproc, DbHandler *db,
+                          OpServerProxy *osp);
 
         void print(std::ostream& os) {
             rulelist_->print(os);
@@ -46,15 +49,14 @@ class Ruleeng {
         std::vector<std::string> rulesrc_;
 
         bool handle_uve_publish(const pugi::xml_node& parent,
-            const VizMsg *rmsg, DbHandler *db, const SandeshHeader &header);
+            const VizMsgFields &fields, const VizMsg *rmsg, DbHandler *db,
+            OpServerProxy *osp, const SandeshHeader &header);
 
-        bool handle_flow_object(const pugi::xml_node& parent, DbHandler *db,
+        bool handle_flow_object(const VizMsgFields &fields, DbHandler *db,
             const SandeshHeader &header);
 
-        void handle_object_log(const pugi::xml_node& parent,
+        void handle_object_log(const VizMsgFields &fields,
             const VizMsg *rmsg, DbHandler *db, const SandeshHeader &header);
-
-        void remove_identifier(const pugi::xml_node& parent);
 };
 
 class Builder : public Task {
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "testing/gunit.h"
+
+#include <set>
+#include <boost/scoped_ptr.hpp>
+
+#include "base/logging.h"
+#include "base/task.h"
+#include "base/util.h"
+#include "base/test/task_test_util.h"
+#include "io/event_manager.h"
+
+#include "../OpServerProxy.h"
+#include "../collector.h"
+#include "../collector_shard.h"
+#include "../ruleeng.h"
+#include "db_handler_mock.h"
+
+using std::string;
+using std::vector;
+
+class CollectorShardTest : public ::testing::Test {
+protected:
+    static const int kShardCount = 4;
+
+    virtual void SetUp() {
+        evm_.reset(new EventManager());
+        db_handler_.reset(new DbHandlerMock(evm_.get()));
+        osp_.reset(new OpServerProxy());
+        ruleeng_.reset(new Ruleeng(db_handler_.get(), osp_.get()));
+        collector_ = new Collector(evm_.get(), 0, db_handler_.get(),
+                                   ruleeng_.get());
+        // Shard proxies without a redis connection
+        for (int idx = 0; idx < kShardCount; idx++) {
+            collector_->AddShard(new CollectorShard(collector_, idx,
+                                                    new OpServerProxy()));
+        }
+        shutdown_ = false;
+    }
+
+    virtual void TearDown() {
+        Shutdown();
+        TcpServerManager::DeleteServer(collector_);
+        task_util::WaitForIdle();
+    }
+
+    void Shutdown() {
+        if (shutdown_) {
+            return;
+        }
+        task_util::WaitForIdle();
+        collector_->Shutdown();
+        task_util::WaitForIdle();
+        shutdown_ = true;
+    }
+
+    vector<CollectorShardInfo> ShardInfo() const {
+        vector<CollectorShardInfo> shards;
+        collector_->GetShardInfo(shards);
+        return shards;
+    }
+
+    CollectorShard *Shard(int idx) {
+        for (int i = 0; i < 1000; i++) {
+            CollectorShard *shard = collector_->SelectShard(
+                "host:Compute:module:" + integerToString(i));
+            if (shard->index() == idx) {
+                return shard;
+            }
+        }
+        return NULL;
+    }
+
+    boost::scoped_ptr<EventManager> evm_;
+    boost::scoped_ptr<DbHandlerMock> db_handler_;
+    boost::scoped_ptr<OpServerProxy> osp_;
+    boost::scoped_ptr<Ruleeng> ruleeng_;
+    Collector *collector_;
+    bool shutdown_;
+};
+
+TEST_F(CollectorShardTest, Select) {
+    const string name("a3s45:Compute:contrail-vrouter-agent:0");
+    size_t idx = CollectorShard::Select(name, kShardCount);
+    EXPECT_LT(idx, static_cast<size_t>(kShardCount));
+    EXPECT_EQ(idx, CollectorShard::Select(name, kShardCount));
+    EXPECT_EQ(0U, CollectorShard::Select(name, 1));
+
+    // Every shard gets some of the generators
+    std::set<size_t> selected;
+    for (int i = 0; i < 1000; i++) {
+        selected.insert(CollectorShard::Select(
+            "host" + integerToString(i) + ":Compute:module:0", kShardCount));
+    }
+    EXPECT_EQ(static_cast<size_t>(kShardCount), selected.size());
+}
+
+TEST_F(CollectorShardTest, SelectShard) {
+    EXPECT_EQ(static_cast<size_t>(kShardCount), collector_->shard_count());
+    const string name("a3s45:Compute:contrail-vrouter-agent:0");
+    CollectorShard *shard = collector_->SelectShard(name);
+    ASSERT_TRUE(shard != NULL);
+    EXPECT_EQ(CollectorShard::Select(name, kShardCount),
+              static_cast<size_t>(shard->index()));
+    EXPECT_EQ(shard, collector_->SelectShard(name));
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_TRUE(Shard(idx) != NULL);
+    }
+}
+
+TEST_F(CollectorShardTest, SelectShardNoShards) {
+    Collector *collector = new Collector(evm_.get(), 0, db_handler_.get(),
+                                         ruleeng_.get());
+    EXPECT_EQ(0U, collector->shard_count());
+    EXPECT_TRUE(collector->SelectShard("a3s45:Compute:module:0") == NULL);
+    collector->Shutdown();
+    task_util::WaitForIdle();
+    TcpServerManager::DeleteServer(collector);
+}
+
+TEST_F(CollectorShardTest, RedisUpdate) {
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_FALSE(Shard(idx)->redis_up());
+    }
+
+    // Only the shard of the redis connection is updated
+    collector_->RedisUpdate(true, 1);
+    collector_->RedisUpdate(true, 2);
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_EQ(idx == 1 || idx == 2, Shard(idx)->redis_up());
+    }
+    collector_->RedisUpdate(false, 1);
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_EQ(idx == 2, Shard(idx)->redis_up());
+    }
+
+    // The collector's own redis connection leaves the shards alone
+    collector_->RedisUpdate(false);
+    collector_->RedisUpdate(true);
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_EQ(idx == 2, Shard(idx)->redis_up());
+    }
+
+    vector<CollectorShardInfo> shards = ShardInfo();
+    ASSERT_EQ(static_cast<size_t>(kShardCount), shards.size());
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_EQ(idx == 2, shards[idx].get_redis_up());
+    }
+}
+
+TEST_F(CollectorShardTest, Shutdown) {
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_FALSE(Shard(idx)->IsShutdown());
+    }
+    Shutdown();
+    for (int idx = 0; idx < kShardCount; idx++) {
+        EXPECT_TRUE(Shard(idx)->IsShutdown());
+    }
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    int result = RUN_ALL_TESTS();
+    TaskScheduler::GetInstance()->Terminate();
+    return result;
+}
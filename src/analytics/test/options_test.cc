@@ -12,6 +12,7 @@
 #include "base/logging.h"
 #include "base/test/task_test_util.h"
 #include "analytics/options.h"
+#include "analytics/redis_uve_batch.h"
 #include "io/event_manager.h"
 
 using namespace std;
@@ -21,6 +22,9 @@ static uint16_t default_redis_port = ContrailPorts::RedisUvePort;
 static uint16_t default_collector_port = ContrailPorts::CollectorPort;
 static uint16_t default_http_server_port = ContrailPorts::HttpPortCollector;
 static uint16_t default_discovery_port = ContrailPorts::DiscoveryServerPort;
+static uint32_t default_uve_batch_size = RedisUveBatcher::kDefaultBatchSize;
+static int default_uve_batch_latency_msec =
+    RedisUveBatcher::kDefaultLatencyMsec;
 
 class OptionsTest : public ::testing::Test {
 protected:
@@ -52,8 +56,12 @@ TEST_F(OptionsTest, NoArguments) {
                      options_.cassandra_server_list());
     EXPECT_EQ(options_.redis_server(), "127.0.0.1");
     EXPECT_EQ(options_.redis_port(), default_redis_port);
+    EXPECT_EQ(options_.redis_uve_batch_size(), default_uve_batch_size);
+    EXPECT_EQ(options_.redis_uve_batch_latency_msec(),
+              default_uve_batch_latency_msec);
     EXPECT_EQ(options_.collector_server(), "0.0.0.0");
     EXPECT_EQ(options_.collector_port(), default_collector_port);
+    EXPECT_EQ(options_.collector_shards(), 0);
     EXPECT_EQ(options_.config_file(), "/etc/contrail/collector.conf");
     EXPECT_EQ(options_.discovery_server(), "");
     EXPECT_EQ(options_.discovery_port(), default_discovery_port);
@@ -208,6 +216,7 @@ TEST_F(OptionsTest, CustomConfigFile) {
         "[COLLECTOR]\n"
         "port=100\n"
         "server=3.4.5.6\n"
+        "shards=8\n"
         "\n"
         "[DISCOVERY]\n"
         "port=100\n"
@@ -215,6 +224,8 @@ TEST_F(OptionsTest, CustomConfigFile) {
         "[REDIS]\n"
         "server=1.2.3.4\n"
         "port=200\n"
+        "uve_batch_size=100\n"
+        "uve_batch_latency_msec=50\n"
         "\n"
     ;
 
@@ -241,8 +252,11 @@ TEST_F(OptionsTest, CustomConfigFile) {
 
     EXPECT_EQ(options_.redis_server(), "1.2.3.4");
     EXPECT_EQ(options_.redis_port(), 200);
+    EXPECT_EQ(options_.redis_uve_batch_size(), 100);
+    EXPECT_EQ(options_.redis_uve_batch_latency_msec(), 50);
     EXPECT_EQ(options_.collector_server(), "3.4.5.6");
     EXPECT_EQ(options_.collector_port(), 100);
+    EXPECT_EQ(options_.collector_shards(), 8);
     EXPECT_EQ(options_.config_file(),
               "/tmp/options_test_collector_config_file.conf");
     EXPECT_EQ(options_.discovery_server(), "1.0.0.1");
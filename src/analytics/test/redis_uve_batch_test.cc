@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+
+#include "analytics/redis_uve_batch.h"
+#include "base/logging.h"
+#include "base/test/task_test_util.h"
+#include "io/event_manager.h"
+#include "io/test/event_manager_test.h"
+#include "testing/gunit.h"
+
+using std::string;
+using std::vector;
+
+//
+// Stands in for redis. Keeps the last message of every attribute of a UVE,
+// which is what uveupdate_batch.lua leaves behind, along with the order in
+// which the batches were received.
+//
+class RedisUveBatchTest : public ::testing::Test {
+protected:
+    typedef std::map<string, string> AttrMap;
+    typedef std::map<string, AttrMap> UveMap;
+
+    RedisUveBatchTest() : thread_(&evm_), fail_(false), flush_delay_(0) {
+        flushing_ = false;
+    }
+
+    virtual void SetUp() {
+        thread_.Start();
+    }
+
+    virtual void TearDown() {
+        batcher_.reset();
+        evm_.Shutdown();
+        thread_.Join();
+        task_util::WaitForIdle();
+    }
+
+    void CreateBatcher(size_t batch_size, int latency_msec) {
+        batcher_.reset(new RedisUveBatcher(&evm_,
+            boost::bind(&RedisUveBatchTest::Flush, this, _1, _2),
+            batch_size, latency_msec));
+    }
+
+    bool Flush(const RedisUveGenerator &generator,
+               const RedisUveBatcher::UpdateList &updates) {
+        flushing_ = true;
+        if (flush_delay_) {
+            usleep(flush_delay_);
+        }
+        tbb::mutex::scoped_lock lock(mutex_);
+        batch_sizes_.push_back(updates.size());
+        if (fail_) {
+            return false;
+        }
+        for (RedisUveBatcher::UpdateList::const_iterator it = updates.begin();
+             it != updates.end(); ++it) {
+            uves_[generator.source + ":" + it->key][it->attr] = it->message;
+        }
+        return true;
+    }
+
+    bool Enqueue(const string &source, const string &key, const string &attr,
+                 const string &message) {
+        RedisUveGenerator generator(source, "Analytics", "Collector", "0");
+        return batcher_->Enqueue(generator,
+            RedisUveUpdate("UveTest", attr, key, message, 1));
+    }
+
+    size_t batch_count() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return batch_sizes_.size();
+    }
+
+    size_t uve_count() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return uves_.size();
+    }
+
+    string Lookup(const string &key, const string &attr) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return uves_[key][attr];
+    }
+
+    EventManager evm_;
+    ServerThread thread_;
+    boost::scoped_ptr<RedisUveBatcher> batcher_;
+    tbb::mutex mutex_;
+    UveMap uves_;
+    vector<size_t> batch_sizes_;
+    bool fail_;
+    int flush_delay_;
+    tbb::atomic<bool> flushing_;
+};
+
+TEST_F(RedisUveBatchTest, SizeFlush) {
+    CreateBatcher(4, 60000);
+    for (int idx = 0; idx < 3; ++idx) {
+        EXPECT_TRUE(Enqueue("src1", "uve1", "attr" + integerToString(idx),
+                            "msg"));
+    }
+    EXPECT_EQ(0, batch_count());
+    EXPECT_EQ(3, batcher_->pending());
+
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr3", "msg"));
+    EXPECT_EQ(1, batch_count());
+    EXPECT_EQ(4, batch_sizes_[0]);
+    EXPECT_EQ(0, batcher_->pending());
+    EXPECT_EQ("msg", Lookup("src1:uve1", "attr3"));
+
+    RedisUveBatcher::Stats stats;
+    batcher_->GetStats(&stats);
+    EXPECT_EQ(4, stats.updates);
+    EXPECT_EQ(1, stats.batches);
+    EXPECT_EQ(1, stats.size_flushes);
+    EXPECT_EQ(4, stats.max_batch_size);
+}
+
+TEST_F(RedisUveBatchTest, TimerFlush) {
+    CreateBatcher(100, 10);
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "msg1"));
+    EXPECT_TRUE(Enqueue("src2", "uve1", "attr1", "msg2"));
+    TASK_UTIL_EXPECT_EQ(0, batcher_->pending());
+    TASK_UTIL_EXPECT_EQ(2, uve_count());
+    EXPECT_EQ("msg1", Lookup("src1:uve1", "attr1"));
+    EXPECT_EQ("msg2", Lookup("src2:uve1", "attr1"));
+
+    RedisUveBatcher::Stats stats;
+    batcher_->GetStats(&stats);
+    EXPECT_EQ(2, stats.timer_flushes);
+
+    // The timer is restarted for updates that arrive after it fired
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "msg3"));
+    TASK_UTIL_EXPECT_EQ("msg3", Lookup("src1:uve1", "attr1"));
+}
+
+//
+// Later updates of an attribute in the same batch must win, and a forced
+// flush must hand over what is pending before the caller goes on, e.g. to
+// delete the UVE.
+//
+TEST_F(RedisUveBatchTest, ForcedFlush) {
+    CreateBatcher(100, 60000);
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "old"));
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "new"));
+    EXPECT_TRUE(Enqueue("src2", "uve2", "attr1", "msg"));
+
+    batcher_->Flush(RedisUveGenerator("src1", "Analytics", "Collector", "0"));
+    EXPECT_EQ(1, batch_count());
+    EXPECT_EQ("new", Lookup("src1:uve1", "attr1"));
+    EXPECT_EQ(1, batcher_->pending());
+
+    batcher_->FlushAll();
+    EXPECT_EQ(2, batch_count());
+    EXPECT_EQ(0, batcher_->pending());
+    EXPECT_EQ("msg", Lookup("src2:uve2", "attr1"));
+
+    RedisUveBatcher::Stats stats;
+    batcher_->GetStats(&stats);
+    EXPECT_EQ(2, stats.forced_flushes);
+}
+
+//
+// Updates of a generator whose UVEs are deleted are dropped, not flushed.
+//
+TEST_F(RedisUveBatchTest, Discard) {
+    CreateBatcher(100, 60000);
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "msg"));
+    EXPECT_TRUE(Enqueue("src2", "uve2", "attr1", "msg"));
+    EXPECT_EQ(2, batcher_->pending());
+
+    batcher_->Discard(RedisUveGenerator("src1", "Analytics", "Collector",
+                                        "0"));
+    EXPECT_EQ(1, batcher_->pending());
+    batcher_->FlushAll();
+    EXPECT_EQ(1, batch_count());
+    EXPECT_EQ(1, uve_count());
+    EXPECT_EQ("msg", Lookup("src2:uve2", "attr1"));
+}
+
+//
+// Deleting the batcher waits for a timer flush that is running.
+//
+TEST_F(RedisUveBatchTest, DeleteDuringTimerFlush) {
+    CreateBatcher(100, 1);
+    flush_delay_ = 100000;
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "msg"));
+    TASK_UTIL_EXPECT_TRUE(flushing_);
+    batcher_.reset();
+    EXPECT_EQ(1, batch_count());
+    EXPECT_EQ("msg", Lookup("src1:uve1", "attr1"));
+}
+
+TEST_F(RedisUveBatchTest, Disabled) {
+    CreateBatcher(1, 10);
+    EXPECT_FALSE(batcher_->enabled());
+    EXPECT_TRUE(Enqueue("src1", "uve1", "attr1", "msg"));
+    EXPECT_EQ(1, batch_count());
+    EXPECT_EQ(0, batcher_->pending());
+
+    fail_ = true;
+    EXPECT_FALSE(Enqueue("src1", "uve1", "attr2", "msg"));
+
+    RedisUveBatcher::Stats stats;
+    batcher_->GetStats(&stats);
+    EXPECT_EQ(2, stats.updates);
+    EXPECT_EQ(2, stats.batches);
+    EXPECT_EQ(1, stats.failed_batches);
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    int result = RUN_ALL_TESTS();
+    TaskScheduler::GetInstance()->Terminate();
+    return result;
+}
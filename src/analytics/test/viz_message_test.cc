@@ -8,6 +8,8 @@
 #include <boost/uuid/random_generator.hpp>
 
 #include <base/logging.h>
+#include <base/util.h>
+#include <sandesh/sandesh_constants.h>
 #include <sandesh/sandesh_message_builder.h>
 
 #include "../viz_message.h"
@@ -228,6 +230,108 @@ TEST_F(VizMessageTest, Stats) {
     msg = NULL;
 }
 
+TEST_F(VizMessageTest, ExtractFields) {
+    SandeshHeader hdr;
+    hdr.set_Type(SandeshType::UVE);
+    hdr.set_Hints(g_sandesh_constants.SANDESH_KEY_HINT);
+    std::string xmlmessage = "<UveVirtualNetworkAgentTrace type=\"sandesh\"><data type=\"struct\" identifier=\"1\"><UveVirtualNetworkAgent><name type=\"string\" identifier=\"1\" key=\"ObjectVNTable\">vn1</name><acl type=\"string\" identifier=\"2\">acl1</acl><in_bytes type=\"u64\" identifier=\"3\" aggtype=\"counter\">10</in_bytes><deleted type=\"bool\">true</deleted></UveVirtualNetworkAgent></data></UveVirtualNetworkAgentTrace>";
+    boost::uuids::uuid unm(rgen_());
+    SandeshXMLMessageTest *msg = dynamic_cast<SandeshXMLMessageTest *>(
+        builder_->Create(
+        reinterpret_cast<const uint8_t *>(xmlmessage.c_str()),
+        xmlmessage.size()));
+    msg->SetHeader(hdr);
+    VizMsgFields fields;
+    fields.Extract(msg->GetMessageNode(), hdr);
+    // ObjectLog keys
+    ASSERT_EQ(1, fields.object_keys.size());
+    EXPECT_EQ("ObjectVNTable", fields.object_keys[0].first);
+    EXPECT_EQ("vn1", fields.object_keys[0].second);
+    // UVE key and attributes
+    EXPECT_STREQ("UveVirtualNetworkAgent", fields.uve_object.name());
+    EXPECT_EQ("ObjectVNTable", fields.uve_table);
+    EXPECT_EQ("ObjectVNTable:vn1", fields.uve_key);
+    EXPECT_TRUE(fields.uve_deleted);
+    ASSERT_EQ(2, fields.uve_attrs.size());
+    EXPECT_STREQ("acl", fields.uve_attrs[0].name());
+    EXPECT_STREQ("in_bytes", fields.uve_attrs[1].name());
+    EXPECT_TRUE(fields.flow_fields.empty());
+    // Identifiers are stripped
+    EXPECT_TRUE(fields.uve_attrs[1].attribute("identifier").empty());
+    EXPECT_STREQ("counter", fields.uve_attrs[1].attribute("aggtype").value());
+    delete msg;
+}
+
+TEST_F(VizMessageTest, ExtractFlowFields) {
+    SandeshHeader hdr;
+    hdr.set_Type(SandeshType::FLOW);
+    std::string xmlmessage = "<FlowDataIpv4Object type=\"sandesh\"><flowdata type=\"struct\"><FlowDataIpv4><flowuuid type=\"string\">555788e0-513c-4351-8711-3fc481cf2eb4</flowuuid><direction_ing type=\"byte\">0</direction_ing><sourcevn type=\"string\">default-domain:demo:vn1</sourcevn></FlowDataIpv4></flowdata></FlowDataIpv4Object>";
+    SandeshXMLMessageTest *msg = dynamic_cast<SandeshXMLMessageTest *>(
+        builder_->Create(
+        reinterpret_cast<const uint8_t *>(xmlmessage.c_str()),
+        xmlmessage.size()));
+    msg->SetHeader(hdr);
+    VizMsgFields fields;
+    fields.Extract(msg->GetMessageNode(), hdr);
+    EXPECT_TRUE(fields.object_keys.empty());
+    EXPECT_TRUE(fields.uve_attrs.empty());
+    ASSERT_EQ(5, fields.flow_fields.size());
+    EXPECT_STREQ("flowdata", fields.flow_fields[0].first);
+    EXPECT_STREQ("FlowDataIpv4", fields.flow_fields[1].first);
+    EXPECT_STREQ("flowuuid", fields.flow_fields[2].first);
+    EXPECT_STREQ("555788e0-513c-4351-8711-3fc481cf2eb4",
+                 fields.flow_fields[2].second);
+    EXPECT_STREQ("sourcevn", fields.flow_fields[4].first);
+    EXPECT_STREQ("default-domain:demo:vn1", fields.flow_fields[4].second);
+    // Same as walking the message for the flow fields only
+    VizMsgFields::FlowFieldList flow_fields;
+    VizMsgFields::GetFlowFields(msg->GetMessageNode(), &flow_fields);
+    EXPECT_EQ(fields.flow_fields, flow_fields);
+    delete msg;
+}
+
+//
+// Collector ingestion benchmark: parse a mix of UVE, ObjectLog and flow
+// messages and extract their fields on a single core.
+//
+TEST_F(VizMessageTest, IngestionBenchmark) {
+    static const int kMessages = 30000;
+    SandeshHeader uve_hdr;
+    uve_hdr.set_Type(SandeshType::UVE);
+    uve_hdr.set_Hints(g_sandesh_constants.SANDESH_KEY_HINT);
+    SandeshHeader flow_hdr;
+    flow_hdr.set_Type(SandeshType::FLOW);
+    SandeshHeader object_hdr;
+    object_hdr.set_Type(SandeshType::OBJECT);
+    object_hdr.set_Hints(g_sandesh_constants.SANDESH_KEY_HINT);
+    const SandeshHeader *headers[] = { &uve_hdr, &flow_hdr, &object_hdr };
+    std::string messages[] = {
+        "<UveVirtualNetworkAgentTrace type=\"sandesh\"><data type=\"struct\" identifier=\"1\"><UveVirtualNetworkAgent><name type=\"string\" identifier=\"1\" key=\"ObjectVNTable\">vn1</name><acl type=\"string\" identifier=\"2\">acl1</acl><in_bytes type=\"u64\" identifier=\"3\" aggtype=\"counter\">10</in_bytes><out_bytes type=\"u64\" identifier=\"4\" aggtype=\"counter\">20</out_bytes></UveVirtualNetworkAgent></data></UveVirtualNetworkAgentTrace>",
+        "<FlowDataIpv4Object type=\"sandesh\"><flowdata type=\"struct\"><FlowDataIpv4><flowuuid type=\"string\">555788e0-513c-4351-8711-3fc481cf2eb4</flowuuid><direction_ing type=\"byte\">0</direction_ing><sourcevn type=\"string\">default-domain:demo:vn1</sourcevn><sourceip type=\"i32\">-1062731267</sourceip><destvn type=\"string\">default-domain:demo:vn2</destvn><destip type=\"i32\">-1062731266</destip><protocol type=\"byte\">6</protocol><sport type=\"i16\">-4805</sport><dport type=\"i16\">9100</dport><bytes type=\"i64\">1000</bytes><packets type=\"i64\">10</packets></FlowDataIpv4></flowdata></FlowDataIpv4Object>",
+        "<VNObjectLog type=\"sandesh\"><vn type=\"struct\"><VirtualNetwork><name type=\"string\" key=\"ObjectVNTable\">vn1</name><vm type=\"string\" key=\"ObjectVMTable\">vm1</vm><attached type=\"bool\">true</attached></VirtualNetwork></vn></VNObjectLog>",
+    };
+    uint64_t start = UTCTimestampUsec();
+    size_t extracted = 0;
+    for (int i = 0; i < kMessages; i++) {
+        int idx = i % 3;
+        SandeshXMLMessageTest *msg = dynamic_cast<SandeshXMLMessageTest *>(
+            builder_->Create(
+            reinterpret_cast<const uint8_t *>(messages[idx].c_str()),
+            messages[idx].size()));
+        VizMsgFields fields;
+        fields.Extract(msg->GetMessageNode(), *headers[idx]);
+        extracted += fields.object_keys.size() + fields.uve_attrs.size() +
+            fields.flow_fields.size();
+        delete msg;
+    }
+    uint64_t elapsed = UTCTimestampUsec() - start;
+    // 4 for the UVE, 13 for the flow and 2 for the ObjectLog
+    EXPECT_EQ((kMessages / 3) * (4 + 13 + 2), extracted);
+    std::cout << kMessages << " messages in " << elapsed << " usec: " <<
+        (elapsed ? kMessages * 1000000ULL / elapsed : 0) <<
+        " messages/sec per core" << std::endl;
+}
+
 int main(int argc, char **argv) {
     LoggingInit();
     ::testing::InitGoogleTest(&argc, argv);
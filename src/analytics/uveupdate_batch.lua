@@ -0,0 +1,33 @@
+--
+-- Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+--
+
+-- Batched form of uveupdate.lua for updates from a single generator.
+-- KEYS[1] is the TYPES key of the generator, followed by the ORIGINS, TABLE,
+-- UVES and VALUES keys of each update. ARGV[1..4] identify the generator,
+-- followed by the type, attr, key, seq and value of each update.
+
+local sm = ARGV[1]..":"..ARGV[2]..":"..ARGV[3]..":"..ARGV[4]
+local _types = KEYS[1]
+local count = (#KEYS - 1) / 4
+
+for i = 0, count - 1 do
+    local typ = ARGV[5 + i * 5]
+    local attr = ARGV[6 + i * 5]
+    local key = ARGV[7 + i * 5]
+    local seq = ARGV[8 + i * 5]
+    local val = ARGV[9 + i * 5]
+
+    local _origins = KEYS[2 + i * 4]
+    local _table = KEYS[3 + i * 4]
+    local _uves = KEYS[4 + i * 4]
+    local _values = KEYS[5 + i * 4]
+
+    redis.call('sadd',_types,typ)
+    redis.call('sadd',_origins,sm..":"..typ)
+    redis.call('sadd',_table,key..':'..sm..":"..typ)
+    redis.call('zadd',_uves,seq,key)
+    redis.call('hset',_values,attr,val)
+end
+
+return true
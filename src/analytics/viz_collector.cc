@@ -16,6 +16,7 @@
 #include "sandesh/sandesh.h"
 #include "sandesh/sandesh_session.h"
 
+#include "collector_shard.h"
 #include "db_handler.h"
 #include "ruleeng.h" 
 
@@ -25,20 +26,29 @@ using boost::system::error_code;
 VizCollector::VizCollector(EventManager *evm, unsigned short listen_port,
             std::string cassandra_ip, unsigned short cassandra_port,
             const std::string redis_uve_ip, unsigned short redis_uve_port,
-            int syslog_port, bool dup, int analytics_ttl) :
+            int syslog_port, bool dup, int analytics_ttl,
+            size_t redis_uve_batch_size, int redis_uve_batch_latency_msec,
+            uint32_t collector_shards) :
     evm_(evm),
-    osp_(new OpServerProxy(evm, this, redis_uve_ip, redis_uve_port)),
+    osp_(new OpServerProxy(evm, this, redis_uve_ip, redis_uve_port,
+            redis_uve_batch_size, redis_uve_batch_latency_msec)),
     db_handler_(new DbHandler(evm, boost::bind(&VizCollector::StartDbifReinit, this),
                 cassandra_ip, cassandra_port, analytics_ttl, DbifGlobalName(dup))),
     ruleeng_(new Ruleeng(db_handler_.get(), osp_.get())),
     collector_(new Collector(evm, listen_port, db_handler_.get(), ruleeng_.get(),
             cassandra_ip, cassandra_port, analytics_ttl)),
     syslog_listener_(new SyslogListeners (evm,
-            boost::bind(&Ruleeng::rule_execute, ruleeng_.get(), _1, _2, _3),
+            boost::bind(&Ruleeng::rule_execute, ruleeng_.get(), _1, _2, _3,
+                osp_.get()),
             db_handler_.get(), syslog_port)),
     dbif_timer_(TimerManager::CreateTimer(
             *evm_->io_service(), "Collector DbIf Timer",
             TaskScheduler::GetInstance()->GetTaskId("collector::DbIf"))) {
+    for (uint32_t idx = 0; idx < collector_shards; idx++) {
+        collector_->AddShard(new CollectorShard(collector_, idx,
+            new OpServerProxy(evm, this, redis_uve_ip, redis_uve_port,
+                redis_uve_batch_size, redis_uve_batch_latency_msec, idx)));
+    }
     error_code error;
     if (dup)
         name_ = boost::asio::ip::host_name(error) + "dup";
@@ -54,7 +64,7 @@ VizCollector::VizCollector(EventManager *evm, DbHandler *db_handler,
     ruleeng_(ruleeng),
     collector_(collector),
     syslog_listener_(new SyslogListeners (evm,
-            boost::bind(&Ruleeng::rule_execute, ruleeng, _1, _2, _3),
+            boost::bind(&Ruleeng::rule_execute, ruleeng, _1, _2, _3, osp),
             db_handler)),
     dbif_timer_(TimerManager::CreateTimer(
             *evm_->io_service(), "Collector DbIf Timer",
@@ -30,7 +30,11 @@ public:
             std::string cassandra_ip, unsigned short cassandra_port,
             const std::string redis_uve_ip, unsigned short redis_uve_port,
             int syslog_port, bool dup=false,
-            int analytics_ttl=g_viz_constants.AnalyticsTTL);
+            int analytics_ttl=g_viz_constants.AnalyticsTTL,
+            size_t redis_uve_batch_size=RedisUveBatcher::kDefaultBatchSize,
+            int redis_uve_batch_latency_msec=
+                RedisUveBatcher::kDefaultLatencyMsec,
+            uint32_t collector_shards=0);
     VizCollector(EventManager *evm, DbHandler *db_handler, Ruleeng *ruleeng,
                  Collector *collector, OpServerProxy *osp);
     ~VizCollector();
@@ -56,8 +60,8 @@ public:
         return osp_.get();
     }
     bool SendRemote(const std::string& destination, const std::string& dec_sandesh);
-    void RedisUpdate(bool rsc) {
-        collector_->RedisUpdate(rsc);
+    void RedisUpdate(bool rsc, int shard = -1) {
+        collector_->RedisUpdate(rsc, shard);
     }
 
 private:
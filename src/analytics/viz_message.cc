@@ -2,8 +2,10 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <map>
 #include <base/logging.h>
 #include <base/util.h>
+#include <sandesh/sandesh_constants.h>
 #include <sandesh/sandesh_message_builder.h>
 #include "collector_uve_types.h"
 #include "viz_message.h"
@@ -54,6 +56,94 @@ int RuleMsg::field_value(const std::string& field_id, std::string& type, std::st
     return field_value_recur(field_id, type, value, message_node_);
 }
 
+void VizMsgFields::Extract(const pugi::xml_node &message,
+                           const SandeshHeader &header) {
+    bool keys =
+        (header.get_Hints() & g_sandesh_constants.SANDESH_KEY_HINT) != 0;
+    bool flow = header.get_Type() == SandeshType::FLOW;
+    Walk(message, keys, flow);
+    if (header.get_Type() == SandeshType::UVE) {
+        ExtractUve(message);
+    }
+}
+
+//
+// Pre-order walk of the elements below parent. The ObjectLog keys of the
+// children of a node are grouped by table and added ahead of the keys found
+// further down, the same order in which they were inserted when each of
+// these was a separate walk.
+//
+void VizMsgFields::Walk(const pugi::xml_node &parent, bool keys,
+                        bool flow) {
+    size_t pos = object_keys.size();
+    std::map<std::string, std::string> keymap;
+    for (pugi::xml_node node = parent.first_child(); node;
+         node = node.next_sibling()) {
+        if (node.type() != pugi::node_element) {
+            continue;
+        }
+        node.remove_attribute("identifier");
+        if (keys) {
+            const char *table = node.attribute("key").value();
+            if (*table) {
+                std::pair<std::map<std::string, std::string>::iterator,
+                    bool> ret = keymap.insert(
+                        std::make_pair(table, node.child_value()));
+                if (!ret.second) {
+                    ret.first->second.append(":");
+                    ret.first->second.append(node.child_value());
+                }
+            }
+        }
+        if (flow) {
+            flow_fields.push_back(FlowField(node.name(), node.child_value()));
+        }
+        Walk(node, keys, flow);
+    }
+    if (!keymap.empty()) {
+        object_keys.insert(object_keys.begin() + pos, keymap.begin(),
+                           keymap.end());
+    }
+}
+
+void VizMsgFields::ExtractUve(const pugi::xml_node &message) {
+    uve_object = message.child("data").first_child();
+    std::string barekey;
+    for (pugi::xml_node node = uve_object.first_child(); node;
+         node = node.next_sibling()) {
+        const char *table = node.attribute("key").value();
+        if (*table) {
+            if (barekey.empty()) {
+                uve_table = table;
+            } else {
+                barekey.append(":");
+            }
+            barekey.append(node.child_value());
+            continue;
+        }
+        if (!strcmp(node.name(), "deleted")) {
+            if (!strcmp(node.child_value(), "true")) {
+                uve_deleted = true;
+            }
+            continue;
+        }
+        uve_attrs.push_back(node);
+    }
+    uve_key = uve_table + ":" + barekey;
+}
+
+void VizMsgFields::GetFlowFields(const pugi::xml_node &parent,
+                                 FlowFieldList *fields) {
+    for (pugi::xml_node node = parent.first_child(); node;
+         node = node.next_sibling()) {
+        if (node.type() != pugi::node_element) {
+            continue;
+        }
+        fields->push_back(FlowField(node.name(), node.child_value()));
+        GetFlowFields(node, fields);
+    }
+}
+
 // VizMsgStatistics
 VizMsgStats operator+(const VizMsgStats &a, const VizMsgStats &b) {
     VizMsgStats sum;
@@ -6,6 +6,7 @@
 #define __VIZ_MESSAGE_H__
 
 #include <string>
+#include <vector>
 #include <boost/uuid/uuid.hpp>
 #include <boost/ptr_container/ptr_map.hpp>
 #include <pugixml/pugixml.hpp>
@@ -28,6 +29,43 @@ struct VizMsg {
     boost::uuids::uuid unm; /* uuid key for this message in the global table */
 };
 
+//
+// Fields of a sandesh message that the rule engine acts on, gathered in a
+// single walk of the parsed message. The walk also strips the "identifier"
+// attributes. The raw message bytes are not touched, and the extracted
+// nodes and names point into the parsed message, so they are only valid
+// as long as the message is.
+//
+struct VizMsgFields {
+    typedef std::pair<std::string, std::string> ObjectKey;
+    typedef std::vector<ObjectKey> ObjectKeyList;
+    typedef std::pair<const char *, const char *> FlowField;
+    typedef std::vector<FlowField> FlowFieldList;
+
+    VizMsgFields() : uve_deleted(false) {}
+
+    void Extract(const pugi::xml_node &message, const SandeshHeader &header);
+    static void GetFlowFields(const pugi::xml_node &parent,
+                              FlowFieldList *fields);
+
+    // ObjectLog (table, rowkey), only if the message has the key hint
+    ObjectKeyList object_keys;
+
+    // UVE object and its key and non-key attributes, only for UVEs
+    pugi::xml_node uve_object;
+    std::string uve_table;
+    std::string uve_key;
+    std::vector<pugi::xml_node> uve_attrs;
+    bool uve_deleted;
+
+    // (name, value) of every element in a flow message, in document order
+    FlowFieldList flow_fields;
+
+private:
+    void Walk(const pugi::xml_node &parent, bool keys, bool flow);
+    void ExtractUve(const pugi::xml_node &message);
+};
+
 class SandeshStats;
 class SandeshLogLevelStats;
 class SandeshMessageInfo;
@@ -4,8 +4,13 @@
 
 #include "base/lifetime.h"
 
+#include <algorithm>
 #include <boost/bind.hpp>
 
+#include "base/logging.h"
+#include "base/task.h"
+#include "base/sandesh/task_types.h"
+
 LifetimeRefBase::LifetimeRefBase(LifetimeActor *actor)
         : ref_(this, actor) {
 }
@@ -13,8 +18,9 @@ LifetimeRefBase::LifetimeRefBase(LifetimeActor *actor)
 LifetimeRefBase::~LifetimeRefBase() {
 }
 
-LifetimeActor::LifetimeActor(LifetimeManager *manager)
-        : manager_(manager), refcount_(0), shutdown_invoked_(false),
+LifetimeActor::LifetimeActor(LifetimeManager *manager, int partition)
+        : manager_(manager), partition_(partition), refcount_(0),
+          queued_(false), shutdown_invoked_(false),
           delete_paused_(false),
           create_time_stamp_usecs_(UTCTimestampUsec()),
           delete_time_stamp_usecs_(0) {
@@ -47,8 +53,7 @@ void LifetimeActor::Delete() {
          iter != dependents_.end(); ++iter) {
         iter->Delete();
     }
-    refcount_++;
-    manager_->EnqueueNoIncrement(this);
+    EnqueueLocked();
 }
 
 //
@@ -92,8 +97,7 @@ void LifetimeActor::ResumeDelete() {
     tbb::mutex::scoped_lock lock(mutex_);
     assert(deleted_);
     delete_paused_ = false;
-    refcount_++;
-    manager_->EnqueueNoIncrement(this);
+    EnqueueLocked();
 }
 
 //
@@ -120,11 +124,44 @@ void LifetimeActor::DependencyRemove(
     tbb::mutex::scoped_lock lock(mutex_);
     dependents_.Remove(node);
     if (deleted_ && dependents_.empty()) {
-        refcount_++;
-        manager_->EnqueueNoIncrement(this);
+        EnqueueLocked();
     }
 }
 
+//
+// Concurrency: called with the mutex held.
+//
+// Enqueue a delete event unless one is already pending. The pending event
+// is processed after this call, so it sees the change that caused it.
+//
+void LifetimeActor::EnqueueLocked() {
+    if (queued_)
+        return;
+    queued_ = true;
+    refcount_++;
+    manager_->EnqueueNoIncrement(this);
+}
+
+bool LifetimeActor::ReferenceIncrementIfNotQueued() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (queued_)
+        return false;
+    queued_ = true;
+    refcount_++;
+    return true;
+}
+
+//
+// Concurrency: called in the context of the LifetimeManager's Task.
+//
+// The pending delete event is being processed, events posted from now on
+// need another one.
+//
+void LifetimeActor::Dequeued() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    queued_ = false;
+}
+
 // When the actor is placed in the queue the caller must still hold an
 // "lock" on the object in the form of either a dependency or an
 // explicit test performed by the derived class MayDelete() method.
@@ -140,14 +177,54 @@ bool LifetimeActor::ReferenceDecrementAndTest()  {
             MayDelete());
 }
 
-LifetimeManager::LifetimeManager(int task_id, TaskEntryCallback on_entry_cb)
-        : queue_(task_id, 0,
-                 boost::bind(&LifetimeManager::DeleteExecutor, this, _1)) {
-    queue_.SetEntryCallback(on_entry_cb);
+void LifetimeDeleteLatency::Add(uint64_t usecs) {
+    count++;
+    total_usecs += usecs;
+    max_usecs = std::max(max_usecs, usecs);
+    int bucket = 0;
+    for (uint64_t msecs = usecs / 1000; msecs && bucket < kBuckets - 1;
+         msecs >>= 1) {
+        bucket++;
+    }
+    buckets[bucket]++;
+}
+
+tbb::mutex LifetimeManager::managers_mutex_;
+std::set<LifetimeManager *> LifetimeManager::managers_;
+
+//
+// Partition i is served by instance i of the Task.
+//
+LifetimeManager::LifetimeManager(int task_id, TaskEntryCallback on_entry_cb,
+                                 int partitions)
+    : task_id_(task_id) {
+    assert(partitions > 0);
+    for (int idx = 0; idx < partitions; ++idx) {
+        Queue *queue = new Queue(task_id, idx,
+            boost::bind(&LifetimeManager::DeleteExecutor, this, _1));
+        queue->SetEntryCallback(on_entry_cb);
+        queues_.push_back(queue);
+    }
+
+    tbb::mutex::scoped_lock lock(managers_mutex_);
+    managers_.insert(this);
 }
 
 LifetimeManager::~LifetimeManager() {
-    queue_.Shutdown();
+    {
+        tbb::mutex::scoped_lock lock(managers_mutex_);
+        managers_.erase(this);
+    }
+    for (std::vector<Queue *>::iterator it = queues_.begin();
+         it != queues_.end(); ++it) {
+        (*it)->Shutdown();
+        delete *it;
+    }
+}
+
+LifetimeManager::Queue *LifetimeManager::PartitionQueue(
+    const LifetimeActor *actor) {
+    return queues_[static_cast<size_t>(actor->partition()) % queues_.size()];
 }
 
 //
@@ -156,16 +233,24 @@ LifetimeManager::~LifetimeManager() {
 // Enqueue a delete event for the actor.
 //
 void LifetimeManager::Enqueue(LifetimeActor *actor) {
-    LifetimeActorRef actor_ref;
-    actor->ReferenceIncrement();
-    actor_ref.actor = actor;
-    queue_.Enqueue(actor_ref);
+    if (!actor->ReferenceIncrementIfNotQueued())
+        return;
+    EnqueueNoIncrement(actor);
 }
 
 void LifetimeManager::EnqueueNoIncrement(LifetimeActor *actor) {
     LifetimeActorRef actor_ref;
     actor_ref.actor = actor;
-    queue_.Enqueue(actor_ref);
+    PartitionQueue(actor)->Enqueue(actor_ref);
+}
+
+size_t LifetimeManager::GetQueueDeferCount() {
+    size_t count = 0;
+    for (std::vector<Queue *>::iterator it = queues_.begin();
+         it != queues_.end(); ++it) {
+        count += (*it)->on_entry_defer_count();
+    }
+    return count;
 }
 
 //
@@ -177,13 +262,71 @@ void LifetimeManager::EnqueueNoIncrement(LifetimeActor *actor) {
 //
 bool LifetimeManager::DeleteExecutor(LifetimeActorRef actor_ref) {
     LifetimeActor *actor = actor_ref.actor;
+    actor->Dequeued();
     if (!actor->shutdown_invoked()) {
         actor->Shutdown();
         actor->set_shutdown_invoked();
     }
     if (actor->ReferenceDecrementAndTest()) {
+        RecordDeleteLatency(actor);
         actor->DeleteComplete();
         actor->Destroy();
     }
     return true;
 }
+
+//
+// Concurrency: called in the context of the LifetimeManager's Task, from
+// any of the partitions.
+//
+void LifetimeManager::RecordDeleteLatency(const LifetimeActor *actor) {
+    uint64_t start = actor->delete_time_stamp_usecs();
+    if (start == 0)
+        return;
+    uint64_t now = UTCTimestampUsec();
+    tbb::mutex::scoped_lock lock(latency_mutex_);
+    latency_[TYPE_NAME(*actor)].Add(now > start ? now - start : 0);
+}
+
+void LifetimeManager::GetDeleteLatency(DeleteLatencyMap *latency) const {
+    tbb::mutex::scoped_lock lock(latency_mutex_);
+    *latency = latency_;
+}
+
+void LifetimeManager::GetInfo(SandeshLifetimeManagerInfo *info) const {
+    info->set_task_name(
+        TaskScheduler::GetInstance()->GetTaskName(task_id_));
+    info->set_partitions(queues_.size());
+    size_t defer_count = 0;
+    for (std::vector<Queue *>::const_iterator it = queues_.begin();
+         it != queues_.end(); ++it) {
+        defer_count += (*it)->on_entry_defer_count();
+    }
+    info->set_defer_count(defer_count);
+
+    DeleteLatencyMap latency;
+    GetDeleteLatency(&latency);
+    std::vector<SandeshLifetimeDeleteLatency> latency_list;
+    for (DeleteLatencyMap::const_iterator it = latency.begin();
+         it != latency.end(); ++it) {
+        SandeshLifetimeDeleteLatency entry;
+        entry.set_actor(it->first);
+        entry.set_count(it->second.count);
+        entry.set_total_usecs(it->second.total_usecs);
+        entry.set_max_usecs(it->second.max_usecs);
+        entry.set_buckets(it->second.buckets);
+        latency_list.push_back(entry);
+    }
+    info->set_delete_latency(latency_list);
+}
+
+void LifetimeManager::GetManagerInfo(
+    std::vector<SandeshLifetimeManagerInfo> *list) {
+    tbb::mutex::scoped_lock lock(managers_mutex_);
+    for (std::set<LifetimeManager *>::const_iterator it = managers_.begin();
+         it != managers_.end(); ++it) {
+        SandeshLifetimeManagerInfo info;
+        (*it)->GetInfo(&info);
+        list->push_back(info);
+    }
+}
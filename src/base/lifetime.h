@@ -5,6 +5,10 @@
 #ifndef __BASE__LIFETIME_H__
 #define __BASE__LIFETIME_H__
 
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 #include <tbb/atomic.h>
 #include <tbb/mutex.h>
 
@@ -14,6 +18,7 @@
 
 class LifetimeActor;
 class LifetimeManager;
+class SandeshLifetimeManagerInfo;
 
 //
 // The Lifetime management framework enables a structured approach to the
@@ -66,6 +71,17 @@ class LifetimeManager;
 // tracked using simple reference counts. When the reference count becomes
 // 0, a delete event for the actor should be posted to the LifetimeManager.
 //
+// An actor has at most one delete event pending with the LifetimeManager.
+// Events posted while one is pending are folded into it, so that a parent
+// whose dependents go away one by one is checked once per batch instead of
+// once per dependent.
+//
+// The LifetimeManager can be created with several partitions, each served
+// by a separate instance of the Task. An actor is processed in the partition
+// it was created with, so actors of independent subtrees can be deleted in
+// parallel. This is only safe if the Destroy methods of the actors in the
+// different partitions don't share any state other than the LifetimeRefs.
+//
 
 //
 // Base class for a reference to a managed lifetime object.
@@ -115,7 +131,7 @@ private:
 // Member of an object that has managed lifetime.
 class LifetimeActor {
 public:
-    LifetimeActor(LifetimeManager *manager);
+    LifetimeActor(LifetimeManager *manager, int partition = 0);
     virtual ~LifetimeActor();
 
     // trigger the deletion of a an object.
@@ -155,18 +171,25 @@ public:
     const uint64_t delete_time_stamp_usecs() const {
         return delete_time_stamp_usecs_;
     }
+    int partition() const { return partition_; }
 
 private:
     typedef DependencyList<LifetimeRefBase, LifetimeActor> Dependents;
     friend class DependencyRef<LifetimeRefBase, LifetimeActor>;
+    friend class LifetimeManager;
 
     void DependencyAdd(DependencyRef<LifetimeRefBase, LifetimeActor> *node);
     void DependencyRemove(DependencyRef<LifetimeRefBase, LifetimeActor> *node);
+    void EnqueueLocked();
+    bool ReferenceIncrementIfNotQueued();
+    void Dequeued();
     tbb::mutex mutex_;
 
     LifetimeManager *manager_;
+    int partition_;
     tbb::atomic<bool> deleted_;
     int refcount_;
+    bool queued_;
     bool shutdown_invoked_;
     bool delete_paused_;
     uint64_t create_time_stamp_usecs_;
@@ -175,6 +198,26 @@ private:
     DISALLOW_COPY_AND_ASSIGN(LifetimeActor);
 };
 
+//
+// Histogram of the time from the Delete of an actor to its Destroy. Bucket
+// 0 counts the deletes that took less than 1 msec, bucket i those that took
+// [2^(i-1), 2^i) msec. The last bucket counts everything slower. The
+// histograms of all the managers are reported by SandeshLifetimeManagerReq.
+//
+struct LifetimeDeleteLatency {
+    static const int kBuckets = 16;
+
+    LifetimeDeleteLatency()
+        : count(0), total_usecs(0), max_usecs(0), buckets(kBuckets, 0) {
+    }
+    void Add(uint64_t usecs);
+
+    uint64_t count;
+    uint64_t total_usecs;
+    uint64_t max_usecs;
+    std::vector<uint64_t> buckets;
+};
+
 //
 // Handles deletion in the correct task context.
 //
@@ -184,7 +227,10 @@ private:
 class LifetimeManager {
 public:
     typedef boost::function<bool ()> TaskEntryCallback;
-    LifetimeManager(int task_id, TaskEntryCallback on_entry_cb = 0);
+    typedef std::map<std::string, LifetimeDeleteLatency> DeleteLatencyMap;
+
+    LifetimeManager(int task_id, TaskEntryCallback on_entry_cb = 0,
+                    int partitions = 1);
     ~LifetimeManager();
 
     // Enqueue Delete event.
@@ -196,16 +242,34 @@ public:
 
 
     // Return the number of times work queue task executions were deferred.
-    size_t GetQueueDeferCount() { return queue_.on_entry_defer_count(); }
+    size_t GetQueueDeferCount();
+
+    // Delete latency of the actors destroyed so far, by actor type.
+    void GetDeleteLatency(DeleteLatencyMap *latency) const;
+
+    int partitions() const { return queues_.size(); }
+
+    void GetInfo(SandeshLifetimeManagerInfo *info) const;
+    static void GetManagerInfo(std::vector<SandeshLifetimeManagerInfo> *list);
 
 private:
     struct LifetimeActorRef {
         LifetimeActor *actor;
     };
+    typedef WorkQueue<LifetimeActorRef> Queue;
 
     bool DeleteExecutor(LifetimeActorRef actor_ref);
+    Queue *PartitionQueue(const LifetimeActor *actor);
+    void RecordDeleteLatency(const LifetimeActor *actor);
+
+    int task_id_;
+    std::vector<Queue *> queues_;
+    mutable tbb::mutex latency_mutex_;
+    DeleteLatencyMap latency_;
+
+    static tbb::mutex managers_mutex_;
+    static std::set<LifetimeManager *> managers_;
 
-    WorkQueue<LifetimeActorRef> queue_;
     DISALLOW_COPY_AND_ASSIGN(LifetimeManager);
 };
 
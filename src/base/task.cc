@@ -592,6 +592,17 @@ int TaskScheduler::GetTaskId(const string &name) {
     return tid;
 }
 
+string TaskScheduler::GetTaskName(int task_id) {
+    tbb::reader_writer_lock::scoped_lock_read lock(id_map_mutex_);
+    for (TaskIdMap::const_iterator it = id_map_.begin(); it != id_map_.end();
+         ++it) {
+        if (it->second == task_id) {
+            return it->first;
+        }
+    }
+    return "";
+}
+
 void TaskScheduler::ClearTaskGroupStats(int task_id) {
     TaskGroup *group = GetTaskGroup(task_id);
     if (group == NULL)
@@ -154,6 +154,7 @@ public:
 
     bool GetRunStatus() { return running_; };
     int GetTaskId(const std::string &name);
+    std::string GetTaskName(int task_id);
 
     TaskStats *GetTaskGroupStats(int task_id);
     TaskStats *GetTaskStats(int task_id);
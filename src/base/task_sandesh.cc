@@ -6,7 +6,9 @@
 #include <fstream>
 #include <tbb/task.h>
 #include <base/task.h>
+#include <base/lifetime.h>
 #include <base/logging.h>
+#include <base/timer_wheel.h>
 
 #include <sandesh/sandesh_types.h>
 #include <sandesh/sandesh.h>
@@ -115,3 +117,27 @@ void SandeshTaskReq::HandleRequest() const {
     resp->set_more(false);
     resp->Response();
 }
+
+void SandeshTimerWheelReq::HandleRequest() const {
+    SandeshTimerWheelResp *resp = new SandeshTimerWheelResp;
+
+    std::vector<SandeshTimerWheelInfo> list;
+    TimerWheel::GetWheelInfo(&list);
+    resp->set_wheel_list(list);
+
+    resp->set_context(context());
+    resp->set_more(false);
+    resp->Response();
+}
+
+void SandeshLifetimeManagerReq::HandleRequest() const {
+    SandeshLifetimeManagerResp *resp = new SandeshLifetimeManagerResp;
+
+    std::vector<SandeshLifetimeManagerInfo> list;
+    LifetimeManager::GetManagerInfo(&list);
+    resp->set_manager_list(list);
+
+    resp->set_context(context());
+    resp->set_more(false);
+    resp->Response();
+}
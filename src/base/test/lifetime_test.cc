@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "base/lifetime.h"
+
+#include <boost/scoped_ptr.hpp>
+#include "base/logging.h"
+#include "base/task.h"
+#include "base/sandesh/task_types.h"
+#include "base/test/task_test_util.h"
+#include "testing/gunit.h"
+
+class TestObject;
+
+class TestActor : public LifetimeActor {
+public:
+    TestActor(LifetimeManager *manager, TestObject *object, int partition)
+        : LifetimeActor(manager, partition), object_(object) {
+    }
+    virtual bool MayDelete() const;
+    virtual void Destroy();
+
+private:
+    TestObject *object_;
+};
+
+//
+// A managed object, optionally dependent on a parent object. The objects
+// record the checks and the destroys done by the LifetimeManager.
+//
+class TestObject {
+public:
+    TestObject(LifetimeManager *manager, TestObject *parent = NULL,
+               int partition = 0)
+        : deleter_(new TestActor(manager, this, partition)),
+          parent_ref_(this, parent ? parent->deleter() : NULL),
+          may_delete_count_(0), destroyed_(NULL), destroy_instance_(NULL) {
+        busy_ = 0;
+    }
+
+    void ManagedDelete() { deleter_->Delete(); }
+    TestActor *deleter() { return deleter_.get(); }
+
+    bool MayDelete() const {
+        may_delete_count_++;
+        return busy_ == 0;
+    }
+    void Destroy() {
+        if (destroyed_)
+            (*destroyed_)++;
+        if (destroy_instance_)
+            *destroy_instance_ = Task::Running()->GetTaskInstance();
+        delete this;
+    }
+
+    void set_busy(int busy) { busy_ = busy; }
+    int may_delete_count() const { return may_delete_count_; }
+    void set_destroyed(int *destroyed) { destroyed_ = destroyed; }
+    void set_destroy_instance(int *instance) { destroy_instance_ = instance; }
+
+private:
+    boost::scoped_ptr<TestActor> deleter_;
+    LifetimeRef<TestObject> parent_ref_;
+    tbb::atomic<int> busy_;
+    mutable int may_delete_count_;
+    int *destroyed_;
+    int *destroy_instance_;
+};
+
+bool TestActor::MayDelete() const {
+    return object_->MayDelete();
+}
+
+void TestActor::Destroy() {
+    object_->Destroy();
+}
+
+class LifetimeTest : public ::testing::Test {
+protected:
+    LifetimeTest()
+        : task_id_(TaskScheduler::GetInstance()->GetTaskId(
+                       "::test::LifetimeTest")) {
+    }
+
+    virtual void TearDown() {
+        task_util::WaitForIdle();
+    }
+
+    int task_id_;
+};
+
+TEST_F(LifetimeTest, Cascade) {
+    LifetimeManager manager(task_id_);
+    TestObject *parent = new TestObject(&manager);
+    int parent_destroyed = 0;
+    parent->set_destroyed(&parent_destroyed);
+
+    static const int kChildren = 100;
+    int children_destroyed = 0;
+    for (int idx = 0; idx < kChildren; ++idx) {
+        TestObject *child = new TestObject(&manager, parent);
+        child->set_destroyed(&children_destroyed);
+    }
+
+    parent->deleter()->Delete();
+    task_util::WaitForIdle();
+    EXPECT_EQ(kChildren, children_destroyed);
+    EXPECT_EQ(1, parent_destroyed);
+}
+
+//
+// Delete events posted while one is pending are folded into it, MayDelete
+// is called once for all of them.
+//
+TEST_F(LifetimeTest, Coalesce) {
+    LifetimeManager manager(task_id_);
+    TestObject *object = new TestObject(&manager);
+    int destroyed = 0;
+    object->set_destroyed(&destroyed);
+    object->set_busy(1);
+
+    TaskScheduler::GetInstance()->Stop();
+    object->deleter()->Delete();
+    for (int idx = 0; idx < 100; ++idx) {
+        manager.Enqueue(object->deleter());
+    }
+    TaskScheduler::GetInstance()->Start();
+    task_util::WaitForIdle();
+    EXPECT_EQ(0, destroyed);
+    EXPECT_EQ(1, object->may_delete_count());
+
+    // A new event once the pending one was processed
+    object->set_busy(0);
+    manager.Enqueue(object->deleter());
+    task_util::WaitForIdle();
+    EXPECT_EQ(1, destroyed);
+}
+
+//
+// Actors are processed by the Task instance of their partition.
+//
+TEST_F(LifetimeTest, Partitions) {
+    LifetimeManager manager(task_id_, 0, 4);
+    EXPECT_EQ(4, manager.partitions());
+
+    std::vector<int> instances(8, -1);
+    for (int idx = 0; idx < 8; ++idx) {
+        TestObject *parent = new TestObject(&manager, NULL, idx);
+        TestObject *child = new TestObject(&manager, parent, idx);
+        child->set_destroy_instance(&instances[idx]);
+        parent->deleter()->Delete();
+    }
+    task_util::WaitForIdle();
+    for (int idx = 0; idx < 8; ++idx) {
+        EXPECT_EQ(idx % 4, instances[idx]);
+    }
+}
+
+TEST_F(LifetimeTest, DeleteLatency) {
+    LifetimeManager manager(task_id_);
+    TestObject *parent = new TestObject(&manager);
+    new TestObject(&manager, parent);
+    new TestObject(&manager, parent);
+
+    parent->deleter()->Delete();
+    task_util::WaitForIdle();
+
+    LifetimeManager::DeleteLatencyMap latency;
+    manager.GetDeleteLatency(&latency);
+    ASSERT_EQ(1, latency.size());
+    const LifetimeDeleteLatency &stats = latency.begin()->second;
+    EXPECT_EQ(3, stats.count);
+    uint64_t bucket_total = 0;
+    for (int idx = 0; idx < LifetimeDeleteLatency::kBuckets; ++idx) {
+        bucket_total += stats.buckets[idx];
+    }
+    EXPECT_EQ(stats.count, bucket_total);
+    EXPECT_LE(stats.max_usecs, stats.total_usecs);
+}
+
+TEST_F(LifetimeTest, LatencyBuckets) {
+    LifetimeDeleteLatency stats;
+    stats.Add(500);
+    stats.Add(1000);
+    stats.Add(3500);
+    stats.Add(1000ULL * 1000 * 1000);
+    EXPECT_EQ(1, stats.buckets[0]);
+    EXPECT_EQ(1, stats.buckets[1]);
+    EXPECT_EQ(1, stats.buckets[2]);
+    EXPECT_EQ(1, stats.buckets[LifetimeDeleteLatency::kBuckets - 1]);
+    EXPECT_EQ(4, stats.count);
+    EXPECT_EQ(1000ULL * 1000 * 1000, stats.max_usecs);
+}
+
+// The introspect info of a manager carries its delete latency
+TEST_F(LifetimeTest, ManagerInfo) {
+    LifetimeManager manager(task_id_, 0, 2);
+    TestObject *parent = new TestObject(&manager);
+    new TestObject(&manager, parent, 1);
+    parent->deleter()->Delete();
+    task_util::WaitForIdle();
+
+    std::vector<SandeshLifetimeManagerInfo> list;
+    LifetimeManager::GetManagerInfo(&list);
+    ASSERT_EQ(1, list.size());
+    const SandeshLifetimeManagerInfo &info = list[0];
+    EXPECT_EQ("::test::LifetimeTest", info.get_task_name());
+    EXPECT_EQ(2, info.get_partitions());
+    ASSERT_EQ(1, info.get_delete_latency().size());
+    const SandeshLifetimeDeleteLatency &latency = info.get_delete_latency()[0];
+    EXPECT_NE(std::string::npos, latency.get_actor().find("TestActor"));
+    EXPECT_EQ(2, latency.get_count());
+    EXPECT_EQ(static_cast<size_t>(LifetimeDeleteLatency::kBuckets),
+              latency.get_buckets().size());
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
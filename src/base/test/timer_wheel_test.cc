@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <iostream>
+#include <boost/asio/monotonic_deadline_timer.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/scoped_ptr.hpp>
+#include "tbb/atomic.h"
+#include "io/test/event_manager_test.h"
+#include "base/test/task_test_util.h"
+#include "base/logging.h"
+#include "base/util.h"
+#include "base/timer.h"
+#include "base/timer_wheel.h"
+#include "testing/gunit.h"
+
+using namespace std;
+
+static tbb::atomic<int> fire_count_;
+
+static bool TimerCb() {
+    fire_count_.fetch_and_increment();
+    return false;
+}
+
+static tbb::atomic<int> error_count_;
+
+static void TimerErrorCb(string name, string error, string message) {
+    error_count_.fetch_and_increment();
+}
+
+static void AsioTimerCb(const boost::system::error_code &ec) {
+}
+
+//
+// The wheel is advanced by hand in the tests that check the expiry ticks.
+// Its io_service is not run, so the tick never fires by itself.
+//
+class TimerWheelTest : public ::testing::Test {
+protected:
+    TimerWheelTest()
+        : wheel_(&boost::asio::use_service<TimerWheel>(io_service_)) {
+        fire_count_ = 0;
+        task_id_ = TaskScheduler::GetInstance()->GetTaskId(
+            "timer_wheel_test::Timer");
+    }
+
+    virtual void TearDown() {
+        for (vector<Timer *>::iterator it = timers_.begin();
+             it != timers_.end(); ++it) {
+            EXPECT_TRUE(TimerManager::DeleteTimer(*it));
+        }
+    }
+
+    Timer *CreateTimer(const string &name) {
+        Timer *timer = TimerManager::CreateTimer(io_service_, name, task_id_,
+                                                 0);
+        timers_.push_back(timer);
+        return timer;
+    }
+
+    // Start the timer and return the range of ticks it may expire in
+    pair<uint64_t, uint64_t> Start(Timer *timer, int time) {
+        uint64_t before = wheel_->ElapsedMsec();
+        timer->Start(time, TimerCb);
+        uint64_t after = wheel_->ElapsedMsec();
+        return make_pair(
+            max(Round(before + time), current() + 1),
+            max(Round(after + time), current() + 1));
+    }
+
+    static uint64_t Round(uint64_t msec) {
+        return (msec + TimerWheel::kTickMsec - 1) / TimerWheel::kTickMsec;
+    }
+
+    // Returns the number of timers that expired up to tick
+    size_t AdvanceTo(uint64_t tick) {
+        TimerWheel::ExpiryList expired;
+        tbb::mutex::scoped_lock lock(wheel_->mutex_);
+        wheel_->Advance(tick, &expired);
+        return expired.size();
+    }
+
+    uint64_t current() const { return wheel_->current_; }
+    size_t level_count(int level) const { return wheel_->level_count_[level]; }
+    uint64_t cascaded() const { return wheel_->cascaded_; }
+
+    boost::asio::io_service io_service_;
+    TimerWheel *wheel_;
+    int task_id_;
+    vector<Timer *> timers_;
+};
+
+TEST_F(TimerWheelTest, Levels) {
+    static const int kMsec = TimerWheel::kTickMsec;
+
+    Timer *timer1 = CreateTimer("level-0");
+    Timer *timer2 = CreateTimer("level-1");
+    Timer *timer3 = CreateTimer("level-2");
+    Timer *timer4 = CreateTimer("level-3");
+    Start(timer1, 100 * kMsec);
+    Start(timer2, 1000 * kMsec);
+    Start(timer3, 100000 * kMsec);
+    Start(timer4, 10000000 * kMsec);
+    EXPECT_EQ(4U, wheel_->timer_count());
+    for (int level = 0; level < TimerWheel::kLevels; ++level) {
+        EXPECT_EQ(1U, level_count(level));
+    }
+
+    // Restart moves the timer, it is never on the wheel twice
+    timer1->Cancel();
+    Start(timer1, 2 * kMsec);
+    EXPECT_EQ(4U, wheel_->timer_count());
+
+    // Cancel takes the timer off the wheel
+    timer2->Cancel();
+    EXPECT_EQ(3U, wheel_->timer_count());
+    EXPECT_EQ(0U, level_count(1));
+
+    EXPECT_EQ(1U, AdvanceTo(current() + 1100));
+    EXPECT_EQ(2U, wheel_->timer_count());
+    EXPECT_EQ(0U, level_count(0));
+}
+
+//
+// Expire timers on either side of the level boundaries, and check that none
+// expires a tick early or late after being cascaded down.
+//
+TEST_F(TimerWheelTest, Cascade) {
+    static const int kTimes[] = {
+        10, 2540, 2550, 2560, 2570, 5120, 163830, 163840, 163850,
+        10485750, 10485760, 10485770, 671088630, 671088640, 671088650,
+    };
+    static const size_t kCount = sizeof(kTimes) / sizeof(kTimes[0]);
+
+    vector<pair<uint64_t, uint64_t> > expiry;
+    for (size_t idx = 0; idx < kCount; ++idx) {
+        Timer *timer = CreateTimer("cascade-" + integerToString(idx));
+        expiry.push_back(Start(timer, kTimes[idx]));
+    }
+
+    size_t expired = 0;
+    for (size_t idx = 0; idx < kCount; ++idx) {
+        if (current() + 1 < expiry[idx].first) {
+            expired += AdvanceTo(expiry[idx].first - 1);
+            EXPECT_EQ(idx, expired) << "Timer " << kTimes[idx] << " early";
+        }
+        if (current() < expiry[idx].second) {
+            expired += AdvanceTo(expiry[idx].second);
+        }
+        EXPECT_EQ(idx + 1, expired) << "Timer " << kTimes[idx] << " late";
+    }
+    EXPECT_EQ(0U, wheel_->timer_count());
+    EXPECT_LT(0U, cascaded());
+}
+
+class TimerWheelBatchTest : public ::testing::Test {
+protected:
+    TimerWheelBatchTest() : evm_(new EventManager()) {
+        fire_count_ = 0;
+        error_count_ = 0;
+    }
+
+    virtual void SetUp() {
+        thread_.reset(new ServerThread(evm_.get()));
+        thread_->Start();
+        wheel_ = &boost::asio::use_service<TimerWheel>(*evm_->io_service());
+    }
+
+    virtual void TearDown() {
+        task_util::WaitForIdle();
+        evm_->Shutdown();
+        if (thread_.get() != NULL) {
+            thread_->Join();
+        }
+        task_util::WaitForIdle();
+    }
+
+    uint64_t tasks() const {
+        tbb::mutex::scoped_lock lock(wheel_->mutex_);
+        return wheel_->tasks_;
+    }
+
+    uint64_t expired() const {
+        tbb::mutex::scoped_lock lock(wheel_->mutex_);
+        return wheel_->expired_;
+    }
+
+    uint64_t direct() const {
+        tbb::mutex::scoped_lock lock(wheel_->mutex_);
+        return wheel_->direct_;
+    }
+
+    // Hand the running timer to its task as if the asio wait failed
+    void ExpireWithError(Timer *timer, const boost::system::error_code &ec) {
+        TimerWheel::ExpiryList expired;
+        expired.push_back(make_pair(Timer::TimerPtr(timer), timer->seq_no_));
+        wheel_->StartTasks(expired, ec);
+    }
+
+    boost::scoped_ptr<EventManager> evm_;
+    boost::scoped_ptr<ServerThread> thread_;
+    TimerWheel *wheel_;
+};
+
+// Timers that expire together are run from one task per task-id
+TEST_F(TimerWheelBatchTest, Batch) {
+    static const int kTimers = 1000;
+
+    int task_id = TaskScheduler::GetInstance()->GetTaskId(
+        "timer_wheel_test::Batch");
+    vector<Timer *> timers;
+    for (int idx = 0; idx < kTimers; ++idx) {
+        timers.push_back(TimerManager::CreateTimer(*evm_->io_service(),
+            "batch-" + integerToString(idx), task_id, 0));
+    }
+    for (int idx = 0; idx < kTimers; ++idx) {
+        timers[idx]->Start(50, TimerCb);
+    }
+    // Cancelled timers are skipped
+    for (int idx = 0; idx < kTimers; idx += 2) {
+        timers[idx]->Cancel();
+    }
+
+    TASK_UTIL_EXPECT_EQ(static_cast<uint64_t>(kTimers / 2), expired());
+    task_util::WaitForIdle();
+    EXPECT_EQ(kTimers / 2, fire_count_);
+    EXPECT_GE(5U, tasks());
+
+    for (int idx = 0; idx < kTimers; ++idx) {
+        EXPECT_TRUE(TimerManager::DeleteTimer(timers[idx]));
+    }
+    TASK_UTIL_EXPECT_EQ(0U, wheel_->timer_count());
+}
+
+// Timers with no task instance get a task each, so that they run in parallel
+TEST_F(TimerWheelBatchTest, NoInstance) {
+    static const int kTimers = 10;
+
+    int task_id = TaskScheduler::GetInstance()->GetTaskId(
+        "timer_wheel_test::NoInstance");
+    vector<Timer *> timers;
+    for (int idx = 0; idx < kTimers; ++idx) {
+        timers.push_back(TimerManager::CreateTimer(*evm_->io_service(),
+            "no-instance-" + integerToString(idx), task_id, -1));
+    }
+    for (int idx = 0; idx < kTimers; ++idx) {
+        timers[idx]->Start(50, TimerCb);
+    }
+
+    TASK_UTIL_EXPECT_EQ(static_cast<uint64_t>(kTimers), expired());
+    TASK_UTIL_EXPECT_EQ(kTimers, fire_count_);
+    EXPECT_EQ(static_cast<uint64_t>(kTimers), tasks());
+
+    for (int idx = 0; idx < kTimers; ++idx) {
+        EXPECT_TRUE(TimerManager::DeleteTimer(timers[idx]));
+    }
+}
+
+// Timers shorter than a tick are fired without going on the wheel
+TEST_F(TimerWheelBatchTest, Direct) {
+    static const int kTimes[] = { 0, 1, TimerWheel::kTickMsec - 1 };
+    static const int kCount = sizeof(kTimes) / sizeof(kTimes[0]);
+
+    vector<Timer *> timers;
+    for (int idx = 0; idx < kCount; ++idx) {
+        timers.push_back(TimerManager::CreateTimer(*evm_->io_service(),
+            "direct-" + integerToString(idx)));
+        timers[idx]->Start(kTimes[idx], TimerCb);
+    }
+    EXPECT_EQ(0U, wheel_->timer_count());
+
+    TASK_UTIL_EXPECT_EQ(kCount, fire_count_);
+    task_util::WaitForIdle();
+    EXPECT_EQ(static_cast<uint64_t>(kCount), direct());
+    EXPECT_EQ(0U, expired());
+    for (int idx = 0; idx < kCount; ++idx) {
+        EXPECT_FALSE(timers[idx]->running());
+    }
+
+    // A cancelled timer doesn't fire, nor does the previous run of a
+    // restarted timer
+    timers[0]->Start(TimerWheel::kTickMsec - 1, TimerCb);
+    timers[0]->Cancel();
+    timers[1]->Start(TimerWheel::kTickMsec - 1, TimerCb);
+    timers[1]->Cancel();
+    timers[1]->Start(0, TimerCb);
+    TASK_UTIL_EXPECT_EQ(kCount + 1, fire_count_);
+    TASK_UTIL_EXPECT_EQ(static_cast<uint64_t>(kCount + 3), direct());
+    task_util::WaitForIdle();
+    EXPECT_EQ(kCount + 1, fire_count_);
+
+    for (int idx = 0; idx < kCount; ++idx) {
+        EXPECT_TRUE(TimerManager::DeleteTimer(timers[idx]));
+    }
+}
+
+// A failed expiry invokes the error handler instead of the callback
+TEST_F(TimerWheelBatchTest, Error) {
+    boost::system::error_code ec =
+        boost::asio::error::make_error_code(boost::asio::error::timed_out);
+
+    Timer *timer = TimerManager::CreateTimer(*evm_->io_service(), "error");
+    timer->Start(10000, TimerCb, TimerErrorCb);
+    ExpireWithError(timer, ec);
+    TASK_UTIL_EXPECT_EQ(1, error_count_);
+    task_util::WaitForIdle();
+    EXPECT_EQ(0, fire_count_);
+    EXPECT_FALSE(timer->running());
+
+    // Without an error handler the callback is invoked
+    timer->Start(10000, TimerCb);
+    ExpireWithError(timer, ec);
+    TASK_UTIL_EXPECT_EQ(1, fire_count_);
+    task_util::WaitForIdle();
+    EXPECT_EQ(1, error_count_);
+
+    EXPECT_TRUE(TimerManager::DeleteTimer(timer));
+}
+
+//
+// Start and cancel of many timers, as done for keepalive and hold timers,
+// on the wheel and with an asio timer each.
+//
+TEST_F(TimerWheelBatchTest, StartCancelBenchmark) {
+    static const int kTimers = 20000;
+    static const int kRounds = 10;
+
+    vector<Timer *> timers;
+    for (int idx = 0; idx < kTimers; ++idx) {
+        timers.push_back(TimerManager::CreateTimer(*evm_->io_service(),
+            "bench-" + integerToString(idx)));
+    }
+    uint64_t start = UTCTimestampUsec();
+    for (int round = 0; round < kRounds; ++round) {
+        for (int idx = 0; idx < kTimers; ++idx) {
+            timers[idx]->Cancel();
+            timers[idx]->Start(90000 + idx, TimerCb);
+        }
+    }
+    uint64_t wheel_usec = UTCTimestampUsec() - start;
+    for (int idx = 0; idx < kTimers; ++idx) {
+        EXPECT_TRUE(TimerManager::DeleteTimer(timers[idx]));
+    }
+
+    boost::ptr_vector<boost::asio::monotonic_deadline_timer> asio_timers;
+    for (int idx = 0; idx < kTimers; ++idx) {
+        asio_timers.push_back(
+            new boost::asio::monotonic_deadline_timer(*evm_->io_service()));
+    }
+    start = UTCTimestampUsec();
+    for (int round = 0; round < kRounds; ++round) {
+        for (int idx = 0; idx < kTimers; ++idx) {
+            boost::system::error_code ec;
+            asio_timers[idx].expires_from_now(
+                boost::posix_time::milliseconds(90000 + idx), ec);
+            asio_timers[idx].async_wait(
+                boost::bind(&AsioTimerCb, boost::asio::placeholders::error));
+        }
+    }
+    uint64_t asio_usec = UTCTimestampUsec() - start;
+    asio_timers.clear();
+
+    cout << kTimers * kRounds << " timer restarts: wheel " << wheel_usec
+         << " usec, asio " << asio_usec << " usec" << endl;
+    EXPECT_EQ(0, fire_count_);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    LoggingInit();
+    return RUN_ALL_TESTS();
+}
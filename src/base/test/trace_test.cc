@@ -2,6 +2,10 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <pthread.h>
+#include <iostream>
+#include <boost/bind.hpp>
+
 #include "testing/gunit.h"
 #include "base/trace.h"
 
@@ -10,6 +14,207 @@ namespace {
 class TraceTest : public ::testing::Test {
 };
 
+struct TraceEntry {
+    TraceEntry(int thread, int value) : thread(thread), value(value) {
+        live++;
+    }
+    ~TraceEntry() {
+        live--;
+    }
+    int thread;
+    int value;
+    static tbb::atomic<int> live;
+};
+tbb::atomic<int> TraceEntry::live;
+
+typedef TraceBuffer<TraceEntry> TraceEntryBuffer;
+
+class TraceBufferTest : public ::testing::Test {
+protected:
+    struct WriterArgs {
+        TraceEntryBuffer *trace_buf;
+        int thread;
+        int count;
+    };
+
+    virtual void TearDown() {
+        trace_buf_.reset();
+        EXPECT_EQ(0, TraceEntry::live);
+    }
+
+    void Write(int count, int thread = 0) {
+        for (int i = 0; i < count; i++) {
+            trace_buf_->TraceWrite(new TraceEntry(thread, i));
+        }
+    }
+
+    void ReadCb(TraceEntry *entry, bool more) {
+        entries_.push_back(std::make_pair(entry->thread, entry->value));
+        more_ = more;
+    }
+
+    void WriteReadCb(TraceEntry *entry, bool more) {
+        trace_buf_->TraceWrite(new TraceEntry(1, entry->value));
+        ReadCb(entry, more);
+    }
+
+    // Write a trace for every trace read
+    void ReadAndWrite(const std::string &context) {
+        entries_.clear();
+        trace_buf_->TraceRead(context, 0,
+            boost::bind(&TraceBufferTest::WriteReadCb, this, _1, _2));
+    }
+
+    void Read(const std::string &context, int count) {
+        entries_.clear();
+        trace_buf_->TraceRead(context, count,
+            boost::bind(&TraceBufferTest::ReadCb, this, _1, _2));
+    }
+
+    static void *WriterRun(void *arg) {
+        WriterArgs *args = static_cast<WriterArgs *>(arg);
+        for (int i = 0; i < args->count; i++) {
+            args->trace_buf->TraceWrite(new TraceEntry(args->thread, i));
+        }
+        return NULL;
+    }
+
+    // Returns the time it took all the threads to write count traces each
+    uint64_t WriteThreads(int threads, int count) {
+        std::vector<WriterArgs> args(threads);
+        std::vector<pthread_t> thread_ids(threads);
+        uint64_t start = UTCTimestampUsec();
+        for (int i = 0; i < threads; i++) {
+            args[i].trace_buf = trace_buf_.get();
+            args[i].thread = i;
+            args[i].count = count;
+            pthread_create(&thread_ids[i], NULL, &WriterRun, &args[i]);
+        }
+        for (int i = 0; i < threads; i++) {
+            pthread_join(thread_ids[i], NULL);
+        }
+        return UTCTimestampUsec() - start;
+    }
+
+    std::auto_ptr<TraceEntryBuffer> trace_buf_;
+    std::vector<std::pair<int, int> > entries_;
+    bool more_;
+};
+
+TEST_F(TraceBufferTest, Read) {
+    trace_buf_.reset(new TraceEntryBuffer("Read", 100, true));
+    Read("ctx", 0);
+    EXPECT_TRUE(entries_.empty());
+
+    Write(10);
+    Read("ctx", 0);
+    ASSERT_EQ(10U, entries_.size());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i, entries_[i].second);
+    }
+    EXPECT_FALSE(more_);
+
+    // Only the newest traces are kept
+    Write(250);
+    Read("other", 0);
+    ASSERT_EQ(100U, entries_.size());
+    EXPECT_EQ(150, entries_.front().second);
+    EXPECT_EQ(249, entries_.back().second);
+}
+
+TEST_F(TraceBufferTest, ReadContext) {
+    trace_buf_.reset(new TraceEntryBuffer("ReadContext", 100, true));
+    Write(50);
+
+    Read("ctx", 30);
+    ASSERT_EQ(30U, entries_.size());
+    EXPECT_TRUE(more_);
+    Read("ctx", 30);
+    ASSERT_EQ(20U, entries_.size());
+    EXPECT_EQ(30, entries_.front().second);
+    EXPECT_FALSE(more_);
+    Read("ctx", 30);
+    EXPECT_TRUE(entries_.empty());
+
+    // Continue with the new traces
+    Write(10);
+    Read("ctx", 0);
+    ASSERT_EQ(10U, entries_.size());
+    EXPECT_EQ(0, entries_.front().second);
+
+    // Restart from the oldest trace once the read is done
+    trace_buf_->TraceReadDone("ctx");
+    Read("ctx", 0);
+    EXPECT_EQ(60U, entries_.size());
+
+    // Traces that were overwritten since the last read are skipped
+    Read("ctx", 10);
+    Write(200);
+    Read("ctx", 0);
+    ASSERT_EQ(100U, entries_.size());
+    EXPECT_EQ(100, entries_.front().second);
+}
+
+TEST_F(TraceBufferTest, Sample) {
+    trace_buf_.reset(new TraceEntryBuffer("Sample", 100, true));
+    EXPECT_TRUE(trace_buf_->TraceSample());
+    trace_buf_->TraceSampleRateSet(4);
+    int sampled = 0;
+    for (int i = 0; i < 100; i++) {
+        if (trace_buf_->TraceSample()) sampled++;
+    }
+    EXPECT_EQ(25, sampled);
+}
+
+//
+// Traces written concurrently are read back in the order of each writer.
+//
+TEST_F(TraceBufferTest, ConcurrentWrite) {
+    static const int kThreads = 8;
+    static const int kBufferSize = 4096;
+    trace_buf_.reset(new TraceEntryBuffer("ConcurrentWrite", kBufferSize,
+                                          true));
+    WriteThreads(kThreads, 20000);
+
+    // The last kBufferSize traces of all the writers are kept
+    Read("ctx", 0);
+    EXPECT_EQ(static_cast<size_t>(kBufferSize), entries_.size());
+    std::vector<int> last(kThreads, -1);
+    for (size_t i = 0; i < entries_.size(); i++) {
+        EXPECT_LT(last[entries_[i].first], entries_[i].second);
+        last[entries_[i].first] = entries_[i].second;
+    }
+}
+
+//
+// The callback is invoked without any lock of the buffer held, so it can
+// write traces. The traces being read stay valid when they are overwritten.
+//
+TEST_F(TraceBufferTest, WriteFromReadCallback) {
+    trace_buf_.reset(new TraceEntryBuffer("WriteFromReadCallback", 10, true));
+    Write(10);
+    ReadAndWrite("ctx");
+    ASSERT_EQ(10U, entries_.size());
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(i, entries_[i].second);
+    }
+
+    // Only the traces written by the callback are left
+    Read("other", 0);
+    ASSERT_EQ(10U, entries_.size());
+    EXPECT_EQ(1, entries_.front().first);
+}
+
+TEST_F(TraceBufferTest, WriteBenchmark) {
+    static const int kCount = 200000;
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        trace_buf_.reset(new TraceEntryBuffer("WriteBenchmark", 1000, true));
+        uint64_t usec = WriteThreads(threads, kCount);
+        std::cout << threads << " threads: " << threads * kCount
+                  << " traces in " << usec << " usec" << std::endl;
+    }
+}
+
 class TraceStruct {
     char data[4096];
 };
@@ -4,81 +4,106 @@
 
 #include "base/timer.h"
 
+#include <algorithm>
+#include <map>
+
+#include "base/timer_wheel.h"
+
 class Timer::TimerTask : public Task {
 public:
-    TimerTask(TimerPtr timer, boost::system::error_code ec)
-        : Task(timer->task_id_, timer->task_instance_), timer_(timer), ec_(ec) {
+    TimerTask(int task_id, int task_instance,
+              const boost::system::error_code &ec)
+        : Task(task_id, task_instance), ec_(ec) {
     }
 
     virtual ~TimerTask() {
     }
 
-    // Invokes user callback.
-    // Timer could have been cancelled or delete when task was enqueued
+    void Add(TimerPtr timer) {
+        timers_.push_back(timer);
+    }
+
+    size_t size() const { return timers_.size(); }
+
+    // Invokes user callback of every timer expired in the tick.
+    // A timer could have been cancelled or deleted when task was enqueued
     virtual bool Run() {
+        for (TimerList::iterator it = timers_.begin(); it != timers_.end();
+             ++it) {
+            Fire(it->get());
+        }
+        timers_.clear();
+        return true;
+    }
+
+    // Task Cancelled/Destroyed when it was enqueued.
+    void OnTaskCancel() {
+        for (TimerList::iterator it = timers_.begin(); it != timers_.end();
+             ++it) {
+            Timer *timer = it->get();
+            tbb::mutex::scoped_lock lock(timer->mutex_);
+            if (timer->timer_task_ == this) {
+                timer->timer_task_ = NULL;
+                timer->SetState(Timer::Init);
+            }
+        }
+        timers_.clear();
+    }
+
+private:
+    typedef std::vector<TimerPtr> TimerList;
+
+    void Fire(Timer *timer) {
         {
-            tbb::mutex::scoped_lock lock(timer_->mutex_);
+            tbb::mutex::scoped_lock lock(timer->mutex_);
 
-            // cancelled task .. ignore
-            if (task_cancelled()) {
-                // Cancelled timer's task releases the ownership of the timer
-                timer_ = NULL;
-                return true;
+            // cancelled or restarted timer .. ignore
+            if (timer->timer_task_ != this) {
+                return;
             }
 
             // Conditions to invoke user callback met. Fire it
-            timer_->SetState(Timer::Fired);
+            timer->SetState(Timer::Fired);
         }
 
         bool restart = false;
 
-        // TODO: Is this error needed by user?
-        if (ec_ && !timer_->error_handler_.empty()) {
-            timer_->error_handler_(timer_->name_,
-                                   std::string(ec_.category().name()),
-                                   ec_.message());
+        // The expiry failed, report it to the user instead of firing
+        if (ec_ && !timer->error_handler_.empty()) {
+            timer->error_handler_(timer->name_,
+                                  std::string(ec_.category().name()),
+                                  ec_.message());
         } else {
-            restart = timer_->handler_();
-        }
-
-        OnTaskCancel();
-
-        if (restart) {
-            timer_->Start(timer_->time_, timer_->handler_,
-                          timer_->error_handler_);
-        } else if (timer_->delete_on_completion_) {
-            TimerManager::DeleteTimer(timer_.get());
+            restart = timer->handler_();
         }
-        return true;
-    }
 
-    // Task Cancelled/Destroyed when it was Fired.
-    void OnTaskCancel() {
-        if (!timer_) {
-            return;
+        {
+            tbb::mutex::scoped_lock lock(timer->mutex_);
+            timer->timer_task_ = NULL;
+            timer->SetState(Timer::Init);
         }
-        tbb::mutex::scoped_lock lock(timer_->mutex_);
 
-        if (timer_->timer_task_ != this) {
-            assert(!timer_->timer_task_);
+        if (restart) {
+            timer->Start(timer->time_, timer->handler_,
+                         timer->error_handler_);
+        } else if (timer->delete_on_completion_) {
+            TimerManager::DeleteTimer(timer);
         }
-
-        timer_->timer_task_ = NULL;
-        timer_->SetState(Timer::Init);
     }
 
-private:
-    TimerPtr timer_;
+    TimerList timers_;
     boost::system::error_code ec_;
     DISALLOW_COPY_AND_ASSIGN(TimerTask);
 };
 
 Timer::Timer(boost::asio::io_service &service, const std::string &name,
           int task_id, int task_instance, bool delete_on_completion)
-    : boost::asio::monotonic_deadline_timer(service), name_(name), handler_(NULL),
+    : name_(name), handler_(NULL),
     error_handler_(NULL), state_(Init), timer_task_(NULL), time_(0),
     task_id_(task_id), task_instance_(task_instance), seq_no_(0),
-    delete_on_completion_(delete_on_completion) {
+    delete_on_completion_(delete_on_completion),
+    wheel_(&boost::asio::use_service<TimerWheel>(service)),
+    wheel_expiry_(0), wheel_seq_no_(0), wheel_level_(0) {
     refcount_ = 0;
 }
 
@@ -106,15 +131,10 @@ bool Timer::Start(int time, Handler handler, ErrorHandler error_handler) {
     handler_ = handler;
     seq_no_++;
     error_handler_ = error_handler;
-    boost::system::error_code ec;
-    expires_from_now(boost::posix_time::milliseconds(time), ec);
-    if (ec) {
-        return false;
-    }
+    time_ = time;
 
     SetState(Running);
-    async_wait(boost::bind(Timer::StartTimerTask, this, TimerPtr(this), time, 
-                           seq_no_, boost::asio::placeholders::error));
+    wheel_->Add(this, time);
     return true;
 }
 
@@ -130,8 +150,16 @@ bool Timer::Reschedule(int time)
     return true;
 }
 
+//
 // Cancel a running timer
+//
+// Take the timer off the wheel. An expiry already taken off the wheel is
+// ignored as the timer is no longer running, and a task the timer was handed
+// to skips it, as it no longer owns the timer.
+//
 bool Timer::Cancel() {
+    // Released after the timer is unlocked
+    TimerPtr wheel_ref;
     tbb::mutex::scoped_lock lock(mutex_);
 
     // A fired timer cannot be cancelled
@@ -139,43 +167,82 @@ bool Timer::Cancel() {
         return false;
     }
 
-    // Cancel Task. If Task cancel succeeds, there will be no callback.
-    // Reset TaskRef if call succeeds.
-    if (timer_task_) {
-        TaskScheduler::CancelReturnCode rc = 
-            TaskScheduler::GetInstance()->Cancel(timer_task_);
-        assert(rc != TaskScheduler::FAILED);
-        timer_task_ = NULL;
+    // Only a timer linked by Start, under the timer mutex, can be on the
+    // wheel. Timers are never left on the wheel of a destroyed io_service.
+    if (wheel_node_.is_linked() && wheel_->Remove(this)) {
+        wheel_ref = TimerPtr(this, false);
     }
-
+    timer_task_ = NULL;
     SetState(Cancelled);
     return true;
 }
 
-// ASIO callback on timer expiry. Start a task to serve the timer
-void Timer::StartTimerTask(boost::asio::monotonic_deadline_timer* t, TimerPtr timer,
-                           int time, uint32_t seq_no, 
-                           const boost::system::error_code &ec) {
-    tbb::mutex::scoped_lock lock(timer->mutex_);
+//
+// Wheel expiry of the timer. Hand the timer to the task, unless it was
+// cancelled or restarted after the expiry was taken off the wheel.
+//
+bool Timer::Expire(uint32_t seq_no, TimerTask *task) {
+    tbb::mutex::scoped_lock lock(mutex_);
+
+    if (state_ != Running) {
+        return false;
+    }
 
-    if (timer->state_ == Cancelled) {
-        return;
+    // Timer could have expired for previous run. Validate the seq_no_
+    if (seq_no_ != seq_no) {
+        return false;
     }
 
-    // If timer was cancelled, no callback is invoked
-    if (ec && ec.value() == boost::asio::error::operation_aborted) {
-        return;
+    assert(timer_task_ == NULL);
+    timer_task_ = task;
+    task->Add(TimerPtr(this));
+    return true;
+}
+
+void Timer::StartTimerTasks(const ExpiryList &expired,
+                            const boost::system::error_code &ec,
+                            size_t *tasks, size_t *max_batch) {
+    typedef std::map<std::pair<int, int>, TimerTask *> TaskMap;
+    TaskMap task_map;
+    std::vector<TimerTask *> task_list;
+
+    for (ExpiryList::const_iterator it = expired.begin();
+         it != expired.end(); ++it) {
+        Timer *timer = it->first.get();
+
+        // Tasks with no instance can run in parallel, don't serialize the
+        // timers in one task
+        if (timer->task_instance_ == -1) {
+            TimerTask *task = new TimerTask(timer->task_id_, -1, ec);
+            task_list.push_back(task);
+            timer->Expire(it->second, task);
+            continue;
+        }
+
+        std::pair<int, int> key(timer->task_id_, timer->task_instance_);
+        TaskMap::iterator loc = task_map.find(key);
+        if (loc == task_map.end()) {
+            loc = task_map.insert(std::make_pair(key,
+                new TimerTask(key.first, key.second, ec))).first;
+            task_list.push_back(loc->second);
+        }
+        timer->Expire(it->second, loc->second);
     }
 
-    // Timer could have fired for previous run. Validate the seq_no_
-    if (timer->seq_no_ != seq_no) {
-        return;
+    *tasks = 0;
+    *max_batch = 0;
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    for (std::vector<TimerTask *>::iterator it = task_list.begin();
+         it != task_list.end(); ++it) {
+        TimerTask *task = *it;
+        if (task->size() == 0) {
+            delete task;
+            continue;
+        }
+        (*tasks)++;
+        *max_batch = std::max(*max_batch, task->size());
+        scheduler->Enqueue(task);
     }
-    // Start a task and add Task reference.
-    assert(timer->timer_task_ == NULL);
-    timer->timer_task_ = new TimerTask(timer, ec);
-    timer->time_ = time;
-    TaskScheduler::GetInstance()->Enqueue(timer->timer_task_);
 }
 
 //
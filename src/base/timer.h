@@ -2,9 +2,13 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
-//  Timer implementation using ASIO and Task infrastructure. 
-//  Registers an ASIO timer. On ASIO timer expiry, a task will be created to
-//  run the timer. Supports user specified task-id.
+//  Timer implementation using ASIO and Task infrastructure.
+//  Timers are kept on the TimerWheel of their io_service, which is driven by
+//  a single ASIO timer. On expiry, a task is created to run the timer. The
+//  timers that expire together and use the same task-id and instance are
+//  run from one task, the ones with no instance get a task each. Timers
+//  shorter than a tick of the wheel are fired directly. Supports user
+//  specified task-id.
 //
 //  Operations supported
 //  - Create a timer by allocating an object of type Timer
@@ -15,8 +19,8 @@
 //    There can be atmost one "Task" outstanding for the timer.
 //
 //  - Cancel a timer
-//    Cancels a running timer. Both ASIO registerations and task spawned will
-//    be cancelled.
+//    Cancels a running timer. Neither an expiry on the wheel nor a task
+//    spawned for the timer will invoke the callback.
 //
 //    If timer is already fired, "Cancel" api will fail and return 'false'
 //
@@ -28,30 +32,32 @@
 //  - Timer is allocated by application
 //  - Applications must call TimerManager::DeleteTimer() to delete the timer
 //  - All operations on timer are protected by mutex
-//  - When timer is running, it can have references from ASIO and Task. 
-//    Timer class will keep of reference from ASIO and Task. Timer will
+//  - When timer is running, it can have references from the wheel and Task.
+//    Timer class will keep of reference from the wheel and Task. Timer will
 //    be deleted when both the references go away. (via intrusive pointer)
 //
 
 #ifndef TIMER_H_
 #define TIMER_H_
 
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
 
-#include <boost/asio/placeholders.hpp>
 #include <boost/bind.hpp>
 #include <boost/intrusive_ptr.hpp>
+#include <boost/intrusive/list_hook.hpp>
 #include <boost/function.hpp>
 #include <boost/asio.hpp>
-#include <boost/system/error_code.hpp>
 #include <set>
-#include <boost/asio/monotonic_deadline_timer.hpp>
+#include <vector>
 
 #include <base/task.h>
 
-class Timer : public boost::asio::monotonic_deadline_timer {
+class TimerWheel;
+
+class Timer {
 private:
-	// Task used to fire the timer
+    // Task used to fire the timers expired in a tick
     class TimerTask;
 
 public:
@@ -114,10 +120,14 @@ public:
 private:
     friend class TimerManager;
     friend class TimerTest;
+    friend class TimerWheel;
+    friend class TimerWheelBatchTest;
 
     friend void intrusive_ptr_add_ref(Timer *timer);
     friend void intrusive_ptr_release(Timer *timer);
     typedef boost::intrusive_ptr<Timer> TimerPtr;
+    typedef boost::intrusive::list_member_hook<
+        boost::intrusive::link_mode<boost::intrusive::auto_unlink> > WheelHook;
 
     enum TimerState {
         Init            = 0,
@@ -126,10 +136,17 @@ private:
         Cancelled       = 3,
     };
 
-    // ASIO callback on timer expiry. Start a task to serve the timer
-    static void StartTimerTask(boost::asio::monotonic_deadline_timer* t, TimerPtr t_ptr,
-                               int time, uint32_t seq_no,
-                               const boost::system::error_code &ec);
+    typedef std::vector<std::pair<TimerPtr, uint32_t> > ExpiryList;
+
+    // Called by the wheel with the timers expired in a tick, along with the
+    // seq_no_ they were started with. Enqueues one task per task-id and
+    // instance, or per timer for the timers with no instance, and returns
+    // the number of tasks and of timers in the largest. On an asio error
+    // the tasks invoke the error handler instead of the timer callback.
+    static void StartTimerTasks(const ExpiryList &expired,
+                                const boost::system::error_code &ec,
+                                size_t *tasks, size_t *max_batch);
+    bool Expire(uint32_t seq_no, TimerTask *task);
 
     void SetState(TimerState s) { state_ = s; }
     static int GetTimerInstanceId() { return -1; }
@@ -155,6 +172,13 @@ private:
     uint32_t seq_no_;
     bool delete_on_completion_;
     tbb::atomic<int> refcount_;
+
+    // Owned by the wheel and protected by the wheel mutex
+    TimerWheel *wheel_;
+    WheelHook wheel_node_;
+    uint64_t wheel_expiry_;
+    uint32_t wheel_seq_no_;
+    int wheel_level_;
 };
 
 inline void intrusive_ptr_add_ref(Timer *timer) {
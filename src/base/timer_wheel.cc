@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "base/timer_wheel.h"
+
+#include <algorithm>
+#include <boost/asio/placeholders.hpp>
+#include <boost/bind.hpp>
+
+#include "base/sandesh/task_types.h"
+
+using boost::chrono::steady_clock;
+
+boost::asio::io_service::id TimerWheel::id;
+tbb::mutex TimerWheel::wheels_mutex_;
+std::set<TimerWheel *> TimerWheel::wheels_;
+
+TimerWheel::TimerWheel(boost::asio::io_service &io_service)
+    : boost::asio::io_service::service(io_service),
+      io_service_(io_service), tick_timer_(io_service), start_(steady_clock::now()),
+      level_count_(kLevels, 0), current_(0), count_(0),
+      tick_running_(false), ticks_(0), expired_(0), cascaded_(0), tasks_(0),
+      max_batch_(0), direct_(0) {
+    tbb::mutex::scoped_lock lock(wheels_mutex_);
+    wheels_.insert(this);
+}
+
+TimerWheel::~TimerWheel() {
+    tbb::mutex::scoped_lock lock(wheels_mutex_);
+    wheels_.erase(this);
+}
+
+//
+// The io_service is going away. Drop the references to the timers still on
+// the wheel, as asio drops the handlers of the waits still pending.
+//
+void TimerWheel::shutdown_service() {
+    {
+        tbb::mutex::scoped_lock lock(wheels_mutex_);
+        wheels_.erase(this);
+    }
+
+    tbb::mutex::scoped_lock lock(mutex_);
+    boost::system::error_code ec;
+    tick_timer_.cancel(ec);
+    tick_running_ = false;
+    for (size_t index = 0; index < kSlots; ++index) {
+        Slot &slot = slots_[index];
+        while (!slot.empty()) {
+            Timer *timer = &slot.front();
+            Unlink(timer);
+            intrusive_ptr_release(timer);
+        }
+    }
+}
+
+size_t TimerWheel::SlotCount(int level) {
+    return 1 << (level == 0 ? kLevel0Bits : kLevelBits);
+}
+
+// Number of ticks spanned by a slot of the level, as a shift
+int TimerWheel::SlotShift(int level) {
+    return level == 0 ? 0 : kLevel0Bits + (level - 1) * kLevelBits;
+}
+
+size_t TimerWheel::SlotBase(int level) {
+    return level == 0 ? 0 :
+        SlotCount(0) + (level - 1) * SlotCount(level);
+}
+
+uint64_t TimerWheel::ElapsedMsec() const {
+    return boost::chrono::duration_cast<boost::chrono::milliseconds>(
+        steady_clock::now() - start_).count();
+}
+
+//
+// Add a timer to the wheel, or move it if it is still on the wheel. The
+// expiry is rounded up to the next tick, so that a timer never fires early.
+// Timers shorter than a tick are fired directly instead.
+//
+void TimerWheel::Add(Timer *timer, int time) {
+    tbb::mutex::scoped_lock lock(mutex_);
+
+    // The reference of the wheel is kept when the timer is moved
+    bool linked = timer->wheel_node_.is_linked();
+    if (linked) {
+        Unlink(timer);
+    }
+    if (time < kTickMsec) {
+        StartDirect(Timer::TimerPtr(timer, !linked), time);
+        return;
+    }
+    if (!linked) {
+        intrusive_ptr_add_ref(timer);
+    }
+
+    uint64_t elapsed = ElapsedMsec();
+    if (count_ == 0) {
+        // Nothing to cascade, catch up with the ticks skipped while idle
+        current_ = elapsed / kTickMsec;
+    }
+    uint64_t expiry = (elapsed + time + kTickMsec - 1) / kTickMsec;
+    timer->wheel_expiry_ = std::max(expiry, current_ + 1);
+    timer->wheel_seq_no_ = timer->seq_no_;
+    count_++;
+    Insert(timer);
+
+    if (!tick_running_) {
+        StartTick();
+    }
+}
+
+bool TimerWheel::Remove(Timer *timer) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (!timer->wheel_node_.is_linked()) {
+        return false;
+    }
+    Unlink(timer);
+    return true;
+}
+
+//
+// Insert the timer in the slot of the lowest level that covers its expiry.
+// Expiries beyond the range of the wheel are kept in the last slot of the
+// highest level, and are inserted again when that slot is cascaded.
+//
+void TimerWheel::Insert(Timer *timer) {
+    uint64_t max_delta = (static_cast<uint64_t>(1) << SlotShift(kLevels)) - 1;
+    uint64_t expiry = timer->wheel_expiry_;
+    if (expiry > current_ + max_delta) {
+        expiry = current_ + max_delta;
+    }
+    uint64_t delta = expiry > current_ ? expiry - current_ : 0;
+
+    int level = 0;
+    while (delta >= (static_cast<uint64_t>(1) << SlotShift(level + 1))) {
+        level++;
+    }
+    size_t index = (expiry >> SlotShift(level)) & (SlotCount(level) - 1);
+    slots_[SlotBase(level) + index].push_back(*timer);
+    timer->wheel_level_ = level;
+    level_count_[level]++;
+}
+
+// Remove the timer from its slot. The caller takes over the reference.
+void TimerWheel::Unlink(Timer *timer) {
+    timer->wheel_node_.unlink();
+    level_count_[timer->wheel_level_]--;
+    count_--;
+}
+
+// Move the timers of a slot down to the lower levels
+void TimerWheel::Cascade(int level, size_t index) {
+    Slot &slot = slots_[SlotBase(level) + index];
+    while (!slot.empty()) {
+        Timer *timer = &slot.front();
+        slot.pop_front();
+        level_count_[level]--;
+        cascaded_++;
+        Insert(timer);
+    }
+}
+
+//
+// Process the ticks up to now. When level 0 wraps around, the next slot of
+// level 1 is cascaded, and so on up the levels.
+//
+void TimerWheel::Advance(uint64_t now, ExpiryList *expired) {
+    while (current_ < now) {
+        current_++;
+        size_t index = current_ & (SlotCount(0) - 1);
+        for (int level = 1; index == 0 && level < kLevels; ++level) {
+            index = (current_ >> SlotShift(level)) & (SlotCount(level) - 1);
+            Cascade(level, index);
+        }
+
+        Slot &slot = slots_[current_ & (SlotCount(0) - 1)];
+        while (!slot.empty()) {
+            Timer *timer = &slot.front();
+            Unlink(timer);
+            expired_++;
+
+            // The reference of the wheel moves to the expiry list
+            expired->push_back(std::make_pair(Timer::TimerPtr(timer, false),
+                                              timer->wheel_seq_no_));
+        }
+    }
+}
+
+// Schedule the tick at the next tick boundary
+void TimerWheel::StartTick() {
+    int delay = kTickMsec - ElapsedMsec() % kTickMsec;
+    boost::system::error_code ec;
+    tick_timer_.expires_from_now(boost::posix_time::milliseconds(delay), ec);
+    tick_timer_.async_wait(boost::bind(&TimerWheel::OnTick, this,
+                                       boost::asio::placeholders::error));
+    tick_running_ = true;
+}
+
+//
+// ASIO callback on tick expiry. Collect the expired timers with the wheel
+// locked, and start the tasks to serve them after the wheel is unlocked.
+// The tick stops when the wheel is empty.
+//
+void TimerWheel::OnTick(const boost::system::error_code &ec) {
+    if (ec && ec.value() == boost::asio::error::operation_aborted) {
+        return;
+    }
+
+    ExpiryList expired;
+    {
+        tbb::mutex::scoped_lock lock(mutex_);
+        Advance(ElapsedMsec() / kTickMsec, &expired);
+        ticks_++;
+        if (count_ == 0) {
+            tick_running_ = false;
+        } else {
+            StartTick();
+        }
+    }
+
+    if (expired.empty()) {
+        return;
+    }
+    StartTasks(expired, ec);
+}
+
+//
+// Fire a timer shorter than a tick on its own. The asio handler holds the
+// reference to the timer, and the expiry is ignored if the timer has been
+// cancelled or restarted in the meantime.
+//
+void TimerWheel::StartDirect(Timer::TimerPtr timer, int time) {
+    if (time == 0) {
+        io_service_.post(boost::bind(&TimerWheel::OnDirectExpiry, this, timer,
+                                    timer->seq_no_, DeadlineTimerPtr(),
+                                    boost::system::error_code()));
+        return;
+    }
+
+    DeadlineTimerPtr deadline(
+        new boost::asio::monotonic_deadline_timer(io_service_));
+    boost::system::error_code ec;
+    deadline->expires_from_now(boost::posix_time::milliseconds(time), ec);
+    if (ec) {
+        // Report the failure through the timer's error handler
+        io_service_.post(boost::bind(&TimerWheel::OnDirectExpiry, this, timer,
+                                    timer->seq_no_, DeadlineTimerPtr(), ec));
+        return;
+    }
+    deadline->async_wait(boost::bind(&TimerWheel::OnDirectExpiry, this,
+                                     timer, timer->seq_no_, deadline,
+                                     boost::asio::placeholders::error));
+}
+
+// The handler owns the asio timer, which goes away with it
+void TimerWheel::OnDirectExpiry(Timer::TimerPtr timer, uint32_t seq_no,
+                                DeadlineTimerPtr deadline,
+                                const boost::system::error_code &ec) {
+    if (ec && ec.value() == boost::asio::error::operation_aborted) {
+        return;
+    }
+
+    ExpiryList expired;
+    expired.push_back(std::make_pair(timer, seq_no));
+    {
+        tbb::mutex::scoped_lock lock(mutex_);
+        direct_++;
+    }
+    StartTasks(expired, ec);
+}
+
+// Start the tasks to serve the expired timers, with the wheel unlocked
+void TimerWheel::StartTasks(const ExpiryList &expired,
+                            const boost::system::error_code &ec) {
+    size_t tasks, max_batch;
+    Timer::StartTimerTasks(expired, ec, &tasks, &max_batch);
+
+    tbb::mutex::scoped_lock lock(mutex_);
+    tasks_ += tasks;
+    max_batch_ = std::max(max_batch_, max_batch);
+}
+
+size_t TimerWheel::timer_count() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return count_;
+}
+
+uint64_t TimerWheel::tick_count() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return ticks_;
+}
+
+void TimerWheel::GetInfo(SandeshTimerWheelInfo *info) const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    info->set_tick_msec(kTickMsec);
+    info->set_timers(count_);
+    std::vector<uint32_t> level_timers(level_count_.begin(),
+                                       level_count_.end());
+    info->set_level_timers(level_timers);
+    info->set_ticks(ticks_);
+    info->set_expired(expired_);
+    info->set_cascaded(cascaded_);
+    info->set_tasks(tasks_);
+    info->set_max_batch(max_batch_);
+    info->set_direct(direct_);
+}
+
+void TimerWheel::GetWheelInfo(std::vector<SandeshTimerWheelInfo> *list) {
+    tbb::mutex::scoped_lock lock(wheels_mutex_);
+    for (std::set<TimerWheel *>::const_iterator it = wheels_.begin();
+         it != wheels_.end(); ++it) {
+        SandeshTimerWheelInfo info;
+        (*it)->GetInfo(&info);
+        list->push_back(info);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+//
+//  Hashed hierarchical timer wheel, the backend of Timer.
+//
+//  There is one wheel per io_service, registered as an asio service so it
+//  goes away with the io_service. The wheel is driven by a single asio timer
+//  that ticks every kTickMsec while the wheel has running timers.
+//
+//  The wheel has kLevels levels. Level 0 has one slot per tick, and every
+//  slot of a higher level spans all the slots of the level below it. When
+//  level 0 wraps around, the next slot of level 1 is cascaded down, and so
+//  on. Start and Cancel of a timer are O(1), and a tick only looks at the
+//  timers that expire in it or have to be cascaded.
+//
+//  The timers that expire in a tick are handed to one task per task id and
+//  instance, instead of one task per timer. Timers with no task instance are
+//  still handed to a task each, as they may run in parallel.
+//
+//  Timers shorter than a tick are not put on the wheel, which would round
+//  them up to the next tick. They are fired on their own: a zero timer is
+//  posted to the io_service, the others get an asio timer each.
+//
+//  Concurrency aspects:
+//  - The wheel is protected by its own mutex, which also protects the wheel
+//    fields of the timers on it. Timer takes the wheel mutex with the timer
+//    mutex held, the wheel never takes a timer mutex with its mutex held.
+//  - The wheel holds a reference to every timer on it. The timers still on
+//    the wheel when the io_service goes away are taken off it.
+//
+
+#ifndef BASE_TIMER_WHEEL_H_
+#define BASE_TIMER_WHEEL_H_
+
+#include <set>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/monotonic_deadline_timer.hpp>
+#include <boost/chrono.hpp>
+#include <boost/intrusive/list.hpp>
+#include <boost/shared_ptr.hpp>
+#include <tbb/mutex.h>
+
+#include "base/timer.h"
+#include "base/util.h"
+
+class SandeshTimerWheelInfo;
+
+class TimerWheel : public boost::asio::io_service::service {
+public:
+    static boost::asio::io_service::id id;
+
+    static const int kTickMsec = 10;
+    static const int kLevels = 4;
+    static const int kLevel0Bits = 8;
+    static const int kLevelBits = 6;
+
+    explicit TimerWheel(boost::asio::io_service &io_service);
+    virtual ~TimerWheel();
+
+    // Called with the timer mutex held
+    void Add(Timer *timer, int time);
+    // Returns true if the timer was on the wheel. The reference of the wheel
+    // is handed over to the caller.
+    bool Remove(Timer *timer);
+
+    size_t timer_count() const;
+    uint64_t tick_count() const;
+
+    void GetInfo(SandeshTimerWheelInfo *info) const;
+    static void GetWheelInfo(std::vector<SandeshTimerWheelInfo> *list);
+
+private:
+    friend class TimerWheelTest;
+    friend class TimerWheelBatchTest;
+
+    typedef boost::intrusive::member_hook<Timer, Timer::WheelHook,
+        &Timer::wheel_node_> TimerMember;
+    typedef boost::intrusive::list<Timer, TimerMember,
+        boost::intrusive::constant_time_size<false> > Slot;
+    typedef Timer::ExpiryList ExpiryList;
+    typedef boost::shared_ptr<boost::asio::monotonic_deadline_timer>
+        DeadlineTimerPtr;
+
+    static const size_t kSlots =
+        (1 << kLevel0Bits) + (kLevels - 1) * (1 << kLevelBits);
+
+    virtual void shutdown_service();
+
+    uint64_t ElapsedMsec() const;
+    void Insert(Timer *timer);
+    void Unlink(Timer *timer);
+    void Cascade(int level, size_t index);
+    void Advance(uint64_t now, ExpiryList *expired);
+    void StartTick();
+    void OnTick(const boost::system::error_code &ec);
+    void StartDirect(Timer::TimerPtr timer, int time);
+    void OnDirectExpiry(Timer::TimerPtr timer, uint32_t seq_no,
+                        DeadlineTimerPtr deadline,
+                        const boost::system::error_code &ec);
+    void StartTasks(const ExpiryList &expired,
+                    const boost::system::error_code &ec);
+
+    static size_t SlotCount(int level);
+    static int SlotShift(int level);
+    static size_t SlotBase(int level);
+
+    mutable tbb::mutex mutex_;
+    boost::asio::io_service &io_service_;
+    boost::asio::monotonic_deadline_timer tick_timer_;
+    boost::chrono::steady_clock::time_point start_;
+    Slot slots_[kSlots];
+    std::vector<size_t> level_count_;
+    uint64_t current_;
+    size_t count_;
+    bool tick_running_;
+
+    // Load statistics
+    uint64_t ticks_;
+    uint64_t expired_;
+    uint64_t cascaded_;
+    uint64_t tasks_;
+    size_t max_batch_;
+    uint64_t direct_;
+
+    static tbb::mutex wheels_mutex_;
+    static std::set<TimerWheel *> wheels_;
+
+    DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+#endif  // BASE_TIMER_WHEEL_H_
@@ -5,33 +5,49 @@
 #ifndef __TRACE_H__
 #define __TRACE_H__
 
+#include <tbb/atomic.h>
 #include <tbb/mutex.h>
+#include <tbb/spin_mutex.h>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <stdexcept>
 #include <boost/function.hpp>
-#include <boost/ptr_container/ptr_circular_buffer.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include "base/util.h"
 
+//
+// The trace buffer is a ring of trace_buf_size slots. A write takes the next
+// sequence number and stores the trace in the slot of that sequence number,
+// under a lock of the slot only, so concurrent writers don't contend unless
+// the ring wraps around while a write is in progress. The trace is formatted
+// when it is read.
+//
+// A reader copies the traces out of the slots, orders them by sequence
+// number and calls back without holding any lock of the ring. The traces
+// are reference counted, so a trace overwritten during the read is deleted
+// once the reader is done with it. A reader remembers the sequence number
+// of the next trace to read in its read context, so writes don't need to
+// look at the read contexts.
+//
 template<typename TraceEntryT>
 class TraceBuffer {
 public:
     TraceBuffer(const std::string& buf_name, size_t size, bool trace_enable) 
         : trace_buf_name_(buf_name), 
           trace_buf_size_(size),
-          trace_buf_(trace_buf_size_),
-          write_index_(0),
-          read_index_(0),
-          wrap_(false),
-          seqno_(0) {
+          slot_count_(std::max(size, static_cast<size_t>(1))),
+          slots_(new TraceSlot[slot_count_]) {
         trace_enable_ = trace_enable;
+        seqno_ = 0;
+        sample_rate_ = 1;
+        sample_count_ = 0;
     }
 
     ~TraceBuffer() {
         read_context_map_.clear();
-        trace_buf_.clear();
     }
 
     std::string Name() {
@@ -54,92 +70,56 @@ public:
         return trace_buf_size_; 
     }
 
-    uint32_t TraceWrite(TraceEntryT *trace_entry) {
-        tbb::mutex::scoped_lock lock(mutex_);
-       
-        // Add the trace
-        trace_buf_.push_back(trace_entry);
-
-        // Once the trace buffer is wrapped, increment the read index
-        if (wrap_) {
-            if (++read_index_ == trace_buf_size_) {
-                read_index_ = 0;
-            }
-        }
+    // Keep one in every rate traces that check TraceSample(), e.g. the
+    // traces of message payloads. A rate of 0 or 1 keeps all of them.
+    void TraceSampleRateSet(uint32_t rate) {
+        sample_rate_ = rate;
+    }
 
-        // Increment the write_index_ and reset upon reaching trace_buf_size_
-        if (++write_index_ == trace_buf_size_) {
-            write_index_ = 0;
-            wrap_ = true;
-        }
-        
-        // Trace messages could be read in batches instead of reading 
-        // the entire trace buffer in one shot. Therefore, trace messages
-        // could be added between subsequent read requests. If the 
-        // read_index_ [points to the oldest message in the trace buffer] 
-        // becomes same as the read index [points to the position in the 
-        // trace buffer from where the next trace message should be read] 
-        // stored in the read context, then there is no need to remember the
-        // read context. 
-        ReadContextMap::iterator it = read_context_map_.begin();
-        ReadContextMap::iterator next = it; 
-        for (int i = 0, cnt = read_context_map_.size(); i < cnt; 
-             i++, it = next) {
-            ++next;
-            if (*it->second.get() == read_index_) {
-                read_context_map_.erase(it); 
-            }
+    uint32_t TraceSampleRateGet() {
+        return sample_rate_;
+    }
+
+    bool TraceSample() {
+        uint32_t rate = sample_rate_;
+        if (rate <= 1) {
+            return true;
         }
+        return (sample_count_.fetch_and_increment() % rate) == 0;
+    }
 
-        // Reset seqno_ if it reaches max value
-        if (++seqno_  > kMaxSeqno) {
-            seqno_ = kMinSeqno;
+    uint32_t TraceWrite(TraceEntryT *trace_entry) {
+        uint64_t seqno = seqno_.fetch_and_increment() + 1;
+        TraceSlot &slot = slots_[(seqno - 1) % slot_count_];
+        TraceEntryPtr entry(trace_entry);
+        {
+            tbb::spin_mutex::scoped_lock lock(slot.mutex);
+            // A writer that wrapped around the ring may have stored a newer
+            // trace in the slot already
+            if (slot.seqno < seqno) {
+                slot.seqno = seqno;
+                slot.entry.swap(entry);
+            }
         }
+        // The overwritten trace is released outside the lock
 
-        return seqno_; 
+        // Sequence numbers run from kMinSeqno to kMaxSeqno
+        return static_cast<uint32_t>((seqno - 1) % kMaxSeqno) + kMinSeqno;
     }
 
     void TraceRead(const std::string& context, const int count, 
             boost::function<void (TraceEntryT *, bool)> cb) {
-        tbb::mutex::scoped_lock lock(mutex_);
-        if (trace_buf_.empty()) {
-            // No message in the trace buffer
-            return;
-        }
-
-        // if count = 0, then set the cnt equal to the size of trace_buf_
-        int cnt = count ? count : trace_buf_.size();
-
-        int *read_index_ptr;
-        typename ContainerType::iterator it;
-        ReadContextMap::iterator context_it = 
-            read_context_map_.find(context);
-        if (context_it != read_context_map_.end()) {
-            // If the read context is present, manipulate the position
-            // from where we wanna start
-            read_index_ptr = context_it->second.get();
-            int offset = *read_index_ptr - read_index_;
-            offset = offset > 0 ? offset : trace_buf_size_ + offset; 
-            it = trace_buf_.begin() + offset;
-        } else {
-            // Create read context
-            boost::shared_ptr<int> read_context(new int(read_index_));
-            read_index_ptr = read_context.get();
-            read_context_map_.insert(std::make_pair(context, read_context));
-            it = trace_buf_.begin();
+        std::vector<TraceRecord> records;
+        bool more;
+        {
+            tbb::mutex::scoped_lock lock(mutex_);
+            more = ReadRecords(context, count, &records);
         }
 
-        int i;
-        typename ContainerType::iterator next = it;
-        for (i = 0; (it != trace_buf_.end()) && (i < cnt); i++, it = next) {
-            ++next;
-            cb(&(*it), next != trace_buf_.end());
+        for (typename std::vector<TraceRecord>::const_iterator it =
+             records.begin(); it != records.end(); ++it) {
+            cb(it->entry.get(), more || (it + 1) != records.end());
         }
-
-        // Update the read index in the read context
-        int offset = *read_index_ptr + i;
-        *read_index_ptr = offset >= trace_buf_size_ ? 
-            offset - trace_buf_size_ : offset;
     }
 
     void TraceReadDone(const std::string& context) {
@@ -152,25 +132,86 @@ public:
     }
 
 private:
-    typedef boost::ptr_circular_buffer<TraceEntryT> ContainerType;
-    typedef std::map<const std::string, boost::shared_ptr<int> > 
-        ReadContextMap;
+    typedef boost::shared_ptr<TraceEntryT> TraceEntryPtr;
+
+    struct TraceRecord {
+        TraceRecord() : seqno(0) {
+        }
+        bool operator<(const TraceRecord &rhs) const {
+            return seqno < rhs.seqno;
+        }
+        uint64_t seqno;
+        TraceEntryPtr entry;
+    };
+
+    struct TraceSlot {
+        TraceSlot() : seqno(0) {
+        }
+        tbb::spin_mutex mutex;
+        uint64_t seqno;
+        TraceEntryPtr entry;
+    };
+
+    // Called with the reader lock held. Copies the traces to be read, in
+    // the order of their sequence numbers, and advances the read context.
+    // Returns true if there are traces after the ones copied.
+    bool ReadRecords(const std::string& context, const int count,
+                     std::vector<TraceRecord> *records) {
+        std::vector<TraceRecord> all;
+        all.reserve(slot_count_);
+        for (size_t i = 0; i < slot_count_; i++) {
+            TraceSlot &slot = slots_[i];
+            tbb::spin_mutex::scoped_lock lock(slot.mutex);
+            if (slot.entry) {
+                TraceRecord record;
+                record.seqno = slot.seqno;
+                record.entry = slot.entry;
+                all.push_back(record);
+            }
+        }
+        // Nothing to read if there is no message in the trace buffer
+        if (all.empty()) {
+            return false;
+        }
+        std::sort(all.begin(), all.end());
+
+        // Start from the oldest trace, or where the last read stopped
+        typename std::vector<TraceRecord>::const_iterator it = all.begin();
+        uint64_t *next_seqno;
+        ReadContextMap::iterator context_it = read_context_map_.find(context);
+        if (context_it != read_context_map_.end()) {
+            next_seqno = &context_it->second;
+            while (it != all.end() && it->seqno < *next_seqno) {
+                ++it;
+            }
+        } else {
+            next_seqno = &read_context_map_[context];
+        }
+
+        // if count = 0, then read all the traces
+        size_t cnt = count ? count : all.size();
+        for (size_t i = 0; (it != all.end()) && (i < cnt); i++, ++it) {
+            *next_seqno = it->seqno + 1;
+            records->push_back(*it);
+        }
+        return it != all.end();
+    }
+
+    typedef std::map<const std::string, uint64_t> ReadContextMap;
 
     std::string trace_buf_name_;
-    int trace_buf_size_;
-    ContainerType trace_buf_;
+    size_t trace_buf_size_;
+    size_t slot_count_;
+    boost::scoped_array<TraceSlot> slots_;
     tbb::atomic<bool> trace_enable_;
-    int write_index_; // points to the position in the trace buffer, 
-                      // where the next trace message would be added
-    int read_index_; // points to the position of the oldest 
-                     // trace message in the trace buffer
-    bool wrap_; // indicates if the trace buffer is wrapped
+    tbb::atomic<uint64_t> seqno_;
+    tbb::atomic<uint32_t> sample_rate_;
+    tbb::atomic<uint32_t> sample_count_;
     ReadContextMap read_context_map_; // stores the read context  
-    uint32_t seqno_;
-    tbb::mutex mutex_;
+    tbb::mutex mutex_; // serializes the readers
     
     // Reserve 0 and max(uint32_t)
-    static const uint32_t kMaxSeqno = ((2 ^ 32) - 1) - 1;
+    static const uint32_t kMaxSeqno = 0xFFFFFFFF - 1;
     static const uint32_t kMinSeqno = 1;
 
     DISALLOW_COPY_AND_ASSIGN(TraceBuffer);
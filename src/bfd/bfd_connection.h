@@ -4,6 +4,8 @@
 #ifndef BFD_CONNECTION_H_
 #define BFD_CONNECTION_H_
 
+#include <utility>
+#include <vector>
 #include <boost/asio/ip/address.hpp>
 
 namespace BFD {
@@ -11,7 +13,14 @@ class ControlPacket;
 
 class Connection {
  public:
+    typedef std::vector<std::pair<boost::asio::ip::address, const ControlPacket *> > PacketBatch;
+
     virtual void SendPacket(const boost::asio::ip::address &dstAddr, const ControlPacket *packet) = 0;
+    // Packets that are due at the same time are handed over together
+    virtual void SendPackets(const PacketBatch &batch) {
+        for (PacketBatch::const_iterator it = batch.begin(); it != batch.end(); ++it)
+            SendPacket(it->first, it->second);
+    }
     virtual ~Connection() {}
 };
 
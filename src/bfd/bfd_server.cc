@@ -8,13 +8,27 @@
 #include "bfd/bfd_state_machine.h"
 #include "bfd/bfd_common.h"
 
+#include <cassert>
 #include "base/logging.h"
+#include "base/timer.h"
+#include "base/util.h"
 #include "io/event_manager.h"
 
 boost::random::taus88 BFD::randomGen;
 
 namespace BFD {
 
+BFDServer::BFDServer(EventManager *_evm, Connection *communicator) :
+        evm_(_evm), communicator_(communicator),
+        timer_(TimerManager::CreateTimer(*_evm->io_service(), "BFD engine")),
+        txWheel_(kWheelSlots, Now()), rxWheel_(kWheelSlots, Now()) {
+    timer_->Start(kTickMsec, boost::bind(&BFDServer::TimerExpired, this));
+}
+
+BFDServer::~BFDServer() {
+    TimerManager::DeleteTimer(timer_);
+}
+
 BFDSession* BFDServer::GetSession(const ControlPacket *packet) {
     if (packet->receiver_discriminator)
         return sessionManager_.SessionByDiscriminator(packet->receiver_discriminator);
@@ -58,74 +72,186 @@ void BFDServer::createSession(const boost::asio::ip::address &remoteHost, const
         Discriminator *assignedDiscriminator) {
     tbb::mutex::scoped_lock lock(mutex_);
 
-    sessionManager_.CreateOrUpdateSession(remoteHost, config, communicator_,  assignedDiscriminator);
+    sessionManager_.CreateOrUpdateSession(remoteHost, config, communicator_, this, assignedDiscriminator);
+}
+
+ResultCode BFDServer::deleteSession(Discriminator discriminator) {
+    tbb::mutex::scoped_lock lock(mutex_);
+
+    // Entries of the session left on the wheels are dropped when due
+    return sessionManager_.RemoveSession(discriminator);
+}
+
+uint64_t BFDServer::Now() {
+    return ClockMonotonicUsec() / (kTickMsec * 1000);
+}
+
+// Rounded up, so that a deadline never expires early
+uint64_t BFDServer::Ticks(TimeInterval interval) {
+    return (interval.total_milliseconds() + kTickMsec - 1) / kTickMsec;
+}
+
+// Called by the session with the server locked
+void BFDServer::ScheduleTx(Discriminator discriminator, TimeInterval interval) {
+    SessionEntry *entry = sessionManager_.EntryByDiscriminator(discriminator);
+    if (entry == NULL)
+        return;
+    entry->txTick = Now() + Ticks(interval);
+    txWheel_.Schedule(discriminator, entry->txTick);
+}
+
+// Called by the session with the server locked. The deadline moves with
+// every packet received, so the entry on the wheel is only moved when it is
+// due and the deadline has not passed.
+void BFDServer::ScheduleRx(Discriminator discriminator, TimeInterval interval) {
+    SessionEntry *entry = sessionManager_.EntryByDiscriminator(discriminator);
+    if (entry == NULL)
+        return;
+    entry->rxDeadline = Now() + Ticks(interval);
+    if (!entry->rxScheduled) {
+        entry->rxScheduled = true;
+        rxWheel_.Schedule(discriminator, entry->rxDeadline);
+    }
+}
+
+void BFDServer::TransmitDue(uint64_t now) {
+    due_.clear();
+    txWheel_.Advance(now, &due_);
+
+    txPackets_.resize(due_.size());
+    txBatch_.clear();
+    for (size_t i = 0; i < due_.size(); ++i) {
+        SessionEntry *entry = sessionManager_.EntryByDiscriminator(due_[i].discriminator);
+        // Deleted or rescheduled since
+        if (entry == NULL || entry->txTick != due_[i].tick)
+            continue;
+        ControlPacket *packet = &txPackets_[txBatch_.size()];
+        TimeInterval interval = entry->session->Transmit(packet);
+        txBatch_.push_back(std::make_pair(entry->session->RemoteHost(),
+                                          static_cast<const ControlPacket *>(packet)));
+        entry->txTick = now + Ticks(interval);
+        txWheel_.Schedule(due_[i].discriminator, entry->txTick);
+    }
+
+    if (!txBatch_.empty())
+        communicator_->SendPackets(txBatch_);
+}
+
+void BFDServer::DetectDue(uint64_t now) {
+    due_.clear();
+    rxWheel_.Advance(now, &due_);
+
+    for (size_t i = 0; i < due_.size(); ++i) {
+        SessionEntry *entry = sessionManager_.EntryByDiscriminator(due_[i].discriminator);
+        if (entry == NULL || !entry->rxScheduled)
+            continue;
+        if (entry->rxDeadline > now) {
+            rxWheel_.Schedule(due_[i].discriminator, entry->rxDeadline);
+            continue;
+        }
+        entry->rxScheduled = false;
+        entry->session->DetectionTimeout();
+    }
+}
+
+bool BFDServer::TimerExpired() {
+    tbb::mutex::scoped_lock lock(mutex_);
+
+    uint64_t now = Now();
+    DetectDue(now);
+    TransmitDue(now);
+
+    return true;
+}
+
+BFDServer::SessionEntry *BFDServer::SessionManager::EntryByDiscriminator(Discriminator discriminator) {
+    size_t index = discriminator & kIndexMask;
+    if (discriminator == 0 || index >= sessions_.size() ||
+            sessions_[index].discriminator != discriminator)
+        return NULL;
+    return &sessions_[index];
 }
 
 BFDSession* BFDServer::SessionManager::SessionByDiscriminator(Discriminator discriminator) {
-    DiscriminatorSessionMap::const_iterator it = by_discriminator_.find(discriminator);
-    if (it == by_discriminator_.end())
+    SessionEntry *entry = EntryByDiscriminator(discriminator);
+    if (entry == NULL)
         return NULL;
     else
-        return it->second;
+        return entry->session;
 }
+
 BFDSession* BFDServer::SessionManager::SessionByAddress(const boost::asio::ip::address &address) {
     AddressSessionMap::const_iterator it = by_address_.find(address);
     if (it == by_address_.end())
         return NULL;
     else
-        return it->second;
+        return SessionByDiscriminator(it->second);
 }
 
 ResultCode BFDServer::SessionManager::RemoveSession(Discriminator discriminator) {
-    DiscriminatorSessionMap::const_iterator it = by_discriminator_.find(discriminator);
-    if (it == by_discriminator_.end())
+    SessionEntry *entry = EntryByDiscriminator(discriminator);
+    if (entry == NULL)
         return kResultCode_UnknownSession;
-    BFDSession *session = it->second;
-    by_discriminator_.erase(discriminator);
+    BFDSession *session = entry->session;
     by_address_.erase(session->RemoteHost());
     delete session;
 
+    // The next session at the index gets the next generation
+    *entry = SessionEntry();
+    free_.push_back(discriminator);
+
     return kResultCode_Ok;
 }
 
 ResultCode BFDServer::SessionManager::CreateOrUpdateSession(const boost::asio::ip::address &remoteHost,
         const BFDSessionConfig *config,
         Connection *communicator,
+        SessionScheduler *scheduler,
         Discriminator *assignedDiscriminator) {
     if (SessionByAddress(remoteHost))
         // TODO update
         return kResultCode_Ok;
 
     *assignedDiscriminator = GenerateUniqDiscriminator();
-    BFDSession *session = new BFDSession(*assignedDiscriminator, remoteHost, evm_, config, communicator);
-    by_discriminator_[*assignedDiscriminator] = session;
-    by_address_[remoteHost] = session;
+    by_address_[remoteHost] = *assignedDiscriminator;
+    // The session schedules its first transmission right away
+    SessionEntry *entry = EntryByDiscriminator(*assignedDiscriminator);
+    entry->session = new BFDSession(*assignedDiscriminator, remoteHost, scheduler, config, communicator);
 
     return kResultCode_Ok;
 }
 
-class DiscriminatorGenerator {
-    tbb::atomic<Discriminator> next_;
+// Takes an index off the free list, or appends one. A generation is never
+// 0, so neither is a discriminator.
+Discriminator BFDServer::SessionManager::GenerateUniqDiscriminator() {
+    static const Discriminator kGenerationMask = ~kIndexMask;
 
- public:
-    DiscriminatorGenerator() {
-        next_ = random()%0x1000000 + 1;
-    }
-    Discriminator Next() {
-        return next_.fetch_and_increment();
+    size_t index;
+    Discriminator generation;
+    if (free_.empty()) {
+        index = sessions_.size();
+        assert(index <= kIndexMask);
+        sessions_.push_back(SessionEntry());
+        generation = static_cast<Discriminator>(randomGen()) & kGenerationMask;
+    } else {
+        index = free_.back() & kIndexMask;
+        generation = (free_.back() + (1 << kIndexBits)) & kGenerationMask;
+        free_.pop_back();
     }
-};
+    if (generation == 0)
+        generation = 1 << kIndexBits;
 
-static DiscriminatorGenerator generator;
-
-Discriminator BFDServer::SessionManager::GenerateUniqDiscriminator() {
-    return generator.Next();
+    SessionEntry &entry = sessions_[index];
+    entry = SessionEntry();
+    entry.discriminator = generation | index;
+    return entry.discriminator;
 }
 
 BFDServer::SessionManager::~SessionManager() {
-    for (DiscriminatorSessionMap::iterator it = by_discriminator_.begin(); it != by_discriminator_.end(); ++it)
-        delete it->second;
-    by_discriminator_.clear();
+    for (std::vector<SessionEntry>::iterator it = sessions_.begin(); it != sessions_.end(); ++it)
+        delete it->session;
+    sessions_.clear();
+    free_.clear();
     by_address_.clear();
 }
 }  // namespace BFD
@@ -5,21 +5,26 @@
 #define BFD_SERVER_H_
 
 #include "bfd/bfd_common.h"
+#include "bfd/bfd_connection.h"
+#include "bfd/bfd_control_packet.h"
+#include "bfd/bfd_session.h"
+#include "bfd/bfd_timing_wheel.h"
 
 #include <tbb/mutex.h>
 #include <map>
+#include <vector>
 #include <boost/asio/ip/address.hpp>
 
 class EventManager;
+class Timer;
 
 namespace BFD {
 
-class Connection;
-class BFDSession;
-class ControlPacket;
-class BFDSessionConfig;
-
-class BFDServer {
+// Runs all the sessions of the server from a single timer. Sessions are
+// kept in an array indexed by their local discriminator, and their periodic
+// transmissions and detection deadlines are kept on timing wheels that are
+// advanced every kTickMsec. The packets due in a tick are sent as a batch.
+class BFDServer : public SessionScheduler {
     tbb::mutex mutex_;
 
     EventManager *evm_;
@@ -27,37 +32,80 @@ class BFDServer {
     BFDSession *GetSession(const ControlPacket *packet);
 
  public:
-    BFDServer(EventManager *_evm, Connection *communicator) :
-        evm_(_evm), communicator_(communicator), sessionManager_(_evm) {}
+    static const int kTickMsec = 10;
+    static const size_t kWheelSlots = 512;
+
+    BFDServer(EventManager *_evm, Connection *communicator);
+    virtual ~BFDServer();
 
     ResultCode processControlPacket(const ControlPacket *packet);
     void createSession(const boost::asio::ip::address &remoteHost,
             const BFDSessionConfig *config, Discriminator *assignedDiscriminator);
+    ResultCode deleteSession(Discriminator discriminator);
     BFDSession *sessionByAddress(const boost::asio::ip::address &address);
 
+    virtual void ScheduleTx(Discriminator discriminator, TimeInterval interval);
+    virtual void ScheduleRx(Discriminator discriminator, TimeInterval interval);
+
  private:
+    friend class EngineTest;
+
+    // The session with discriminator kIndexMask & discriminator is at that
+    // index in the array. The other bits hold a generation, bumped when the
+    // index is reused, so that a stale discriminator doesn't match.
+    static const int kIndexBits = 20;
+    static const Discriminator kIndexMask = (1 << kIndexBits) - 1;
+
+    struct SessionEntry {
+        SessionEntry() : discriminator(0), session(NULL), txTick(0),
+            rxDeadline(0), rxScheduled(false) {}
+        Discriminator discriminator;
+        BFDSession *session;
+        uint64_t txTick;
+        uint64_t rxDeadline;
+        bool rxScheduled;
+    };
+
     class SessionManager : boost::noncopyable {
-        EventManager *evm_;
-        typedef std::map<Discriminator, BFDSession*> DiscriminatorSessionMap;
-        typedef std::map<boost::asio::ip::address, BFDSession*> AddressSessionMap;
+        typedef std::map<boost::asio::ip::address, Discriminator> AddressSessionMap;
 
-        DiscriminatorSessionMap by_discriminator_;
+        std::vector<SessionEntry> sessions_;
+        // Discriminators of the sessions removed, their indexes are free
+        std::vector<Discriminator> free_;
         AddressSessionMap by_address_;
      public:
-        explicit SessionManager(EventManager *evm) : evm_(evm) {}
+        SessionManager() {}
 
+        SessionEntry *EntryByDiscriminator(Discriminator discriminator);
         BFDSession *SessionByDiscriminator(Discriminator discriminator);
         BFDSession *SessionByAddress(const boost::asio::ip::address &address);
         ResultCode RemoveSession(Discriminator discriminator);
         ResultCode CreateOrUpdateSession(const boost::asio::ip::address &remoteHost,
                 const BFDSessionConfig *config,
                 Connection *communicator,
+                SessionScheduler *scheduler,
                 Discriminator *assignedDiscriminator);
         Discriminator GenerateUniqDiscriminator();
+        size_t size() const { return sessions_.size() - free_.size(); }
 
         ~SessionManager();
     };
+
+    static uint64_t Now();
+    static uint64_t Ticks(TimeInterval interval);
+    bool TimerExpired();
+    void TransmitDue(uint64_t now);
+    void DetectDue(uint64_t now);
+
     SessionManager sessionManager_;
+    Timer *timer_;
+    TimingWheel txWheel_;
+    TimingWheel rxWheel_;
+
+    // Kept across ticks to avoid reallocation
+    TimingWheel::EntryList due_;
+    std::vector<ControlPacket> txPackets_;
+    Connection::PacketBatch txBatch_;
 };
 
 }  // namespace BFD
@@ -15,26 +15,19 @@
 #include "base/logging.h"
 
 namespace BFD {
-bool BFDSession::SendTimerExpired() {
+TimeInterval BFDSession::Transmit(ControlPacket *packet) {
     LOG(DEBUG, __func__);
     tbb::mutex::scoped_lock lock(mutex_);
 
-    ControlPacket packet;
-    PreparePacket(nextConfig_, &packet);
-    SendPacket(&packet);
-
-    // Workaround: Timer code isn't re-entrant
-    this->sendTimer_->Reschedule(TxInterval().total_milliseconds());
-    return true;
+    PreparePacket(nextConfig_, packet);
+    return TxInterval();
 }
 
 
-bool BFDSession::RecvTimerExpired() {
+void BFDSession::DetectionTimeout() {
     LOG(DEBUG, __func__);
     tbb::mutex::scoped_lock lock(mutex_);
     sm_->ProcessTimeout();
-
-    return false;
 }
 
 
@@ -56,17 +49,14 @@ void BFDSession::ScheduleSendTimer() {
     TimeInterval ti = TxInterval();
     LOG(DEBUG, __func__ << " " << ti);
 
-    sendTimer_->Start(ti.total_milliseconds(),
-                             boost::bind(&BFDSession::SendTimerExpired, this));
+    scheduler_->ScheduleTx(localDiscriminator_, ti);
 }
 
 void BFDSession::ScheduleRecvDeadlineTimer() {
     TimeInterval ti = DetectionTime();
     LOG(DEBUG, __func__ << ti);
 
-    recvTimer_->Cancel();
-    recvTimer_->Start(ti.total_milliseconds(),
-                             boost::bind(&BFDSession::RecvTimerExpired, this));
+    scheduler_->ScheduleRx(localDiscriminator_, ti);
 }
 
 BFDState BFDSession::LocalState() {
@@ -112,8 +102,8 @@ ResultCode BFDSession::ProcessControlPacket(const ControlPacket *packet) {
     remoteSession_.discriminator = packet->sender_discriminator;
     if (remoteSession_.minRxInterval != packet->required_min_rx_interval) {
         // TODO schedule from previous packet
-        ScheduleSendTimer();
         remoteSession_.minRxInterval = packet->required_min_rx_interval;
+        ScheduleSendTimer();
     }
     remoteSession_.minTxInterval = packet->desired_min_tx_interval;
     remoteSession_.detectionTimeMultiplier = packet->detection_time_multiplier;
@@ -171,14 +161,4 @@ boost::asio::ip::address BFDSession::RemoteHost() {
     return remoteHost_;
 }
 
-void BFDSession::Stop() {
-    tbb::mutex::scoped_lock lock(mutex_);
-
-    if (stopped_ == false) {
-        TimerManager::DeleteTimer(sendTimer_);
-        TimerManager::DeleteTimer(recvTimer_);
-        stopped_ = true;
-    }
-}
-
 }  // namespace BFD
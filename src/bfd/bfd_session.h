@@ -10,9 +10,7 @@
 #include <string>
 #include <boost/scoped_ptr.hpp>
 #include <boost/asio/ip/address.hpp>
-#include "base/timer.h"
 #include "tbb/mutex.h"
-#include "io/event_manager.h"
 
 namespace BFD {
 
@@ -38,23 +36,28 @@ class BFDRemoteSessionState {
     int detectionTimeMultiplier;
 };
 
+// Keeps the time of the next transmission and the detection deadline of the
+// sessions, instead of a timer each.
+class SessionScheduler {
+ public:
+    virtual void ScheduleTx(Discriminator discriminator, TimeInterval interval) = 0;
+    virtual void ScheduleRx(Discriminator discriminator, TimeInterval interval) = 0;
+    virtual ~SessionScheduler() {}
+};
+
 class BFDSession {
  private:
     mutable tbb::mutex mutex_;
     Discriminator localDiscriminator_;
     boost::asio::ip::address remoteHost_;
-    Timer *sendTimer_;
-    Timer *recvTimer_;
     const BFDSessionConfig *currentConfig_;
     const BFDSessionConfig *nextConfig_;
     BFDRemoteSessionState remoteSession_;
     boost::scoped_ptr<StateMachine> sm_;
     bool pollSequence_;
     Connection *communicator_;
-    bool stopped_;
+    SessionScheduler *scheduler_;
 
-    bool SendTimerExpired();
-    bool RecvTimerExpired();
     void ScheduleSendTimer();
     void ScheduleRecvDeadlineTimer();
     void PreparePacket(const BFDSessionConfig *config, ControlPacket *packet);
@@ -63,30 +66,28 @@ class BFDSession {
  public:
     BFDSession(Discriminator localDiscriminator,
             boost::asio::ip::address remoteHost,
-            EventManager *evm,
+            SessionScheduler *scheduler,
             const BFDSessionConfig *config, Connection *communicator) :
                 localDiscriminator_(localDiscriminator), remoteHost_(remoteHost),
-                    sendTimer_(TimerManager::CreateTimer(*evm->io_service(), "BFD TX timer")),
-                    recvTimer_(TimerManager::CreateTimer(*evm->io_service(), "BFD RX timeout")),
-
                     currentConfig_(config),
                     nextConfig_(config),
                     sm_(CreateStateMachine()),
                     pollSequence_(false),
                     communicator_(communicator),
-                    stopped_(false) {
+                    scheduler_(scheduler) {
         ScheduleSendTimer();
     }
 
-    void Stop();
-
-    ~BFDSession() {
-        Stop();
-    }
+    // Called by the scheduler when the periodic transmission is due. Fills
+    // in the packet to send and returns the interval to the next one.
+    TimeInterval Transmit(ControlPacket *packet);
+    // Called by the scheduler when the detection time expired
+    void DetectionTimeout();
 
     std::string toString() const;
     ResultCode ProcessControlPacket(const ControlPacket *packet);
     boost::asio::ip::address RemoteHost();
+    Discriminator LocalDiscriminator() const { return localDiscriminator_; }
 
     BFDState LocalState();
     TimeInterval DetectionTime();
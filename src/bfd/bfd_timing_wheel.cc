@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2014 CodiLime, Inc. All rights reserved.
+ */
+#include "bfd/bfd_timing_wheel.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace BFD {
+
+TimingWheel::TimingWheel(size_t slots, uint64_t now)
+    : slots_(slots), current_(now), count_(0) {
+    assert(slots > 0 && (slots & (slots - 1)) == 0);
+}
+
+void TimingWheel::Schedule(Discriminator discriminator, uint64_t tick) {
+    if (tick <= current_)
+        tick = current_ + 1;
+    slots_[tick & (slots_.size() - 1)].push_back(Entry(discriminator, tick));
+    count_++;
+}
+
+void TimingWheel::Advance(uint64_t now, EntryList *due) {
+    if (now <= current_)
+        return;
+
+    // Every bucket is visited at most once, however late the tick is
+    uint64_t ticks = std::min(now - current_,
+                              static_cast<uint64_t>(slots_.size()));
+    for (uint64_t tick = current_ + 1; tick <= current_ + ticks; ++tick) {
+        EntryList &slot = slots_[tick & (slots_.size() - 1)];
+        size_t kept = 0;
+        for (size_t i = 0; i < slot.size(); ++i) {
+            if (slot[i].tick <= now)
+                due->push_back(slot[i]);
+            else
+                slot[kept++] = slot[i];
+        }
+        count_ -= slot.size() - kept;
+        slot.resize(kept, Entry(0, 0));
+    }
+    current_ = now;
+}
+
+}  // namespace BFD
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2014 CodiLime, Inc. All rights reserved.
+ */
+#ifndef BFD_TIMING_WHEEL_H_
+#define BFD_TIMING_WHEEL_H_
+
+#include "bfd/bfd_common.h"
+
+#include <vector>
+
+namespace BFD {
+
+// Buckets of session discriminators, one per tick of the BFD engine. The
+// transmit intervals are jittered, so the sessions spread over the buckets
+// and every tick handles a share of them.
+//
+// An entry keeps the tick it was scheduled for. Entries beyond the range of
+// the wheel stay in their bucket until the wheel comes around to their tick.
+// Rescheduling doesn't remove the old entry, the owner recognizes and drops
+// the stale entries when they are due.
+class TimingWheel {
+ public:
+    struct Entry {
+        Entry(Discriminator discriminator, uint64_t tick)
+            : discriminator(discriminator), tick(tick) {}
+        Discriminator discriminator;
+        uint64_t tick;
+    };
+    typedef std::vector<Entry> EntryList;
+
+    // slots must be a power of 2
+    TimingWheel(size_t slots, uint64_t now);
+
+    // Ticks not after the current one are moved to the next tick
+    void Schedule(Discriminator discriminator, uint64_t tick);
+
+    // Append the entries due up to and including tick now to due
+    void Advance(uint64_t now, EntryList *due);
+
+    uint64_t current() const { return current_; }
+    size_t size() const { return count_; }
+
+ private:
+    std::vector<EntryList> slots_;
+    uint64_t current_;
+    size_t count_;
+};
+
+}  // namespace BFD
+
+#endif /* BFD_TIMING_WHEEL_H_ */
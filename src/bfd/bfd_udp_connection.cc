@@ -7,6 +7,12 @@
 #include "bfd/bfd_control_packet.h"
 #include "bfd/bfd_common.h"
 
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/random.hpp>
@@ -73,6 +79,66 @@ UDPConnectionManager::UDPRecvServer::UDPRecvServer(EventManager *evm, int recvPo
         }
 
 
+     // Sends the whole batch with sendmmsg, in as few system calls as the
+     // socket takes. Returns false if sendmmsg is not available, the caller
+     // falls back to sending the packets one at a time.
+     bool UDPConnectionManager::UDPCommunicator::SendPackets(const PacketBatch &batch) {
+#if defined(__linux__) && defined(__NR_sendmmsg)
+            std::vector<uint8_t> data(batch.size() * kMinimalPacketLength);
+            std::vector<boost::asio::ip::udp::endpoint> endpoints;
+            std::vector<struct iovec> iov(batch.size());
+            std::vector<struct mmsghdr> msgs(batch.size());
+            std::vector<PacketBatch::const_iterator> packets;
+            endpoints.reserve(batch.size());
+            packets.reserve(batch.size());
+
+            size_t count = 0;
+            for (PacketBatch::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+                uint8_t *pkt = &data[count * kMinimalPacketLength];
+                if (EncodeControlPacket(it->second, pkt, kMinimalPacketLength) != kMinimalPacketLength) {
+                    LOG(ERROR, "Unable to encode packet");
+                    continue;
+                }
+                endpoints.push_back(boost::asio::ip::udp::endpoint(it->first, remotePort_));
+                packets.push_back(it);
+                iov[count].iov_base = pkt;
+                iov[count].iov_len = kMinimalPacketLength;
+                memset(&msgs[count], 0, sizeof(msgs[count]));
+                msgs[count].msg_hdr.msg_name = endpoints.back().data();
+                msgs[count].msg_hdr.msg_namelen = endpoints.back().size();
+                msgs[count].msg_hdr.msg_iov = &iov[count];
+                msgs[count].msg_hdr.msg_iovlen = 1;
+                count++;
+            }
+
+            int fd = socket()->native_handle();
+            for (size_t sent = 0; sent < count; ) {
+                int rc = syscall(__NR_sendmmsg, fd, &msgs[sent], count - sent, MSG_DONTWAIT);
+                if (rc >= 0) {
+                    sent += rc;
+                    continue;
+                }
+                if (errno == ENOSYS && sent == 0)
+                    return false;
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    // The socket buffer is full, queue the rest for the asynchronous send
+                    for (; sent < count; ++sent)
+                        SendPacket(packets[sent]->first, packets[sent]->second);
+                    break;
+                }
+                // Only the first message of the call failed, skip it and send the others
+                LOG(ERROR, "Unable to send packet to " << packets[sent]->first << ": " << strerror(errno));
+                sent++;
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+
      UDPConnectionManager::UDPConnectionManager(EventManager *evm,  int recvPort, int remotePort)
                : udpRecv_(evm, recvPort), udpSend_(evm, remotePort) {
         if (udpRecv_.GetServerState() != UDPRecvServer::OK)
@@ -86,6 +152,12 @@ UDPConnectionManager::UDPRecvServer::UDPRecvServer(EventManager *evm, int recvPo
         udpSend_.SendPacket(dstAddr, packet);
     }
 
+     void UDPConnectionManager::SendPackets(const PacketBatch &batch) {
+        LOG(DEBUG, __func__ << " " << batch.size());
+        if (!udpSend_.SendPackets(batch))
+            Connection::SendPackets(batch);
+    }
+
     void UDPConnectionManager::RegisterCallback(RecvCallback callback) {
         udpRecv_.RegisterCallback(callback);
     }
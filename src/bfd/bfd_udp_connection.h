@@ -37,12 +37,14 @@ class UDPConnectionManager :  public Connection {
      public:
         UDPCommunicator(EventManager *evm, int remotePort);
         virtual void SendPacket(const boost::asio::ip::address &dstAddr, const ControlPacket *packet);
+        bool SendPackets(const PacketBatch &batch);
     } udpSend_;  // TODO multiple instances to randomize udp source port
 
  public:
     UDPConnectionManager(EventManager *evm,  int recvPort = kRecvPortDefault, int remotePort = kRecvPortDefault);
 
     virtual void SendPacket(const boost::asio::ip::address &dstAddr, const ControlPacket *packet);
+    virtual void SendPackets(const PacketBatch &batch);
     void RegisterCallback(RecvCallback callback);
     ~UDPConnectionManager();
 };
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2014 CodiLime, Inc. All rights reserved.
+ */
+
+#include "bfd/bfd_server.h"
+#include "bfd/bfd_session.h"
+#include "bfd/bfd_timing_wheel.h"
+#include "bfd/test/bfd_test_utils.h"
+
+#include <boost/asio.hpp>
+#include <testing/gunit.h>
+#include "base/test/task_test_util.h"
+#include "base/util.h"
+
+using namespace BFD;
+
+namespace BFD {
+
+class EngineTest : public ::testing::Test {
+ protected:
+    // Counts the packets and the batches they are handed over in
+    class CountingConnection : public Connection {
+     public:
+        CountingConnection() : maxBatch(0) {
+            packets = 0;
+            batches = 0;
+        }
+        virtual void SendPacket(const boost::asio::ip::address &dstAddr, const ControlPacket *packet) {
+            packets++;
+            batches++;
+        }
+        virtual void SendPackets(const PacketBatch &batch) {
+            packets += batch.size();
+            batches++;
+            maxBatch = std::max(maxBatch, batch.size());
+        }
+        tbb::atomic<size_t> packets;
+        tbb::atomic<size_t> batches;
+        size_t maxBatch;
+    };
+
+    EngineTest() {
+        config.desiredMinTxInterval = boost::posix_time::milliseconds(300);
+        config.requiredMinRxInterval = boost::posix_time::milliseconds(300);
+        config.detectionTimeMultiplier = 3;
+    }
+
+    static boost::asio::ip::address HostAddress(uint32_t index) {
+        return boost::asio::ip::address_v4(0x0a000000 + index);
+    }
+
+    static void InitPacket(ControlPacket *packet) {
+        packet->diagnostic = kNoDiagnostic;
+        packet->state = kDown;
+        packet->poll = false;
+        packet->final = false;
+        packet->control_plane_independent = false;
+        packet->authentication_present = false;
+        packet->demand = false;
+        packet->multipoint = false;
+        packet->detection_time_multiplier = 3;
+        packet->length = kMinimalPacketLength;
+        packet->sender_discriminator = 0x1234;
+        packet->receiver_discriminator = 0;
+        packet->desired_min_tx_interval = boost::posix_time::milliseconds(300);
+        packet->required_min_rx_interval = boost::posix_time::milliseconds(300);
+        packet->required_min_echo_rx_interval = boost::posix_time::seconds(0);
+    }
+
+    size_t SessionCount(BFDServer *server) {
+        tbb::mutex::scoped_lock lock(server->mutex_);
+        return server->sessionManager_.size();
+    }
+
+    size_t TxScheduled(BFDServer *server) {
+        tbb::mutex::scoped_lock lock(server->mutex_);
+        return server->txWheel_.size();
+    }
+
+    EventManager evm;
+    BFDSessionConfig config;
+};
+
+}  // namespace BFD
+
+TEST_F(EngineTest, TimingWheel) {
+    TimingWheel wheel(8, 100);
+
+    wheel.Schedule(1, 101);
+    wheel.Schedule(2, 103);
+    // Beyond the range of the wheel, shares the bucket of tick 103
+    wheel.Schedule(3, 111);
+    // In the past, moved to the next tick
+    wheel.Schedule(4, 50);
+    EXPECT_EQ(4, wheel.size());
+
+    TimingWheel::EntryList due;
+    wheel.Advance(101, &due);
+    ASSERT_EQ(2, due.size());
+    EXPECT_EQ(1, due[0].discriminator);
+    EXPECT_EQ(4, due[1].discriminator);
+    EXPECT_EQ(101, wheel.current());
+
+    due.clear();
+    wheel.Advance(103, &due);
+    ASSERT_EQ(1, due.size());
+    EXPECT_EQ(2, due[0].discriminator);
+    EXPECT_EQ(1, wheel.size());
+
+    // A late advance still visits every bucket once
+    due.clear();
+    wheel.Advance(1000, &due);
+    ASSERT_EQ(1, due.size());
+    EXPECT_EQ(3, due[0].discriminator);
+    EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(EngineTest, DiscriminatorReuse) {
+    CountingConnection connection;
+    BFDServer server(&evm, &connection);
+
+    Discriminator disc1, disc2, disc3;
+    server.createSession(HostAddress(1), &config, &disc1);
+    server.createSession(HostAddress(2), &config, &disc2);
+    EXPECT_NE(0, disc1);
+    EXPECT_NE(disc1, disc2);
+    EXPECT_EQ(2, SessionCount(&server));
+
+    EXPECT_EQ(kResultCode_Ok, server.deleteSession(disc1));
+    EXPECT_EQ(kResultCode_UnknownSession, server.deleteSession(disc1));
+    EXPECT_EQ(NULL, server.sessionByAddress(HostAddress(1)));
+    EXPECT_EQ(1, SessionCount(&server));
+
+    // The index is reused with another generation
+    server.createSession(HostAddress(3), &config, &disc3);
+    EXPECT_NE(disc1, disc3);
+    EXPECT_EQ(disc1 & 0xfffff, disc3 & 0xfffff);
+
+    // Packets for the old session are not demultiplexed to the new one
+    ControlPacket packet;
+    InitPacket(&packet);
+    packet.receiver_discriminator = disc1;
+    packet.sender_host = HostAddress(3);
+    EXPECT_EQ(kResultCode_UnknownSession, server.processControlPacket(&packet));
+    packet.receiver_discriminator = disc3;
+    EXPECT_EQ(kResultCode_Ok, server.processControlPacket(&packet));
+}
+
+//
+// A server with 10k sessions. Every session is due at least once a second,
+// the transmissions of a tick are handed over to the connection together.
+//
+TEST_F(EngineTest, Scale) {
+    static const size_t kSessions = 10000;
+    CountingConnection connection;
+    BFDServer server(&evm, &connection);
+
+    std::vector<Discriminator> discriminators(kSessions);
+    uint64_t start = ClockMonotonicUsec();
+    for (size_t i = 0; i < kSessions; ++i)
+        server.createSession(HostAddress(i + 1), &config, &discriminators[i]);
+    LOG(INFO, "Created " << kSessions << " sessions in "
+        << (ClockMonotonicUsec() - start) << " usec");
+    EXPECT_EQ(kSessions, SessionCount(&server));
+    EXPECT_EQ(kSessions, TxScheduled(&server));
+
+    {
+        EventManagerThread t(&evm);
+        TASK_UTIL_EXPECT_TRUE_MSG(connection.packets >= kSessions,
+                                  "Waiting for every session to transmit");
+    }
+    LOG(INFO, "Sent " << connection.packets << " packets in "
+        << connection.batches << " batches, at most " << connection.maxBatch
+        << " per batch");
+    EXPECT_LT(connection.batches * 10, connection.packets);
+    // Every session is rescheduled, no entry is lost or duplicated
+    EXPECT_EQ(kSessions, TxScheduled(&server));
+
+    // Demultiplex a packet for every session
+    ControlPacket packet;
+    InitPacket(&packet);
+    start = ClockMonotonicUsec();
+    for (size_t i = 0; i < kSessions; ++i) {
+        packet.receiver_discriminator = discriminators[i];
+        packet.sender_host = HostAddress(i + 1);
+        EXPECT_EQ(kResultCode_Ok, server.processControlPacket(&packet));
+    }
+    LOG(INFO, "Processed " << kSessions << " packets in "
+        << (ClockMonotonicUsec() - start) << " usec");
+
+    for (size_t i = 0; i < kSessions; ++i)
+        EXPECT_EQ(kResultCode_Ok, server.deleteSession(discriminators[i]));
+    EXPECT_EQ(0, SessionCount(&server));
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -50,14 +50,32 @@ class SessionTest : public ::testing::Test {
         boost::optional<ControlPacket> savedPacket;
         virtual ~TestConnection() {}
     };
+    class TestScheduler : public SessionScheduler {
+     public:
+        TestScheduler() : txCount(0), rxCount(0) {}
+        virtual void ScheduleTx(Discriminator discriminator, TimeInterval interval) {
+            ASSERT_EQ(localDiscriminator, discriminator);
+            txCount++;
+            txInterval = interval;
+        }
+        virtual void ScheduleRx(Discriminator discriminator, TimeInterval interval) {
+            ASSERT_EQ(localDiscriminator, discriminator);
+            rxCount++;
+            rxInterval = interval;
+        }
+        int txCount;
+        int rxCount;
+        TimeInterval txInterval;
+        TimeInterval rxInterval;
+    };
     BFDSessionConfig config;
     ControlPacket packet;
-    EventManager evm;
+    TestScheduler scheduler;
 };
 
 TEST_F(SessionTest, UpTest) {
     TestConnection tc;
-    BFDSession session(localDiscriminator, addr, &evm, &config, &tc);
+    BFDSession session(localDiscriminator, addr, &scheduler, &config, &tc);
 
     EXPECT_EQ(kInit, session.LocalState());
     packet.state = kInit;
@@ -67,7 +85,7 @@ TEST_F(SessionTest, UpTest) {
 
 TEST_F(SessionTest, PollRecvTest) {
     TestConnection tc;
-    BFDSession session(localDiscriminator, addr, &evm, &config, &tc);
+    BFDSession session(localDiscriminator, addr, &scheduler, &config, &tc);
 
     packet.poll = true;
     session.ProcessControlPacket(&packet);
@@ -84,7 +102,7 @@ TEST_F(SessionTest, PollRecvTest) {
 
 TEST_F(SessionTest, PollSendTest) {
     TestConnection tc;
-    BFDSession session(localDiscriminator, addr, &evm, &config, &tc);
+    BFDSession session(localDiscriminator, addr, &scheduler, &config, &tc);
 
     session.ProcessControlPacket(&packet);
     session.InitPollSequence();
@@ -94,15 +112,37 @@ TEST_F(SessionTest, PollSendTest) {
     EXPECT_EQ(0, tc.savedPacket.get().final);
     tc.savedPacket.reset();
 
-    EventManagerThread t(&evm);
-    TASK_UTIL_EXPECT_TRUE(tc.savedPacket.is_initialized());
-    EXPECT_EQ(1, tc.savedPacket.get().poll);
-    EXPECT_EQ(0, tc.savedPacket.get().final);
-    tc.savedPacket.reset();
+    // The poll bit is set on the periodic transmissions too
+    ControlPacket periodic;
+    session.Transmit(&periodic);
+    EXPECT_EQ(1, periodic.poll);
+    EXPECT_EQ(0, periodic.final);
+
+    session.ProcessControlPacket(&packet);
+}
+
+TEST_F(SessionTest, ScheduleTest) {
+    TestConnection tc;
+    BFDSession session(localDiscriminator, addr, &scheduler, &config, &tc);
 
+    // The first transmission is scheduled at the idle interval
+    EXPECT_EQ(1, scheduler.txCount);
+    EXPECT_LE(kIdleTxInterval * 3/4, scheduler.txInterval);
+    EXPECT_GE(kIdleTxInterval, scheduler.txInterval);
+    EXPECT_EQ(0, scheduler.rxCount);
+
+    // Every packet received moves the detection deadline once the session is up
+    packet.state = kInit;
+    session.ProcessControlPacket(&packet);
+    EXPECT_EQ(kUp, session.LocalState());
+    EXPECT_EQ(1, scheduler.rxCount);
+    EXPECT_EQ(session.DetectionTime(), scheduler.rxInterval);
+    packet.state = kUp;
     session.ProcessControlPacket(&packet);
+    EXPECT_EQ(2, scheduler.rxCount);
 
-    evm.Shutdown();
+    session.DetectionTimeout();
+    EXPECT_EQ(kDown, session.LocalState());
 }
 
 
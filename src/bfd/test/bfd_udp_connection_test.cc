@@ -9,6 +9,7 @@
 
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
+#include <tbb/atomic.h>
 #include <testing/gunit.h>
 #include "test/task_test_util.h"
 #include "base/logging.h"
@@ -23,7 +24,11 @@ class BFDTest : public ::testing::Test {
         LOG(INFO, p2->toString());
         cmpResult = (*p1 == *p2);
     }
+    void CountPacket(const ControlPacket *packet) {
+        received++;
+    }
     boost::optional<bool> cmpResult;
+    tbb::atomic<int> received;
 };
 
 
@@ -64,6 +69,51 @@ TEST_F(BFDTest, UDPConnection) {
     EXPECT_EQ(true, cmpResult.get());
 }
 
+// A packet the socket refuses must not keep the rest of the batch from
+// being sent
+TEST_F(BFDTest, UDPConnectionBatchError) {
+    const int port1 = 10003;
+    const int port2 = 10004;
+
+    EventManager em;
+    UDPConnectionManager communicationManager1(&em, port1, port2);
+    UDPConnectionManager communicationManager2(&em, port2, port1);
+
+    const boost::asio::ip::address addr = boost::asio::ip::address::from_string("127.0.0.1");
+    // Sending to broadcast without SO_BROADCAST fails with EACCES
+    const boost::asio::ip::address broadcast = boost::asio::ip::address::from_string("255.255.255.255");
+
+    ControlPacket packet;
+    packet.poll = false;
+    packet.final = false;
+    packet.control_plane_independent = false;
+    packet.authentication_present = false;
+    packet.demand = false;
+    packet.multipoint = false;
+    packet.detection_time_multiplier = 5;
+    packet.length = kMinimalPacketLength;
+    packet.sender_discriminator = 100;
+    packet.receiver_discriminator = 18;
+    packet.diagnostic = kNoDiagnostic;
+    packet.state = kDown;
+    packet.desired_min_tx_interval = boost::posix_time::milliseconds(100);
+    packet.required_min_rx_interval = boost::posix_time::milliseconds(200);
+    packet.required_min_echo_rx_interval = boost::posix_time::milliseconds(0);
+
+    Connection::PacketBatch batch;
+    batch.push_back(std::make_pair(addr, &packet));
+    batch.push_back(std::make_pair(broadcast, &packet));
+    batch.push_back(std::make_pair(addr, &packet));
+    batch.push_back(std::make_pair(broadcast, &packet));
+    batch.push_back(std::make_pair(addr, &packet));
+
+    received = 0;
+    communicationManager2.RegisterCallback(boost::bind(&BFDTest::CountPacket, this, _1));
+    EventManagerThread evmThread(&em);
+    communicationManager1.SendPackets(batch);
+
+    TASK_UTIL_EXPECT_EQ(3, received);
+}
 
 int main(int argc, char **argv) {
     LoggingInit();
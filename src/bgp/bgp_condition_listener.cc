@@ -96,10 +96,16 @@ private:
 // the ConditionMatch and all table walks have finished
 // Holds a table reference to ensure that table with active walk or listener
 // is not deleted
+// ConditionMatch objects that provide a MatchAddress are indexed by the
+// address so that a route notification is only dispatched to the objects
+// interested in the address of the route
 //
 class ConditionMatchTableState {
 public:
     typedef std::set<ConditionMatchPtr> MatchList;
+    typedef std::map<Ip4Address, MatchList> AddressMap;
+    typedef std::map<ConditionMatchPtr, Ip4Address> IndexMap;
+
     ConditionMatchTableState(BgpTable *table, DBTableBase::ListenerId id);
     ~ConditionMatchTableState();
 
@@ -114,9 +120,11 @@ public:
         return &match_object_list_;
     }
 
-    void AddMatchObject(ConditionMatch *obj) {
-        match_object_list_.insert(ConditionMatchPtr(obj));
-    }
+    void AddMatchObject(ConditionMatch *obj);
+    void RemoveMatchObject(ConditionMatch *obj);
+
+    // Invoke Match of all the objects interested in the route
+    void Match(BgpServer *server, BgpRoute *route, bool deleted);
 
     //
     // Mutex required to manager MatchState list for concurrency
@@ -126,9 +134,19 @@ public:
     }
 
 private:
+    void MatchObjects(BgpServer *server, BgpRoute *route, bool deleted,
+                      MatchList *list);
+
     tbb::mutex table_state_mutex_;
+    BgpTable *table_;
     DBTableBase::ListenerId id_;
+    // All the objects registered against the table
     MatchList match_object_list_;
+    // Objects interested in all the routes in the table
+    MatchList unindexed_list_;
+    // Objects interested in the routes with a given address
+    AddressMap address_map_;
+    IndexMap index_map_;
     LifetimeRef<ConditionMatchTableState> table_delete_ref_;
     DISALLOW_COPY_AND_ASSIGN(ConditionMatchTableState);
 };
@@ -333,15 +351,7 @@ bool BgpConditionListener::BgpRouteNotify(BgpServer *server,
     DBTableBase::ListenerId id = ts->GetListenerId();
     assert(id != DBTableBase::kInvalidId);
 
-    for(ConditionMatchTableState::MatchList::iterator match_obj_it = 
-        ts->match_objects()->begin();
-        match_obj_it != ts->match_objects()->end(); match_obj_it++) {
-        bool deleted = false;
-        if ((*match_obj_it)->deleted() || del_rt) {
-            deleted = true;
-        }
-        (*match_obj_it)->Match(server, bgptable, rt, deleted);
-    }
+    ts->Match(server, rt, del_rt);
     return true;
 }
 
@@ -399,7 +409,7 @@ void BgpConditionListener::UnregisterCondition(BgpTable *bgptable,
     //
     if ((!walk_state || !walk_state->is_walk_pending(obj)) && 
         obj->deleted()) {
-        ts->match_objects()->erase(obj);
+        ts->RemoveMatchObject(obj);
     }
 
     if (ts->match_objects()->empty()) {
@@ -411,11 +421,73 @@ void BgpConditionListener::UnregisterCondition(BgpTable *bgptable,
 
 ConditionMatchTableState::ConditionMatchTableState(BgpTable *table, 
                                                    DBTableBase::ListenerId id)
-    : id_(id), table_delete_ref_(this, table->deleter()) {
+    : table_(table), id_(id), table_delete_ref_(this, table->deleter()) {
     assert(table->deleter() != NULL);
 }
 
 ConditionMatchTableState::~ConditionMatchTableState() {
+    assert(address_map_.empty());
+    assert(index_map_.empty());
+}
+
+void ConditionMatchTableState::AddMatchObject(ConditionMatch *obj) {
+    ConditionMatchPtr match(obj);
+    if (!match_object_list_.insert(match).second) {
+        return;
+    }
+
+    Ip4Address address;
+    if (table_->family() != Address::INET ||
+        !obj->MatchAddress(table_, &address)) {
+        unindexed_list_.insert(match);
+        return;
+    }
+    address_map_[address].insert(match);
+    index_map_.insert(std::make_pair(match, address));
+}
+
+void ConditionMatchTableState::RemoveMatchObject(ConditionMatch *obj) {
+    ConditionMatchPtr match(obj);
+    if (match_object_list_.erase(match) == 0) {
+        return;
+    }
+    unindexed_list_.erase(match);
+
+    IndexMap::iterator loc = index_map_.find(match);
+    if (loc == index_map_.end()) {
+        return;
+    }
+    AddressMap::iterator entry = address_map_.find(loc->second);
+    index_map_.erase(loc);
+    assert(entry != address_map_.end());
+    entry->second.erase(match);
+    if (entry->second.empty()) {
+        address_map_.erase(entry);
+    }
+}
+
+void ConditionMatchTableState::MatchObjects(BgpServer *server,
+                                            BgpRoute *route, bool deleted,
+                                            MatchList *list) {
+    for (MatchList::iterator it = list->begin(); it != list->end(); ++it) {
+        (*it)->Match(server, table_, route, deleted || (*it)->deleted());
+    }
+}
+
+void ConditionMatchTableState::Match(BgpServer *server, BgpRoute *route,
+                                     bool deleted) {
+    MatchObjects(server, route, deleted, &unindexed_list_);
+    if (address_map_.empty()) {
+        return;
+    }
+
+    // Routes of any prefix length with the address are of interest
+    InetRoute *inet_route = static_cast<InetRoute *>(route);
+    AddressMap::iterator entry =
+        address_map_.find(inet_route->GetPrefix().ip4_addr());
+    if (entry != address_map_.end()) {
+        MatchObjects(server, route, deleted, &entry->second);
+    }
 }
 
 WalkRequest::WalkRequest() : id_(DBTableWalker::kInvalidWalkerId) {
@@ -16,6 +16,7 @@
 
 #include "bgp/bgp_table.h"
 #include "bgp/bgp_route.h"
+#include "bgp/inet/inet_route.h"
 #include "db/db_table_partition.h"
 // 
 // ConditionMatch
@@ -40,6 +41,15 @@ public:
     virtual bool Match(BgpServer *server, BgpTable *table, 
                        BgpRoute *route, bool deleted) = 0;
 
+    // Conditions that only match the routes of an inet table whose prefix
+    // address is a given address, whatever the prefix length, return true
+    // and fill the address. Such conditions are indexed by the address and
+    // Match is invoked only for the routes with that address.
+    // Default is to match all routes in the table
+    virtual bool MatchAddress(BgpTable *table, Ip4Address *address) const {
+        return false;
+    }
+
     bool deleted() {
         return deleted_;
     }
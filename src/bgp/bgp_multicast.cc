@@ -17,7 +17,8 @@ class McastTreeManager::DeleteActor : public LifetimeActor {
 public:
     DeleteActor(McastTreeManager *tree_manager)
         : LifetimeActor(tree_manager->table_->routing_instance()->server()->
-                lifetime_manager()),
+                lifetime_manager(),
+                tree_manager->table_->deleter()->partition()),
           tree_manager_(tree_manager) {
     }
     virtual ~DeleteActor() {
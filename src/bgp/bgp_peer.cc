@@ -213,7 +213,8 @@ private:
 class BgpPeer::DeleteActor : public LifetimeActor {
   public:
     DeleteActor(BgpPeer *peer)
-        : LifetimeActor(peer->server_->lifetime_manager()),
+        : LifetimeActor(peer->server_->lifetime_manager(),
+                        peer->rtinstance_->deleter()->partition()),
           peer_(peer) {
     }
 
@@ -887,9 +888,15 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg) {
         for (vector<BgpProtoPrefix *>::const_iterator it = msg->nlri.begin();
              it != msg->nlri.end(); ++it) {
             DBRequest req;
-            req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
-            req.data.reset(new InetTable::RequestData(attr, flags, 0));
             Ip4Prefix prefix = Ip4Prefix(**it);
+            BgpAttrPtr policy_attr = attr;
+            if (ApplyImportPolicy(&prefix, &policy_attr)) {
+                req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+                req.data.reset(
+                    new InetTable::RequestData(policy_attr, flags, 0));
+            } else {
+                req.oper = DBRequest::DB_ENTRY_DELETE;
+            }
             req.key.reset(new InetTable::RequestKey(prefix, this));
             table->Enqueue(&req);
             inc_rx_route_reach();
@@ -925,6 +932,15 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg) {
         if ((*ait)->code == BgpAttribute::MPReachNlri)
             attr = GetMpNlriNexthop(nlri, attr);
 
+        // Import policy for families without a per prefix match. A rejected
+        // route is withdrawn in case it was accepted earlier.
+        BgpAttrPtr policy_attr = attr;
+        if (oper == DBRequest::DB_ENTRY_ADD_CHANGE &&
+            family != Address::INET && family != Address::RTARGET &&
+            !ApplyImportPolicy(NULL, &policy_attr)) {
+            oper = DBRequest::DB_ENTRY_DELETE;
+        }
+
         switch (family) {
         case Address::INET: {
             InetTable *table =
@@ -935,9 +951,16 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg) {
             for (it = nlri->nlri.begin(); it < nlri->nlri.end(); it++) {
                 DBRequest req;
                 req.oper = oper;
-                if (oper == DBRequest::DB_ENTRY_ADD_CHANGE)
-                    req.data.reset(new InetTable::RequestData(attr, flags, 0));
                 Ip4Prefix prefix = Ip4Prefix(**it);
+                policy_attr = attr;
+                if (oper == DBRequest::DB_ENTRY_ADD_CHANGE &&
+                    !ApplyImportPolicy(&prefix, &policy_attr)) {
+                    req.oper = DBRequest::DB_ENTRY_DELETE;
+                }
+                if (req.oper == DBRequest::DB_ENTRY_ADD_CHANGE) {
+                    req.data.reset(
+                        new InetTable::RequestData(policy_attr, flags, 0));
+                }
                 req.key.reset(new InetTable::RequestKey(prefix, this));
                 table->Enqueue(&req);
             }
@@ -957,7 +980,8 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg) {
                 DBRequest req;
                 req.oper = oper;
                 if (oper == DBRequest::DB_ENTRY_ADD_CHANGE)
-                    req.data.reset(new InetVpnTable::RequestData(attr, flags, label));
+                    req.data.reset(new InetVpnTable::RequestData(policy_attr,
+                                                                 flags, label));
                 req.key.reset(new InetVpnTable::RequestKey(InetVpnPrefix(**it),
                                                            this));
                 table->Enqueue(&req);
@@ -985,7 +1009,8 @@ void BgpPeer::ProcessUpdate(const BgpProto::Update *msg) {
                 DBRequest req;
                 req.oper = oper;
                 if (oper == DBRequest::DB_ENTRY_ADD_CHANGE)
-                    req.data.reset(new EvpnTable::RequestData(attr, flags, label));
+                    req.data.reset(new EvpnTable::RequestData(policy_attr,
+                                                              flags, label));
                 req.key.reset(new EvpnTable::RequestKey(EvpnPrefix(**it), this));
                 table->Enqueue(&req);
             }
@@ -1248,6 +1273,17 @@ BgpAttrPtr BgpPeer::GetMpNlriNexthop(BgpMpNlri *nlri, BgpAttrPtr attr) {
     return attr;
 }
 
+//
+// Run the import policy, if any, on a received route. Returns false if the
+// route is rejected. Otherwise attr is updated with the resulting attributes.
+//
+bool BgpPeer::ApplyImportPolicy(const Ip4Prefix *prefix, BgpAttrPtr *attr) {
+    BgpPolicyPtr policy = import_policy_;
+    if (!policy)
+        return true;
+    return import_policy_cache_.Evaluate(policy, prefix, attr);
+}
+
 void BgpPeer::ManagedDelete() {
     BGP_LOG_PEER(Config, this, SandeshLevel::SYS_INFO, BGP_LOG_FLAG_ALL,
                  BGP_PEER_DIR_NA, "Received request for deletion");
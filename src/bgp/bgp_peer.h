@@ -17,6 +17,7 @@
 #include "base/timer.h"
 #include "bgp/bgp_debug.h"
 #include "bgp/bgp_peer_key.h"
+#include "bgp/bgp_policy.h"
 #include "bgp/bgp_proto.h"
 #include "bgp/bgp_ribout.h"
 #include "bgp/ipeer.h"
@@ -145,6 +146,11 @@ public:
 
     const BgpNeighborConfig *config() const { return config_; }
 
+    // Policy applied to routes received from the peer. Set from the
+    // bgp::Config task. Routes already received are not re-evaluated.
+    BgpPolicyPtr import_policy() const { return import_policy_; }
+    void set_import_policy(BgpPolicyPtr policy) { import_policy_ = policy; }
+
     virtual void SetDataCollectionKey(BgpPeerInfo *peer_info) const;
     void FillNeighborInfo(std::vector<BgpNeighborResp> &nbr_list) const;
 
@@ -222,6 +228,7 @@ private:
 
     virtual bool MpNlriAllowed(uint16_t afi, uint8_t safi);
     BgpAttrPtr GetMpNlriNexthop(BgpMpNlri *nlri, BgpAttrPtr attr);
+    bool ApplyImportPolicy(const Ip4Prefix *prefix, BgpAttrPtr *attr);
 
     void PostCloseRelease();
     void CustomClose();
@@ -277,6 +284,9 @@ private:
     AddressFamilyList family_;
     BgpProto::BgpPeerType peer_type_;
     RibExportPolicy policy_;
+    BgpPolicyPtr import_policy_;
+    // Accessed only from ProcessUpdate, which is serialized for the peer
+    BgpPolicyCache import_policy_cache_;
     boost::scoped_ptr<PeerClose> peer_close_;
     boost::scoped_ptr<PeerStats> peer_stats_;
     boost::scoped_ptr<DeleteActor> deleter_;
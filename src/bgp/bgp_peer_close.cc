@@ -290,17 +290,12 @@ void PeerCloseManager::Close() {
 //
 void PeerCloseManager::ProcessRibIn(DBTablePartBase *root, BgpRoute *rt,
                                     BgpTable *table, int action_mask) {
-    DBRequest::DBOperation oper;
-    BgpAttrPtr attrs;
-    MembershipRequest::Action  action;
-
     // Look for the flags that we care about
-    action = static_cast<MembershipRequest::Action>(action_mask &
-                (MembershipRequest::RIBIN_STALE |
-                 MembershipRequest::RIBIN_SWEEP |
-                 MembershipRequest::RIBIN_DELETE));
-
-    if (action == MembershipRequest::INVALID) return;
+    if (!(action_mask & (MembershipRequest::RIBIN_STALE |
+                         MembershipRequest::RIBIN_SWEEP |
+                         MembershipRequest::RIBIN_DELETE))) {
+        return;
+    }
 
     // Process all paths sourced from this peer_. Multiple paths could exist
     // in ecmp cases.
@@ -313,46 +308,69 @@ void PeerCloseManager::ProcessRibIn(DBTablePartBase *root, BgpRoute *rt,
         BgpPath *path = static_cast<BgpPath *>(it.operator->());
         if (path->GetPeer() != peer_) continue;
 
-        switch (action) {
-            case MembershipRequest::RIBIN_SWEEP:
+        ProcessRibInPath(root, rt, path, table, action_mask);
+    }
+}
+
+// ProcessRibInPath
+//
+// Concurrency: Runs in the context of the DB Walker task launched by
+// peer rib membership manager
+//
+// Stale, sweep or delete a single path sourced from this peer_. Used by the
+// membership manager to process paths from many peers in a single pass over
+// the path list of a route.
+//
+void PeerCloseManager::ProcessRibInPath(DBTablePartBase *root, BgpRoute *rt,
+                                        BgpPath *path, BgpTable *table,
+                                        int action_mask) {
+    DBRequest::DBOperation oper;
+    BgpAttrPtr attrs;
+    MembershipRequest::Action  action;
+
+    // Look for the flags that we care about
+    action = static_cast<MembershipRequest::Action>(action_mask &
+                (MembershipRequest::RIBIN_STALE |
+                 MembershipRequest::RIBIN_SWEEP |
+                 MembershipRequest::RIBIN_DELETE));
 
-                // Stale paths must be deleted
-                if (!path->IsStale()) {
-                    return;
-                }
+    switch (action) {
+        case MembershipRequest::RIBIN_SWEEP:
 
-                // Fall through to delete case as the path is still stale
-                // and we are sweeping such paths from the table
-            case MembershipRequest::RIBIN_DELETE:
+            // Stale paths must be deleted
+            if (!path->IsStale()) {
+                return;
+            }
 
-                // This path must be deleted. Hence attr is not required
-                oper = DBRequest::DB_ENTRY_DELETE;
-                attrs = NULL;
-                break;
+            // Fall through to delete case as the path is still stale
+            // and we are sweeping such paths from the table
+        case MembershipRequest::RIBIN_DELETE:
 
-            case MembershipRequest::RIBIN_STALE:
+            // This path must be deleted. Hence attr is not required
+            oper = DBRequest::DB_ENTRY_DELETE;
+            attrs = NULL;
+            break;
 
-                // This path must be marked for staling. Update the local
-                // preference and update the route accordingly
-                oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        case MembershipRequest::RIBIN_STALE:
 
-                // Update attrs with maximum local preference so that this path
-                // is least preferred
-                // TODO: Check for the right local-pref value to use
-                attrs = peer_->server()->attr_db()->\
-                        ReplaceLocalPreferenceAndLocate(path->GetAttr(), 1);
-                path->SetStale();
-                break;
+            // This path must be marked for staling. Update the local
+            // preference and update the route accordingly
+            oper = DBRequest::DB_ENTRY_ADD_CHANGE;
 
-            default:
-                return;
-        }
+            // Update attrs with maximum local preference so that this path
+            // is least preferred
+            // TODO: Check for the right local-pref value to use
+            attrs = peer_->server()->attr_db()->\
+                    ReplaceLocalPreferenceAndLocate(path->GetAttr(), 1);
+            path->SetStale();
+            break;
 
-        // Feed the route modify/delete request to the table input process
-        table->InputCommon(root, rt, path, peer_, NULL, oper, attrs,
-                        path->GetPathId(), path->GetFlags(), path->GetLabel());
+        default:
+            return;
     }
 
-    return;
+    // Feed the route modify/delete request to the table input process
+    table->InputCommon(root, rt, path, peer_, NULL, oper, attrs,
+                    path->GetPathId(), path->GetFlags(), path->GetLabel());
 }
 
@@ -14,6 +14,7 @@
 #include "bgp/ipeer.h"
 
 class IPeerRib;
+class BgpPath;
 class BgpRoute;
 class BgpTable;
 
@@ -53,6 +54,8 @@ public:
     int GetActionAtStart(IPeerRib *peer_rib);
     void ProcessRibIn(DBTablePartBase *root, BgpRoute *rt, BgpTable *table,
                       int action_mask);
+    void ProcessRibInPath(DBTablePartBase *root, BgpRoute *rt, BgpPath *path,
+                          BgpTable *table, int action_mask);
     bool IsCloseInProgress();
 
 private:
@@ -4,6 +4,8 @@
 
 #include "bgp/bgp_peer_membership.h"
 
+#include <algorithm>
+
 #include <boost/assign/list_of.hpp>
 #include <boost/bind.hpp>
 #include <tbb/mutex.h>
@@ -14,7 +16,9 @@
 
 #include "bgp/bgp_export.h"
 #include "bgp/bgp_log.h"
+#include "bgp/bgp_path.h"
 #include "bgp/bgp_peer.h"
+#include "bgp/bgp_peer_close.h"
 #include "bgp/bgp_peer_types.h"
 #include "bgp/bgp_ribout.h"
 #include "bgp/bgp_ribout_updates.h"
@@ -319,7 +323,7 @@ void IPeerRib::ManagedDelete() {
 // required.  Also create a WorkQueue to handle IPeerRibEvents.
 //
 PeerRibMembershipManager::PeerRibMembershipManager(BgpServer *server) :
-        server_(server) {
+        server_(server), unregister_peer_list_(NULL) {
     if (membership_task_id_ == -1) {
         TaskScheduler *scheduler = TaskScheduler::GetInstance();
         membership_task_id_ = scheduler->GetTaskId("bgp::PeerMembership");
@@ -336,6 +340,7 @@ PeerRibMembershipManager::PeerRibMembershipManager(BgpServer *server) :
 //
 PeerRibMembershipManager::~PeerRibMembershipManager() {
     delete event_queue_;
+    STLDeleteValues(&leave_walk_map_);
 }
 
 //
@@ -418,60 +423,111 @@ void PeerRibMembershipManager::JoinDone(DBTableBase *db,
 // In the meantime, we deactivate the IPeer in the RibOut to ensure that it
 // does not export any more routes.
 //
+// The requests in the list are folded into a LeaveWalkState so that the walk
+// handles all of them with a single pass over the paths of each route.
+//
 void PeerRibMembershipManager::Leave(BgpTable *table,
                               MembershipRequestList *request_list) {
+    static const int kRibInMask = MembershipRequest::RIBIN_STALE |
+        MembershipRequest::RIBIN_SWEEP | MembershipRequest::RIBIN_DELETE;
 
     DB *db = table->database();
+    LeaveWalkState *state = new LeaveWalkState;
+    state->request_list = request_list;
 
     for (MembershipRequestList::iterator iter = request_list->begin();
              iter != request_list->end(); iter++) {
         MembershipRequest *request = iter.operator->();
 
-        if (!(request->action_mask & MembershipRequest::RIBOUT_DELETE)) {
+        IPeerRib *peer_rib = IPeerRibFind(request->ipeer, table);
+        if (!peer_rib) {
             continue;
         }
 
-        IPeerRib *peer_rib = IPeerRibFind(request->ipeer, table);
-
-        if (peer_rib) {
+        if (request->action_mask & MembershipRequest::RIBOUT_DELETE) {
 
             // 
             // Ignore peer ribs which are already in close process
             //
             if (peer_rib->IsRibOutActive()) peer_rib->DeactivateRibOut();
+
+            if (peer_rib->IsRibOutRegistered()) {
+                RibOut *ribout = peer_rib->ribout();
+                state->ribout_peers[ribout].set(
+                    ribout->GetPeerIndex(request->ipeer));
+            }
+        }
+
+        int ribin_action = request->action_mask & kRibInMask;
+        if (!ribin_action || !peer_rib->IsRibInRegistered()) {
+            continue;
+        }
+
+        //
+        // The same peer may have more than one request in the list. A delete
+        // overrides any other action, otherwise the later request wins.
+        //
+        LeaveWalkState::RibInPeerMap::iterator loc =
+            state->ribin_peers.find(request->ipeer);
+        if (loc == state->ribin_peers.end()) {
+            state->ribin_peers.insert(std::make_pair(request->ipeer,
+                std::make_pair(peer_rib, ribin_action)));
+        } else if (!(loc->second.second & MembershipRequest::RIBIN_DELETE)) {
+            loc->second.second = ribin_action;
         }
     }
 
+    leave_walk_map_.insert(std::make_pair(table, state));
+    leave_stats_.walks_in_progress++;
+    state->start_time = UTCTimestampUsec();
+
     DBTableWalker *walker = db->GetWalker();
     walker->WalkTable(table, NULL,
         // _1: DBTablePartBase, _2: DBEntry
         boost::bind(&PeerRibMembershipManager::RouteLeave, this, _1, _2, table,
-                    request_list),
+                    state),
         // _1: DBTableBase
-        boost::bind(&PeerRibMembershipManager::LeaveDone, this, _1,
-                    request_list));
+        boost::bind(&PeerRibMembershipManager::LeaveDone, this, _1, state));
 }
 
 //
 // Concurrency: Runs in the context of the db walker task triggered from
 // BGP peer membership task.
 //
-// Leave the route from RibIn and from RibOut
+// Leave the route from RibOut and from RibIn. RibOut leave is done once for
+// each RibOut with the mask of all the leaving peers. The path list is then
+// walked once and each path from a leaving peer is staled, swept or deleted
+// as requested.
 //
 bool PeerRibMembershipManager::RouteLeave(DBTablePartBase *root,
                                           DBEntryBase *db_entry,
                                           BgpTable *table,
-                                          MembershipRequestList *request_list) {
-    for (MembershipRequestList::iterator iter = request_list->begin();
-             iter != request_list->end(); iter++) {
-        MembershipRequest *request = iter.operator->();
+                                          LeaveWalkState *state) {
+    for (LeaveWalkState::RibOutPeerMap::const_iterator it =
+         state->ribout_peers.begin(); it != state->ribout_peers.end(); ++it) {
+        it->first->bgp_export()->Leave(root, it->second, db_entry);
+    }
 
-        IPeerRib  *peer_rib = IPeerRibFind(request->ipeer, table);
-        if (peer_rib == NULL) {
-            continue;
-        }
-        peer_rib->RibOutLeave(root, db_entry, table, request->action_mask);
-        peer_rib->RibInLeave(root, db_entry, table, request->action_mask);
+    if (state->ribin_peers.empty()) {
+        return true;
+    }
+
+    BgpRoute *rt = static_cast<BgpRoute *>(db_entry);
+    for (Route::PathList::iterator it = rt->GetPathList().begin(), next = it;
+         it != rt->GetPathList().end(); it = next) {
+        next++;
+
+        // Skip secondary paths.
+        if (dynamic_cast<BgpSecondaryPath *>(it.operator->())) continue;
+        BgpPath *path = static_cast<BgpPath *>(it.operator->());
+
+        LeaveWalkState::RibInPeerMap::const_iterator loc =
+            state->ribin_peers.find(path->GetPeer());
+        if (loc == state->ribin_peers.end()) continue;
+
+        IPeerRib *peer_rib = loc->second.first;
+        peer_rib->ipeer()->peer_close()->close_manager()->ProcessRibInPath(
+            root, rt, path, table, loc->second.second);
     }
     return true;
 }
@@ -499,15 +555,52 @@ void PeerRibMembershipManager::MembershipRequestListDebug(
 // task.
 //
 void PeerRibMembershipManager::LeaveDone(DBTableBase *db,
-                                         MembershipRequestList *request_list) {
+                                         LeaveWalkState *state) {
     BgpTable *table = static_cast<BgpTable *>(db);
 
+    state->end_time = UTCTimestampUsec();
     IPeerRibEvent *event =
         new IPeerRibEvent(IPeerRibEvent::UNREGISTER_RIB_COMPLETE, NULL, table,
-                          request_list);
+                          state->request_list);
     Enqueue(event);
 }
 
+//
+// Concurrency: Runs in the context of the BGP peer membership task.
+//
+// Account for a completed Leave walk and free the walk state.
+//
+void PeerRibMembershipManager::UpdateLeaveStats(BgpTable *table) {
+    LeaveWalkStateMap::iterator loc = leave_walk_map_.find(table);
+    if (loc == leave_walk_map_.end()) {
+        return;
+    }
+    LeaveWalkState *state = loc->second;
+    leave_walk_map_.erase(loc);
+
+    uint64_t elapsed = state->end_time - state->start_time;
+    uint32_t requests = state->request_list->size();
+    leave_stats_.walks++;
+    leave_stats_.walks_in_progress--;
+    leave_stats_.requests += requests;
+    leave_stats_.max_requests = std::max(leave_stats_.max_requests, requests);
+    leave_stats_.total_usec += elapsed;
+    leave_stats_.last_usec = elapsed;
+    leave_stats_.max_usec = std::max(leave_stats_.max_usec, elapsed);
+    delete state;
+}
+
+void PeerRibMembershipManager::FillLeaveStats(
+        ShowPeerMembershipResp *resp) const {
+    resp->set_leave_walks(leave_stats_.walks);
+    resp->set_leave_requests(leave_stats_.requests);
+    resp->set_max_requests_per_walk(leave_stats_.max_requests);
+    resp->set_leave_walks_in_progress(leave_stats_.walks_in_progress);
+    resp->set_total_leave_walk_usec(leave_stats_.total_usec);
+    resp->set_last_leave_walk_usec(leave_stats_.last_usec);
+    resp->set_max_leave_walk_usec(leave_stats_.max_usec);
+}
+
 //
 // Process Register/Unregister request for a peer with a particular rib
 //
@@ -591,6 +684,7 @@ void PeerRibMembershipManager::Register(
 
     if (event) {
         Enqueue(event);
+        CloseUnregisterPeerList();
     }
 }
 
@@ -616,6 +710,7 @@ void PeerRibMembershipManager::Unregister(IPeer *ipeer, BgpTable *table,
                                           table, request);
     if (event) {
         Enqueue(event);
+        CloseUnregisterPeerList();
     }
 }
 
@@ -624,35 +719,95 @@ void PeerRibMembershipManager::Unregister(IPeer *ipeer, BgpTable *table,
 //
 // Unregister request for an ipeer from all the ribs it has registered to.
 //
-// Enqueue a request to peer rib membership manager
+// The request is added to the list of the last UNREGISTER_PEER event that
+// is still pending, if there's one. Otherwise a new event is enqueued to the
+// peer rib membership manager.
 //
 void PeerRibMembershipManager::UnregisterPeer(IPeer *ipeer,
         MembershipRequest::ActionGetFn action_get_fn,
         MembershipRequest::NotifyCompletionFn notify_completion_fn) {
-    IPeerRibEvent *event = new IPeerRibEvent(IPeerRibEvent::UNREGISTER_PEER,
-                                             ipeer, NULL);
+    MembershipRequest request;
+    request.ipeer = ipeer;
+    request.action_get_fn = action_get_fn;
+    request.notify_completion_fn = notify_completion_fn;
 
-    event->request.action_get_fn = action_get_fn;
-    event->request.notify_completion_fn = notify_completion_fn;
-    Enqueue(event);
+    tbb::mutex::scoped_lock lock(unregister_peer_mutex_);
+    if (!unregister_peer_list_) {
+        unregister_peer_list_ = new MembershipRequestList();
+        IPeerRibEvent *event = new IPeerRibEvent(
+            IPeerRibEvent::UNREGISTER_PEER, NULL, NULL, unregister_peer_list_);
+        Enqueue(event);
+    }
+    unregister_peer_list_->push_back(request);
+}
+
+//
+// Stop adding peers to the list of the pending UNREGISTER_PEER event. Called
+// after other events are enqueued so that a later UnregisterPeer is not
+// processed ahead of them.
+//
+void PeerRibMembershipManager::CloseUnregisterPeerList() {
+    tbb::mutex::scoped_lock lock(unregister_peer_mutex_);
+    unregister_peer_list_ = NULL;
 }
 
 //
 // Concurrency: Runs in the context of the BGP peer membership task.
 //
-// Callback where in we can start unregistering a peer from all of its ribs
+// Callback where in we can start unregistering a batch of peers from all of
+// their ribs.
+//
+// Requests for all the peers are added to the per table request lists before
+// any of the walks is started. This way all the peers in the batch leave a
+// given table in the same walk.
 //
 void PeerRibMembershipManager::UnregisterPeerCallback(IPeerRibEvent *event) {
     CHECK_CONCURRENCY("bgp::PeerMembership");
 
+    MembershipRequestList *peer_list = event->request_list;
+    {
+        tbb::mutex::scoped_lock lock(unregister_peer_mutex_);
+        if (unregister_peer_list_ == peer_list) {
+            unregister_peer_list_ = NULL;
+        }
+    }
+
+    std::vector<IPeerRibEvent *> process_events;
+    for (MembershipRequestList::const_iterator iter = peer_list->begin();
+         iter != peer_list->end(); ++iter) {
+        UnregisterPeerInternal(*iter, &process_events);
+    }
+    delete peer_list;
+
+    //
+    // We are already running in membership task. Invoke the callback
+    // right away. This is required also to serialize rib membership
+    // requests. Unregister peer request should not get mangled with other
+    // explicit register/unregister requests
+    //
+    for (std::vector<IPeerRibEvent *>::iterator it = process_events.begin();
+         it != process_events.end(); ++it) {
+        IPeerRibEventCallbackUnlocked(*it);
+    }
+}
+
+//
+// Concurrency: Runs in the context of the BGP peer membership task.
+//
+// Add an unregister request for each of the ribs of a peer. Events for the
+// tables that don't have a pending request yet are returned in events.
+//
+void PeerRibMembershipManager::UnregisterPeerInternal(
+        const MembershipRequest &peer_request,
+        std::vector<IPeerRibEvent *> *events) {
     PeerRibMap::const_iterator it;
     int *count = NULL;
 
     // Walk the set and find all the ribs this peer has registered to.
     // Unregister the peer from each of those ribs
-    for (it = peer_rib_map_.find(event->ipeer); it != peer_rib_map_.end();
-            it++) {
-        if (it->first != event->ipeer) break;
+    for (it = peer_rib_map_.find(peer_request.ipeer);
+         it != peer_rib_map_.end(); it++) {
+        if (it->first != peer_request.ipeer) break;
         IPeerRib *peer_rib = it->second;
 
         // 
@@ -665,25 +820,18 @@ void PeerRibMembershipManager::UnregisterPeerCallback(IPeerRibEvent *event) {
         ++*count;
 
         MembershipRequest request;
-        request.ipeer = event->ipeer;
+        request.ipeer = peer_request.ipeer;
         request.action_mask = static_cast<MembershipRequest::Action>(
-            event->request.action_get_fn(peer_rib));
+            peer_request.action_get_fn(peer_rib));
         request.notify_completion_fn = boost::bind(
             &PeerRibMembershipManager::UnregisterPeerDone,
-            this, _1, _2, count, event->request.notify_completion_fn);
+            this, _1, _2, count, peer_request.notify_completion_fn);
 
         IPeerRibEvent *process_event;
         process_event = ProcessRequest(IPeerRibEvent::UNREGISTER_RIB,
                                        peer_rib->table(), request);
-
-        //
-        // We are already running in membership task. Invoke the callback
-        // right away. This is required also to serialize rib membership
-        // requests. Unregister peer request should not get mangled with other
-        // explicit register/unregister requests
-        //
         if (process_event) {
-            IPeerRibEventCallbackUnlocked(process_event);
+            events->push_back(process_event);
         }
     }
 
@@ -691,7 +839,7 @@ void PeerRibMembershipManager::UnregisterPeerCallback(IPeerRibEvent *event) {
     // If there are no peer_ribs to unregister, notify completion right away
     //
     if (!count) {
-        event->request.notify_completion_fn(event->ipeer, NULL);
+        peer_request.notify_completion_fn(peer_request.ipeer, NULL);
     }
 }
 
@@ -1079,6 +1227,7 @@ void PeerRibMembershipManager::IPeerRibEventCallbackUnlocked(
     case IPeerRibEvent::UNREGISTER_RIB_COMPLETE:
 
         // Unregistration for a set of peers from a rib is complete
+        UpdateLeaveStats(event->table);
         ProcessUnregisterRibCompleteEvent(event);
 
         // Check if there are any new registrations pending
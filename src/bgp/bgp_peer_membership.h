@@ -5,6 +5,7 @@
 #ifndef __BGP_PEER_MEMBERSHIP_H__
 #define __BGP_PEER_MEMBERSHIP_H__
 
+#include <map>
 #include <set>
 
 #include "base/lifetime.h"
@@ -21,6 +22,7 @@ class PeerRibMembershipManager;
 class RibOut;
 class ShowRoutingInstanceTable;
 class BgpNeighborResp;
+class ShowPeerMembershipResp;
 
 struct MembershipRequest {
 public:
@@ -113,6 +115,7 @@ public:
 
     IPeer *ipeer() { return ipeer_; }
     BgpTable *table() { return table_; }
+    RibOut *ribout() { return ribout_; }
 
     void SetStale() { stale_ = true; }
     void ResetStale() { stale_ = false; }
@@ -188,6 +191,12 @@ struct IPeerRibCompare {
 // spreading it out over multiple IPeers or BgpTables, makes it possible to
 // optimize regsiter/unregister processing in future.
 //
+// Requests to unregister whole peers are batched. All UnregisterPeer calls
+// made before the BGP peer membership task gets to run are handled by a
+// single UNREGISTER_PEER event, so that a burst of closing peers results in
+// one table walk per BgpTable. The walk visits the paths of each route once
+// and processes the paths of all the leaving peers in that pass.
+//
 class PeerRibMembershipManager {
 public:
     typedef std::set<IPeerRib *, IPeerRibCompare> PeerRibSet;
@@ -196,6 +205,21 @@ public:
     typedef MembershipRequest::NotifyCompletionFn NotifyCompletionFn;
     static const int kMembershipTaskInstanceId = 0;
 
+    // Statistics for the table walks done to leave peers from tables.
+    struct LeaveStats {
+        LeaveStats()
+            : walks(0), requests(0), max_requests(0), walks_in_progress(0),
+              total_usec(0), last_usec(0), max_usec(0) {
+        }
+        uint64_t walks;
+        uint64_t requests;
+        uint32_t max_requests;
+        uint32_t walks_in_progress;
+        uint64_t total_usec;
+        uint64_t last_usec;
+        uint64_t max_usec;
+    };
+
     PeerRibMembershipManager(BgpServer *server);
     virtual ~PeerRibMembershipManager();
 
@@ -225,6 +249,8 @@ public:
     IPeerRib *IPeerRibFind(IPeer *ipeer, BgpTable *table);
     bool IsQueueEmpty() { return event_queue_->IsQueueEmpty(); }
     void FillRegisteredTable(IPeer *peer, std::vector<std::string> &list);
+    void FillLeaveStats(ShowPeerMembershipResp *resp) const;
+    const LeaveStats &leave_stats() const { return leave_stats_; }
 
 private:
     friend class BgpServerUnitTest;
@@ -235,6 +261,27 @@ private:
     typedef std::multimap<const BgpTable *, IPeer *> RibPeerMap;
     typedef std::multimap<const IPeer *, IPeerRib *> PeerRibMap;
 
+    //
+    // State for a Leave table walk. It's built before the walk is started so
+    // that the per route work does not depend on the number of requests in
+    // the list. RibIn actions are looked up by the peer of each path, and
+    // RibOut leaves are aggregated into a single mask per RibOut.
+    //
+    struct LeaveWalkState {
+        typedef std::map<const IPeer *, std::pair<IPeerRib *, int> >
+            RibInPeerMap;
+        typedef std::map<RibOut *, RibPeerSet> RibOutPeerMap;
+
+        LeaveWalkState() : request_list(NULL), start_time(0), end_time(0) { }
+
+        MembershipRequestList *request_list;
+        RibInPeerMap ribin_peers;
+        RibOutPeerMap ribout_peers;
+        uint64_t start_time;
+        uint64_t end_time;
+    };
+    typedef std::map<BgpTable *, LeaveWalkState *> LeaveWalkStateMap;
+
     void Join(BgpTable *table, MembershipRequestList *request_list);
     bool RouteJoin(DBTablePartBase *root, DBEntryBase *db_entry,
                    BgpTable *table, MembershipRequestList *request_list);
@@ -242,13 +289,17 @@ private:
 
     void Leave(BgpTable *table, MembershipRequestList *request_list);
     bool RouteLeave(DBTablePartBase *root, DBEntryBase *db_entry,
-                    BgpTable *table, MembershipRequestList *request_list);
-    void LeaveDone(DBTableBase *db, MembershipRequestList *request_list);
+                    BgpTable *table, LeaveWalkState *state);
+    void LeaveDone(DBTableBase *db, LeaveWalkState *state);
+    void UpdateLeaveStats(BgpTable *table);
 
     IPeerRibEvent *ProcessRequest(IPeerRibEvent::EventType event_type,
                                   BgpTable *table,
                                   const MembershipRequest &request);
     void UnregisterPeerCallback(IPeerRibEvent *event);
+    void UnregisterPeerInternal(const MembershipRequest &peer_request,
+                                std::vector<IPeerRibEvent *> *events);
+    void CloseUnregisterPeerList();
     void UnregisterPeerDone(IPeer *ipeer, BgpTable *table, int *count,
              MembershipRequest::NotifyCompletionFn notify_completion_fn);
     void UnregisterPeerCompleteCallback(IPeerRibEvent *event);
@@ -281,6 +332,15 @@ private:
     TableMembershipRequestMap unregister_request_map_;
     tbb::mutex mutex_;
 
+    // Request list of the pending UNREGISTER_PEER event that new peers can
+    // still be added to. Protected by a separate mutex since UnregisterPeer
+    // is also invoked from completion callbacks that run with mutex_ held.
+    MembershipRequestList *unregister_peer_list_;
+    tbb::mutex unregister_peer_mutex_;
+
+    LeaveWalkStateMap leave_walk_map_;
+    LeaveStats leave_stats_;
+
     DISALLOW_COPY_AND_ASSIGN(PeerRibMembershipManager);
 };
 
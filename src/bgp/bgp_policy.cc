@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/bgp_policy.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "bgp/inet/inet_route.h"
+#include "bgp/rtarget/rtarget_address.h"
+
+using std::string;
+using std::vector;
+
+static bool ParseCommunity(const string &str, uint32_t *value) {
+    if (str == "no-export") {
+        *value = Community::NoExport;
+        return true;
+    }
+    if (str == "no-advertise") {
+        *value = Community::NoAdvertise;
+        return true;
+    }
+    if (str == "no-export-subconfed") {
+        *value = Community::NoExportSubconfed;
+        return true;
+    }
+
+    size_t pos = str.find(':');
+    if (pos == 0 || pos == string::npos || pos == str.size() - 1)
+        return false;
+    char *end;
+    unsigned long asn = strtoul(str.c_str(), &end, 10);
+    if (*end != ':' || asn > 0xFFFF)
+        return false;
+    unsigned long num = strtoul(str.c_str() + pos + 1, &end, 10);
+    if (*end != '\0' || num > 0xFFFF)
+        return false;
+    *value = (asn << 16) | num;
+    return true;
+}
+
+static bool IsExtCommunity(const string &str) {
+    return (str.compare(0, 7, "target:") == 0);
+}
+
+static bool ParseExtCommunity(const string &str,
+                              ExtCommunity::ExtCommunityValue *value) {
+    boost::system::error_code ec;
+    RouteTarget rtarget = RouteTarget::FromString(str, &ec);
+    if (ec)
+        return false;
+    *value = rtarget.GetExtCommunity();
+    return true;
+}
+
+//
+// Parse a list of community strings into the standard and extended lists.
+//
+static bool ParseCommunityList(const vector<string> &list,
+        vector<uint32_t> *communities,
+        ExtCommunity::ExtCommunityList *ext_communities) {
+    for (vector<string>::const_iterator it = list.begin();
+         it != list.end(); ++it) {
+        if (IsExtCommunity(*it)) {
+            ExtCommunity::ExtCommunityValue value;
+            if (!ext_communities || !ParseExtCommunity(*it, &value))
+                return false;
+            ext_communities->push_back(value);
+        } else {
+            uint32_t value;
+            if (!ParseCommunity(*it, &value))
+                return false;
+            communities->push_back(value);
+        }
+    }
+    return true;
+}
+
+static bool ContainsAll(const vector<uint32_t> &list,
+                        const vector<uint32_t> &values) {
+    for (vector<uint32_t>::const_iterator it = values.begin();
+         it != values.end(); ++it) {
+        if (std::find(list.begin(), list.end(), *it) == list.end())
+            return false;
+    }
+    return true;
+}
+
+//
+// Extended communities added by earlier terms are matched as well.
+//
+static bool ContainsAll(const ExtCommunity::ExtCommunityList &list,
+                        const ExtCommunity::ExtCommunityList &added,
+                        const ExtCommunity::ExtCommunityList &values) {
+    for (ExtCommunity::ExtCommunityList::const_iterator it = values.begin();
+         it != values.end(); ++it) {
+        if (std::find(list.begin(), list.end(), *it) == list.end() &&
+            std::find(added.begin(), added.end(), *it) == added.end())
+            return false;
+    }
+    return true;
+}
+
+BgpPolicy::Instruction::Instruction()
+    : match(0), signature(0), prefix(0), mask(0), prefixlen(0),
+      local_pref(0), update(0), set_community(false), update_local_pref(0),
+      action(BgpPolicyTerm::NEXT) {
+}
+
+BgpPolicy::BgpPolicy(const string &name)
+    : name_(name), attribute_only_(true) {
+}
+
+BgpPolicy *BgpPolicy::Compile(const string &name, const TermList &terms) {
+    BgpPolicy *policy = new BgpPolicy(name);
+    policy->program_.resize(terms.size());
+    for (size_t idx = 0; idx < terms.size(); ++idx) {
+        if (!policy->CompileTerm(terms[idx], &policy->program_[idx])) {
+            delete policy;
+            return NULL;
+        }
+    }
+    return policy;
+}
+
+//
+// Fold a set of communities into a 64 bit signature. A term can only match
+// if all bits of its signature are present in the signature of the route.
+//
+uint64_t BgpPolicy::Signature(const vector<uint32_t> &communities) {
+    uint64_t signature = 0;
+    for (vector<uint32_t>::const_iterator it = communities.begin();
+         it != communities.end(); ++it) {
+        signature |= (1ULL << ((*it * 2654435761U) >> 26));
+    }
+    return signature;
+}
+
+bool BgpPolicy::CompileTerm(const BgpPolicyTerm &term, Instruction *insn) {
+    if (!ParseCommunityList(term.match_community, &insn->communities,
+                            &insn->ext_communities)) {
+        return false;
+    }
+    if (!insn->communities.empty()) {
+        insn->match |= MATCH_COMMUNITY;
+        insn->signature = Signature(insn->communities);
+    }
+    if (!insn->ext_communities.empty()) {
+        insn->match |= MATCH_EXT_COMMUNITY;
+    }
+
+    if (!term.match_prefix.empty()) {
+        boost::system::error_code ec;
+        Ip4Prefix prefix = Ip4Prefix::FromString(term.match_prefix, &ec);
+        if (ec || prefix.prefixlen() < 0 || prefix.prefixlen() > 32)
+            return false;
+        insn->match |= MATCH_PREFIX;
+        insn->prefixlen = prefix.prefixlen();
+        insn->mask = insn->prefixlen ?
+            (0xFFFFFFFFU << (32 - insn->prefixlen)) : 0;
+        insn->prefix = prefix.ip4_addr().to_ulong() & insn->mask;
+        attribute_only_ = false;
+    }
+
+    if (term.match_local_pref) {
+        insn->match |= MATCH_LOCAL_PREF;
+        insn->local_pref = term.match_local_pref;
+    }
+
+    if (!term.set_community.empty()) {
+        insn->set_community = true;
+        if (!ParseCommunityList(term.set_community, &insn->add_communities,
+                                NULL)) {
+            return false;
+        }
+    }
+    if (!ParseCommunityList(term.add_community, &insn->add_communities,
+                            &insn->add_ext_communities) ||
+        !ParseCommunityList(term.remove_community, &insn->remove_communities,
+                            NULL)) {
+        return false;
+    }
+    if (insn->set_community || !insn->add_communities.empty() ||
+        !insn->remove_communities.empty()) {
+        insn->update |= UPDATE_COMMUNITY;
+    }
+    if (!insn->add_ext_communities.empty()) {
+        insn->update |= UPDATE_EXT_COMMUNITY;
+    }
+    if (term.update_local_pref) {
+        insn->update |= UPDATE_LOCAL_PREF;
+        insn->update_local_pref = term.update_local_pref;
+    }
+
+    insn->action = term.action;
+    return true;
+}
+
+bool BgpPolicy::Evaluate(const Ip4Prefix *prefix, BgpAttrPtr *attr) const {
+    static const vector<uint32_t> kEmptyList;
+    static const ExtCommunity::ExtCommunityList kEmptyExtList;
+
+    const BgpAttr *in = attr->get();
+    const vector<uint32_t> *communities = in->community() ?
+        &in->community()->communities() : &kEmptyList;
+    const ExtCommunity::ExtCommunityList &ext_communities =
+        in->ext_community() ?
+        in->ext_community()->communities() : kEmptyExtList;
+    uint64_t signature = Signature(*communities);
+    uint32_t address = prefix ? prefix->ip4_addr().to_ulong() : 0;
+    uint32_t local_pref = in->local_pref();
+
+    // Working copies, only populated once a term updates them.
+    vector<uint32_t> community_list;
+    ExtCommunity::ExtCommunityList ext_community_add;
+    uint32_t updated = 0;
+
+    for (Program::const_iterator it = program_.begin();
+         it != program_.end(); ++it) {
+        const Instruction &insn = *it;
+
+        if (insn.match) {
+            if ((insn.signature & ~signature) != 0)
+                continue;
+            if ((insn.match & MATCH_PREFIX) &&
+                (!prefix || prefix->prefixlen() < insn.prefixlen ||
+                 (address & insn.mask) != insn.prefix)) {
+                continue;
+            }
+            if ((insn.match & MATCH_LOCAL_PREF) &&
+                local_pref != insn.local_pref) {
+                continue;
+            }
+            if ((insn.match & MATCH_COMMUNITY) &&
+                !ContainsAll(*communities, insn.communities)) {
+                continue;
+            }
+            if ((insn.match & MATCH_EXT_COMMUNITY) &&
+                !ContainsAll(ext_communities, ext_community_add,
+                             insn.ext_communities)) {
+                continue;
+            }
+        }
+
+        if (insn.update & UPDATE_COMMUNITY) {
+            if (communities != &community_list) {
+                community_list = *communities;
+                communities = &community_list;
+            }
+            if (insn.set_community)
+                community_list.clear();
+            for (vector<uint32_t>::const_iterator add_it =
+                 insn.add_communities.begin();
+                 add_it != insn.add_communities.end(); ++add_it) {
+                if (std::find(community_list.begin(), community_list.end(),
+                              *add_it) == community_list.end()) {
+                    community_list.push_back(*add_it);
+                }
+            }
+            for (vector<uint32_t>::const_iterator rm_it =
+                 insn.remove_communities.begin();
+                 rm_it != insn.remove_communities.end(); ++rm_it) {
+                community_list.erase(std::remove(community_list.begin(),
+                    community_list.end(), *rm_it), community_list.end());
+            }
+            signature = Signature(community_list);
+        }
+        if (insn.update & UPDATE_EXT_COMMUNITY) {
+            ext_community_add.insert(ext_community_add.end(),
+                                     insn.add_ext_communities.begin(),
+                                     insn.add_ext_communities.end());
+        }
+        if (insn.update & UPDATE_LOCAL_PREF) {
+            local_pref = insn.update_local_pref;
+        }
+        updated |= insn.update;
+
+        if (insn.action == BgpPolicyTerm::REJECT)
+            return false;
+        if (insn.action == BgpPolicyTerm::ACCEPT)
+            break;
+    }
+
+    if (!updated)
+        return true;
+
+    BgpAttrDB *attr_db = in->attr_db();
+    BgpAttr *clone = new BgpAttr(*in);
+    if (updated & UPDATE_COMMUNITY) {
+        CommunitySpec spec;
+        spec.communities = community_list;
+        clone->set_community(community_list.empty() ? NULL : &spec);
+    }
+    if (updated & UPDATE_EXT_COMMUNITY) {
+        ExtCommunityDB *extcomm_db = attr_db->server()->extcomm_db();
+        clone->set_ext_community(extcomm_db->AppendAndLocate(
+            in->ext_community(), ext_community_add));
+    }
+    if (updated & UPDATE_LOCAL_PREF) {
+        clone->set_local_pref(local_pref);
+    }
+    *attr = attr_db->Locate(clone);
+    return true;
+}
+
+bool BgpPolicyCache::Evaluate(const BgpPolicyPtr &policy,
+                              const Ip4Prefix *prefix, BgpAttrPtr *attr) {
+    if (!policy->attribute_only())
+        return policy->Evaluate(prefix, attr);
+
+    // Results of a policy that has been replaced are stale.
+    if (policy != policy_) {
+        cache_.clear();
+        policy_ = policy;
+    }
+
+    const BgpAttr *key = attr->get();
+    CacheMap::const_iterator loc = cache_.find(key);
+    if (loc != cache_.end()) {
+        hits_++;
+        if (loc->second.accept)
+            *attr = loc->second.result;
+        return loc->second.accept;
+    }
+
+    misses_++;
+    if (cache_.size() >= kMaxEntries)
+        cache_.clear();
+
+    CacheEntry entry;
+    entry.key = *attr;
+    entry.accept = policy->Evaluate(prefix, attr);
+    entry.result = *attr;
+    cache_.insert(std::make_pair(key, entry));
+    return entry.accept;
+}
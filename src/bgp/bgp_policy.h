@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef ctrlplane_bgp_policy_h
+#define ctrlplane_bgp_policy_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "bgp/bgp_attr.h"
+#include "bgp/community.h"
+
+class Ip4Prefix;
+
+//
+// Configuration of a single term of a routing policy. The layout follows
+// the PolicyTerm in the routing policy schema: a set of match conditions
+// that must all be true, a set of attribute updates and a terminal action.
+// Communities are given as "asn:value" or "target:asn:value" strings.
+//
+struct BgpPolicyTerm {
+    enum Action {
+        NEXT,
+        ACCEPT,
+        REJECT
+    };
+
+    BgpPolicyTerm() : match_local_pref(0), action(NEXT), update_local_pref(0) {
+    }
+
+    std::string name;
+
+    // Match conditions. Empty or 0 matches everything.
+    std::vector<std::string> match_community;
+    std::string match_prefix;
+    uint32_t match_local_pref;
+
+    // Updates applied when the term matches.
+    Action action;
+    std::vector<std::string> add_community;
+    std::vector<std::string> remove_community;
+    std::vector<std::string> set_community;
+    uint32_t update_local_pref;
+};
+
+//
+// A routing policy compiled into a flat program. Each term is reduced to a
+// bitmask of the conditions to check, pre-parsed community values, a masked
+// prefix and the updates to apply. Communities required by a term are also
+// folded into a 64 bit signature so that terms which can't match the route's
+// communities are skipped with a single AND.
+//
+// Evaluation does not allocate while walking the terms. Updates accumulate
+// in a working copy and a new BgpAttr is located only once at the end, if
+// anything changed.
+//
+// The program is immutable after compilation and can be evaluated from
+// multiple tasks concurrently.
+//
+class BgpPolicy {
+public:
+    typedef std::vector<BgpPolicyTerm> TermList;
+
+    // Returns NULL if any of the terms can't be parsed.
+    static BgpPolicy *Compile(const std::string &name, const TermList &terms);
+
+    // Evaluate the policy for a route with the given prefix and attributes.
+    // The prefix may be NULL for families other than inet, in which case
+    // terms with a prefix condition never match. Returns false if the route
+    // is rejected. Otherwise attr is updated with the resulting attributes.
+    bool Evaluate(const Ip4Prefix *prefix, BgpAttrPtr *attr) const;
+
+    // True if the result depends only on the attributes of the route and
+    // can be cached per BgpAttr.
+    bool attribute_only() const { return attribute_only_; }
+
+    const std::string &name() const { return name_; }
+    size_t term_count() const { return program_.size(); }
+
+private:
+    enum MatchFlags {
+        MATCH_COMMUNITY = 1 << 0,
+        MATCH_EXT_COMMUNITY = 1 << 1,
+        MATCH_PREFIX = 1 << 2,
+        MATCH_LOCAL_PREF = 1 << 3
+    };
+
+    enum UpdateFlags {
+        UPDATE_COMMUNITY = 1 << 0,
+        UPDATE_EXT_COMMUNITY = 1 << 1,
+        UPDATE_LOCAL_PREF = 1 << 2
+    };
+
+    struct Instruction {
+        Instruction();
+
+        uint32_t match;
+        uint64_t signature;
+        std::vector<uint32_t> communities;
+        ExtCommunity::ExtCommunityList ext_communities;
+        uint32_t prefix;
+        uint32_t mask;
+        int prefixlen;
+        uint32_t local_pref;
+
+        uint32_t update;
+        bool set_community;
+        std::vector<uint32_t> add_communities;
+        std::vector<uint32_t> remove_communities;
+        ExtCommunity::ExtCommunityList add_ext_communities;
+        uint32_t update_local_pref;
+
+        BgpPolicyTerm::Action action;
+    };
+    typedef std::vector<Instruction> Program;
+
+    explicit BgpPolicy(const std::string &name);
+    bool CompileTerm(const BgpPolicyTerm &term, Instruction *insn);
+    static uint64_t Signature(const std::vector<uint32_t> &communities);
+
+    std::string name_;
+    Program program_;
+    bool attribute_only_;
+
+    DISALLOW_COPY_AND_ASSIGN(BgpPolicy);
+};
+
+typedef boost::shared_ptr<const BgpPolicy> BgpPolicyPtr;
+
+//
+// Cache of policy results keyed by BgpAttr. BgpAttrs are interned in the
+// BgpAttrDB, so routes with identical attributes share the result. Only
+// policies that don't look at the prefix are cached.
+//
+// The results are for a single policy. The cache holds a reference to the
+// policy it was filled with and is flushed when it's used with a different
+// policy, so replacing a policy never returns results of the old one.
+//
+// The cache is not thread safe. Users keep one instance per DB partition or
+// per peer. The cache holds references to the attributes in it and is
+// flushed when it grows beyond kMaxEntries.
+//
+class BgpPolicyCache {
+public:
+    static const size_t kMaxEntries = 16 * 1024;
+
+    BgpPolicyCache() : hits_(0), misses_(0) { }
+
+    // Evaluate the policy, using the cached result if available.
+    bool Evaluate(const BgpPolicyPtr &policy, const Ip4Prefix *prefix,
+                  BgpAttrPtr *attr);
+    void clear() {
+        cache_.clear();
+        policy_.reset();
+    }
+
+    size_t size() const { return cache_.size(); }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+private:
+    struct CacheEntry {
+        BgpAttrPtr key;
+        BgpAttrPtr result;
+        bool accept;
+    };
+    typedef std::map<const BgpAttr *, CacheEntry> CacheMap;
+
+    BgpPolicyPtr policy_;
+    CacheMap cache_;
+    uint64_t hits_;
+    uint64_t misses_;
+};
+
+#endif  // ctrlplane_bgp_policy_h
@@ -1396,6 +1396,39 @@ void ShowBgpServerReq::HandleRequest() const {
     RequestPipeline rp(ps);
 }
 
+class ShowPeerMembershipHandler {
+public:
+    static bool CallbackS1(const Sandesh *sr,
+            const RequestPipeline::PipeSpec ps, int stage, int instNum,
+            RequestPipeline::InstData *data) {
+        const ShowPeerMembershipReq *req =
+            static_cast<const ShowPeerMembershipReq *>(ps.snhRequest_.get());
+        BgpSandeshContext *bsc =
+            static_cast<BgpSandeshContext *>(req->client_context());
+
+        ShowPeerMembershipResp *resp = new ShowPeerMembershipResp;
+        bsc->bgp_server->membership_mgr()->FillLeaveStats(resp);
+
+        resp->set_context(req->context());
+        resp->Response();
+        return true;
+    }
+};
+
+void ShowPeerMembershipReq::HandleRequest() const {
+    RequestPipeline::PipeSpec ps(this);
+
+    // Request pipeline has single stage to collect the statistics, which
+    // runs in the membership task since that is where they are updated
+    RequestPipeline::StageSpec s1;
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    s1.taskId_ = scheduler->GetTaskId("bgp::PeerMembership");
+    s1.cbFn_ = ShowPeerMembershipHandler::CallbackS1;
+    s1.instances_.push_back(0);
+    ps.stages_ = list_of(s1);
+    RequestPipeline rp(ps);
+}
+
 class ShowXmppServerHandler {
 public:
     static bool CallbackS1(const Sandesh *sr,
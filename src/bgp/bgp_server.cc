@@ -5,6 +5,7 @@
 #include "bgp/bgp_server.h"
 
 #include <boost/assign.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "base/logging.h"
 #include "base/lifetime.h"
@@ -202,7 +203,8 @@ BgpServer::BgpServer(EventManager *evm)
     : autonomous_system_(0), bgp_identifier_(0),
       lifetime_manager_(new LifetimeManager(
           TaskScheduler::GetInstance()->GetTaskId("bgp::Config"),
-          boost::bind(&BgpServer::IsReadyForDeletion, this))),
+          boost::bind(&BgpServer::IsReadyForDeletion, this),
+          kLifetimePartitions)),
       deleter_(new DeleteActor(this)),
       aspath_db_(new AsPathDB(this)),
       comm_db_(new CommunityDB(this)),
@@ -325,3 +327,13 @@ void BgpServer::VisitBgpPeers(BgpServer::VisitorFn fn) const {
         }
     }
 }
+
+//
+// The partitions all run in the bgp::Config task, which excludes itself, so
+// the actors of different instances are not destroyed concurrently. Spread
+// the instances so that a large subtree doesn't hold up the delete events of
+// the others in the same queue.
+//
+int BgpServer::LifetimePartition(const std::string &instance_name) {
+    return boost::hash<std::string>()(instance_name) % kLifetimePartitions;
+}
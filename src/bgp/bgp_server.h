@@ -35,6 +35,11 @@ class ServiceChainMgr;
 class BgpServer {
 public:
     typedef boost::function<void(BgpPeer *)> VisitorFn;
+
+    // The delete events of a routing instance and of its tables and peers
+    // are processed in the lifetime partition of the instance.
+    static const int kLifetimePartitions = 8;
+
     explicit BgpServer(EventManager *evm);
     virtual ~BgpServer();
 
@@ -50,6 +55,8 @@ public:
 
     void VisitBgpPeers(BgpServer::VisitorFn) const;
 
+    static int LifetimePartition(const std::string &instance_name);
+
     // accessors
     BgpSessionManager *session_manager() { return session_mgr_; }
     SchedulingGroupManager *scheduling_group_manager() {
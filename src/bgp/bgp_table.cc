@@ -10,6 +10,7 @@
 #include <sandesh/sandesh_types.h>
 #include <sandesh/sandesh.h>
 
+#include "db/db.h"
 #include "db/db_table_partition.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_path.h"
@@ -21,6 +22,7 @@
 #include "bgp/bgp_sandesh.h"
 #include "bgp/bgp_server.h"
 #include "bgp/bgp_update_queue.h"
+#include "bgp/inet/inet_route.h"
 #include "bgp/routing-instance/routing_instance.h"
 #include "bgp/routing-instance/rtarget_group.h"
 #include "bgp/routing-instance/rtarget_group_mgr.h"
@@ -30,7 +32,8 @@ using namespace std;
 class BgpTable::DeleteActor : public LifetimeActor {
   public:
     DeleteActor(BgpTable *table)
-        : LifetimeActor(table->rtinstance_->server()->lifetime_manager()),
+        : LifetimeActor(table->rtinstance_->server()->lifetime_manager(),
+                        table->rtinstance_->deleter()->partition()),
           table_(table) {
     }
     virtual ~DeleteActor() {
@@ -59,6 +62,7 @@ class BgpTable::DeleteActor : public LifetimeActor {
 BgpTable::BgpTable(DB *db, const string &name)
         : RouteTable(db, name),
           rtinstance_(NULL),
+          policy_cache_(DB::PartitionCount()),
           instance_delete_ref_(this, NULL) {
     primary_path_count_ = 0;
     secondary_path_count_ = 0;
@@ -134,6 +138,21 @@ UpdateInfo *BgpTable::GetUpdateInfo(RibOut *ribout, BgpRoute *route,
 
     RibPeerSet new_peerset = peerset;
 
+    // Apply the export policy of the routing instance.
+    BgpPolicyPtr policy;
+    if (rtinstance_)
+        policy = rtinstance_->export_policy();
+    if (policy) {
+        const Ip4Prefix *prefix = NULL;
+        if (family() == Address::INET)
+            prefix = &static_cast<InetRoute *>(route)->GetPrefix();
+        int part_id = route->get_table_partition()->index();
+        attr_ptr = attr;
+        if (!policy_cache_[part_id].Evaluate(policy, prefix, &attr_ptr))
+            return NULL;
+        attr = attr_ptr.get();
+    }
+
     // LocalPref, Med and AsPath manipulation is needed only if the RibOut
     // has BGP encoding. Similarly, well-known communities do not apply if
     // the encoding is not BGP.
@@ -6,6 +6,7 @@
 #define ctrlplane_bgp_table_h
 
 #include <map>
+#include <vector>
 #include <tbb/atomic.h>
 
 #include "base/lifetime.h"
@@ -13,6 +14,7 @@
 #include "bgp/bgp_update.h"
 #include "route/table.h"
 #include "bgp/bgp_path.h"
+#include "bgp/bgp_policy.h"
 #include "bgp_ribout.h"
 #include "db/db_table_walker.h"
 
@@ -127,6 +129,8 @@ private:
             const DBRequestKey *prefix) = 0;
     RoutingInstance *rtinstance_;
     RibOutMap ribout_map_;
+    // Results of the export policy of the routing instance, per partition
+    std::vector<BgpPolicyCache> policy_cache_;
 
     boost::scoped_ptr<DeleteActor> deleter_;
     LifetimeRef<BgpTable> instance_delete_ref_;
@@ -4,6 +4,8 @@
 
 #include "bgp/routing-instance/routepath_replicator.h"
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 
@@ -281,48 +283,37 @@ void RoutePathReplicator::Leave(BgpTable *table, const RouteTarget &rt,
     walk_trigger_->Set();
 }
 
+//
+// Replace the secondary paths in the dbstate with the current list and
+// delete the secondary paths that are no longer present.
+// Both lists are sorted, so a single merge pass finds the stale entries.
+//
 void 
 RoutePathReplicator::DBStateSync(BgpTable *table, BgpRoute *rt, 
                                  DBTableBase::ListenerId id,
                                  RtReplicated *dbstate,
                                  RtReplicated::ReplicatedRtPathList &current) {
-    RtReplicated::ReplicatedRtPathList::iterator cur_it = current.begin();
-    RtReplicated::ReplicatedRtPathList::iterator dbstate_next_it, dbstate_it;
-    dbstate_it = dbstate_next_it = dbstate->GetMutableList()->begin();
-    std::pair<RtReplicated::ReplicatedRtPathList::iterator, bool> r;
-
-    while (cur_it != current.end() && 
-           dbstate_it != dbstate->GetMutableList()->end()) {
-        if (*cur_it < *dbstate_it) {
-            // Add to DBstate
-            r = dbstate->GetMutableList()->insert(*cur_it);
-            assert(r.second);
-            cur_it++;
+    RtReplicated::ReplicatedRtPathList *list = dbstate->GetMutableList();
+    RtReplicated::ReplicatedRtPathList::const_iterator cur_it = current.begin();
+    RtReplicated::ReplicatedRtPathList::const_iterator dbstate_it =
+        list->begin();
 
-        } else if (*cur_it > *dbstate_it) {
+    while (dbstate_it != list->end()) {
+        if (cur_it == current.end() || *dbstate_it < *cur_it) {
             // Remove from DBstate
-            dbstate_next_it++;
             DeleteSecondaryPath(table, rt, *dbstate_it);
-            dbstate->GetMutableList()->erase(dbstate_it);
-            dbstate_it = dbstate_next_it;
+            ++dbstate_it;
+        } else if (*cur_it < *dbstate_it) {
+            // Add to DBstate
+            ++cur_it;
         } else {
             // Update
-            cur_it++;
-            dbstate_it++;
+            ++cur_it;
+            ++dbstate_it;
         }
-        dbstate_next_it = dbstate_it;
-    }
-    for (; cur_it != current.end(); ++cur_it) {
-        r = dbstate->GetMutableList()->insert(*cur_it);
-        assert(r.second);
-    }
-    for (dbstate_next_it = dbstate_it; 
-         dbstate_it != dbstate->GetMutableList()->end(); 
-         dbstate_it = dbstate_next_it) {
-        dbstate_next_it++;
-        DeleteSecondaryPath(table, rt, *dbstate_it);
-        dbstate->GetMutableList()->erase(dbstate_it);
     }
+    list->swap(current);
+
     if (dbstate->GetList().empty()) {
         rt->ClearState(table, id);
         delete dbstate;
@@ -438,7 +429,7 @@ bool RoutePathReplicator::BgpTableListener(DBTablePartBase *root,
         if (!ext_community)
             continue;
 
-        RtGroup::RtGroupMemberList super_set;
+        std::vector<BgpTable *> super_set;
 
         // Go through all extended communities.
         //
@@ -455,15 +446,21 @@ bool RoutePathReplicator::BgpTableListener(DBTablePartBase *root,
                 RtGroup *rtgroup = 
                     server()->rtarget_group_mgr()->GetRtGroup(comm);
                 if (!rtgroup) continue;
-                RtGroup::RtGroupMemberList import_list = 
+                const RtGroup::RtGroupMemberList &import_list = 
                     rtgroup->GetImportTables(family());
                 if (import_list.empty()) continue;
-                super_set.insert(import_list.begin(), import_list.end());
+                super_set.insert(super_set.end(), import_list.begin(),
+                                 import_list.end());
             }
         }
 
         if (super_set.empty()) continue;
 
+        // Tables may import more than one of the route targets
+        std::sort(super_set.begin(), super_set.end());
+        super_set.erase(std::unique(super_set.begin(), super_set.end()),
+                        super_set.end());
+
         // To all destination tables.. call replicate
         BOOST_FOREACH(BgpTable *dest, super_set) {
             // same as source table... skip
@@ -492,9 +489,7 @@ bool RoutePathReplicator::BgpTableListener(DBTablePartBase *root,
             if (replicated) {
                 RtReplicated::SecondaryRouteInfo rtinfo(dest, path->GetPeer(),
                             path->GetPathId(), path->GetSource(), replicated);
-                std::pair<RtReplicated::ReplicatedRtPathList::iterator, bool> r;
-                r = replicated_path_list.insert(rtinfo);
-                assert(r.second);
+                replicated_path_list.push_back(rtinfo);
                 RPR_TRACE_ONLY(Replicate, table->name(), rt->ToString(),
                           path->ToString(),
                           BgpPath::PathIdString(path->GetPathId()),
@@ -503,6 +498,7 @@ bool RoutePathReplicator::BgpTableListener(DBTablePartBase *root,
         }
     }
 
+    std::sort(replicated_path_list.begin(), replicated_path_list.end());
     DBStateSync(table, rt, id, dbstate, replicated_path_list);
     return true;
 }
@@ -6,6 +6,7 @@
 #define ctrlplane_routepath_replicator_h
 
 #include <list>
+#include <vector>
 
 #include <boost/ptr_container/ptr_map.hpp>
 #include <tbb/mutex.h>
@@ -117,7 +118,9 @@ public:
         std::string ToString() const; 
     };  
 
-    typedef std::set<SecondaryRouteInfo> ReplicatedRtPathList;
+    // Sorted vector of the secondary paths. It is rebuilt on every change
+    // to the primary route, so a vector is more compact than a set
+    typedef std::vector<SecondaryRouteInfo> ReplicatedRtPathList;
 
     // Get the list of replicated route for given Primary Route
     const ReplicatedRtPathList &GetList() const {
@@ -412,7 +412,9 @@ void RoutingInstanceMgr::DestroyRoutingInstance(RoutingInstance *rtinstance) {
 class RoutingInstance::DeleteActor : public LifetimeActor {
 public:
     DeleteActor(BgpServer *server, RoutingInstance *parent)
-            : LifetimeActor(server->lifetime_manager()), parent_(parent) {
+            : LifetimeActor(server->lifetime_manager(),
+                            BgpServer::LifetimePartition(parent->name())),
+              parent_(parent) {
     }
     virtual bool MayDelete() const {
         return parent_->MayDelete();
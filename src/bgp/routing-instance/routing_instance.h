@@ -21,6 +21,7 @@
 #include "base/lifetime.h"
 #include "bgp/bgp_condition_listener.h"
 #include "bgp/bgp_peer_key.h"
+#include "bgp/bgp_policy.h"
 #include "bgp/rtarget/rtarget_address.h"
 #include "bgp/ipeer.h"
 #include "bgp/inet/inet_route.h"
@@ -113,6 +114,12 @@ public:
     StaticRouteMgr *static_route_mgr() { return static_route_mgr_.get(); }
     PeerManager *peer_manager() { return peer_manager_.get(); }
 
+    // Policy applied to routes advertised from the tables of this instance.
+    // Set from the bgp::Config task. Routes already advertised are not
+    // re-evaluated till they change.
+    BgpPolicyPtr export_policy() const { return export_policy_; }
+    void set_export_policy(BgpPolicyPtr policy) { export_policy_ = policy; }
+
 private:
     class DeleteActor;
 
@@ -138,6 +145,7 @@ private:
     LifetimeRef<RoutingInstance> manager_delete_ref_;
     boost::scoped_ptr<StaticRouteMgr> static_route_mgr_;
     boost::scoped_ptr<PeerManager> peer_manager_;
+    BgpPolicyPtr export_policy_;
 };
 
 
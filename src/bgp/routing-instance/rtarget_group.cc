@@ -16,15 +16,19 @@ const RtGroup::RTargetDepRouteList &RtGroup::DepRouteList() const {
     return dep_;
 }
 
-const RtGroup::RtGroupMemberList RtGroup::GetImportTables(Address::Family family) const {
+static const RtGroup::RtGroupMemberList empty_member_list;
+
+const RtGroup::RtGroupMemberList &RtGroup::GetImportTables(
+        Address::Family family) const {
     RtGroupMembers::const_iterator loc = import_.find(family);
-    if (loc == import_.end()) return RtGroup::RtGroupMemberList();
+    if (loc == import_.end()) return empty_member_list;
     return loc->second;
 }
 
-const RtGroup::RtGroupMemberList RtGroup::GetExportTables(Address::Family family) const {
+const RtGroup::RtGroupMemberList &RtGroup::GetExportTables(
+        Address::Family family) const {
     RtGroupMembers::const_iterator loc = export_.find(family);
-    if (loc == export_.end()) return RtGroup::RtGroupMemberList();
+    if (loc == export_.end()) return empty_member_list;
     return loc->second;
 }
 
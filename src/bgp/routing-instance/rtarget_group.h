@@ -70,8 +70,8 @@ public:
         return export_;
     }
 
-    const RtGroupMemberList GetImportTables(Address::Family family) const;
-    const RtGroupMemberList GetExportTables(Address::Family family) const;
+    const RtGroupMemberList &GetImportTables(Address::Family family) const;
+    const RtGroupMemberList &GetExportTables(Address::Family family) const;
 
     bool AddImportTable(Address::Family family, BgpTable *tbl);
     bool AddExportTable(Address::Family family, BgpTable *tbl);
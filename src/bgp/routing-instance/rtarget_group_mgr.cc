@@ -197,6 +197,11 @@ void RTargetGroupMgr::RTargetPeerSync(BgpTable *table, RTargetRoute *rt,
         dbstate->GetMutableList()->erase(dbstate_it);
     }
 
+    if (pending_rtarget_trigger_list_.find(rtarget) !=
+        pending_rtarget_trigger_list_.end()) {
+        UpdateRTargetPeerIndex(rtarget, rtgroup);
+    }
+
     if (dbstate->GetList().empty()) {
         rt->ClearState(table, id);
         delete dbstate;
@@ -209,6 +214,21 @@ void RTargetGroupMgr::RTargetPeerSync(BgpTable *table, RTargetRoute *rt,
     }
 }
 
+//
+// Refresh the interested peers of the RouteTarget in the RTargetPeerIndex.
+// The entry is removed when there are no interested peers.
+//
+void RTargetGroupMgr::UpdateRTargetPeerIndex(const RouteTarget &rtarget,
+                                             const RtGroup *rtgroup) {
+    CHECK_CONCURRENCY("bgp::RTFilter");
+
+    if (rtgroup->peer_list_empty()) {
+        rtarget_peer_index_.erase(rtarget);
+    } else {
+        rtarget_peer_index_[rtarget] = rtgroup->GetInterestedPeers();
+    }
+}
+
 void RTargetGroupMgr::BuildRTargetDistributionGraph(BgpTable *table, 
                                 RTargetRoute *rt, DBTableBase::ListenerId id) {
     CHECK_CONCURRENCY("bgp::RTFilter");
@@ -527,14 +547,15 @@ void RTargetGroupMgr::GetRibOutInterestedPeers(RibOut *ribout,
              const ExtCommunity *ext_community, 
              const RibPeerSet &peerset, RibPeerSet &new_peerset) {
     RtGroupInterestedPeerSet peer_set; 
-    RtGroup *null_rtgroup = GetRtGroup(RouteTarget::null_rtarget);
-    if (null_rtgroup) peer_set = null_rtgroup->GetInterestedPeers();
+    RTargetPeerIndex::const_iterator loc =
+        rtarget_peer_index_.find(RouteTarget::null_rtarget);
+    if (loc != rtarget_peer_index_.end()) peer_set = loc->second;
     BOOST_FOREACH(const ExtCommunity::ExtCommunityValue &comm, 
                   ext_community->communities()) {
         if (ExtCommunity::is_route_target(comm)) {
-            RtGroup *rtgroup = GetRtGroup(comm);
-            if (!rtgroup) continue;
-            peer_set |= rtgroup->GetInterestedPeers();
+            loc = rtarget_peer_index_.find(RouteTarget(comm));
+            if (loc == rtarget_peer_index_.end()) continue;
+            peer_set |= loc->second;
         }
     }
     RibOut::PeerIterator iter(ribout, peerset);
@@ -180,6 +180,14 @@ struct RtGroupMgrReq {
 // allow more than 1 bgp::RTFilter task to run at the same time, this ensures
 // that the RouteTargetTriggerList is not modified while it's being processed.
 //
+// The RTargetPeerIndex maps each RouteTarget with at least one interested
+// peer to the bitset of interested peer indices.  It's updated from the
+// bgp::RTFilter task whenever the InterestedPeerList of a RtGroup changes and
+// is read without locks by GetRibOutInterestedPeers when exporting VPN routes
+// from the db::DBTable task.  This lets the export path compute the set of
+// interested peers with a bitwise OR per RouteTarget instead of a locked
+// lookup in the RtGroupMap.
+//
 // A mutex is used to protect the RtGroupMap since LocateRtGroup/GetRtGroup
 // is called from multiple db::DBTable tasks concurrently. The same mutex is
 // also used to protect the RtGroupRemoveList as multiple db::DBTable tasks
@@ -193,6 +201,7 @@ public:
     typedef std::set<RTargetRoute *> RTargetRouteTriggerList;
     typedef std::set<RouteTarget> RouteTargetTriggerList;
     typedef std::set<RtGroup *> RtGroupRemoveList;
+    typedef std::map<RouteTarget, RtGroupInterestedPeerSet> RTargetPeerIndex;
 
     RTargetGroupMgr(BgpServer *);
     virtual ~RTargetGroupMgr();
@@ -221,6 +230,8 @@ private:
                          RtGroup::InterestedPeerList &current);
     void BuildRTargetDistributionGraph(BgpTable *table, RTargetRoute *rt, 
                                        DBTableBase::ListenerId id);
+    void UpdateRTargetPeerIndex(const RouteTarget &rtarget,
+                                const RtGroup *rtgroup);
     BgpServer *server() { return server_; }
     bool ProcessRTargetRouteList();
     void TriggerRTGroupDepWalk();
@@ -244,6 +255,7 @@ private:
     RouteTargetTriggerList rtarget_trigger_list_;
     RouteTargetTriggerList pending_rtarget_trigger_list_;
     RtGroupRemoveList rtgroup_remove_list_;
+    RTargetPeerIndex rtarget_peer_index_;
     WorkQueue<RtGroupMgrReq *> *process_queue_;
     LifetimeRef<RTargetGroupMgr> master_instance_delete_ref_;
 
@@ -151,6 +151,17 @@ public:
     virtual bool Match(BgpServer *server, BgpTable *table, 
                        BgpRoute *route, bool deleted);
 
+    // Only the routes of the service chain address are of interest in the
+    // connected table
+    virtual bool MatchAddress(BgpTable *table, Ip4Address *address) const {
+        if (table == dest_table() || table != connected_table() ||
+            !service_chain_addr_.is_v4()) {
+            return false;
+        }
+        *address = service_chain_addr_.to_v4();
+        return true;
+    }
+
     void FillServiceChainInfo(ShowServicechainInfo &info) const; 
 
     void set_connected_table_unregistered() {
@@ -163,6 +163,16 @@ public:
     virtual bool Match(BgpServer *server, BgpTable *table, 
                        BgpRoute *route, bool deleted);
 
+    // Only the routes of the nexthop address are of interest, as in
+    // is_nexthop_route
+    virtual bool MatchAddress(BgpTable *table, Ip4Address *address) const {
+        if (table != bgp_table() || !nexthop_.is_v4()) {
+            return false;
+        }
+        *address = nexthop_.to_v4();
+        return true;
+    }
+
     void set_unregistered() {
         unregistered_ = true;
     }
@@ -2,6 +2,8 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <boost/bind.hpp>
+
 #include "base/task.h"
 #include "base/task_annotations.h"
 #include "base/test/task_test_util.h"
@@ -27,6 +29,14 @@ using namespace std;
 
 static int gbl_index;
 
+static int GetUnregisterAction(IPeerRib *peer_rib) {
+    return MembershipRequest::RIBIN_DELETE | MembershipRequest::RIBOUT_DELETE;
+}
+
+static void UnregisterPeerDone(int *count, IPeer *ipeer, BgpTable *table) {
+    (*count)++;
+}
+
 class BgpTestPeer : public BgpPeer {
 public:
     BgpTestPeer(BgpServer *server, RoutingInstance *instance,
@@ -150,6 +160,19 @@ protected:
     BgpServer *server() { return server_.get(); }
     int size() { return server()->membership_mgr()->peer_rib_set_.size(); }
 
+    void AddRoute(BgpTable *table, BgpTestPeer *peer,
+                  const string &prefix_str) {
+        BgpAttrSpec attr_spec;
+        BgpAttrPtr attr = server_->attr_db()->Locate(attr_spec);
+
+        DBRequest req;
+        Ip4Prefix prefix(Ip4Prefix::FromString(prefix_str));
+        req.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+        req.key.reset(new InetTable::RequestKey(prefix, peer));
+        req.data.reset(new InetTable::RequestData(attr, 0, 0));
+        table->Enqueue(&req);
+    }
+
     auto_ptr<EventManager> evm_;
     auto_ptr<BgpServerTest> server_;
     vector<BgpTestPeer *> peers_;
@@ -373,6 +396,69 @@ TEST_F(PeerMembershipMgrTest, MultiplePeersSingleTable) {
     TASK_UTIL_EXPECT_TRUE(size() == 0);
 }
 
+// Unregister multiple peers with routes in multiple tables. The peers should
+// leave each table in a single walk.
+TEST_F(PeerMembershipMgrTest, MultiplePeersUnregisterPeer) {
+    static const int kRouteCount = 8;
+    PeerRibMembershipManager *mgr = server()->membership_mgr();
+
+    // Make sure we start out clean.
+    ASSERT_EQ(size(), 0);
+
+    vector<BgpTable *> tables;
+    tables.push_back(red_tbl_);
+    tables.push_back(green_tbl_);
+    tables.push_back(blue_tbl_);
+
+    // Register all peers to all tables and add routes from each of them.
+    for (size_t idx = 0; idx < tables.size(); idx++) {
+        for (size_t jdx = 0; jdx < peers_.size(); jdx++) {
+            mgr->Register(peers_[jdx], tables[idx],
+                          peers_[jdx]->GetRibExportPolicy(), -1);
+        }
+    }
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(9, size());
+
+    for (size_t idx = 0; idx < tables.size(); idx++) {
+        for (size_t jdx = 0; jdx < peers_.size(); jdx++) {
+            for (int rt_idx = 0; rt_idx < kRouteCount; rt_idx++) {
+                ostringstream out;
+                out << "10.1." << rt_idx << ".0/24";
+                AddRoute(tables[idx], peers_[jdx], out.str());
+            }
+        }
+    }
+    task_util::WaitForIdle();
+    for (size_t idx = 0; idx < tables.size(); idx++) {
+        TASK_UTIL_EXPECT_EQ(kRouteCount, tables[idx]->Size());
+    }
+
+    // Unregister all peers while the membership queue is disabled.
+    static_cast<PeerRibMembershipManagerTest *>(mgr)->SetQueueDisable(true);
+    int count = 0;
+    for (size_t jdx = 0; jdx < peers_.size(); jdx++) {
+        mgr->UnregisterPeer(peers_[jdx],
+            boost::bind(&GetUnregisterAction, _1),
+            boost::bind(&UnregisterPeerDone, &count, _1, _2));
+    }
+    static_cast<PeerRibMembershipManagerTest *>(mgr)->SetQueueDisable(false);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_EXPECT_EQ(3, count);
+    TASK_UTIL_EXPECT_EQ(0, size());
+    for (size_t idx = 0; idx < tables.size(); idx++) {
+        TASK_UTIL_EXPECT_EQ(0, tables[idx]->Size());
+    }
+
+    // One walk per table, with all the peers in it.
+    const PeerRibMembershipManager::LeaveStats &stats = mgr->leave_stats();
+    EXPECT_EQ(3, stats.walks);
+    EXPECT_EQ(9, stats.requests);
+    EXPECT_EQ(3, stats.max_requests);
+    EXPECT_EQ(0, stats.walks_in_progress);
+}
+
 // Delete a peer with membership request pending
 TEST_F(PeerMembershipMgrTest, PeerDeleteWithPendingMembershipRequestPending) {
     PeerRibMembershipManager *mgr = server()->membership_mgr();
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "bgp/bgp_policy.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "base/logging.h"
+#include "base/task.h"
+#include "base/util.h"
+#include "base/test/task_test_util.h"
+#include "bgp/bgp_attr.h"
+#include "bgp/bgp_log.h"
+#include "bgp/bgp_server.h"
+#include "bgp/inet/inet_route.h"
+#include "bgp/rtarget/rtarget_address.h"
+#include "control-node/control_node.h"
+#include "io/event_manager.h"
+#include "testing/gunit.h"
+
+using std::string;
+using std::vector;
+
+class BgpPolicyTest : public ::testing::Test {
+protected:
+    BgpPolicyTest() : server_(&evm_), attr_db_(server_.attr_db()) {
+    }
+
+    void TearDown() {
+        server_.Shutdown();
+        task_util::WaitForIdle();
+    }
+
+    BgpAttrPtr BuildAttr(const vector<uint32_t> &communities,
+                         uint32_t local_pref = 100) {
+        BgpAttrSpec spec;
+        BgpAttrLocalPref attr_local_pref(local_pref);
+        spec.push_back(&attr_local_pref);
+        CommunitySpec comm_spec;
+        comm_spec.communities = communities;
+        if (!communities.empty())
+            spec.push_back(&comm_spec);
+        return attr_db_->Locate(spec);
+    }
+
+    BgpAttrPtr BuildAttr(uint32_t community, uint32_t local_pref = 100) {
+        vector<uint32_t> communities;
+        communities.push_back(community);
+        return BuildAttr(communities, local_pref);
+    }
+
+    static BgpPolicyTerm Term(const string &community, const string &prefix,
+                              BgpPolicyTerm::Action action) {
+        BgpPolicyTerm term;
+        if (!community.empty())
+            term.match_community.push_back(community);
+        term.match_prefix = prefix;
+        term.action = action;
+        return term;
+    }
+
+    static Ip4Prefix Prefix(const string &str) {
+        return Ip4Prefix::FromString(str);
+    }
+
+    EventManager evm_;
+    BgpServer server_;
+    BgpAttrDB *attr_db_;
+};
+
+TEST_F(BgpPolicyTest, AcceptReject) {
+    BgpPolicy::TermList terms;
+    terms.push_back(Term("64512:1", "", BgpPolicyTerm::REJECT));
+    terms.push_back(Term("64512:2", "", BgpPolicyTerm::ACCEPT));
+    terms.push_back(Term("", "", BgpPolicyTerm::REJECT));
+    boost::scoped_ptr<BgpPolicy> policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+    EXPECT_EQ(3, policy->term_count());
+    EXPECT_TRUE(policy->attribute_only());
+
+    BgpAttrPtr attr = BuildAttr((64512U << 16) | 1);
+    EXPECT_FALSE(policy->Evaluate(NULL, &attr));
+
+    attr = BuildAttr((64512U << 16) | 2);
+    const BgpAttr *orig = attr.get();
+    EXPECT_TRUE(policy->Evaluate(NULL, &attr));
+    EXPECT_EQ(orig, attr.get());
+
+    attr = BuildAttr((64512U << 16) | 3);
+    EXPECT_FALSE(policy->Evaluate(NULL, &attr));
+}
+
+TEST_F(BgpPolicyTest, UpdateAttributes) {
+    BgpPolicy::TermList terms;
+    BgpPolicyTerm term = Term("64512:1", "", BgpPolicyTerm::NEXT);
+    term.add_community.push_back("64512:100");
+    term.remove_community.push_back("64512:1");
+    term.update_local_pref = 200;
+    terms.push_back(term);
+
+    // Matches on the community added by the previous term
+    term = Term("64512:100", "", BgpPolicyTerm::ACCEPT);
+    term.add_community.push_back("target:64512:7");
+    terms.push_back(term);
+    boost::scoped_ptr<BgpPolicy> policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+
+    BgpAttrPtr attr = BuildAttr((64512U << 16) | 1);
+    EXPECT_TRUE(policy->Evaluate(NULL, &attr));
+    EXPECT_EQ(200, attr->local_pref());
+    ASSERT_TRUE(attr->community() != NULL);
+    ASSERT_EQ(1, attr->community()->communities().size());
+    EXPECT_EQ((64512U << 16) | 100, attr->community()->communities()[0]);
+    ASSERT_TRUE(attr->ext_community() != NULL);
+    ASSERT_EQ(1, attr->ext_community()->communities().size());
+    EXPECT_EQ(RouteTarget::FromString("target:64512:7").GetExtCommunity(),
+              attr->ext_community()->communities()[0]);
+
+    // Unmatched route is accepted by default
+    attr = BuildAttr((64512U << 16) | 2);
+    const BgpAttr *orig = attr.get();
+    EXPECT_TRUE(policy->Evaluate(NULL, &attr));
+    EXPECT_EQ(orig, attr.get());
+}
+
+TEST_F(BgpPolicyTest, SetCommunity) {
+    BgpPolicy::TermList terms;
+    BgpPolicyTerm term = Term("", "", BgpPolicyTerm::ACCEPT);
+    term.set_community.push_back("no-export");
+    terms.push_back(term);
+    boost::scoped_ptr<BgpPolicy> policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+
+    vector<uint32_t> communities;
+    communities.push_back((64512U << 16) | 1);
+    communities.push_back((64512U << 16) | 2);
+    BgpAttrPtr attr = BuildAttr(communities);
+    EXPECT_TRUE(policy->Evaluate(NULL, &attr));
+    ASSERT_TRUE(attr->community() != NULL);
+    ASSERT_EQ(1, attr->community()->communities().size());
+    EXPECT_EQ(static_cast<uint32_t>(Community::NoExport),
+              attr->community()->communities()[0]);
+}
+
+TEST_F(BgpPolicyTest, PrefixMatch) {
+    BgpPolicy::TermList terms;
+    terms.push_back(Term("", "10.1.0.0/16", BgpPolicyTerm::REJECT));
+    boost::scoped_ptr<BgpPolicy> policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+    EXPECT_FALSE(policy->attribute_only());
+
+    BgpAttrPtr attr = BuildAttr((64512U << 16) | 1);
+    Ip4Prefix prefix = Prefix("10.1.2.0/24");
+    EXPECT_FALSE(policy->Evaluate(&prefix, &attr));
+    prefix = Prefix("10.1.0.0/16");
+    EXPECT_FALSE(policy->Evaluate(&prefix, &attr));
+    prefix = Prefix("10.0.0.0/8");
+    EXPECT_TRUE(policy->Evaluate(&prefix, &attr));
+    prefix = Prefix("10.2.0.0/24");
+    EXPECT_TRUE(policy->Evaluate(&prefix, &attr));
+    EXPECT_TRUE(policy->Evaluate(NULL, &attr));
+}
+
+TEST_F(BgpPolicyTest, InvalidTerm) {
+    BgpPolicy::TermList terms;
+    terms.push_back(Term("64512", "", BgpPolicyTerm::REJECT));
+    EXPECT_TRUE(BgpPolicy::Compile("p1", terms) == NULL);
+
+    terms.clear();
+    terms.push_back(Term("", "10.1.0.0/33", BgpPolicyTerm::REJECT));
+    EXPECT_TRUE(BgpPolicy::Compile("p1", terms) == NULL);
+}
+
+TEST_F(BgpPolicyTest, Cache) {
+    BgpPolicy::TermList terms;
+    BgpPolicyTerm term = Term("64512:1", "", BgpPolicyTerm::ACCEPT);
+    term.update_local_pref = 300;
+    terms.push_back(term);
+    terms.push_back(Term("", "", BgpPolicyTerm::REJECT));
+    BgpPolicyPtr policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+
+    BgpPolicyCache cache;
+    for (int idx = 0; idx < 4; ++idx) {
+        BgpAttrPtr attr = BuildAttr((64512U << 16) | 1);
+        EXPECT_TRUE(cache.Evaluate(policy, NULL, &attr));
+        EXPECT_EQ(300, attr->local_pref());
+        attr = BuildAttr((64512U << 16) | 2);
+        EXPECT_FALSE(cache.Evaluate(policy, NULL, &attr));
+    }
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(2, cache.misses());
+    EXPECT_EQ(6, cache.hits());
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+}
+
+//
+// Replacing the policy flushes the results of the old policy. The old policy
+// is kept alive while the cache has results for it, so a new policy can't
+// be mistaken for it.
+//
+TEST_F(BgpPolicyTest, CacheReplacePolicy) {
+    BgpPolicy::TermList terms;
+    BgpPolicyTerm term = Term("64512:1", "", BgpPolicyTerm::ACCEPT);
+    term.update_local_pref = 300;
+    terms.push_back(term);
+    BgpPolicyPtr policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+    boost::weak_ptr<const BgpPolicy> old_policy(policy);
+
+    BgpPolicyCache cache;
+    BgpAttrPtr attr = BuildAttr((64512U << 16) | 1);
+    EXPECT_TRUE(cache.Evaluate(policy, NULL, &attr));
+    EXPECT_EQ(300, attr->local_pref());
+
+    terms.clear();
+    terms.push_back(Term("64512:1", "", BgpPolicyTerm::REJECT));
+    policy.reset();
+    EXPECT_FALSE(old_policy.expired());
+    policy.reset(BgpPolicy::Compile("p2", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+
+    attr = BuildAttr((64512U << 16) | 1);
+    EXPECT_FALSE(cache.Evaluate(policy, NULL, &attr));
+    EXPECT_TRUE(old_policy.expired());
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(2, cache.misses());
+    EXPECT_EQ(0, cache.hits());
+}
+
+//
+// Evaluate a 1000 term policy for routes with distinct communities, with and
+// without the cache.
+//
+TEST_F(BgpPolicyTest, Throughput) {
+    static const int kTerms = 1000;
+    static const int kAttrs = 1000;
+    static const int kRounds = 20;
+
+    BgpPolicy::TermList terms;
+    for (int idx = 0; idx < kTerms; ++idx) {
+        BgpPolicyTerm term = Term(
+            "64512:" + integerToString(idx), "", BgpPolicyTerm::ACCEPT);
+        term.update_local_pref = idx + 1;
+        terms.push_back(term);
+    }
+    terms.push_back(Term("", "", BgpPolicyTerm::REJECT));
+    BgpPolicyPtr policy(BgpPolicy::Compile("p1", terms));
+    ASSERT_TRUE(policy.get() != NULL);
+
+    vector<BgpAttrPtr> attrs;
+    for (int idx = 0; idx < kAttrs; ++idx) {
+        attrs.push_back(BuildAttr((64512U << 16) | (idx * 2)));
+    }
+
+    uint64_t start = UTCTimestampUsec();
+    int accepted = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        for (int idx = 0; idx < kAttrs; ++idx) {
+            BgpAttrPtr attr = attrs[idx];
+            if (policy->Evaluate(NULL, &attr))
+                accepted++;
+        }
+    }
+    uint64_t uncached_usec = UTCTimestampUsec() - start;
+    EXPECT_EQ(kRounds * kTerms / 2, accepted);
+
+    BgpPolicyCache cache;
+    start = UTCTimestampUsec();
+    accepted = 0;
+    for (int round = 0; round < kRounds; ++round) {
+        for (int idx = 0; idx < kAttrs; ++idx) {
+            BgpAttrPtr attr = attrs[idx];
+            if (cache.Evaluate(policy, NULL, &attr))
+                accepted++;
+        }
+    }
+    uint64_t cached_usec = UTCTimestampUsec() - start;
+    EXPECT_EQ(kRounds * kTerms / 2, accepted);
+    EXPECT_EQ(kAttrs, cache.misses());
+
+    int evaluations = kRounds * kAttrs;
+    std::cout << evaluations << " evaluations of " << kTerms
+              << " term policy: " << uncached_usec << " usec uncached, "
+              << cached_usec << " usec cached" << std::endl;
+}
+
+static void SetUp() {
+    bgp_log_test::init();
+    ControlNode::SetDefaultSchedulingPolicy();
+}
+
+static void TearDown() {
+    task_util::WaitForIdle();
+    TaskScheduler *scheduler = TaskScheduler::GetInstance();
+    scheduler->Terminate();
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    SetUp();
+    int result = RUN_ALL_TESTS();
+    TearDown();
+    return result;
+}
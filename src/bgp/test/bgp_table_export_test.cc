@@ -12,10 +12,12 @@
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_path.h"
 #include "bgp/bgp_peer.h"
+#include "bgp/bgp_policy.h"
 #include "bgp/bgp_update.h"
 #include "bgp/scheduling_group.h"
 #include "bgp/inet/inet_table.h"
 #include "bgp/inet/inet_route.h"
+#include "bgp/routing-instance/routing_instance.h"
 #include "bgp/routing-instance/rtarget_group_mgr.h"
 #include "bgp/test/bgp_server_test_util.h"
 #include "control-node/control_node.h"
@@ -845,6 +847,43 @@ TEST_P(BgpTableExportParamTest5, NoStripExtendedCommunity2) {
     }
 }
 
+//
+// Table : bgp.l3vpn.0
+// Source: eBGP, iBGP
+// RibOut: eBGP
+// Intent: Replacing the export policy of the routing instance is applied
+//         to the next export of the route, not the cached result of the
+//         old policy.
+//
+TEST_P(BgpTableExportParamTest5, ExportPolicyReplace) {
+    CreateRibOut(BgpProto::EBGP, RibExportPolicy::BGP, 300);
+    SetAttrCommunity((64512U << 16) | 1);
+    AddPath();
+    rt_.set_table_partition(table_->GetTablePartition(0));
+
+    BgpPolicy::TermList terms;
+    BgpPolicyTerm term;
+    term.match_community.push_back("64512:1");
+    term.action = BgpPolicyTerm::ACCEPT;
+    terms.push_back(term);
+    RoutingInstance *rtinstance = table_->routing_instance();
+    rtinstance->set_export_policy(
+        BgpPolicyPtr(BgpPolicy::Compile("accept", terms)));
+    RunExport();
+    VerifyExportAccept();
+
+    terms[0].action = BgpPolicyTerm::REJECT;
+    rtinstance->set_export_policy(
+        BgpPolicyPtr(BgpPolicy::Compile("reject", terms)));
+    UpdateInfoSList uinfo_slist;
+    uinfo_slist_.swap(uinfo_slist);
+    RunExport();
+    VerifyExportReject();
+
+    rtinstance->set_export_policy(BgpPolicyPtr());
+    rt_.set_table_partition(NULL);
+}
+
 INSTANTIATE_TEST_CASE_P(Instance, BgpTableExportParamTest5,
             ::testing::Bool());
 
@@ -522,7 +522,7 @@ protected:
             }
 
             // secondary routes which are no longer replicated
-            for (RtReplicated::ReplicatedRtPathList::iterator iter =
+            for (RtReplicated::ReplicatedRtPathList::const_iterator iter =
                  dbstate->GetList().begin();
                  iter != dbstate->GetList().end(); iter++) {
                 RtReplicated::SecondaryRouteInfo rinfo = *iter;
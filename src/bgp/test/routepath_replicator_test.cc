@@ -8,6 +8,7 @@
 #include <boost/assign/list_of.hpp>
 
 #include "base/test/task_test_util.h"
+#include "base/util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/inet/inet_table.h"
@@ -1694,6 +1695,84 @@ TEST_F(ReplicationTest, UpdateInstanceRouteTargets8) {
     TASK_UTIL_EXPECT_TRUE(VPNRouteLookup("192.168.0.1:1:10.0.1.1/32") == NULL);
 }
 
+//
+// Replicate VPN routes that carry the export targets of 5000 instances and
+// report the time taken to add, update and delete the secondary paths.
+//
+TEST_F(ReplicationTest, ScaleBenchmark) {
+    static const int kInstances = 5000;
+    static const int kRoutes = 20;
+
+    vector<string> instance_names;
+    for (int i = 0; i < kInstances; i++) {
+        instance_names.push_back("vrf" + integerToString(i));
+    }
+    multimap<string, string> connections;
+    NetworkConfig(instance_names, connections);
+    task_util::WaitForIdle();
+
+    boost::system::error_code ec;
+    peers_.push_back(
+        new BgpPeerMock(Ip4Address::from_string("192.168.0.1", ec)));
+
+    BgpTable *table = static_cast<BgpTable *>(
+        bgp_server_->database()->FindTable("bgp.l3vpn.0"));
+    ASSERT_TRUE(table != NULL);
+
+    vector<string> prefixes;
+    for (int i = 0; i < kRoutes; i++) {
+        prefixes.push_back("192.168.0.1:1:10.0." + integerToString(i) +
+                           ".1/32");
+    }
+
+    // The second pass changes the local preference of every route so that
+    // the existing secondary paths are merged with the new list.
+    const char *phases[] = { "add", "update" };
+    for (int idx = 0; idx < 2; idx++) {
+        BgpAttrSpec attr_spec;
+        boost::scoped_ptr<BgpAttrLocalPref> local_pref(
+                                new BgpAttrLocalPref(100 + idx * 100));
+        attr_spec.push_back(local_pref.get());
+        boost::scoped_ptr<ExtCommunitySpec> commspec(
+            BuildInstanceListTargets(instance_names, &attr_spec));
+        BgpAttrPtr attr = bgp_server_->attr_db()->Locate(attr_spec);
+
+        uint64_t start = UTCTimestampUsec();
+        BOOST_FOREACH(const string &prefix, prefixes) {
+            boost::system::error_code error;
+            InetVpnPrefix nlri = InetVpnPrefix::FromString(prefix, &error);
+            EXPECT_FALSE(error);
+            DBRequest request;
+            request.oper = DBRequest::DB_ENTRY_ADD_CHANGE;
+            request.key.reset(new InetVpnTable::RequestKey(nlri, peers_[0]));
+            request.data.reset(new BgpTable::RequestData(attr, 0, 0));
+            table->Enqueue(&request);
+        }
+        task_util::WaitForIdle();
+        uint64_t elapsed = UTCTimestampUsec() - start;
+        cout << phases[idx] << " " << kRoutes
+             << " routes replicated to " << kInstances << " instances: "
+             << elapsed << " usec ("
+             << elapsed / (kRoutes * kInstances)
+             << " usec per secondary path)" << endl;
+
+        VERIFY_EQ(kRoutes, RouteCount("vrf0"));
+        VERIFY_EQ(kRoutes, RouteCount("vrf" + integerToString(kInstances - 1)));
+    }
+
+    uint64_t start = UTCTimestampUsec();
+    BOOST_FOREACH(const string &prefix, prefixes) {
+        DeleteVPNRoute(peers_[0], prefix);
+    }
+    task_util::WaitForIdle();
+    uint64_t elapsed = UTCTimestampUsec() - start;
+    cout << "delete " << kRoutes << " routes replicated to " << kInstances
+         << " instances: " << elapsed << " usec" << endl;
+
+    VERIFY_EQ(0, RouteCount("vrf0"));
+    VERIFY_EQ(0, RouteCount("vrf" + integerToString(kInstances - 1)));
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
@@ -6,6 +6,7 @@
 #include <boost/foreach.hpp>
 #include <fstream>
 
+#include "base/lifetime.h"
 #include "base/task.h"
 #include "base/task_annotations.h"
 #include "base/util.h"
@@ -743,6 +744,60 @@ TEST_F(RoutingInstanceMgrTest, VnIndexByExtCommunity12) {
     TASK_UTIL_EXPECT_EQ(0, GetVnIndexByExtCommunity(ext_community_12y));
 }
 
+//
+// The actors of a routing instance and of its tables are in the lifetime
+// partition of the instance, and the instances are spread over partitions.
+// Deleting the instances records their delete latency.
+//
+TEST_F(RoutingInstanceMgrTest, LifetimePartitions) {
+    static const int kInstances = 32;
+    const int kPartitions = BgpServer::kLifetimePartitions;
+    LifetimeManager *manager = server_.lifetime_manager();
+    EXPECT_EQ(kPartitions, manager->partitions());
+
+    vector<BgpInstanceConfigTest *> cfg_list;
+    for (int idx = 1; idx <= kInstances; ++idx) {
+        string target = "target:100:" + integerToString(idx);
+        cfg_list.push_back(BgpTestUtil::CreateBgpInstanceConfig(
+            "ri" + integerToString(idx), target, target));
+        CreateRoutingInstance(cfg_list.back());
+    }
+
+    set<int> partitions;
+    for (int idx = 0; idx < kInstances; ++idx) {
+        RoutingInstance *rti =
+            ri_mgr_->GetRoutingInstance(cfg_list[idx]->name());
+        ASSERT_TRUE(rti != NULL);
+        int partition = rti->deleter()->partition();
+        EXPECT_EQ(BgpServer::LifetimePartition(rti->name()), partition);
+        EXPECT_LE(0, partition);
+        EXPECT_GT(kPartitions, partition);
+        const RoutingInstance::RouteTableList &tables = rti->GetTables();
+        for (RoutingInstance::RouteTableList::const_iterator it =
+             tables.begin(); it != tables.end(); ++it) {
+            EXPECT_EQ(partition, it->second->deleter()->partition());
+        }
+        partitions.insert(partition);
+    }
+    EXPECT_LT(1U, partitions.size());
+
+    for (int idx = 0; idx < kInstances; ++idx) {
+        DeleteRoutingInstance(cfg_list[idx]);
+        delete cfg_list[idx];
+    }
+
+    LifetimeManager::DeleteLatencyMap latency;
+    manager->GetDeleteLatency(&latency);
+    uint64_t instances = 0;
+    for (LifetimeManager::DeleteLatencyMap::const_iterator it =
+         latency.begin(); it != latency.end(); ++it) {
+        if (it->first.find("RoutingInstance::DeleteActor") != string::npos) {
+            instances += it->second.count;
+        }
+    }
+    EXPECT_EQ(static_cast<uint64_t>(kInstances), instances);
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
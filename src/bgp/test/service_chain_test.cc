@@ -15,6 +15,7 @@
 #include <pugixml/pugixml.hpp>
 
 #include "base/test/task_test_util.h"
+#include "base/util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_sandesh.h"
@@ -3514,6 +3515,88 @@ TEST_P(ServiceChainParamTest, EntryAfterStop) {
     task_util::WaitForIdle();
 }
 
+//
+// Many service chains
+// 1. Configure service chains in multiple service instances that share the
+//    destination and the connected routing instance
+// 2. Add unrelated routes to the connected table, no aggregate is added
+// 3. Add the connected routes, all the aggregates are added
+//
+TEST_P(ServiceChainParamTest, ManyServiceChains) {
+    static const int kChains = 64;
+    static const int kRoutes = 1024;
+    vector<string> instance_names = list_of("blue")("red-i2")("red");
+    multimap<string, string> connections = map_list_of("red-i2", "red");
+    for (int i = 1; i <= kChains; i++) {
+        string name = "blue-i" + integerToString(i);
+        instance_names.push_back(name);
+        connections.insert(make_pair("blue", name));
+    }
+    NetworkConfig(instance_names, connections);
+    VerifyNetworkConfig(instance_names);
+
+    for (int i = 1; i <= kChains; i++) {
+        std::auto_ptr<autogen::ServiceChainInfo> params(
+            new autogen::ServiceChainInfo());
+        params->routing_instance = "red";
+        params->source_routing_instance = "blue";
+        params->prefix.push_back("192.168." + integerToString(i) + ".0/24");
+        params->service_chain_address = "1.1." + integerToString(i) + ".3";
+        ifmap_test_util::IFMapMsgPropertyAdd(&config_db_, "routing-instance", 
+                                             "blue-i" + integerToString(i),
+                                             "service-chain-information", 
+                                             params.release(), 0);
+    }
+    task_util::WaitForIdle();
+
+    // More specific routes
+    for (int i = 1; i <= kChains; i++) {
+        AddInetRoute(NULL, "red", "192.168." + integerToString(i) + ".1/32",
+                     100);
+    }
+    task_util::WaitForIdle();
+
+    // Routes in the connected table that are not connected routes
+    for (int i = 0; i < kRoutes; i++) {
+        AddConnectedRoute(NULL, "10.1." + integerToString(i / 256) + "." +
+                          integerToString(i % 256) + "/32", 100, "2.3.4.5");
+    }
+    task_util::WaitForIdle();
+    for (int i = 1; i <= kChains; i++) {
+        EXPECT_TRUE(InetRouteLookup("blue",
+                    "192.168." + integerToString(i) + ".0/24") == NULL);
+    }
+
+    // Connected routes
+    for (int i = 1; i <= kChains; i++) {
+        AddConnectedRoute(NULL, "1.1." + integerToString(i) + ".3/32", 100,
+                          "2.3.4.5");
+    }
+    for (int i = 1; i <= kChains; i++) {
+        TASK_UTIL_WAIT_NE_NO_MSG(InetRouteLookup("blue",
+                                 "192.168." + integerToString(i) + ".0/24"),
+                                 NULL, 1000, 10000, 
+                                 "Wait for Aggregate route in blue..");
+    }
+
+    for (int i = 0; i < kRoutes; i++) {
+        DeleteConnectedRoute(NULL, "10.1." + integerToString(i / 256) + "." +
+                             integerToString(i % 256) + "/32");
+    }
+    for (int i = 1; i <= kChains; i++) {
+        DeleteConnectedRoute(NULL, "1.1." + integerToString(i) + ".3/32");
+        DeleteInetRoute(NULL, "red", "192.168." + integerToString(i) + ".1/32");
+    }
+    task_util::WaitForIdle();
+
+    for (int i = 1; i <= kChains; i++) {
+        TASK_UTIL_WAIT_EQ_NO_MSG(InetRouteLookup("blue",
+                                 "192.168." + integerToString(i) + ".0/24"),
+                                 NULL, 1000, 10000, 
+                                 "Wait for Aggregate route in blue..");
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(Instance, ServiceChainParamTest,
         ::testing::Combine(::testing::Bool(), ::testing::Bool()));
 
@@ -13,6 +13,7 @@
 #include <boost/assign/list_of.hpp>
 
 #include "base/test/task_test_util.h"
+#include "base/util.h"
 #include "bgp/bgp_config.h"
 #include "bgp/bgp_log.h"
 #include "bgp/bgp_sandesh.h"
@@ -413,6 +414,48 @@ TEST_F(StaticRouteTest, Basic) {
                              "Wait for Static route in blue..");
 }
 
+//
+// The nexthop is resolved by any route with the nexthop address, not only by
+// its host route
+//
+TEST_F(StaticRouteTest, NexthopRouteNotHostRoute) {
+    vector<string> instance_names = list_of("blue")("nat")("red")("green");
+    multimap<string, string> connections;
+    NetworkConfig(instance_names, connections);
+    task_util::WaitForIdle();
+
+    std::auto_ptr<autogen::StaticRouteEntriesType> params =
+        GetStaticRouteConfig("controller/src/bgp/testdata/static_route_1.xml");
+
+    ifmap_test_util::IFMapMsgPropertyAdd(&config_db_, "routing-instance",
+                         "nat", "static-route-entries", params.release(), 0);
+    task_util::WaitForIdle();
+
+    TASK_UTIL_WAIT_EQ_NO_MSG(InetRouteLookup("blue", "192.168.1.0/24"),
+                             NULL, 1000, 10000,
+                             "Wait for Static route in blue..");
+
+    // Add Nexthop Route with a prefix length other than 32
+    AddInetRoute(NULL, "nat", "192.168.1.254/31", 100, "2.3.4.5");
+    task_util::WaitForIdle();
+
+    TASK_UTIL_WAIT_NE_NO_MSG(InetRouteLookup("blue", "192.168.1.0/24"),
+                             NULL, 1000, 10000,
+                             "Wait for Static route in blue..");
+    BgpRoute *static_rt = InetRouteLookup("blue", "192.168.1.0/24");
+    const BgpPath *static_path = static_rt->BestPath();
+    BgpAttrPtr attr = static_path->GetAttr();
+    EXPECT_EQ(attr->nexthop().to_v4().to_string(), "2.3.4.5");
+
+    // Delete nexthop route
+    DeleteInetRoute(NULL, "nat", "192.168.1.254/31");
+    task_util::WaitForIdle();
+
+    TASK_UTIL_WAIT_EQ_NO_MSG(InetRouteLookup("blue", "192.168.1.0/24"),
+                             NULL, 1000, 10000,
+                             "Wait for Static route in blue..");
+}
+
 TEST_F(StaticRouteTest, UpdateRtList) {
     vector<string> instance_names = list_of("blue")("nat")("red")("green");
     multimap<string, string> connections;
@@ -1336,6 +1379,74 @@ TEST_F(StaticRouteTest, EntryAfterStop) {
                              "Wait for Static route in blue..");
 }
 
+//
+// Many static routes
+// 1. Configure a large number of static routes with distinct nexthops
+// 2. Add unrelated routes, none of the static routes is resolved
+// 3. Add the nexthop routes, all the static routes are resolved
+//
+TEST_F(StaticRouteTest, ManyStaticRoutes) {
+    static const int kStaticRoutes = 256;
+    static const int kRoutes = 1024;
+    vector<string> instance_names = list_of("blue")("nat")("red")("green");
+    multimap<string, string> connections;
+    NetworkConfig(instance_names, connections);
+    task_util::WaitForIdle();
+
+    std::auto_ptr<autogen::StaticRouteEntriesType> params(
+        new autogen::StaticRouteEntriesType());
+    for (int i = 0; i < kStaticRoutes; i++) {
+        autogen::StaticRouteType route;
+        route.prefix = "192.168." + integerToString(i) + ".0/24";
+        route.next_hop = "192.168." + integerToString(i) + ".254";
+        route.route_target.push_back("target:64496:1");
+        params->route.push_back(route);
+    }
+    ifmap_test_util::IFMapMsgPropertyAdd(&config_db_, "routing-instance", 
+                         "nat", "static-route-entries", params.release(), 0);
+    task_util::WaitForIdle();
+
+    // Routes that don't match any of the static route nexthops
+    for (int i = 0; i < kRoutes; i++) {
+        AddInetRoute(NULL, "nat", "10.1." + integerToString(i / 256) + "." +
+                     integerToString(i % 256) + "/32", 100, "2.3.4.5");
+    }
+    task_util::WaitForIdle();
+    for (int i = 0; i < kStaticRoutes; i++) {
+        EXPECT_TRUE(InetRouteLookup("blue",
+                    "192.168." + integerToString(i) + ".0/24") == NULL);
+    }
+
+    // Nexthop routes
+    for (int i = 0; i < kStaticRoutes; i++) {
+        AddInetRoute(NULL, "nat", "192.168." + integerToString(i) + ".254/32",
+                     100, "2.3.4.5");
+    }
+    for (int i = 0; i < kStaticRoutes; i++) {
+        TASK_UTIL_WAIT_NE_NO_MSG(InetRouteLookup("blue",
+                                 "192.168." + integerToString(i) + ".0/24"),
+                                 NULL, 1000, 10000, 
+                                 "Wait for Static route in blue..");
+    }
+
+    for (int i = 0; i < kRoutes; i++) {
+        DeleteInetRoute(NULL, "nat", "10.1." + integerToString(i / 256) + "." +
+                        integerToString(i % 256) + "/32");
+    }
+    for (int i = 0; i < kStaticRoutes; i++) {
+        DeleteInetRoute(NULL, "nat",
+                        "192.168." + integerToString(i) + ".254/32");
+    }
+    task_util::WaitForIdle();
+
+    for (int i = 0; i < kStaticRoutes; i++) {
+        TASK_UTIL_WAIT_EQ_NO_MSG(InetRouteLookup("blue",
+                                 "192.168." + integerToString(i) + ".0/24"),
+                                 NULL, 1000, 10000, 
+                                 "Wait for Static route in blue..");
+    }
+}
+
 class TestEnvironment : public ::testing::Environment {
     virtual ~TestEnvironment() { }
 };
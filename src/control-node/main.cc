@@ -38,6 +38,7 @@
 #include "sandesh/common/vns_constants.h"
 #include "schema/vnc_cfg_types.h"
 #include "xmpp/xmpp_init.h"
+#include "xmpp/xmpp_log.h"
 #include "xmpp/xmpp_server.h"
 #include "xmpp/sandesh/xmpp_peer_info_types.h"
 #include "bgp/bgp_sandesh.h"
@@ -408,6 +409,7 @@ int main(int argc, char *argv[]) {
     }
 
     ControlNode::SetTestMode(options.test_mode());
+    XmppMessageTraceBuf->TraceSampleRateSet(options.xmpp_trace_sample_rate());
 
     boost::scoped_ptr<BgpServer> bgp_server(new BgpServer(&evm));
     sandesh_context.bgp_server = bgp_server.get();
@@ -106,6 +106,9 @@ void Options::Initialize(EventManager &evm,
         ("DEFAULT.test_mode", opt::bool_switch(&test_mode_),
              "Enable control-node to run in test-mode")
 
+        ("DEFAULT.xmpp_message_trace_sample_rate",
+             opt::value<uint32_t>()->default_value(1),
+             "Trace one in every these many XMPP messages")
         ("DEFAULT.xmpp_server_port",
              opt::value<uint16_t>()->default_value(default_xmpp_port),
              "XMPP listener port")
@@ -207,6 +210,8 @@ bool Options::Process(int argc, char *argv[],
     GetOptValue<int>(var_map, log_files_count_, "DEFAULT.log_files_count");
     GetOptValue<long>(var_map, log_file_size_, "DEFAULT.log_file_size");
     GetOptValue<string>(var_map, log_level_, "DEFAULT.log_level");
+    GetOptValue<uint32_t>(var_map, xmpp_trace_sample_rate_,
+                          "DEFAULT.xmpp_message_trace_sample_rate");
     GetOptValue<uint16_t>(var_map, xmpp_port_, "DEFAULT.xmpp_server_port");
 
     GetOptValue<uint16_t>(var_map, discovery_port_, "DISCOVERY.port");
@@ -34,6 +34,9 @@ public:
     const std::string ifmap_user() const { return ifmap_user_; }
     const std::string ifmap_certs_store() const { return ifmap_certs_store_; }
     const uint16_t xmpp_port() const { return xmpp_port_; }
+    const uint32_t xmpp_trace_sample_rate() const {
+        return xmpp_trace_sample_rate_;
+    }
     const bool test_mode() const { return test_mode_; }
     const bool collectors_configured() const { return collectors_configured_; }
 
@@ -68,6 +71,7 @@ private:
     std::string ifmap_user_;
     std::string ifmap_certs_store_;
     uint16_t xmpp_port_;
+    uint32_t xmpp_trace_sample_rate_;
     bool test_mode_;
     bool collectors_configured_;
 
@@ -49,3 +49,20 @@ void DiscoveryClientPublisherStatsReq::HandleRequest() const {
     resp->Response();
 }
 
+void DiscoveryClientHttpStatsReq::HandleRequest() const {
+
+    DiscoveryClientHttpStatsResponse *resp =
+        new DiscoveryClientHttpStatsResponse();
+    resp->set_context(context());
+
+    DiscoveryClientHttpStats stats;
+    DiscoveryServiceClient *ds = ControlNode::GetControlNodeDiscoveryServiceClient();
+    if (ds) {
+        ds->FillDiscoveryServiceHttpStats(stats);
+    }
+
+    resp->set_http(stats);
+    resp->set_more(false);
+    resp->Response();
+}
+
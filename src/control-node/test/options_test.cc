@@ -69,6 +69,7 @@ TEST_F(OptionsTest, NoArguments) {
     EXPECT_EQ(options_.ifmap_user(), "control_user");
     EXPECT_EQ(options_.ifmap_certs_store(), "");
     EXPECT_EQ(options_.xmpp_port(), default_xmpp_port);
+    EXPECT_EQ(options_.xmpp_trace_sample_rate(), 1);
     EXPECT_EQ(options_.test_mode(), false);
 }
 
@@ -105,6 +106,7 @@ TEST_F(OptionsTest, DefaultConfFile) {
     EXPECT_EQ(options_.ifmap_user(), "control_user");
     EXPECT_EQ(options_.ifmap_certs_store(), "");
     EXPECT_EQ(options_.xmpp_port(), default_xmpp_port);
+    EXPECT_EQ(options_.xmpp_trace_sample_rate(), 1);
     EXPECT_EQ(options_.test_mode(), false);
 }
 
@@ -143,6 +145,7 @@ TEST_F(OptionsTest, OverrideStringFromCommandLine) {
     EXPECT_EQ(options_.ifmap_user(), "control_user");
     EXPECT_EQ(options_.ifmap_certs_store(), "");
     EXPECT_EQ(options_.xmpp_port(), default_xmpp_port);
+    EXPECT_EQ(options_.xmpp_trace_sample_rate(), 1);
     EXPECT_EQ(options_.test_mode(), false);
 }
 
@@ -181,6 +184,7 @@ TEST_F(OptionsTest, OverrideBooleanFromCommandLine) {
     EXPECT_EQ(options_.ifmap_user(), "control_user");
     EXPECT_EQ(options_.ifmap_certs_store(), "");
     EXPECT_EQ(options_.xmpp_port(), default_xmpp_port);
+    EXPECT_EQ(options_.xmpp_trace_sample_rate(), 1);
     EXPECT_EQ(options_.test_mode(), true); // Overridden from command line.
 }
 
@@ -203,6 +207,7 @@ TEST_F(OptionsTest, CustomConfigFile) {
         "log_level=SYS_DEBUG\n"
         "log_local=1\n"
         "test_mode=1\n"
+        "xmpp_message_trace_sample_rate=10\n"
         "xmpp_server_port=100\n"
         "\n"
         "[DISCOVERY]\n"
@@ -257,6 +262,7 @@ TEST_F(OptionsTest, CustomConfigFile) {
     EXPECT_EQ(options_.ifmap_user(), "test-user");
     EXPECT_EQ(options_.ifmap_certs_store(), "test-store");
     EXPECT_EQ(options_.xmpp_port(), 100);
+    EXPECT_EQ(options_.xmpp_trace_sample_rate(), 10);
     EXPECT_EQ(options_.test_mode(), true);
 }
 
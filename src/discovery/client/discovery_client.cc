@@ -775,3 +775,20 @@ void DiscoveryServiceClient::FillDiscoveryServicePublisherStats(
          next++;
     } 
 }
+
+void DiscoveryServiceClient::FillDiscoveryServiceHttpStats(
+         DiscoveryClientHttpStats &ds_stats) {
+
+    const HttpClient::Stats &stats = http_client_->stats();
+    ds_stats.set_requests(stats.requests);
+    ds_stats.set_responses(stats.responses);
+    ds_stats.set_errors(stats.errors);
+    ds_stats.set_queued(stats.queued);
+    ds_stats.set_new_connections(stats.new_connections);
+    ds_stats.set_reused_connections(stats.reused_connections);
+    if (stats.responses) {
+        ds_stats.set_latency_avg_usecs(stats.latency_total_usecs /
+                                       stats.responses);
+    }
+    ds_stats.set_latency_max_usecs(stats.latency_max_usecs);
+}
@@ -24,6 +24,7 @@ class DiscoveryServiceClient;
 class DiscoveryServiceClientMock;
 struct DiscoveryClientPublisherStats;
 struct DiscoveryClientSubscriberStats;
+struct DiscoveryClientHttpStats;
 
 struct DSResponse {
    boost::asio::ip::tcp::endpoint  ep;
@@ -147,6 +148,8 @@ public:
     void FillDiscoveryServiceSubscriberStats(
          std::vector<DiscoveryClientSubscriberStats> &ds_stats); 
 
+    void FillDiscoveryServiceHttpStats(DiscoveryClientHttpStats &ds_stats);
+
     // Map of <ServiceName, SubscribeResponseHeader> for subscribe
     typedef std::map<std::string, DSResponseHeader *> ServiceResponseMap;
 
@@ -622,11 +622,17 @@ CdbIf::CdbIf(DbErrorHandler errhandler,
     cassandra_ttl_(ttl),
     only_sync_(only_sync),
     task_instance_(-1),
-    task_instance_initialized_(false) {
+    task_instance_initialized_(false),
+    batch_column_lists_(0),
+    batch_columns_(0),
+    batch_start_usec_(0) {
     db_init_done_ = false;
 }
 
-CdbIf::CdbIf() {
+CdbIf::CdbIf() :
+    batch_column_lists_(0),
+    batch_columns_(0),
+    batch_start_usec_(0) {
 }
 
 CdbIf::~CdbIf() {
@@ -1192,11 +1198,13 @@ bool CdbIf::Db_AsyncAddColumn(CdbIfColList &cl) {
     std::string key_value;
     DbDataValueVecToString(key_value, new_colp->rowkey_.size() != 1,
                            new_colp->rowkey_);
+    bool merged = true;
     CassandraMutationMap::iterator cmm_it = mutation_map_.find(key_value);
     if (cmm_it == mutation_map_.end()) {
         cmm_it = mutation_map_.insert(
             std::pair<std::string, CFMutationMap>(key_value,
                 CFMutationMap())).first;
+        merged = false;
     } 
     CFMutationMap &cf_mutation_map(cmm_it->second);
     // Does the column family exist in the column family mutation map ?
@@ -1204,6 +1212,10 @@ bool CdbIf::Db_AsyncAddColumn(CdbIfColList &cl) {
     if (cfmm_it == cf_mutation_map.end()) {
         cfmm_it = cf_mutation_map.insert(
             std::pair<std::string, MutationList>(cfname, MutationList())).first;
+        merged = false;
+    }
+    if (batch_start_usec_ == 0) {
+        batch_start_usec_ = ts;
     }
     MutationList &mutations(cfmm_it->second);
     mutations.reserve(mutations.size() + new_colp->columns_.size());
@@ -1280,13 +1292,38 @@ bool CdbIf::Db_AsyncAddColumn(CdbIfColList &cl) {
     }
     // Update write stats
     UpdateCfWriteStats(cfname);
+    if (merged) {
+        stats_.batch_stats_.merged_column_lists++;
+    }
+    batch_column_lists_++;
+    batch_columns_ += new_colp->columns_.size();
     // Allocated when enqueued, free it after processing
     delete new_colp;
     cl.gendb_cl = NULL;
+    if (batch_columns_ >= kBatchMaxColumns) {
+        Db_FlushBatch(CdbIfStats::CDBIF_STATS_BATCH_FLUSH_SIZE);
+    }
     return true;
 }
 
+// Called when the queue runner exits or yields. Keep coalescing while the
+// runner still has work, unless the batch has been pending for too long.
 void CdbIf::Db_BatchAddColumn(bool done) {
+    if (mutation_map_.empty()) {
+        return;
+    }
+    if (done) {
+        Db_FlushBatch(CdbIfStats::CDBIF_STATS_BATCH_FLUSH_DRAIN);
+        return;
+    }
+    if (UTCTimestampUsec() - batch_start_usec_ >= kBatchMaxLatencyUsec) {
+        Db_FlushBatch(CdbIfStats::CDBIF_STATS_BATCH_FLUSH_LATENCY);
+    }
+}
+
+void CdbIf::Db_FlushBatch(CdbIfStats::BatchFlush reason) {
+    stats_.UpdateBatch(reason, mutation_map_.size(), batch_column_lists_,
+        batch_columns_);
     CDBIF_BEGIN_TRY {
         client_->batch_mutate(mutation_map_,
             org::apache::cassandra::ConsistencyLevel::ONE);
@@ -1294,6 +1331,9 @@ void CdbIf::Db_BatchAddColumn(bool done) {
           false, false, true, CdbIfStats::CDBIF_STATS_ERR_WRITE_BATCH_COLUMN,
           CdbIfStats::CDBIF_STATS_CF_OP_NONE)
     mutation_map_.clear();
+    batch_column_lists_ = 0;
+    batch_columns_ = 0;
+    batch_start_usec_ = 0;
 }
 
 bool CdbIf::Db_AddColumn(std::auto_ptr<GenDb::ColList> cl) {
@@ -1593,6 +1633,11 @@ bool CdbIf::Db_GetStats(std::vector<DbTableInfo> &vdbti, DbErrors &dbe) {
     stats_.Get(vdbti, dbe);
     return true;
 }
+
+bool CdbIf::Db_GetBatchStats(DbBatchInfo &dbbi) const {
+    stats_.batch_stats_.Get(dbbi);
+    return true;
+}
        
 void CdbIf::UpdateCfWriteStats(const std::string &cf_name) {
     tbb::mutex::scoped_lock lock(smutex_);
@@ -1675,6 +1720,30 @@ void CdbIf::CdbIfStats::IncrementErrors(CdbIf::CdbIfStats::ErrorType type) {
     }
 }
 
+void CdbIf::CdbIfStats::UpdateBatch(CdbIf::CdbIfStats::BatchFlush reason,
+    size_t rows, size_t column_lists, size_t columns) {
+    switch (reason) {
+    case CdbIfStats::CDBIF_STATS_BATCH_FLUSH_SIZE:
+        batch_stats_.size_flushes++;
+        break;
+    case CdbIfStats::CDBIF_STATS_BATCH_FLUSH_LATENCY:
+        batch_stats_.latency_flushes++;
+        break;
+    case CdbIfStats::CDBIF_STATS_BATCH_FLUSH_DRAIN:
+        batch_stats_.drain_flushes++;
+        break;
+    default:
+        break;
+    }
+    batch_stats_.batches++;
+    batch_stats_.rows += rows;
+    batch_stats_.column_lists += column_lists;
+    batch_stats_.columns += columns;
+    if (columns > batch_stats_.max_batch_columns) {
+        batch_stats_.max_batch_columns = columns;
+    }
+}
+
 void CdbIf::CdbIfStats::Get(std::vector<DbTableInfo> &vdbti,
     DbErrors &dbe) {
     // Send diffs
@@ -1781,3 +1850,16 @@ void CdbIf::CdbIfStats::Errors::Get(DbErrors &db_errors) const {
     db_errors.set_write_batch_column_fails(write_batch_column_fails);
     db_errors.set_read_column_fails(read_column_fails);
 }
+
+// BatchStats
+void CdbIf::CdbIfStats::BatchStats::Get(DbBatchInfo &db_batch_info) const {
+    db_batch_info.set_batches(batches);
+    db_batch_info.set_rows(rows);
+    db_batch_info.set_column_lists(column_lists);
+    db_batch_info.set_merged_column_lists(merged_column_lists);
+    db_batch_info.set_columns(columns);
+    db_batch_info.set_size_flushes(size_flushes);
+    db_batch_info.set_latency_flushes(latency_flushes);
+    db_batch_info.set_drain_flushes(drain_flushes);
+    db_batch_info.set_max_batch_columns(max_batch_columns);
+}
@@ -62,6 +62,7 @@ public:
     // Stats
     virtual bool Db_GetStats(std::vector<GenDb::DbTableInfo> &vdbti,
         GenDb::DbErrors &dbe);
+    virtual bool Db_GetBatchStats(GenDb::DbBatchInfo &dbbi) const;
 
 private:
     friend class CdbIfTest;
@@ -153,6 +154,14 @@ private:
     bool Db_GetColumnfamily(CdbIfCfInfo **info, const std::string& cfname);
     bool Db_FindColumnfamily(const std::string& cfname);
     // Column
+    //
+    // Column lists dequeued from cdbq_ are merged into mutation_map_ by row
+    // key and column family, and written with a single batch_mutate when
+    // the batch reaches kBatchMaxColumns, when the queue is drained, or when
+    // the queue runner yields and the oldest column list has waited longer
+    // than kBatchMaxLatencyUsec.
+    static const size_t kBatchMaxColumns = 2048;
+    static const uint64_t kBatchMaxLatencyUsec = 20000;
     bool Db_AsyncAddColumn(CdbIfColList &cl);
     bool Db_AsyncAddColumnLocked(CdbIfColList &cl);
     void Db_BatchAddColumn(bool done);
@@ -213,6 +222,34 @@ private:
             CDBIF_STATS_ERR_WRITE_BATCH_COLUMN,
             CDBIF_STATS_ERR_READ_COLUMN,
         };
+        struct BatchStats {
+            BatchStats() {
+                batches = 0;
+                rows = 0;
+                column_lists = 0;
+                merged_column_lists = 0;
+                columns = 0;
+                size_flushes = 0;
+                latency_flushes = 0;
+                drain_flushes = 0;
+                max_batch_columns = 0;
+            }
+            void Get(GenDb::DbBatchInfo &db_batch_info) const;
+            tbb::atomic<uint64_t> batches;
+            tbb::atomic<uint64_t> rows;
+            tbb::atomic<uint64_t> column_lists;
+            tbb::atomic<uint64_t> merged_column_lists;
+            tbb::atomic<uint64_t> columns;
+            tbb::atomic<uint64_t> size_flushes;
+            tbb::atomic<uint64_t> latency_flushes;
+            tbb::atomic<uint64_t> drain_flushes;
+            tbb::atomic<uint64_t> max_batch_columns;
+        };
+        enum BatchFlush {
+            CDBIF_STATS_BATCH_FLUSH_SIZE,
+            CDBIF_STATS_BATCH_FLUSH_LATENCY,
+            CDBIF_STATS_BATCH_FLUSH_DRAIN,
+        };
         enum CfOp {
             CDBIF_STATS_CF_OP_NONE,
             CDBIF_STATS_CF_OP_WRITE,
@@ -221,6 +258,8 @@ private:
             CDBIF_STATS_CF_OP_READ_FAIL,
         };
         void IncrementErrors(ErrorType type);
+        void UpdateBatch(BatchFlush reason, size_t rows, size_t column_lists,
+            size_t columns);
         void UpdateCf(const std::string &cf_name, bool write, bool fail);
         void Get(std::vector<GenDb::DbTableInfo> &vdbti, GenDb::DbErrors &dbe);
         typedef boost::ptr_map<const std::string, CfStats> CfStatsMap;
@@ -228,6 +267,7 @@ private:
         CfStatsMap ocf_stats_map_;
         Errors db_errors_;
         Errors odb_errors_;
+        BatchStats batch_stats_;
     };
 
     friend CdbIfStats::CfStats operator+(const CdbIfStats::CfStats &a,
@@ -240,6 +280,7 @@ private:
         const CdbIfStats::Errors &b);
 
     void UpdateCfStats(CdbIfStats::CfOp op, const std::string &cf_name);
+    void Db_FlushBatch(CdbIfStats::BatchFlush reason);
     void UpdateCfWriteStats(const std::string &cf_name);
     void UpdateCfWriteFailStats(const std::string &cf_name);
     void UpdateCfReadStats(const std::string &cf_name);
@@ -273,6 +314,9 @@ private:
     typedef std::map<std::string, MutationList> CFMutationMap;
     typedef std::map<std::string, CFMutationMap> CassandraMutationMap;
     CassandraMutationMap mutation_map_;
+    size_t batch_column_lists_;
+    size_t batch_columns_;
+    uint64_t batch_start_usec_;
     mutable tbb::mutex smutex_;
     CdbIfStats stats_;
     std::vector<DbQueueWaterMarkInfo> cdbq_wm_info_;
@@ -167,6 +167,7 @@ public:
     // Stats
     virtual bool Db_GetStats(std::vector<DbTableInfo> &vdbti,
         DbErrors &dbe) = 0;
+    virtual bool Db_GetBatchStats(DbBatchInfo &dbbi) const = 0;
 
     static GenDbIf *GenDbIfImpl(DbErrorHandler hdlr, 
         std::string cassandra_ip, unsigned short cassandra_port, 
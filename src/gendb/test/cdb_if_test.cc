@@ -7,6 +7,7 @@
 #include "testing/gunit.h"
 
 #include "base/logging.h"
+#include "base/util.h"
 #include "../cdb_if.h"
 
 using namespace GenDb;
@@ -65,6 +66,31 @@ protected:
         const GenDb::DbDataValueVec& input) {
         return dbif_.DbDataValueVecToString(output, composite, input);
     }
+    bool AddColumnToBatch(const std::string &cfname,
+        const std::string &rowkey, int ncolumns) {
+        GenDb::ColList *cl(new GenDb::ColList);
+        cl->cfname_ = cfname;
+        cl->rowkey_.push_back(rowkey);
+        for (int i = 0; i < ncolumns; i++) {
+            cl->columns_.push_back(new GenDb::NewCol(
+                "column" + integerToString(i), rowkey));
+        }
+        CdbIf::CdbIfColList qentry;
+        qentry.gendb_cl = cl;
+        return dbif_.Db_AsyncAddColumn(qentry);
+    }
+    void BatchRunnerExit(bool done) {
+        dbif_.Db_BatchAddColumn(done);
+    }
+    size_t BatchRows() const {
+        return dbif_.mutation_map_.size();
+    }
+    size_t BatchColumns() const {
+        return dbif_.batch_columns_;
+    }
+    size_t BatchColumnLists() const {
+        return dbif_.batch_column_lists_;
+    }
  
     CdbIf dbif_;
     CdbIf::CdbIfStats stats_;
@@ -329,6 +355,24 @@ TEST_F(CdbIfTest, Stats) {
     EXPECT_EQ(edbe_diffs, adbe_diffs); 
 }
 
+TEST_F(CdbIfTest, BatchCoalesce) {
+    // Column lists for the same row and column family are merged
+    EXPECT_TRUE(AddColumnToBatch("FakeColumnFamily", "row1", 3));
+    EXPECT_TRUE(AddColumnToBatch("FakeColumnFamily", "row1", 2));
+    EXPECT_TRUE(AddColumnToBatch("FakeColumnFamily", "row2", 1));
+    EXPECT_TRUE(AddColumnToBatch("OtherColumnFamily", "row2", 1));
+    EXPECT_EQ(2, BatchRows());
+    EXPECT_EQ(4, BatchColumnLists());
+    EXPECT_EQ(7, BatchColumns());
+    // Runner yielding with a fresh batch does not flush it
+    BatchRunnerExit(false);
+    EXPECT_EQ(2, BatchRows());
+    GenDb::DbBatchInfo dbbi;
+    EXPECT_TRUE(dbif_.Db_GetBatchStats(dbbi));
+    EXPECT_EQ(1, dbbi.get_merged_column_lists());
+    EXPECT_EQ(0, dbbi.get_batches());
+}
+
 int main(int argc, char **argv) {
     LoggingInit();
     ::testing::InitGoogleTest(&argc, argv);
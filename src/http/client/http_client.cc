@@ -3,14 +3,19 @@
  */
 
 #include "http_client.h"
+#include <algorithm>
 #include <boost/bind.hpp>
 #include "base/task_annotations.h"
+#include "base/util.h"
 #include "io/event_manager.h"
 #include "http_curl.h"
 
 using namespace std;
 using tbb::mutex;
 
+const size_t HttpClient::kDefaultMaxInFlight;
+const long HttpClient::kMaxCachedConnections;
+
 HttpClientSession::HttpClientSession(HttpClient *client, Socket *socket) 
     : TcpSession(client, socket) , delete_called_(0) {
         set_observer(boost::bind(&HttpClientSession::OnEvent, this, _1, _2));
@@ -54,17 +59,17 @@ void HttpClientSession::RegisterEventCb(SessionEventCb cb) {
 HttpConnection::HttpConnection(boost::asio::ip::tcp::endpoint ep, size_t id, 
                                HttpClient *client) :
     endpoint_(ep), id_(id), cb_(NULL), offset_(0), curl_handle_(NULL),
-    session_(NULL), client_(client) {
+    session_(NULL), start_time_(0), client_(client) {
 }
 
 HttpConnection::~HttpConnection() {
+    // The session is deleted when libcurl closes the socket, which may be
+    // carrying the request of another connection by now
     if (session_) {
-        {
-            tbb::mutex::scoped_lock lock(session_->mutex());
+        tbb::mutex::scoped_lock lock(session_->mutex());
+        if (session_->Connection() == this) {
             session_->SetConnection(NULL);
         }
-        client_->DeleteSession(session_);
-        set_session(NULL);
     }
 }
 
@@ -116,7 +121,7 @@ void HttpConnection::HttpGetInternal(std::string path, bool header, bool timeout
     if (hdr_options.length())
         set_header_options(curl_handle_, hdr_options.c_str());
 
-    http_get(curl_handle_, gi);
+    client()->StartRequest(this);
 }
 
 int HttpConnection::HttpGet(std::string &path, HttpCb cb) {
@@ -154,7 +159,7 @@ void HttpConnection::HttpPutInternal(std::string put_string, std::string path,
         set_header_options(curl_handle_, hdr_options.c_str());
     set_put_string(curl_handle_, put_string.c_str());
 
-    http_put(curl_handle_, gi);
+    client()->StartRequest(this);
 }
 
 int HttpConnection::HttpPut(std::string &put_string, 
@@ -197,7 +202,8 @@ HttpClient::HttpClient(EventManager *evm) :
   TcpServer(evm) , 
   curl_timer_(TimerManager::CreateTimer(*evm->io_service(), "http client",
               TaskScheduler::GetInstance()->GetTaskId("http client"), 0)),
-  id_(0), work_queue_(TaskScheduler::GetInstance()->GetTaskId("http client"), 0,
+  id_(0), pipelining_(false), max_in_flight_(kDefaultMaxInFlight),
+  work_queue_(TaskScheduler::GetInstance()->GetTaskId("http client"), 0,
               boost::bind(&HttpClient::DequeueEvent, this, _1)) { 
     gi_ = (struct _GlobalInfo *)malloc(sizeof(struct _GlobalInfo));
     memset(gi_, 0, sizeof(struct _GlobalInfo));
@@ -210,7 +216,9 @@ void HttpClient::ShutdownInternal() {
         next++;
         RemoveConnectionInternal(iter->second);
     }
+    requests_.clear();
 
+    // Closes the connections in the cache, deleting their sessions
     curl_multi_cleanup(gi_->multi);
     TimerManager::DeleteTimer(curl_timer_);
     SessionShutdown();
@@ -272,6 +280,71 @@ bool HttpClient::AddConnection(HttpConnection *conn) {
     return false;
 }
 
+// Send the request once fewer than max_in_flight_ requests to the endpoint
+// are outstanding
+void HttpClient::StartRequest(HttpConnection *conn) {
+    stats_.requests++;
+    conn->set_start_time(ClockMonotonicUsec());
+    EndpointRequests *requests = &requests_[conn->endpoint()];
+    if (requests->in_flight.size() >= max_in_flight_) {
+        stats_.queued++;
+        requests->pending.push_back(conn);
+        return;
+    }
+    DispatchRequest(requests, conn);
+}
+
+void HttpClient::DispatchRequest(EndpointRequests *requests,
+                                 HttpConnection *conn) {
+    requests->in_flight.insert(conn);
+    struct _ConnInfo *curl_handle = conn->curl_handle();
+    if (curl_handle->post) {
+        http_put(curl_handle, gi_);
+    } else {
+        http_get(curl_handle, gi_);
+    }
+}
+
+void HttpClient::DispatchPending(endpoint ep) {
+    EndpointRequestMap::iterator it = requests_.find(ep);
+    if (it == requests_.end())
+        return;
+    EndpointRequests *requests = &it->second;
+    while (!requests->pending.empty() &&
+           requests->in_flight.size() < max_in_flight_) {
+        HttpConnection *conn = requests->pending.front();
+        requests->pending.pop_front();
+        DispatchRequest(requests, conn);
+    }
+}
+
+// Called from libcurl when the transfer of the request is complete. The
+// connection stays in the map till the application removes it.
+void HttpClient::RequestDone(HttpConnection *conn, bool error, bool reused) {
+    EndpointRequestMap::iterator it = requests_.find(conn->endpoint());
+    if (it == requests_.end() || it->second.in_flight.erase(conn) == 0)
+        return;
+
+    stats_.responses++;
+    if (error) {
+        stats_.errors++;
+    } else if (reused) {
+        stats_.reused_connections++;
+    } else {
+        stats_.new_connections++;
+    }
+    uint64_t latency = ClockMonotonicUsec() - conn->start_time();
+    stats_.latency_total_usecs += latency;
+    if (latency > stats_.latency_max_usecs)
+        stats_.latency_max_usecs = latency;
+
+    // Not from within the libcurl callback that got us here
+    if (!it->second.pending.empty()) {
+        ProcessEvent(boost::bind(&HttpClient::DispatchPending, this,
+                                 conn->endpoint()));
+    }
+}
+
 void HttpClient::RemoveConnection(HttpConnection *connection) {
     work_queue_.Enqueue(boost::bind(&HttpClient::RemoveConnectionInternal, 
                                      this, connection));
@@ -305,6 +378,23 @@ bool HttpClient::IsErrorHard(const boost::system::error_code &ec) {
 void HttpClient::RemoveConnectionInternal(HttpConnection *connection) {
     boost::asio::ip::tcp::endpoint endpoint = connection->endpoint();
     size_t id = connection->id();
+
+    EndpointRequestMap::iterator it = requests_.find(endpoint);
+    if (it != requests_.end()) {
+        EndpointRequests *requests = &it->second;
+        if (requests->in_flight.erase(connection)) {
+            if (!requests->pending.empty()) {
+                ProcessEvent(boost::bind(&HttpClient::DispatchPending, this,
+                                         endpoint));
+            }
+        } else {
+            requests->pending.erase(std::remove(requests->pending.begin(),
+                                                requests->pending.end(),
+                                                connection),
+                                    requests->pending.end());
+        }
+    }
+
     del_conn(connection, gi_);
     map_.erase(std::make_pair(endpoint, id));
     return;
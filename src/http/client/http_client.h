@@ -5,8 +5,12 @@
 #ifndef __HTTP_CLIENT_H__
 #define __HTTP_CLIENT_H__
 
+#include <deque>
+#include <map>
+#include <set>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/function.hpp>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/ptr_container/ptr_map.hpp>
 #include <boost/system/error_code.hpp>
 #include <string>
@@ -55,6 +59,8 @@ private:
     DISALLOW_COPY_AND_ASSIGN(HttpClientSession);
 };
 
+typedef boost::intrusive_ptr<HttpClientSession> HttpClientSessionPtr;
+
 class HttpConnection {
 public:
     HttpConnection(boost::asio::ip::tcp::endpoint, size_t id, HttpClient *);
@@ -72,7 +78,7 @@ public:
 
     struct _ConnInfo *curl_handle() { return curl_handle_; }
     HttpClient *client() { return client_; }
-    HttpClientSession *session() { return session_; }
+    HttpClientSession *session() { return session_.get(); }
     tbb::mutex &mutex() { return mutex_; }
     boost::asio::ip::tcp::endpoint endpoint() { return endpoint_; }
     size_t id() { return id_; }
@@ -84,6 +90,8 @@ public:
     void AssignData(const char *ptr, size_t size);
     void UpdateOffset(size_t bytes);
     size_t GetOffset();
+    uint64_t start_time() const { return start_time_; }
+    void set_start_time(uint64_t time) { start_time_ = time; }
     HttpCb HttpClientCb() { return cb_; }
     void RegisterEventCb(HttpClientSession::SessionEventCb cb) { event_cb_ = cb; }
 
@@ -101,7 +109,10 @@ private:
     size_t offset_;
     std::string buf_;
     struct _ConnInfo *curl_handle_;
-    HttpClientSession *session_;
+    // The socket is owned by libcurl, which keeps it open for the next
+    // request to the endpoint once this one is done with it
+    HttpClientSessionPtr session_;
+    uint64_t start_time_;
     HttpClient *client_;
     mutable tbb::mutex mutex_;
     HttpClientSession::SessionEventCb event_cb_;
@@ -110,8 +121,37 @@ private:
 };
 
 // Http Client class
+//
+// Connections to an endpoint are kept alive in the connection cache of the
+// curl multi handle and reused by the requests that follow. At most
+// max_in_flight() requests are outstanding to an endpoint at a time, the rest
+// are queued and sent in the order they were made as earlier ones complete.
 class HttpClient : public TcpServer {
 public:
+    static const size_t kDefaultMaxInFlight = 8;
+    static const long kMaxCachedConnections = 32;
+
+    struct Stats {
+        Stats() { Reset(); }
+        void Reset() {
+            requests = responses = errors = queued = 0;
+            new_connections = reused_connections = 0;
+            latency_total_usecs = latency_max_usecs = 0;
+        }
+
+        uint64_t requests;
+        uint64_t responses;
+        uint64_t errors;
+        // requests which waited for an earlier one to the endpoint to complete
+        uint64_t queued;
+        // responses received over a new connection vs a cached one
+        uint64_t new_connections;
+        uint64_t reused_connections;
+        // from the request being made to its transfer completing
+        uint64_t latency_total_usecs;
+        uint64_t latency_max_usecs;
+    };
+
     explicit HttpClient(EventManager *evm);
     virtual ~HttpClient();
 
@@ -123,7 +163,8 @@ public:
     HttpConnection *CreateConnection(boost::asio::ip::tcp::endpoint);
     bool AddConnection(HttpConnection *);
     void RemoveConnection(HttpConnection *);
-
+    void StartRequest(HttpConnection *);
+    void RequestDone(HttpConnection *, bool error, bool reused);
 
     void ProcessEvent(EnqueuedCb cb);
     struct _GlobalInfo *GlobalInfo() { return gi_; }
@@ -134,6 +175,16 @@ public:
 
     bool IsErrorHard(const boost::system::error_code &ec);
 
+    // Send requests to an endpoint back to back over a connection, without
+    // waiting for the earlier responses. Only takes effect before Init().
+    void set_pipelining(bool pipelining) { pipelining_ = pipelining; }
+    bool pipelining() const { return pipelining_; }
+    void set_max_in_flight(size_t count) { max_in_flight_ = count; }
+    size_t max_in_flight() const { return max_in_flight_; }
+
+    const Stats &stats() const { return stats_; }
+    void ClearStats() { stats_.Reset(); }
+
 protected:
     virtual TcpSession *AllocSession(Socket *socket);
 
@@ -147,11 +198,25 @@ private:
     typedef std::pair<endpoint, size_t> Key;
     typedef boost::ptr_map<Key, HttpConnection> HttpConnectionMap;
 
+    // Requests to an endpoint
+    struct EndpointRequests {
+        std::set<HttpConnection *> in_flight;
+        std::deque<HttpConnection *> pending;
+    };
+    typedef std::map<endpoint, EndpointRequests> EndpointRequestMap;
+
+    void DispatchRequest(EndpointRequests *requests, HttpConnection *conn);
+    void DispatchPending(endpoint ep);
+
     bool TimerCb();
     struct _GlobalInfo *gi_;
     Timer *curl_timer_;
     HttpConnectionMap map_;
+    EndpointRequestMap requests_;
     size_t id_;
+    bool pipelining_;
+    size_t max_in_flight_;
+    Stats stats_;
 
     WorkQueue<EnqueuedCb> work_queue_;
 
@@ -96,6 +96,11 @@ static void check_multi_info(GlobalInfo *g)
       curl_easy_getinfo(easy, CURLINFO_PRIVATE, &conn);
       curl_easy_getinfo(easy, CURLINFO_EFFECTIVE_URL, &eff_url);
 
+      /* no connect done means the connection came from the cache */
+      long connects = 0;
+      curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+      g->client->RequestDone(conn->connection, res != CURLE_OK, connects == 0);
+
       boost::system::error_code error(res, boost::system::system_category());
       std::string empty_str("");
       conn->connection->HttpClientCb()(empty_str, error);
@@ -130,14 +135,12 @@ static void event_cb_impl(GlobalInfo *g, TcpSessionPtr session, int action,
 static void event_cb(GlobalInfo *g, TcpSessionPtr session, int action,
                      const boost::system::error_code &error, std::size_t bytes_transferred)
 {
-  tbb::mutex::scoped_lock lock(session->mutex());
-
-  // Ignore if the connection is already deleted.
-  if (!session->Connection()) return;
+  // Ignore if libcurl has closed the socket already. The session may be
+  // carrying requests of several connections, so do not look at those.
+  if (session->IsClosed()) return;
 
-  HttpClient *client = session->Connection()->client();
-  client->ProcessEvent(boost::bind(&event_cb_impl, g, session, action, error, 
-                                   bytes_transferred));
+  g->client->ProcessEvent(boost::bind(&event_cb_impl, g, session, action, error,
+                                      bytes_transferred));
 }
 
 /* Called by asio when our timeout expires */
@@ -171,6 +174,18 @@ static void setsock(int *fdp, curl_socket_t s, CURL*e, int act, GlobalInfo *g)
   HttpClientSession *session = it->second;
   if (session->IsClosed()) return;
 
+  /* the socket may be a cached one, opened for an earlier request */
+  ConnInfo *conn = NULL;
+  curl_easy_getinfo(e, CURLINFO_PRIVATE, &conn);
+  if ( conn && conn->connection && conn->connection->session() != session )
+  {
+    {
+      tbb::mutex::scoped_lock lock(session->mutex());
+      session->SetConnection(conn->connection);
+    }
+    conn->connection->set_session(session);
+  }
+
   boost::asio::ip::tcp::socket * tcp_socket = session->socket();
 
   *fdp = act;
@@ -288,35 +303,45 @@ static curl_socket_t opensocket(void *data,
   if (purpose == CURLSOCKTYPE_IPCXN && address->family == AF_INET)
   {
       HttpClientSession *session = conn->CreateSession();
-      sockfd = session->socket()->native_handle();
-      socket_map.insert(std::pair<curl_socket_t, HttpClientSession *>(sockfd, 
-                  static_cast<HttpClientSession *>(session)));
-      conn->set_session(session);
+      if (session)
+      {
+        sockfd = session->socket()->native_handle();
+        socket_map.insert(std::pair<curl_socket_t, HttpClientSession *>(sockfd,
+                    static_cast<HttpClientSession *>(session)));
+        conn->set_session(session);
+      }
   }
 
 
   return sockfd;
 }
 
-/* CURLOPT_CLOSESOCKETFUNCTION */
+/* CURLOPT_CLOSESOCKETFUNCTION
+ * libcurl closes the socket when it is done with the connection, which may be
+ * well after the request that opened it, so the session goes with it.
+ */
 static int closesocket(void *clientp, curl_socket_t item)
 {
+  GlobalInfo *g = (GlobalInfo *) clientp;
   std::map<curl_socket_t, HttpClientSession *>::iterator it = socket_map.find(item);
-  if ( it != socket_map.end() ) {
-      socket_map.erase(it);
+  if ( it == socket_map.end() )
+  {
+    return 0;
+  }
+
+  HttpClientSession *session = it->second;
+  socket_map.erase(it);
+  {
+    tbb::mutex::scoped_lock lock(session->mutex());
+    session->SetConnection(NULL);
   }
+  g->client->DeleteSession(session);
 
   return 0;
 }
 
 void del_conn(HttpConnection *connection, GlobalInfo *g) {
 
-    if (connection->session()) {
-        tbb::mutex::scoped_lock lock(connection->session()->mutex());
-        closesocket(NULL, connection->session()->socket()->native_handle());
-        connection->session()->SetConnection(NULL);
-    }
-
     struct _ConnInfo *curl_handle = connection->curl_handle();
     if (curl_handle) {
         curl_multi_remove_handle(g->multi, curl_handle->easy);
@@ -360,7 +385,6 @@ ConnInfo *new_conn(HttpConnection *connection, GlobalInfo *g,
       curl_easy_setopt(conn->easy, CURLOPT_LOW_SPEED_TIME, 3L);
       curl_easy_setopt(conn->easy, CURLOPT_LOW_SPEED_LIMIT, 10L);
   }
-  curl_easy_setopt(conn->easy, CURLOPT_FORBID_REUSE, 1L);
 
   /* to include the header in the body */
   if (header)
@@ -372,6 +396,7 @@ ConnInfo *new_conn(HttpConnection *connection, GlobalInfo *g,
 
   /* call this function to close a socket */
   curl_easy_setopt(conn->easy, CURLOPT_CLOSESOCKETFUNCTION, closesocket);
+  curl_easy_setopt(conn->easy, CURLOPT_CLOSESOCKETDATA, g);
 
   return conn;
 }
@@ -418,5 +443,13 @@ int curl_init(HttpClient *client)
   curl_multi_setopt(g->multi, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
   curl_multi_setopt(g->multi, CURLMOPT_TIMERDATA, client);
 
+  /* keep connections alive for the requests that follow */
+  curl_multi_setopt(g->multi, CURLMOPT_MAXCONNECTS,
+                    HttpClient::kMaxCachedConnections);
+  if (client->pipelining())
+  {
+    curl_multi_setopt(g->multi, CURLMOPT_PIPELINING, 1L);
+  }
+
   return 0;
 }
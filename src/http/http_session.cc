@@ -5,6 +5,7 @@
 #include "http/http_session.h"
 
 #include <map>
+#include <vector>
 #include <boost/bind.hpp>
 #include <cstdio>
 
@@ -219,7 +220,7 @@ private:
 };
 
 HttpSession::HttpSession(HttpServer *server, Socket *socket)
-    : TcpSession(server, socket), event_cb_(NULL) {
+    : TcpSession(server, socket), event_cb_(NULL), send_ready_(true) {
     if (req_handler_task_id_ == -1) {
         TaskScheduler *scheduler = TaskScheduler::GetInstance();
         req_handler_task_id_ = scheduler->GetTaskId("http::RequestHandlerTask");
@@ -286,6 +287,104 @@ void HttpSession::OnSessionEvent(TcpSession *session,
     if (event_cb_ && !event_cb_.empty()) {
         event_cb_(h_session, event);
     }
+
+    // Nothing more will be written, let a waiting producer find that out
+    if (event == TcpSession::CLOSE) {
+        SetSendReady();
+    }
+}
+
+// Whatever the socket does not take right away is queued in the session
+// and written out when the socket is writable again. The session is not
+// ready for more till WriteReady() says the queue has drained.
+bool HttpSession::Send(const u_int8_t *data, size_t size, size_t *sent) {
+    {
+        tbb::mutex::scoped_lock lock(send_mutex_);
+        send_ready_ = false;
+    }
+    if (!TcpSession::Send(data, size, sent)) {
+        // Nothing is queued on a closed session, do not keep a producer
+        // waiting for a drain that never comes
+        if (!IsEstablished()) {
+            SetSendReady();
+        }
+        return false;
+    }
+    SetSendReady();
+    return true;
+}
+
+HttpSession::SendStatus HttpSession::SendPiece(const u_int8_t *data,
+                                               size_t size) {
+    if (Send(data, size, NULL)) {
+        return SEND_DONE;
+    }
+    return IsEstablished() ? SEND_QUEUED : SEND_CLOSED;
+}
+
+void HttpSession::WriteReady(const boost::system::error_code &error) {
+    SetSendReady();
+}
+
+void HttpSession::SetSendReady() {
+    SendReadyCb cb;
+    {
+        tbb::mutex::scoped_lock lock(send_mutex_);
+        send_ready_ = true;
+        cb.swap(send_ready_cb_);
+    }
+    if (!cb.empty()) {
+        cb();
+    }
+}
+
+bool HttpSession::send_ready() const {
+    tbb::mutex::scoped_lock lock(send_mutex_);
+    return send_ready_;
+}
+
+bool HttpSession::RegisterSendReadyCb(SendReadyCb cb) {
+    tbb::mutex::scoped_lock lock(send_mutex_);
+    if (send_ready_) {
+        return false;
+    }
+    send_ready_cb_ = cb;
+    return true;
+}
+
+HttpSession::SendStatus HttpSession::SendChunkedHeader(
+        const std::string &content_type) {
+    std::string header = "HTTP/1.1 200 OK\r\n"
+                         "Content-Type: " + content_type + "\r\n"
+                         "Transfer-Encoding: chunked\r\n"
+                         "\r\n";
+    return SendPiece(reinterpret_cast<const u_int8_t *>(header.c_str()),
+                     header.size());
+}
+
+// Each chunk is the size in hex, the data and a CRLF, sent in one go so that
+// the client does not see the framing in separate segments
+HttpSession::SendStatus HttpSession::SendChunk(const u_int8_t *data,
+                                               size_t size) {
+    // A zero length chunk would end the response
+    if (size == 0) {
+        return IsEstablished() ? SEND_DONE : SEND_CLOSED;
+    }
+    char size_line[32];
+    int len = snprintf(size_line, sizeof(size_line), "%zx\r\n", size);
+    std::vector<u_int8_t> chunk;
+    chunk.reserve(len + size + 2);
+    chunk.insert(chunk.end(), size_line, size_line + len);
+    chunk.insert(chunk.end(), data, data + size);
+    chunk.push_back('\r');
+    chunk.push_back('\n');
+    return SendPiece(&chunk[0], chunk.size());
+}
+
+HttpSession::SendStatus HttpSession::SendLastChunk() {
+    static const char last_chunk[] = "0\r\n\r\n";
+    return SendPiece(reinterpret_cast<const u_int8_t *>(last_chunk),
+                     sizeof(last_chunk) - 1);
 }
 
 void HttpSession::OnRead(Buffer buffer) {
@@ -19,6 +19,14 @@ class HttpSession: public TcpSession {
   public:
     typedef boost::function<void(HttpSession *session,
                                  enum TcpSession::Event event)> SessionEventCb;
+    typedef boost::function<void(void)> SendReadyCb;
+
+    // Outcome of sending a piece of a chunked response
+    enum SendStatus {
+        SEND_CLOSED,    // The session is gone, stop producing
+        SEND_QUEUED,    // Queued behind a blocked socket, wait for send ready
+        SEND_DONE,      // Written to the socket, go on with the next chunk
+    };
 
     explicit HttpSession(HttpServer *server, Socket *socket);
     virtual ~HttpSession();
@@ -45,6 +53,41 @@ class HttpSession: public TcpSession {
         hs->set_client_context(ctx);
         return true;
     }    
+
+    // Responses sent with chunked transfer encoding, a chunk at a time as
+    // they are built, instead of being put together in one buffer first
+    static SendStatus SendChunkedHeaderSession(std::string const& s,
+            const std::string &content_type) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        HttpSession* hs = GetSession(s);
+        if (!hs) return SEND_CLOSED;
+        return hs->SendChunkedHeader(content_type);
+    }
+    static SendStatus SendChunkSession(std::string const& s,
+            const u_int8_t *data, size_t size) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        HttpSession* hs = GetSession(s);
+        if (!hs) return SEND_CLOSED;
+        return hs->SendChunk(data, size);
+    }
+    static SendStatus SendLastChunkSession(std::string const& s) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        HttpSession* hs = GetSession(s);
+        if (!hs) return SEND_CLOSED;
+        return hs->SendLastChunk();
+    }
+    // Returns false if everything sent so far has been written to the
+    // socket. Otherwise cb is called once it has been, or once the session
+    // is closed, so that the producer of a streamed response can wait for
+    // the client to catch up before building the next chunk.
+    static bool RegisterSendReadySession(std::string const& s,
+            SendReadyCb cb) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        HttpSession* hs = GetSession(s);
+        if (!hs) return false;
+        return hs->RegisterSendReadyCb(cb);
+    }
+
     static tbb::atomic<long> GetPendingTaskCount() {
         return task_count_;
     }
@@ -52,8 +95,16 @@ class HttpSession: public TcpSession {
     void AcceptSession();
     void RegisterEventCb(SessionEventCb cb);
 
+    virtual bool Send(const u_int8_t *data, size_t size, size_t *sent);
+    SendStatus SendChunkedHeader(const std::string &content_type);
+    SendStatus SendChunk(const u_int8_t *data, size_t size);
+    SendStatus SendLastChunk();
+    bool RegisterSendReadyCb(SendReadyCb cb);
+    bool send_ready() const;
+
   protected:
     virtual void OnRead(Buffer buffer);
+    virtual void WriteReady(const boost::system::error_code &error);
 
   private:
     class RequestBuilder;
@@ -77,6 +128,9 @@ class HttpSession: public TcpSession {
         }
         return it->second;
     }
+    void SetSendReady();
+    SendStatus SendPiece(const u_int8_t *data, size_t size);
+
     const std::string get_client_context() { return client_context_str_; }
     void set_client_context(const std::string& client_ctx)
       { client_context_str_ = client_ctx; }
@@ -85,6 +139,10 @@ class HttpSession: public TcpSession {
     std::string context_str_;
     std::string client_context_str_;
     SessionEventCb event_cb_;
+    // false while data sent is queued, waiting for the socket to drain
+    bool send_ready_;
+    SendReadyCb send_ready_cb_;
+    mutable tbb::mutex send_mutex_;
 
     static int req_handler_task_id_;
     static map_type* context_map_;
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+
+#include "testing/gunit.h"
+
+#include "base/logging.h"
+#include "base/task.h"
+#include "base/test/task_test_util.h"
+#include "http/http_request.h"
+#include "http/http_server.h"
+#include "http/http_session.h"
+#include "io/event_manager.h"
+#include "io/test/event_manager_test.h"
+
+using boost::asio::ip::tcp;
+using std::string;
+using std::vector;
+
+namespace {
+
+//
+// Blocking client on its own io_service, so that it reads only when the
+// test tells it to.
+//
+class LoopbackClient {
+public:
+    explicit LoopbackClient(int port) : socket_(io_service_) {
+        boost::system::error_code ec;
+        tcp::endpoint endpoint(
+            boost::asio::ip::address::from_string("127.0.0.1", ec), port);
+        socket_.connect(endpoint, ec);
+        EXPECT_FALSE(ec);
+    }
+
+    void Get(const string &path) {
+        string request = "GET " + path + " HTTP/1.1\r\n"
+                         "Host: 127.0.0.1\r\n"
+                         "\r\n";
+        boost::system::error_code ec;
+        boost::asio::write(socket_, boost::asio::buffer(request), ec);
+        EXPECT_FALSE(ec);
+    }
+
+    // Reads till the data received ends with the given suffix
+    string ReadUntil(const string &suffix) {
+        string data;
+        while (data.size() < suffix.size() ||
+               data.compare(data.size() - suffix.size(), suffix.size(),
+                            suffix) != 0) {
+            if (!ReadSome(&data)) {
+                break;
+            }
+        }
+        return data;
+    }
+
+    string Read(size_t size) {
+        string data;
+        while (data.size() < size) {
+            if (!ReadSome(&data)) {
+                break;
+            }
+        }
+        return data;
+    }
+
+    void Close() {
+        boost::system::error_code ec;
+        socket_.close(ec);
+    }
+
+private:
+    bool ReadSome(string *data) {
+        char buffer[16384];
+        boost::system::error_code ec;
+        size_t len = socket_.read_some(boost::asio::buffer(buffer), ec);
+        if (ec) {
+            return false;
+        }
+        data->append(buffer, len);
+        return true;
+    }
+
+    boost::asio::io_service io_service_;
+    tcp::socket socket_;
+};
+
+// Splits a chunked response into its header and the data of its chunks.
+// Returns false if the framing is broken or the last chunk is missing.
+bool DecodeChunked(const string &response, string *header,
+                   vector<string> *chunks) {
+    size_t pos = response.find("\r\n\r\n");
+    if (pos == string::npos) {
+        return false;
+    }
+    *header = response.substr(0, pos + 2);
+    pos += 4;
+    while (true) {
+        size_t eol = response.find("\r\n", pos);
+        if (eol == string::npos) {
+            return false;
+        }
+        size_t size = strtoul(response.substr(pos, eol - pos).c_str(),
+                              NULL, 16);
+        pos = eol + 2;
+        if (size == 0) {
+            return response.compare(pos, string::npos, "\r\n") == 0;
+        }
+        if (response.compare(pos + size, 2, "\r\n") != 0) {
+            return false;
+        }
+        chunks->push_back(response.substr(pos, size));
+        pos += size + 2;
+    }
+}
+
+}  // namespace
+
+class HttpSessionTest : public ::testing::Test {
+protected:
+    static const size_t kChunkSize = 64 * 1024;
+    static const int kQueuedChunks = 16;
+
+    virtual void SetUp() {
+        evm_.reset(new EventManager());
+        server_ = new HttpServer(evm_.get());
+        server_->RegisterHandler("/chunked",
+            boost::bind(&HttpSessionTest::HandleRequest, this, _1, _2));
+        server_->Initialize(0);
+        task_util::WaitForIdle();
+        thread_.reset(new ServerThread(evm_.get()));
+        thread_->Start();
+        send_ready_count_ = 0;
+    }
+
+    virtual void TearDown() {
+        task_util::WaitForIdle();
+        server_->Shutdown();
+        task_util::WaitForIdle();
+        TcpServerManager::DeleteServer(server_);
+        server_ = NULL;
+        evm_->Shutdown();
+        if (thread_.get() != NULL) {
+            thread_->Join();
+        }
+        task_util::WaitForIdle();
+    }
+
+    void HandleRequest(HttpSession *session, const HttpRequest *request) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        context_ = session->get_context();
+        delete request;
+    }
+
+    string context() {
+        tbb::mutex::scoped_lock lock(mutex_);
+        return context_;
+    }
+
+    // Connects a client and returns the context of its session
+    string Connect(LoopbackClient *client) {
+        client->Get("/chunked");
+        TASK_UTIL_EXPECT_FALSE(context().empty());
+        return context();
+    }
+
+    void SendReady() {
+        send_ready_count_++;
+    }
+
+    // Sends chunks till the socket blocks and then some more, so that the
+    // session has a queue to drain. Returns the bytes sent.
+    size_t FillSocket(const string &ctx) {
+        string data(kChunkSize, 'x');
+        size_t total = 0;
+        int queued = 0;
+        for (int i = 0; i < 1024 && queued < kQueuedChunks; i++) {
+            HttpSession::SendStatus status = HttpSession::SendChunkSession(
+                ctx, reinterpret_cast<const u_int8_t *>(data.c_str()),
+                data.size());
+            EXPECT_NE(HttpSession::SEND_CLOSED, status);
+            total += strlen("10000\r\n") + data.size() + 2;
+            if (status == HttpSession::SEND_QUEUED) {
+                queued++;
+            }
+        }
+        EXPECT_TRUE(queued == kQueuedChunks);
+        return total;
+    }
+
+    boost::scoped_ptr<EventManager> evm_;
+    boost::scoped_ptr<ServerThread> thread_;
+    HttpServer *server_;
+    tbb::mutex mutex_;
+    string context_;
+    tbb::atomic<int> send_ready_count_;
+};
+
+TEST_F(HttpSessionTest, ChunkFraming) {
+    LoopbackClient client(server_->GetPort());
+    string ctx = Connect(&client);
+
+    const string small("hello");
+    const string large(300, 'y');
+    EXPECT_EQ(HttpSession::SEND_DONE,
+              HttpSession::SendChunkedHeaderSession(ctx, "text/xml"));
+    EXPECT_EQ(HttpSession::SEND_DONE, HttpSession::SendChunkSession(ctx,
+        reinterpret_cast<const u_int8_t *>(small.c_str()), small.size()));
+    // An empty chunk must not end the response
+    EXPECT_EQ(HttpSession::SEND_DONE, HttpSession::SendChunkSession(ctx,
+        reinterpret_cast<const u_int8_t *>(""), 0));
+    EXPECT_EQ(HttpSession::SEND_DONE, HttpSession::SendChunkSession(ctx,
+        reinterpret_cast<const u_int8_t *>(large.c_str()), large.size()));
+    EXPECT_EQ(HttpSession::SEND_DONE,
+              HttpSession::SendLastChunkSession(ctx));
+
+    // Everything has been written, there is nothing to wait for
+    EXPECT_FALSE(HttpSession::RegisterSendReadySession(ctx,
+        boost::bind(&HttpSessionTest::SendReady, this)));
+
+    string response = client.ReadUntil("0\r\n\r\n");
+    string header;
+    vector<string> chunks;
+    ASSERT_TRUE(DecodeChunked(response, &header, &chunks));
+    EXPECT_EQ(0U, header.find("HTTP/1.1 200 OK\r\n"));
+    EXPECT_NE(string::npos, header.find("Content-Type: text/xml\r\n"));
+    EXPECT_NE(string::npos, header.find("Transfer-Encoding: chunked\r\n"));
+    ASSERT_EQ(2U, chunks.size());
+    EXPECT_EQ(small, chunks[0]);
+    EXPECT_EQ(large, chunks[1]);
+    EXPECT_NE(string::npos, response.find("\r\n5\r\nhello\r\n"));
+    EXPECT_NE(string::npos, response.find("\r\n12c\r\n"));
+    client.Close();
+}
+
+TEST_F(HttpSessionTest, SendReadyOnDrain) {
+    LoopbackClient client(server_->GetPort());
+    string ctx = Connect(&client);
+
+    const string header("HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/xml\r\n"
+                        "Transfer-Encoding: chunked\r\n"
+                        "\r\n");
+    EXPECT_EQ(HttpSession::SEND_DONE,
+              HttpSession::SendChunkedHeaderSession(ctx, "text/xml"));
+    size_t total = header.size() + FillSocket(ctx);
+
+    // The client is not reading, the callback waits for the drain
+    EXPECT_TRUE(HttpSession::RegisterSendReadySession(ctx,
+        boost::bind(&HttpSessionTest::SendReady, this)));
+    EXPECT_EQ(0, send_ready_count_);
+
+    EXPECT_EQ(total, client.Read(total).size());
+    TASK_UTIL_EXPECT_EQ(1, send_ready_count_);
+
+    // Ready again, the last chunk goes out right away
+    EXPECT_EQ(HttpSession::SEND_DONE,
+              HttpSession::SendLastChunkSession(ctx));
+    EXPECT_EQ("0\r\n\r\n", client.Read(5));
+    EXPECT_EQ(1, send_ready_count_);
+    client.Close();
+}
+
+TEST_F(HttpSessionTest, SendReadyOnClose) {
+    LoopbackClient client(server_->GetPort());
+    string ctx = Connect(&client);
+
+    EXPECT_EQ(HttpSession::SEND_DONE,
+              HttpSession::SendChunkedHeaderSession(ctx, "text/xml"));
+    FillSocket(ctx);
+    EXPECT_TRUE(HttpSession::RegisterSendReadySession(ctx,
+        boost::bind(&HttpSessionTest::SendReady, this)));
+
+    // The producer is woken up when the client goes away
+    client.Close();
+    TASK_UTIL_EXPECT_EQ(1, send_ready_count_);
+
+    // and then finds out the session is closed
+    const string data("late");
+    TASK_UTIL_EXPECT_EQ(HttpSession::SEND_CLOSED,
+        HttpSession::SendChunkSession(ctx,
+            reinterpret_cast<const u_int8_t *>(data.c_str()), data.size()));
+    EXPECT_EQ(HttpSession::SEND_CLOSED,
+              HttpSession::SendLastChunkSession(ctx));
+    EXPECT_FALSE(HttpSession::RegisterSendReadySession(ctx,
+        boost::bind(&HttpSessionTest::SendReady, this)));
+}
+
+TEST_F(HttpSessionTest, UnknownSession) {
+    EXPECT_EQ(HttpSession::SEND_CLOSED,
+              HttpSession::SendChunkedHeaderSession("http%none", "text/xml"));
+    EXPECT_EQ(HttpSession::SEND_CLOSED,
+              HttpSession::SendLastChunkSession("http%none"));
+}
+
+int main(int argc, char **argv) {
+    LoggingInit();
+    ::testing::InitGoogleTest(&argc, argv);
+    int result = RUN_ALL_TESTS();
+    TaskScheduler::GetInstance()->Terminate();
+    return result;
+}
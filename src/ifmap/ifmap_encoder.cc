@@ -19,83 +19,136 @@ IFMapMessage::IFMapMessage() : op_type_(NONE), node_count_(0),
 }
 
 void IFMapMessage::Open() {
-    xml_node iq = doc_.append_child("iq");
-    // set iq (type, from, to) attributes
-    iq.append_attribute("type") = "set";
-    iq.append_attribute("from") = "network-control@contrailsystems.com"; 
-    iq.append_attribute("to") = "";
-    config_ = iq.append_child("config");
+    receiver_.clear();
+    config_.clear();
+}
+
+// Escape the characters that are not allowed in an attribute value.
+static void EscapeAttribute(const string &value, string *out) {
+    for (string::const_iterator iter = value.begin(); iter != value.end();
+         ++iter) {
+        switch (*iter) {
+        case '&':
+            out->append("&amp;");
+            break;
+        case '<':
+            out->append("&lt;");
+            break;
+        case '>':
+            out->append("&gt;");
+            break;
+        case '"':
+            out->append("&quot;");
+            break;
+        default:
+            out->push_back(*iter);
+            break;
+        }
+    }
 }
 
 void IFMapMessage::Close() {
-    ostringstream oss;
-    doc_.save(oss);
-    str_ = oss.str();
+    str_.clear();
+    str_.reserve(config_.size() + receiver_.size() + 128);
+    str_.append("<?xml version=\"1.0\"?>\n");
+    // set iq (type, from, to) attributes
+    str_.append("<iq type=\"set\"");
+    str_.append(" from=\"network-control@contrailsystems.com\" to=\"");
+    EscapeAttribute(receiver_, &str_);
+    str_.append("\"><config>");
+    str_.append(config_);
+    if (op_type_ == UPDATE) {
+        str_.append("</update>");
+    } else if (op_type_ == DELETE) {
+        str_.append("</delete>");
+    }
+    str_.append("</config></iq>");
 }
 
 void IFMapMessage::SetReceiverInMsg(const std::string &cli_identifier) {
-    xml_node iq = doc_.child("iq");
-    assert(iq);
-    xml_attribute iqattr = iq.attribute("to");
-    assert(iqattr);
-    std::string str(cli_identifier);
-    str += "/config";
-    iqattr.set_value(str.c_str());
+    receiver_ = cli_identifier;
+    receiver_ += "/config";
 }
 
 void IFMapMessage::SetObjectsPerMessage(int num) {
     objects_per_message_ = num;
 }
 
-void IFMapMessage::EncodeUpdate(const IFMapUpdate *update) {
+void IFMapMessage::EncodeUpdate(const IFMapUpdate *update, IFMapState *state) {
     // update is either of type UPDATE OR DELETE
     if (update->IsUpdate()) {
         if (op_type_ != UPDATE) {
-            op_node_ = config_.append_child("update");
+            if (op_type_ == DELETE) {
+                config_.append("</delete>");
+            }
+            config_.append("<update>");
             op_type_ = UPDATE;
         }
-        if (update->data().type == IFMapObjectPtr::NODE) {
-            EncodeNode(update);
-        } else if (update->data().type == IFMapObjectPtr::LINK) {
-            EncodeLink(update);
-        } else {
-            assert(0);
-        }
     } else {
         if (op_type_ != DELETE) {
-            op_node_ = config_.append_child("delete");
+            if (op_type_ == UPDATE) {
+                config_.append("</update>");
+            }
+            config_.append("<delete>");
             op_type_ = DELETE;
         }
-        if (update->data().type == IFMapObjectPtr::NODE) {
-            EncodeNode(update);
-        } else if (update->data().type == IFMapObjectPtr::LINK) {
-            EncodeLink(update);
-        } else {
-            assert(0);
+    }
+
+    if (state == NULL) {
+        string xml;
+        Encode(update, &xml);
+        config_.append(xml);
+    } else {
+        if (state->encoded(update->type).empty()) {
+            string xml;
+            Encode(update, &xml);
+            state->SetEncoded(update->type, xml);
         }
+        config_.append(state->encoded(update->type));
+    }
+
+    if (update->data().type == IFMapObjectPtr::LINK) {
+        node_count_++;
     }
     node_count_++;
 }
 
-void IFMapMessage::EncodeNode(const IFMapUpdate *update) {
+void IFMapMessage::Encode(const IFMapUpdate *update, string *xml) {
+    xml_document doc;
+    xml_node parent = doc.append_child("config");
+    if (update->data().type == IFMapObjectPtr::NODE) {
+        EncodeNode(update, &parent);
+    } else if (update->data().type == IFMapObjectPtr::LINK) {
+        EncodeLink(update, &parent);
+    } else {
+        assert(0);
+    }
+
+    ostringstream oss;
+    for (xml_node node = parent.first_child(); node;
+         node = node.next_sibling()) {
+        node.print(oss, "", format_raw);
+    }
+    *xml = oss.str();
+}
+
+void IFMapMessage::EncodeNode(const IFMapUpdate *update, xml_node *parent) {
     IFMapNode *node = update->data().u.node;
     if (update->IsUpdate()) {
-        node->EncodeNodeDetail(&op_node_);
+        node->EncodeNodeDetail(parent);
     } else {
-        node->EncodeNode(&op_node_);
+        node->EncodeNode(parent);
     }    
 }
 
-void IFMapMessage::EncodeLink(const IFMapUpdate *update) {
-    xml_node link_node = op_node_.append_child("link");
+void IFMapMessage::EncodeLink(const IFMapUpdate *update, xml_node *parent) {
+    xml_node link_node = parent->append_child("link");
 
     const IFMapLink *link = update->data().u.link;
 
     IFMapNode::EncodeNode(link->left_id(), &link_node);
     IFMapNode::EncodeNode(link->right_id(), &link_node);
     //link->EncodeLinkInfo(&link_node);
-
-    node_count_++;
 }
 
 bool IFMapMessage::IsFull() {
@@ -107,7 +160,6 @@ bool IFMapMessage::IsEmpty() {
 }
 
 void IFMapMessage::Reset() {
-    doc_.reset();
     node_count_ = 0;
     op_type_ = NONE;
     Open();
@@ -5,12 +5,19 @@
 #ifndef __ctrlplane__ifmap_encoder__
 #define __ctrlplane__ifmap_encoder__
 
+#include <string>
 #include <pugixml/pugixml.hpp>
 
 class IFMapNode;
 class IFMapLink;
+class IFMapState;
 class IFMapUpdate;
 
+// The message is assembled as a string. The XML of each node and link is
+// encoded once and cached in its IFMapState until every client interested in
+// the update has been sent it, so that an object sent to many clients is not
+// re-encoded per client. Only the 'to' field of the envelope differs between
+// the clients.
 class IFMapMessage {
 public:
     static const int kObjectsPerMessage = 16;
@@ -20,7 +27,9 @@ public:
     // set the 'to' field in the message
     void SetReceiverInMsg(const std::string &cli_identifier);
     void SetObjectsPerMessage(int num);
-    void EncodeUpdate(const IFMapUpdate *update);
+    // state is the IFMapState of the object in the update. The encoding is
+    // not cached if state is NULL.
+    void EncodeUpdate(const IFMapUpdate *update, IFMapState *state = NULL);
     bool IsFull();
     bool IsEmpty();
     void Reset();
@@ -34,13 +43,13 @@ private:
         DELETE
     };
     void Open();
-    void EncodeNode(const IFMapUpdate *update);
-    void EncodeLink(const IFMapUpdate *update);
+    static void EncodeNode(const IFMapUpdate *update, pugi::xml_node *parent);
+    static void EncodeLink(const IFMapUpdate *update, pugi::xml_node *parent);
+    static void Encode(const IFMapUpdate *update, std::string *xml);
 
-    pugi::xml_document doc_;
-    pugi::xml_node config_;
-    Op op_type_;             // the current  type of op_node_
-    pugi::xml_node op_node_;
+    std::string receiver_;
+    std::string config_;     // contents of the config element
+    Op op_type_;             // the current op element open in config_
     std::string str_;
     int node_count_;
     int objects_per_message_;
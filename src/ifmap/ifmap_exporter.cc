@@ -285,6 +285,16 @@ IFMapLinkState *IFMapExporter::LinkStateLookup(IFMapLink *link) {
     return state;    
 }
 
+IFMapState *IFMapExporter::UpdateStateLookup(const IFMapUpdate *update) {
+    if (update->data().IsNode()) {
+        return NodeStateLookup(update->data().u.node);
+    }
+    if (update->data().IsLink()) {
+        return LinkStateLookup(update->data().u.link);
+    }
+    return NULL;
+}
+
 void IFMapExporter::MoveDependentLinks(IFMapNodeState *state) {
     for (IFMapNodeState::iterator iter = state->begin(); iter != state->end();
          ++iter) {
@@ -598,6 +608,7 @@ bool IFMapExporter::ConfigChanged(IFMapNode *node) {
     if (state->crc() != node_crc) {
         changed = true;
         state->SetCrc(node_crc);
+        state->ClearEncoded();
     }
 
     return changed;
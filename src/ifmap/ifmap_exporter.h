@@ -53,9 +53,12 @@ public:
     IFMapNodeState *NodeStateLocate(IFMapNode *node);
     IFMapNodeState *NodeStateLookup(IFMapNode *node);
     IFMapLinkState *LinkStateLookup(IFMapLink *link);
+    // State of the node or link that the update refers to.
+    IFMapState *UpdateStateLookup(const IFMapUpdate *update);
 
     DBTable *link_table() { return link_table_; }
     IFMapServer *server() { return server_; }
+    IFMapGraphWalker *graph_walker() { return walker_.get(); }
 
     bool FilterNeighbor(IFMapNode *lnode, IFMapNode *rnode);
 
@@ -4,6 +4,8 @@
 
 #include "ifmap/ifmap_graph_walker.h"
 
+#include <deque>
+#include <map>
 #include <boost/bind.hpp>
 #include "base/logging.h"
 #include "db/db_graph.h"
@@ -66,7 +68,9 @@ IFMapGraphWalker::IFMapGraphWalker(DBGraph *graph, IFMapExporter *exporter)
     : graph_(graph),
       exporter_(exporter),
       work_queue_(TaskScheduler::GetInstance()->GetTaskId("db::DBTable"), 0,
-                  boost::bind(&IFMapGraphWalker::Worker, this, _1)) {
+                  boost::bind(&IFMapGraphWalker::Worker, this, _1)),
+      traversal_count_(0),
+      vertex_visit_count_(0) {
     work_queue_.SetExitCallback(
         boost::bind(&IFMapGraphWalker::WorkBatchEnd, this, _1));
     traversal_white_list_.reset(new IFMapTypenameWhiteList());
@@ -132,32 +136,86 @@ bool IFMapGraphWalker::FilterNeighbor(IFMapNode *lnode, IFMapNode *rnode) {
     return false;
 }
 
-void IFMapGraphWalker::RecomputeInterest(DBGraphVertex *vertex, int bit) {
-    IFMapNode *node = static_cast<IFMapNode *>(vertex);
-    IFMapNodeState *state = exporter_->NodeStateLocate(node);
-    state->nmask_set(bit);
-}
+// Compute the nmask of all the nodes reachable from the virtual-routers of
+// the clients in bset with a single breadth-first traversal. Each vertex
+// carries the set of bits it acquired since it was last expanded, so a vertex
+// reachable from many clients is expanded once per new set of bits rather
+// than once per client.
+void IFMapGraphWalker::RecomputeInterest(const BitSet &bset) {
+    typedef std::map<IFMapNode *, BitSet> PendingMap;
+    PendingMap pending;
+    std::deque<IFMapNode *> queue;
 
-bool IFMapGraphWalker::Worker(QueueEntry work_entry) {
-    const BitSet &bset = work_entry.set;
     IFMapServer *server = exporter_->server();
+    // TODO: In order to handle interest based on the vswitch registration
+    // there need to be links in the graph that correspond to these.
+    IFMapTable *table = IFMapTable::FindTable(server->database(),
+                                              "virtual-router");
     for (size_t i = bset.find_first(); i != BitSet::npos;
          i = bset.find_next(i)) {
         IFMapClient *client = server->GetClient(i);
         if (client == NULL) {
             continue;
         }
-        // TODO: In order to handle interest based on the vswitch registration
-        // there need to be links in the graph that correspond to these.
-        IFMapTable *table = IFMapTable::FindTable(server->database(),
-                                                  "virtual-router");
         IFMapNode *node = table->FindNode(client->identifier());
-        if ((node != NULL) && node->IsVertexValid()) {
-            graph_->Visit(node,
-                boost::bind(&IFMapGraphWalker::RecomputeInterest, this, _1, i),
-                0, *traversal_white_list_.get());
+        if ((node == NULL) || !node->IsVertexValid()) {
+            continue;
+        }
+        IFMapNodeState *state = exporter_->NodeStateLocate(node);
+        state->nmask_set(i);
+        std::pair<PendingMap::iterator, bool> result =
+            pending.insert(std::make_pair(node, BitSet()));
+        result.first->second.set(i);
+        if (result.second) {
+            queue.push_back(node);
+        }
+    }
+
+    if (!queue.empty()) {
+        traversal_count_++;
+    }
+
+    while (!queue.empty()) {
+        IFMapNode *node = queue.front();
+        queue.pop_front();
+        PendingMap::iterator loc = pending.find(node);
+        BitSet bits = loc->second;
+        pending.erase(loc);
+        vertex_visit_count_++;
+
+        for (DBGraphVertex::edge_iterator iter = node->edge_list_begin(graph_);
+             iter != node->edge_list_end(graph_); ++iter) {
+            const DBGraphEdge *edge = iter.operator->();
+            IFMapNode *target = static_cast<IFMapNode *>(iter.target());
+            if (edge->IsDeleted() || target->IsDeleted()) {
+                continue;
+            }
+            if (!traversal_white_list_->VertexFilter(target) ||
+                !traversal_white_list_->EdgeFilter(node, target, edge)) {
+                continue;
+            }
+
+            // Propagate only the bits that the target hasn't seen yet.
+            IFMapNodeState *state = exporter_->NodeStateLocate(target);
+            BitSet nbits;
+            nbits.BuildComplement(bits, state->nmask());
+            if (nbits.empty()) {
+                continue;
+            }
+            state->NmaskOr(nbits);
+            std::pair<PendingMap::iterator, bool> result =
+                pending.insert(std::make_pair(target, BitSet()));
+            result.first->second |= nbits;
+            if (result.second) {
+                queue.push_back(target);
+            }
         }
     }
+}
+
+// Link removal is batched. The interest of all the affected clients is
+// recomputed once when the batch ends.
+bool IFMapGraphWalker::Worker(QueueEntry work_entry) {
     rm_mask_ |= work_entry.set;
     return true;
 }
@@ -197,6 +255,7 @@ void IFMapGraphWalker::CleanupInterest(DBGraphVertex *vertex) {
 // Cleanup all graph nodes that a bit set in the remove mask (rm_mask_) but
 // where not visited by the walker.
 void IFMapGraphWalker::WorkBatchEnd(bool done) {
+    RecomputeInterest(rm_mask_);
     for (DBGraph::vertex_iterator iter = graph_->vertex_list_begin();
          iter != graph_->vertex_list_end(); ++iter) {
         DBGraphVertex *vertex = iter.operator->();
@@ -32,6 +32,9 @@ public:
 
     bool FilterNeighbor(IFMapNode *lnode, IFMapNode *rnode);
 
+    uint64_t traversal_count() const { return traversal_count_; }
+    uint64_t vertex_visit_count() const { return vertex_visit_count_; }
+
 private:
     struct QueueEntry {
         BitSet set;
@@ -42,7 +45,7 @@ private:
 
     void ProcessLinkAdd(IFMapNode *lnode, IFMapNode *rnode, const BitSet &bset);
     void JoinVertex(DBGraphVertex *vertex, const BitSet &bset);
-    void RecomputeInterest(DBGraphVertex *vertex, int bit);
+    void RecomputeInterest(const BitSet &bset);
     void CleanupInterest(DBGraphVertex *vertex);
     void AddNodesToWhitelist();
     void AddLinksToWhitelist();
@@ -52,6 +55,8 @@ private:
     WorkQueue<QueueEntry> work_queue_;
     std::auto_ptr<IFMapTypenameWhiteList> traversal_white_list_;
     BitSet rm_mask_;
+    uint64_t traversal_count_;
+    uint64_t vertex_visit_count_;
 };
 
 #endif /* defined(__ctrlplane__ifmap_graph_walker__) */
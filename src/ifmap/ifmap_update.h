@@ -5,6 +5,7 @@
 #ifndef __DB_IFMAP_UPDATE_H__
 #define __DB_IFMAP_UPDATE_H__
 
+#include <string>
 #include <boost/crc.hpp>      // for boost::crc_32_type
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/slist.hpp>
@@ -135,6 +136,23 @@ public:
     const crc32type &crc() const { return crc_; }
     void SetCrc(crc32type &crc) { crc_ = crc; }
 
+    // XML encoding of the object, shared by the clients that an update of
+    // the object is sent to. Released once every interested client has been
+    // sent the update, and when the configuration of the object changes.
+    const std::string &encoded(IFMapListEntry::EntryType type) const {
+        return encoded_[type];
+    }
+    void SetEncoded(IFMapListEntry::EntryType type, const std::string &xml) {
+        encoded_[type] = xml;
+    }
+    void ClearEncoded(IFMapListEntry::EntryType type) {
+        std::string().swap(encoded_[type]);
+    }
+    void ClearEncoded() {
+        ClearEncoded(IFMapListEntry::UPDATE);
+        ClearEncoded(IFMapListEntry::DELETE);
+    }
+
 protected:
     static const uint32_t kInvalidSig = -1;
     uint32_t sig_;
@@ -149,6 +167,7 @@ private:
     UpdateList update_list_;
 
     crc32type crc_;
+    std::string encoded_[IFMapListEntry::MARKER];
 };
 
 class IFMapNodeState : public IFMapState {
@@ -171,6 +190,7 @@ public:
     const BitSet &nmask() const { return nmask_; }
     void nmask_clear() { nmask_.clear(); }
     void nmask_set(int bit) { nmask_.set(bit); }
+    void NmaskOr(const BitSet &bset) { nmask_ |= bset; }
 
 private:
     DEPENDENCY_LIST(IFMapLink, IFMapNodeState, dependents_);
@@ -213,11 +213,16 @@ void IFMapUpdateSender::ProcessUpdate(IFMapUpdate *update,
     LogAndCountSentUpdate(update, base_send_set);
 
     // Append the contents of the update-node to the message.
-    message_->EncodeUpdate(update);
+    IFMapState *state = server_->exporter()->UpdateStateLookup(update);
+    message_->EncodeUpdate(update, state);
 
-    // Clean up the node if everybody has seen it.
+    // Clean up the node if everybody has seen it. The message has its own
+    // copy of the encoding, which no other client needs anymore.
     update->AdvertiseReset(base_send_set);
     if (update->advertise().empty()) {
+        if (state) {
+            state->ClearEncoded(update->type);
+        }
         queue_->Dequeue(update);
     }
     // Update may be freed.
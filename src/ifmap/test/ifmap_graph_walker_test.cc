@@ -7,6 +7,7 @@
 #include <fstream>
 
 #include "base/logging.h"
+#include "base/util.h"
 #include "base/test/task_test_util.h"
 #include "control-node/control_node.h"
 #include "db/db.h"
@@ -656,6 +657,68 @@ TEST_F(IFMapGraphWalkerTest, VrsubConfignoprop) {
     c1.PrintNodes();
 }
 
+// Remove a link that is of interest to all the vrouters. The interest of all
+// the clients must be recomputed with a single traversal of the graph.
+TEST_F(IFMapGraphWalkerTest, MultiClientLinkRemove) {
+    static const int kClients = 100;
+
+    ifmap_test_util::IFMapMsgLink(&db_, "global-system-config", "gsc1",
+        "global-vrouter-config", "gvc1",
+        "global-system-config-global-vrouter-config");
+    vector<IFMapClientMock *> clients;
+    for (int i = 0; i < kClients; ++i) {
+        ostringstream oss;
+        oss << "vr" << i;
+        ifmap_test_util::IFMapMsgLink(&db_, "global-system-config", "gsc1",
+            "virtual-router", oss.str(), "global-system-config-virtual-router");
+        IFMapClientMock *client = new IFMapClientMock(oss.str());
+        server_.AddClient(client);
+        clients.push_back(client);
+    }
+    task_util::WaitForIdle();
+
+    for (int i = 0; i < kClients; ++i) {
+        TASK_UTIL_EXPECT_TRUE(clients[i]->NodeExists("global-vrouter-config",
+                                                     "gvc1"));
+    }
+
+    IFMapGraphWalker *walker = server_.exporter()->graph_walker();
+    uint64_t traversals = walker->traversal_count();
+    uint64_t visits = walker->vertex_visit_count();
+    uint64_t start = UTCTimestampUsec();
+
+    ifmap_test_util::IFMapMsgUnlink(&db_, "global-system-config", "gsc1",
+        "global-vrouter-config", "gvc1",
+        "global-system-config-global-vrouter-config");
+    task_util::WaitForIdle();
+    uint64_t elapsed = UTCTimestampUsec() - start;
+
+    for (int i = 0; i < kClients; ++i) {
+        TASK_UTIL_EXPECT_FALSE(clients[i]->NodeExists("global-vrouter-config",
+                                                      "gvc1"));
+        TASK_UTIL_EXPECT_TRUE(clients[i]->NodeExists("global-system-config",
+                                                     "gsc1"));
+    }
+
+    // A walk per client visits the virtual-router and global-system-config
+    // of every client. The single traversal visits global-system-config once.
+    uint64_t per_client_visits = kClients * 2;
+    uint64_t bfs_visits = walker->vertex_visit_count() - visits;
+    EXPECT_EQ(1U, walker->traversal_count() - traversals);
+    EXPECT_EQ(kClients + 1U, bfs_visits);
+    EXPECT_LT(bfs_visits, per_client_visits);
+    cout << "Interest recompute for " << kClients << " clients: "
+         << "per-client walks " << per_client_visits << " visits, "
+         << "single traversal " << bfs_visits << " visits in "
+         << elapsed << " usec" << endl;
+
+    for (int i = 0; i < kClients; ++i) {
+        server_.DeleteClient(clients[i]);
+    }
+    task_util::WaitForIdle();
+    STLDeleteValues(&clients);
+}
+
 // Calculate the white list filter information based on the xsd.
 TEST_F(IFMapGraphWalkerTest, PopulateWhiteList) {
     // Populate 'filter_info' with information from the xsd
@@ -36,11 +36,13 @@ public:
 
     virtual bool SendUpdate(const std::string &msg) {
         cout << "Sending " << endl << msg << endl;
+        last_msg_ = msg;
         send_update_cnt_++;
         return send_success_;
     }
 
     int get_send_update_cnt() { return send_update_cnt_; }
+    const string &last_msg() const { return last_msg_; }
 
     // Control if you want to block or continue sending
     void set_send_success(bool succ) { send_success_ = succ; }
@@ -49,6 +51,7 @@ private:
     string identifier_;
     bool send_success_;
     int send_update_cnt_;
+    string last_msg_;
 };
 
 struct IFMapUpdateDeleter {
@@ -1205,6 +1208,101 @@ TEST_F(IFMapUpdateSenderTest, Bug228) {
     queue_->PrintQueue();
 }
 
+// An update sent to multiple clients is encoded once. The encoding is cached
+// in the state of the node while an interested client has not been sent the
+// update yet, and only the receiver differs between messages.
+TEST_F(IFMapUpdateSenderTest, EncodeOnce) {
+    TestClient c0("c0");
+    TestClient c1("c1");
+    server_.ClientRegister(&c0);
+    server_.ClientRegister(&c1);
+
+    IFMapUpdate *u1 = CreateUpdate("u1", true);
+    IFMapUpdate *u2 = CreateUpdate("u2", false);
+
+    BitSet cli_bs;
+    cli_bs.set(c0.index());
+    cli_bs.set(c1.index());
+    u1->AdvertiseOr(cli_bs);
+    u2->AdvertiseOr(cli_bs);
+
+    queue_->Join(c0.index());
+    queue_->Join(c1.index());
+    queue_->Enqueue(u1);
+    queue_->Enqueue(u2);
+
+    // c1 is blocked, only c0 is sent the updates
+    SetSendBlocked(c1.index());
+    sender_->SendActive(c0.index());
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, c0.get_send_update_cnt());
+    TASK_UTIL_EXPECT_EQ(0, c1.get_send_update_cnt());
+
+    IFMapExporter *exporter = server_.exporter();
+    IFMapNodeState *s1 = exporter->NodeStateLookup(node_map_["u1"]);
+    IFMapNodeState *s2 = exporter->NodeStateLookup(node_map_["u2"]);
+    ASSERT_TRUE(s1 != NULL);
+    ASSERT_TRUE(s2 != NULL);
+    string update_xml = s1->encoded(IFMapListEntry::UPDATE);
+    string delete_xml = s2->encoded(IFMapListEntry::DELETE);
+    EXPECT_NE(string::npos, update_xml.find("u1"));
+    EXPECT_TRUE(s1->encoded(IFMapListEntry::DELETE).empty());
+    EXPECT_NE(string::npos, delete_xml.find("u2"));
+    EXPECT_TRUE(s2->encoded(IFMapListEntry::UPDATE).empty());
+
+    string expected =
+        "<config><update>" + update_xml + "</update><delete>" + delete_xml +
+        "</delete></config>";
+    EXPECT_NE(string::npos, c0.last_msg().find(expected));
+    EXPECT_NE(string::npos, c0.last_msg().find("to=\"c0/config\""));
+
+    // c1 is sent the cached encoding, which is then released
+    sender_->SendActive(c1.index());
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, c1.get_send_update_cnt());
+    EXPECT_NE(string::npos, c1.last_msg().find(expected));
+    EXPECT_NE(string::npos, c1.last_msg().find("to=\"c1/config\""));
+    EXPECT_TRUE(s1->encoded(IFMapListEntry::UPDATE).empty());
+    EXPECT_TRUE(s2->encoded(IFMapListEntry::DELETE).empty());
+    TASK_UTIL_EXPECT_EQ(1, queue_->size());
+
+    queue_->Leave(c0.index());
+    queue_->Leave(c1.index());
+}
+
+// The encoding is not kept once all the interested clients are sent the
+// update in the same message.
+TEST_F(IFMapUpdateSenderTest, EncodeReleased) {
+    TestClient c0("c0");
+    TestClient c1("c1");
+    server_.ClientRegister(&c0);
+    server_.ClientRegister(&c1);
+
+    IFMapUpdate *u1 = CreateUpdate("u1", true);
+    BitSet cli_bs;
+    cli_bs.set(c0.index());
+    cli_bs.set(c1.index());
+    u1->AdvertiseOr(cli_bs);
+
+    queue_->Join(c0.index());
+    queue_->Join(c1.index());
+    queue_->Enqueue(u1);
+
+    sender_->SendActive(c0.index());
+    task_util::WaitForIdle();
+    TASK_UTIL_EXPECT_EQ(1, c0.get_send_update_cnt());
+    TASK_UTIL_EXPECT_EQ(1, c1.get_send_update_cnt());
+    EXPECT_EQ(c0.last_msg().substr(c0.last_msg().find("<config>")),
+              c1.last_msg().substr(c1.last_msg().find("<config>")));
+
+    IFMapNodeState *s1 = server_.exporter()->NodeStateLookup(node_map_["u1"]);
+    ASSERT_TRUE(s1 != NULL);
+    EXPECT_TRUE(s1->encoded(IFMapListEntry::UPDATE).empty());
+
+    queue_->Leave(c0.index());
+    queue_->Leave(c1.index());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     bool success = RUN_ALL_TESTS();
@@ -59,6 +59,7 @@ public:
 
 protected:
     EventManager *event_manager() { return evm_; }
+    udp::socket *socket() { return &socket_; }
     virtual bool DisableSandeshLogMessages() { return false; }
     virtual std::string ToString() { return name_; }
 private:
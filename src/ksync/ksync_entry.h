@@ -49,10 +49,12 @@ public:
     // Use this constructor if automatic index allocation is *not* needed
     KSyncEntry() : index_(kInvalidIndex), state_(INIT), seen_(false) { 
         refcount_ = 0;
+        release_sock_hash_ = kInvalidIndex;
     };
     // Use this constructor if automatic index allocation is needed
     KSyncEntry(uint32_t index) : index_(index), state_(INIT), seen_(false) {
         refcount_ = 0;
+        release_sock_hash_ = kInvalidIndex;
     };
     virtual ~KSyncEntry() { assert(refcount_ == 0);};
 
@@ -99,6 +101,17 @@ public:
     // User defined error handler
     virtual void ErrorHandler(int err, uint32_t seqno) const;
 
+    // Hash used to pick the KSyncSock to send the entry on. An entry is sent
+    // only after entries it depends on are acked, so entries can be spread
+    // across sockets. Entries that must be programmed in order should return
+    // same hash
+    virtual size_t SockHash() const;
+    // Hash used to pick the KSyncSock to send delete of the entry on. An
+    // entry releasing a reference while it is synced sends its message after
+    // the release, so delete of the released entry is queued on the same
+    // KSyncSock behind that message
+    size_t DeleteSockHash() const;
+
     size_t GetIndex() const {return index_;};
     KSyncState GetState() const {return state_;};
     uint32_t GetRefCount() const {return refcount_;} 
@@ -124,6 +137,8 @@ private:
     KSyncState          state_;
     tbb::atomic<int>    refcount_;
     bool                seen_;
+    // SockHash() of entry that last released a reference to this entry
+    tbb::atomic<size_t> release_sock_hash_;
     DISALLOW_COPY_AND_ASSIGN(KSyncEntry);
 };
 
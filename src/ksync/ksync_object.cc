@@ -8,7 +8,10 @@
 #include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 
+#include <deque>
+
 #include <boost/bind.hpp>
+#include <tbb/enumerable_thread_specific.h>
 
 #include <base/logging.h>
 #include <db/db.h>
@@ -26,10 +29,77 @@
 #include "ksync_sock.h"
 #include "ksync_types.h"
 
-KSyncObject::FwdRefTree  KSyncObject::fwd_ref_tree_;
-KSyncObject::BackRefTree  KSyncObject::back_ref_tree_;
 KSyncObjectManager *KSyncObjectManager::singleton_;
 bool KSyncDebug::debug_;
+KSyncObject::AddFilter KSyncObject::add_filter_;
+
+// KSyncEntry being processed by the current thread. References released
+// while an entry is processed are recorded against its KSyncSock, so that
+// delete of the released entry is ordered behind the message of the entry.
+// Only tracked when KSyncEntries are spread across KSyncSocks
+// The hash is taken when processing starts since the entry may be freed
+// before processing completes
+struct KSyncReferrer {
+    KSyncReferrer() : entry(NULL), sock_hash(KSyncEntry::kInvalidIndex) { }
+    const KSyncEntry *entry;
+    size_t sock_hash;
+};
+static tbb::enumerable_thread_specific<KSyncReferrer> ksync_referrer;
+
+class KSyncReferrerScope {
+public:
+    KSyncReferrerScope(const KSyncEntry *entry) : active_(false) {
+        if (KSyncSock::GetParallelSend() == false) {
+            return;
+        }
+        active_ = true;
+        KSyncReferrer &referrer = ksync_referrer.local();
+        prev_ = referrer;
+        referrer.entry = entry;
+        referrer.sock_hash = entry->SockHash();
+    }
+    ~KSyncReferrerScope() {
+        if (active_) {
+            ksync_referrer.local() = prev_;
+        }
+    }
+
+private:
+    KSyncReferrer prev_;
+    bool active_;
+    DISALLOW_COPY_AND_ASSIGN(KSyncReferrerScope);
+};
+
+// Back-references to re-evaluate once the current thread releases the
+// last KSyncObject lock it holds. Lock of an object is taken with lock of
+// its referrers held when references are released, so the re-evaluation
+// must not lock the referrer objects in the reverse order
+struct KSyncReEvalList {
+    typedef std::pair<KSyncEntry *, KSyncEntry *> Entry;
+    KSyncReEvalList() : lock_depth(0), running(false) { }
+    int lock_depth;
+    bool running;
+    std::deque<Entry> entries;
+};
+static tbb::enumerable_thread_specific<KSyncReEvalList> ksync_reeval_list;
+
+class KSyncObject::ScopedLock {
+public:
+    explicit ScopedLock(KSyncObject *obj) : lock_(obj->lock_) {
+        ksync_reeval_list.local().lock_depth++;
+    }
+    ~ScopedLock() {
+        lock_.release();
+        KSyncReEvalList &list = ksync_reeval_list.local();
+        if (--list.lock_depth == 0 && list.running == false) {
+            KSyncObject::BackRefReEvalPending();
+        }
+    }
+
+private:
+    tbb::recursive_mutex::scoped_lock lock_;
+    DISALLOW_COPY_AND_ASSIGN(ScopedLock);
+};
 
 KSyncObject::KSyncObject() : need_index_(false), index_table_() {
 }
@@ -40,11 +110,18 @@ KSyncObject::KSyncObject(int max_index) :
 
 KSyncObject::~KSyncObject() {
     assert(tree_.size() == 0);
+    assert(fwd_ref_tree_.size() == 0);
+    assert(back_ref_tree_.size() == 0);
 }
 
 void KSyncObject::Shutdown() {
-    assert(fwd_ref_tree_.size() == 0);
-    assert(back_ref_tree_.size() == 0);
+}
+
+bool KSyncObject::FilterAdd(const char *msg, int msg_len) {
+    if (add_filter_.empty()) {
+        return false;
+    }
+    return add_filter_(msg, msg_len);
 }
 
 KSyncEntry *KSyncObject::Find(const KSyncEntry *key) {
@@ -69,7 +146,7 @@ KSyncEntry *KSyncObject::CreateImpl(const KSyncEntry *key) {
 }
 
 KSyncEntry *KSyncObject::Create(const KSyncEntry *key) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    ScopedLock lock(this);
     KSyncEntry *entry = Find(key);
     if (entry == NULL) {
         entry = CreateImpl(key);
@@ -114,7 +191,7 @@ void KSyncObject::FreeInd(KSyncEntry *entry, uint32_t index) {
 
 void KSyncObject::SafeNotifyEvent(KSyncEntry *entry, 
                                   KSyncEntry::KSyncEvent event) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    ScopedLock lock(this);
     NotifyEvent(entry, event);
 }
 
@@ -186,7 +263,7 @@ void KSyncDBObject::CleanupOnDel(KSyncEntry *entry) {
 // Generates events for the KSyncEntry state-machine based DBEntry
 // Stores the KSyncEntry allocated as DBEntry-state
 void KSyncDBObject::Notify(DBTablePartBase *partition, DBEntryBase *e) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    ScopedLock lock(this);
     DBEntry *entry = static_cast<DBEntry *>(e);
     DBTableBase *table = partition->parent();
     assert(table_ == table);
@@ -227,6 +304,7 @@ void KSyncDBObject::Notify(DBTablePartBase *partition, DBEntryBase *e) {
             need_sync = true;
         }
 
+        KSyncReferrerScope scope(ksync);
         if (ksync->Sync(entry) || need_sync) {
             NotifyEvent(ksync, KSyncEntry::ADD_CHANGE_REQ);
         }
@@ -243,6 +321,18 @@ bool KSyncEntry::IsResolved() {
     return ((state_ >= IN_SYNC) && (state_ < DEL_DEFER_SYNC));
 }
 
+size_t KSyncEntry::SockHash() const {
+    if (index_ != kInvalidIndex)
+        return index_;
+    return (reinterpret_cast<size_t>(this) >> 4);
+}
+
+size_t KSyncEntry::DeleteSockHash() const {
+    if (release_sock_hash_ != kInvalidIndex)
+        return release_sock_hash_;
+    return SockHash();
+}
+
 void KSyncEntry::ErrorHandler(int err, uint32_t seq_no) const {
     if (err == 0) {
         return;
@@ -382,6 +472,13 @@ void intrusive_ptr_add_ref(KSyncEntry *p) {
 // (i) delete was deferred due to refcount or
 // (ii) the ksync entry is in TEMP state.
 void intrusive_ptr_release(KSyncEntry *p) {
+    if (KSyncSock::GetParallelSend()) {
+        const KSyncReferrer &referrer = ksync_referrer.local();
+        if (referrer.entry != NULL && referrer.entry != p) {
+            p->release_sock_hash_ = referrer.sock_hash;
+        }
+    }
+
     if (--p->refcount_ == 1) {
         KSyncObject *obj = p->GetObject();
         switch(p->state_) {
@@ -405,11 +502,11 @@ bool KSyncNetlinkEntry::Add() {
 
     Sync();
     msg_len = AddMsg(msg, KSYNC_DEFAULT_MSG_SIZE);
-    if (msg_len == 0) {
+    if (msg_len == 0 || KSyncObject::FilterAdd(msg, msg_len)) {
         free(msg);
         return true;
     }
-    KSyncSock   *sock = KSyncSock::Get(0);
+    KSyncSock   *sock = KSyncSock::Get(this);
     sock->SendAsync(this, msg_len, msg, KSyncEntry::ADD_ACK);
     return false;
 }
@@ -428,7 +525,7 @@ bool KSyncNetlinkEntry::Change() {
         free(msg);
         return true;
     }
-    KSyncSock   *sock = KSyncSock::Get(0);
+    KSyncSock   *sock = KSyncSock::Get(this);
     sock->SendAsync(this, msg_len, msg, KSyncEntry::CHANGE_ACK);
     return false;
 }
@@ -442,7 +539,7 @@ bool KSyncNetlinkEntry::Delete() {
         free(msg);
         return true;
     }
-    KSyncSock   *sock = KSyncSock::Get(0);
+    KSyncSock   *sock = KSyncSock::GetForDelete(this);
     sock->SendAsync(this, msg_len, msg, KSyncEntry::DEL_ACK);
     return false;
 }
@@ -455,11 +552,11 @@ bool KSyncNetlinkDBEntry::Add() {
     int         msg_len;
 
     msg_len = AddMsg(msg, KSYNC_DEFAULT_MSG_SIZE); 
-    if (msg_len == 0) {
+    if (msg_len == 0 || KSyncObject::FilterAdd(msg, msg_len)) {
         free(msg);
         return true;
     }
-    KSyncSock   *sock = KSyncSock::Get(0);
+    KSyncSock   *sock = KSyncSock::Get(this);
     sock->SendAsync(this, msg_len, msg, KSyncEntry::ADD_ACK);
     return false;
 }
@@ -473,7 +570,7 @@ bool KSyncNetlinkDBEntry::Change() {
         free(msg);
         return true;
     }
-    KSyncSock   *sock = KSyncSock::Get(0);
+    KSyncSock   *sock = KSyncSock::Get(this);
     sock->SendAsync(this, msg_len, msg, KSyncEntry::CHANGE_ACK);
     return false;
 }
@@ -487,7 +584,7 @@ bool KSyncNetlinkDBEntry::Delete() {
         free(msg);
         return true;
     }
-    KSyncSock   *sock = KSyncSock::Get(0);
+    KSyncSock   *sock = KSyncSock::GetForDelete(this);
     sock->SendAsync(this, msg_len, msg, KSyncEntry::DEL_ACK);
     return false;
 }
@@ -1012,6 +1109,7 @@ void KSyncObject::NotifyEvent(KSyncEntry *entry, KSyncEntry::KSyncEvent event) {
 
     KSyncEntry::KSyncState state;
     bool dep_reval = false;
+    KSyncReferrerScope scope(entry);
 
     if (DoEventTrace()) {
         KSYNC_TRACE(Event, entry->ToString(), entry->StateString(),
@@ -1093,7 +1191,7 @@ void KSyncObject::NotifyEvent(KSyncEntry *entry, KSyncEntry::KSyncEvent event) {
 }
 
 void KSyncObject::NetlinkAckInternal(KSyncEntry *entry, KSyncEntry::KSyncEvent event) {
-    tbb::recursive_mutex::scoped_lock lock(lock_);
+    ScopedLock lock(this);
     entry->Response();
     NotifyEvent(entry, event);
 }
@@ -1114,9 +1212,7 @@ void KSyncObject::BackRefAdd(KSyncEntry *key, KSyncEntry *reference) {
     intrusive_ptr_add_ref(reference);
 
     KSyncBackReference *back_node = new KSyncBackReference(reference, key);
-    BackRefTree::iterator back_it = back_ref_tree_.find(*back_node);
-    assert(back_it == back_ref_tree_.end());
-    back_ref_tree_.insert(*back_node);
+    reference->GetObject()->BackRefNodeAdd(back_node);
 }
 
 void KSyncObject::BackRefDel(KSyncEntry *key) {
@@ -1130,39 +1226,80 @@ void KSyncObject::BackRefDel(KSyncEntry *key) {
     fwd_ref_tree_.erase(fwd_it);
     delete entry;
 
-    KSyncBackReference back_search_node(reference, key);
+    reference->GetObject()->BackRefNodeDel(reference, key);
+
+    intrusive_ptr_release(key);
+    intrusive_ptr_release(reference);
+}
+
+void KSyncObject::BackRefNodeAdd(KSyncBackReference *node) {
+    tbb::mutex::scoped_lock lock(back_ref_lock_);
+    BackRefTree::iterator back_it = back_ref_tree_.find(*node);
+    assert(back_it == back_ref_tree_.end());
+    back_ref_tree_.insert(*node);
+}
+
+void KSyncObject::BackRefNodeDel(KSyncEntry *key, KSyncEntry *back_ref) {
+    tbb::mutex::scoped_lock lock(back_ref_lock_);
+    KSyncBackReference back_search_node(key, back_ref);
     BackRefTree::iterator back_it = back_ref_tree_.find(back_search_node);
     assert(back_it != back_ref_tree_.end());
     KSyncBackReference *back_node = back_it.operator->();
     back_ref_tree_.erase(back_it);
     delete back_node;
-
-    intrusive_ptr_release(key);
-    intrusive_ptr_release(reference);
 }
 
+// Entries waiting on key can belong to other KSyncObjects. Their
+// re-evaluation is deferred till the current thread releases lock of this
+// object, so that locks of objects are never nested against the direction
+// of references. A reference is held on the waiting entries and key till
+// they are re-evaluated, since their objects can process them concurrently
 void KSyncObject::BackRefReEval(KSyncEntry *key) {
-    std::vector<KSyncEntry *> buf;
+    KSyncReEvalList &list = ksync_reeval_list.local();
     KSyncBackReference node(key, NULL);
 
+    tbb::mutex::scoped_lock lock(back_ref_lock_);
     for (BackRefTree::iterator it = back_ref_tree_.upper_bound(node); 
-         it != back_ref_tree_.end(); ) {
-        BackRefTree::iterator it_work = it++;
-
-        KSyncBackReference *entry = it_work.operator->();
+         it != back_ref_tree_.end(); ++it) {
+        KSyncBackReference *entry = it.operator->();
         if (entry->key_ != key) {
             break;
         }
-        KSyncEntry *back_ref = entry->back_reference_;
-        buf.push_back(back_ref);
-        BackRefDel(entry->back_reference_);
+        intrusive_ptr_add_ref(entry->back_reference_);
+        intrusive_ptr_add_ref(key);
+        list.entries.push_back(KSyncReEvalList::Entry(entry->back_reference_,
+                                                      key));
     }
+}
 
-    std::vector<KSyncEntry *>::iterator it = buf.begin();
-    while (it != buf.end()) {
-        NotifyEvent(*it, KSyncEntry::RE_EVAL);
-        it++;
+// Runs with no KSyncObject lock held. Each entry is re-evaluated under
+// lock of its own object only. Re-evaluation can resolve more entries,
+// which are queued and processed in the same loop
+void KSyncObject::BackRefReEvalPending() {
+    KSyncReEvalList &list = ksync_reeval_list.local();
+    list.running = true;
+    while (list.entries.empty() == false) {
+        KSyncEntry *back_ref = list.entries.front().first;
+        KSyncEntry *key = list.entries.front().second;
+        list.entries.pop_front();
+
+        KSyncObject *obj = back_ref->GetObject();
+        {
+            ScopedLock lock(obj);
+            // Skip if entry stopped waiting on key in the meanwhile
+            KSyncFwdReference fwd_search_node(back_ref, NULL);
+            FwdRefTree::iterator fwd_it =
+                obj->fwd_ref_tree_.find(fwd_search_node);
+            if (fwd_it != obj->fwd_ref_tree_.end() &&
+                fwd_it->reference_ == key) {
+                obj->BackRefDel(back_ref);
+                obj->NotifyEvent(back_ref, KSyncEntry::RE_EVAL);
+            }
+        }
+        intrusive_ptr_release(back_ref);
+        intrusive_ptr_release(key);
     }
+    list.running = false;
 }
 
 bool KSyncObjectManager::Process(KSyncObjectEvent *event) {
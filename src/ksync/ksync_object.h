@@ -5,6 +5,7 @@
 #ifndef ctrlplane_ksync_object_h 
 #define ctrlplane_ksync_object_h 
 
+#include <boost/function.hpp>
 #include <tbb/mutex.h>
 #include <tbb/recursive_mutex.h>
 #include <base/queue_task.h>
@@ -13,19 +14,29 @@
 // Back-Ref management needs two trees,
 // Back-Ref tree:
 // --------------
-// An entry of type <key-entry, back-ref-entry> means that key-entry is
-// waiting for back-ref-entry to be added to kernel.
-// Note, there can be more than one key-entry waiting on a single 
-// back-ref-entry. However, a key-entry can be waiting on only one
-// back-ref-entry at a time.
+// An entry of type <key-entry, back-ref-entry> means that back-ref-entry is
+// waiting for key-entry to be added to kernel.
+// Note, there can be more than one back-ref-entry waiting on a single 
+// key-entry. However, a back-ref-entry can be waiting on only one
+// key-entry at a time.
 //
 // This is a dynamic tree. Entries are added only when constraints are not
 // met. Entries will not be in tree when constraints are met.
 //
+// Back-Ref tree is maintained in the KSyncObject of key-entry and is
+// protected by back_ref_lock_ of the object, since entries of other objects
+// add themselves to it.
+//
 // Fwd-Ref tree: 
 // -------------
 // Holds forward reference information. If Object-A is waiting on Object-B
 // Fwd-Ref tree will have an entry with Object-A as key and Object-B as data.
+//
+// Fwd-Ref tree is maintained in the KSyncObject of Object-A and is protected
+// by lock_ of the object.
+//
+// Keeping the trees per KSyncObject lets state-machines of independent
+// objects run concurrently without a global lock.
 /////////////////////////////////////////////////////////////////////////////
 
 struct KSyncFwdReference {
@@ -97,7 +108,7 @@ public:
     void BackRefAdd(KSyncEntry *key, KSyncEntry *reference);
     // Delete a back-reference entry
     void BackRefDel(KSyncEntry *key);
-    // Re-valuate the back-reference entries
+    // Queue re-valuation of the back-reference entries
     void BackRefReEval(KSyncEntry *key);
 
     // Create an entry
@@ -121,6 +132,16 @@ public:
 
     virtual bool DoEventTrace(void) { return true; }
     static void Shutdown();
+
+    // Filter invoked with ADD message of netlink entries before sending to
+    // kernel. Message is not sent if filter returns true and entry moves to
+    // IN_SYNC state. Used to skip entries already present in kernel
+    typedef boost::function<bool(const char *, int)> AddFilter;
+    static void set_add_filter(AddFilter filter) { add_filter_ = filter; }
+    static bool FilterAdd(const char *msg, int msg_len);
+
+    size_t fwd_ref_count() const { return fwd_ref_tree_.size(); }
+    size_t back_ref_count() const { return back_ref_tree_.size(); }
 protected:
     // Create an entry with default state. Used internally
     KSyncEntry *CreateImpl(const KSyncEntry *key);
@@ -130,10 +151,16 @@ protected:
 
 private:
     friend class KSyncEntry;
+    class ScopedLock;
+    // Re-valuate back-references queued by BackRefReEval
+    static void BackRefReEvalPending();
     // Free indication of an KSyncElement. 
     // Removes from tree and free index if allocated earlier
     void FreeInd(KSyncEntry *entry, uint32_t index);
     void NetlinkAckInternal(KSyncEntry *entry, KSyncEntry::KSyncEvent event);
+    // Manage back-reference nodes for entries of this object
+    void BackRefNodeAdd(KSyncBackReference *node);
+    void BackRefNodeDel(KSyncEntry *key, KSyncEntry *back_ref);
 
     bool IsIndexValid() const { return need_index_; }
 
@@ -142,14 +169,16 @@ private:
 
     // Tree of all KSyncEntries
     Tree tree_;
-    // Forward reference tree
-    static FwdRefTree  fwd_ref_tree_;
-    // Back reference tree
-    static BackRefTree  back_ref_tree_;
+    // Forward reference tree for entries of this object
+    FwdRefTree  fwd_ref_tree_;
+    // Back reference tree for entries of this object
+    BackRefTree  back_ref_tree_;
+    tbb::mutex  back_ref_lock_;
     // Does the KSyncEntry need index?
     bool need_index_;
     // Index table for KSyncObject
     KSyncIndexTable index_table_;
+    static AddFilter add_filter_;
     DISALLOW_COPY_AND_ASSIGN(KSyncObject);
 };
 
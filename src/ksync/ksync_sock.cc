@@ -43,6 +43,7 @@ AgentSandeshContext *KSyncSock::agent_sandesh_ctx_;
 std::vector<KSyncSock *> KSyncSock::sock_table_;
 pid_t KSyncSock::pid_;
 tbb::atomic<bool> KSyncSock::shutdown_;
+bool KSyncSock::parallel_send_;
 
 const char* IoContext::io_wq_names[IoContext::MAX_WORK_QUEUES] = 
                                                 {"Agent::KSync", "Agent::Uve"};
@@ -287,16 +288,23 @@ void KSyncSockUdp::Receive(mutable_buffers_1 buf) {
     sock_.receive_from(buf, ep);
 }
 
-KSyncSock::KSyncSock() : tx_count_(0), err_count_(0), run_sync_mode_(true) {
+KSyncSock::KSyncSock() : tx_count_(0), err_count_(0), run_sync_mode_(true),
+    bulk_mode_(false), bulk_ctx_(NULL), bulk_msg_count_(0),
+    bulk_entry_count_(0) {
     for(int i = 0; i < IoContext::MAX_WORK_QUEUES; i++) {
         receive_work_queue[i] = new WorkQueue<char *>(TaskScheduler::GetInstance()->
                              GetTaskId(IoContext::io_wq_names[i]), 0,
                              boost::bind(&KSyncSock::ProcessKernelData, this, 
                                          _1));
     }
+    // Send queues of all KSyncSocks run in parallel only when entries are
+    // spread across them
     async_send_queue_ = new WorkQueue<IoContext *>(TaskScheduler::GetInstance()->
-                            GetTaskId("Ksync::AsyncSend"), 0,
+                            GetTaskId("Ksync::AsyncSend"),
+                            parallel_send_ ? -1 : 0,
                             boost::bind(&KSyncSock::SendAsyncImpl, this, _1));
+    async_send_queue_->SetExitCallback(
+            boost::bind(&KSyncSock::OnSendQueueExit, this, _1));
     rx_buff_ = NULL;
     seqno_ = 0;
     uve_seqno_ = 0;
@@ -312,6 +320,7 @@ KSyncSock::~KSyncSock() {
 
     assert(async_send_queue_->Length() == 0);
     async_send_queue_->Shutdown();
+    delete bulk_ctx_;
     delete async_send_queue_;
 
     for(int i = 0; i < IoContext::MAX_WORK_QUEUES; i++) {
@@ -419,23 +428,33 @@ bool KSyncSock::ProcessKernelData(char *data) {
     Tree::iterator it = GetIoContext(data);
     IoContext *context = it.operator->();
 
-    AgentSandeshContext *ctxt = context->GetSandeshContext();
+    // Responses for a bulk message arrive in the order of batched requests.
+    // Run handlers of the batched context the response belongs to
+    KSyncBulkIoContext *bulk_ctx = dynamic_cast<KSyncBulkIoContext *>(context);
+    IoContext *ioc = context;
+    if (bulk_ctx != NULL) {
+        ioc = bulk_ctx->current();
+    }
+
+    AgentSandeshContext *ctxt = ioc->GetSandeshContext();
     ctxt->SetErrno(0);
-    ctxt->set_ksync_io_ctx(static_cast<KSyncIoContext *>(context));
+    ctxt->set_ksync_io_ctx(static_cast<KSyncIoContext *>(ioc));
     Decoder(data, ctxt);
     ctxt->set_ksync_io_ctx(NULL);
     if (ctxt->GetErrno() != 0) {
-        context->ErrorHandler(ctxt->GetErrno());
+        ioc->ErrorHandler(ctxt->GetErrno());
     }
 
     if (!IsMoreData(data)) {
-        context->Handler();
-        {
-            tbb::mutex::scoped_lock lock(mutex_);
-            wait_tree_.erase(it);
+        ioc->Handler();
+        if (bulk_ctx == NULL || bulk_ctx->ResponseDone()) {
+            {
+                tbb::mutex::scoped_lock lock(mutex_);
+                wait_tree_.erase(it);
+            }
+            async_send_queue_->MayBeStartRunner();
+            delete(context);
         }
-        async_send_queue_->MayBeStartRunner();
-        delete(context);
     }
 
     delete[] data;
@@ -463,6 +482,26 @@ KSyncSock *KSyncSock::Get(int idx) {
     return sock_table_[idx];
 }
 
+// With parallel send, add/change of an entry is sent only after the entries
+// it refers to are acked, so it cannot overtake them on another KSyncSock
+KSyncSock *KSyncSock::Get(const KSyncEntry *entry) {
+    if (parallel_send_ == false) {
+        return sock_table_[0];
+    }
+    return sock_table_[entry->SockHash() % sock_table_.size()];
+}
+
+// An entry is deleted once its last reference is released. The referrer
+// releasing it (ex. route moving to a new nexthop) may not be acked yet, so
+// the delete is sent on the KSyncSock of that referrer to keep it behind the
+// referrer's message
+KSyncSock *KSyncSock::GetForDelete(const KSyncEntry *entry) {
+    if (parallel_send_ == false) {
+        return sock_table_[0];
+    }
+    return sock_table_[entry->DeleteSockHash() % sock_table_.size()];
+}
+
 size_t KSyncSock::BlockingSend(const char *msg, int msg_len) {
     return SendTo(buffer(msg, msg_len), 0);
 }
@@ -502,6 +541,51 @@ void KSyncSock::GenericSend(IoContext *ioc) {
 }
 
 bool KSyncSock::SendAsyncImpl(IoContext *ioc) {
+    // Only messages for KSyncEntries are batched. Others are sent after
+    // flushing the pending bulk message to retain the order of messages
+    if (bulk_mode_ && dynamic_cast<KSyncIoContext *>(ioc) != NULL) {
+        if (bulk_ctx_ == NULL) {
+            bulk_ctx_ = new KSyncBulkIoContext(AllocSeqNo(false));
+        }
+
+        if (bulk_ctx_->Add(ioc) == false) {
+            BulkFlush();
+            bulk_ctx_ = new KSyncBulkIoContext(AllocSeqNo(false));
+            bool ret = bulk_ctx_->Add(ioc);
+            assert(ret);
+        }
+
+        if (bulk_ctx_->IsFull()) {
+            BulkFlush();
+        }
+        return true;
+    }
+
+    BulkFlush();
+    SendIoContext(ioc);
+    return true;
+}
+
+// Send the pending bulk message. Invoked when bulk message is full, before
+// sending a message that cannot be batched and when the send queue runner
+// exits
+void KSyncSock::BulkFlush() {
+    if (bulk_ctx_ == NULL) {
+        return;
+    }
+
+    KSyncBulkIoContext *bulk_ctx = bulk_ctx_;
+    bulk_ctx_ = NULL;
+    bulk_msg_count_++;
+    bulk_entry_count_ += bulk_ctx->count();
+    SendIoContext(bulk_ctx);
+}
+
+void KSyncSock::OnSendQueueExit(bool done) {
+    BulkFlush();
+}
+
+void KSyncSock::SendIoContext(IoContext *ioc) {
     {
         tbb::mutex::scoped_lock lock(mutex_);
         wait_tree_.insert(*ioc);
@@ -514,15 +598,21 @@ bool KSyncSock::SendAsyncImpl(IoContext *ioc) {
     } else {
         SendTo(boost::asio::buffer((const char *)ioc->GetMsg(),
                     ioc->GetMsgLen()), ioc->GetSeqno());
-        bool more_data = false;
+        // Bulk message gets one response per batched request
+        uint32_t response_count = 1;
+        KSyncBulkIoContext *bulk_ctx = dynamic_cast<KSyncBulkIoContext *>(ioc);
+        if (bulk_ctx != NULL) {
+            response_count = bulk_ctx->count();
+        }
         do {
             char *rxbuf = new char[kBufLen];
             Receive(boost::asio::buffer(rxbuf, kBufLen));
-            more_data = IsMoreData(rxbuf);
+            if (!IsMoreData(rxbuf)) {
+                response_count--;
+            }
             ValidateAndEnqueue(rxbuf);
-        } while(more_data);
+        } while(response_count != 0);
     }
-    return true;
 }
 
 KSyncIoContext::KSyncIoContext(KSyncEntry *sync_entry, int msg_len,
@@ -540,3 +630,43 @@ void KSyncIoContext::Handler() {
 void KSyncIoContext::ErrorHandler(int err) {
     entry_->ErrorHandler(err, GetSeqno());
 }
+
+KSyncBulkIoContext::KSyncBulkIoContext(uint32_t seqno) :
+    IoContext((char *)malloc(KSyncSock::kBulkMsgLen), 0, seqno,
+              KSyncSock::GetAgentSandeshContext()), current_(0) {
+    ioc_list_.reserve(KSYNC_BULK_MSG_COUNT_MAX);
+}
+
+KSyncBulkIoContext::~KSyncBulkIoContext() {
+    for (uint32_t i = current_; i < ioc_list_.size(); i++) {
+        delete ioc_list_[i];
+    }
+}
+
+bool KSyncBulkIoContext::Add(IoContext *ioc) {
+    if (IsFull())
+        return false;
+
+    // KSyncEntry messages are encoded in KSYNC_DEFAULT_MSG_SIZE buffers, so
+    // an empty bulk message can always accomodate one
+    uint32_t len = GetMsgLen();
+    assert(ioc->GetMsgLen() <= KSyncSock::kBulkMsgLen);
+    if (len + ioc->GetMsgLen() > KSyncSock::kBulkMsgLen)
+        return false;
+
+    memcpy(GetMsg() + len, ioc->GetMsg(), ioc->GetMsgLen());
+    SetMsgLen(len + ioc->GetMsgLen());
+    ioc->SetSeqno(GetSeqno());
+    ioc_list_.push_back(ioc);
+    return true;
+}
+
+bool KSyncBulkIoContext::IsFull() const {
+    return ioc_list_.size() >= KSYNC_BULK_MSG_COUNT_MAX;
+}
+
+bool KSyncBulkIoContext::ResponseDone() {
+    delete ioc_list_[current_];
+    current_++;
+    return (current_ == ioc_list_.size());
+}
@@ -24,6 +24,7 @@
 #define KSYNC_DEFAULT_Q_ID_SEQ    0x00000001
 #define KSYNC_ACK_WAIT_THRESHOLD  200
 #define KSYNC_SOCK_RECV_BUFF_SIZE (256 * 1024)
+#define KSYNC_BULK_MSG_COUNT_MAX  16
 
 #define KSYNC_ERROR(obj, ...)\
 do {\
@@ -77,7 +78,8 @@ public:
         MAX_WORK_QUEUES // This should always be last
     };
     static const char* io_wq_names[MAX_WORK_QUEUES];
-    IoContext() : ctx_(NULL), msg_(NULL), msg_len_(0), seqno_(0) { };
+    IoContext() : ctx_(NULL), msg_(NULL), msg_len_(0), seqno_(0),
+        work_q_id_(DEFAULT_Q_ID) { };
 
     IoContext(char *msg, uint32_t len, uint32_t seq, AgentSandeshContext *ctx) 
         : ctx_(ctx), msg_(msg), msg_len_(len), seqno_(seq), 
@@ -110,6 +112,7 @@ public:
 
 protected:
     AgentSandeshContext *ctx_;
+    void SetMsgLen(uint32_t len) {msg_len_ = len;};
 
 private:
     char *msg_;
@@ -134,6 +137,34 @@ private:
     KSyncEntry::KSyncEvent event_;
 };
 
+/* IoContext aggregating multiple KSyncIoContexts that are sent to kernel as
+ * a single netlink message. Kernel responds to each of the batched requests
+ * in order, so responses are mapped back to the batched contexts in the
+ * order they were added
+ */
+class KSyncBulkIoContext : public IoContext {
+public:
+    KSyncBulkIoContext(uint32_t seqno);
+    virtual ~KSyncBulkIoContext();
+
+    // Append message of ioc into the bulk message. Returns false if the
+    // bulk message cannot accomodate ioc
+    bool Add(IoContext *ioc);
+    bool IsFull() const;
+    bool Empty() const { return ioc_list_.empty(); }
+    uint32_t count() const { return ioc_list_.size(); }
+
+    // Context to which the response being processed belongs
+    IoContext *current() const { return ioc_list_[current_]; }
+    // Response for current context is complete. Returns true when responses
+    // for all batched contexts are processed
+    bool ResponseDone();
+private:
+    std::vector<IoContext *> ioc_list_;
+    uint32_t current_;
+    DISALLOW_COPY_AND_ASSIGN(KSyncBulkIoContext);
+};
+
 typedef boost::intrusive::member_hook<IoContext,
         boost::intrusive::set_member_hook<>,
         &IoContext::node_> KSyncSockNode;
@@ -143,6 +174,7 @@ class KSyncSock {
 public:
     const static int kMsgGrowSize = 16;
     const static unsigned kBufLen = 4096;
+    const static unsigned kBulkMsgLen = KSYNC_DEFAULT_MSG_SIZE;
 
     typedef boost::function<void(const boost::system::error_code &, size_t)> HandlerCb;
     KSyncSock();
@@ -155,6 +187,14 @@ public:
     // Partition to KSyncSock mapping
     static KSyncSock *Get(DBTablePartBase *partition);
     static KSyncSock *Get(int partition_id);
+    // KSyncSock to send add/change of a KSyncEntry on
+    static KSyncSock *Get(const KSyncEntry *entry);
+    // KSyncSock to send delete of a KSyncEntry on
+    static KSyncSock *GetForDelete(const KSyncEntry *entry);
+    // Spread KSyncEntries across all KSyncSocks. Must be set before the
+    // KSyncSocks are created
+    static void SetParallelSend(bool enable) {parallel_send_ = enable;};
+    static bool GetParallelSend() {return parallel_send_;};
     // Write a KSyncEntry to kernel
     void SendAsync(KSyncEntry *entry, int msg_len, char *msg, KSyncEntry::KSyncEvent event);
     std::size_t BlockingSend(const char *msg, int msg_len);
@@ -181,6 +221,12 @@ public:
         agent_sandesh_ctx_ = ctx;
     }
     virtual void Decoder(char *data, SandeshContext *ctxt) = 0;
+
+    // Batch KSyncEntry messages into a single netlink message
+    void set_bulk_mode(bool bulk_mode) { bulk_mode_ = bulk_mode; }
+    bool bulk_mode() const { return bulk_mode_; }
+    int bulk_msg_count() const { return bulk_msg_count_; }
+    int bulk_entry_count() const { return bulk_entry_count_; }
 protected:
     static void Init(int count);
     static void SetSockTableEntry(int i, KSyncSock *sock);
@@ -203,6 +249,9 @@ private:
     virtual bool Validate(char *data) = 0;
     bool ValidateAndEnqueue(char *data);
     bool SendAsyncImpl(IoContext *ioc);
+    void SendIoContext(IoContext *ioc);
+    void BulkFlush();
+    void OnSendQueueExit(bool done);
 
     bool SendAsyncStart() {
         tbb::mutex::scoped_lock lock(mutex_);
@@ -224,6 +273,7 @@ private:
     static int vnsw_netlink_family_id_;
     static AgentSandeshContext *agent_sandesh_ctx_;
     static tbb::atomic<bool> shutdown_;
+    static bool parallel_send_;
 
     char *rx_buff_;
     tbb::atomic<int> seqno_;
@@ -235,6 +285,12 @@ private:
     int err_count_;
     bool run_sync_mode_;
 
+    // Bulk message being built. Accessed only from Ksync::AsyncSend task
+    bool bulk_mode_;
+    KSyncBulkIoContext *bulk_ctx_;
+    int bulk_msg_count_;
+    int bulk_entry_count_;
+
     DISALLOW_COPY_AND_ASSIGN(KSyncSock);
 };
 
@@ -1303,13 +1303,15 @@ Sandesh* RouteDumpHandler::GetFirst(Sandesh *from_req) {
     vr_route_req *orig_req, key;
     orig_req = static_cast<vr_route_req *>(from_req);
 
-    if (orig_req->get_rtr_marker()) {
-        key.set_rtr_vrf_id(orig_req->get_rtr_vrf_id());
+    // Bridge routes are continued from the MAC of last route dumped
+    key.set_rtr_vrf_id(orig_req->get_rtr_vrf_id());
+    key.set_rtr_family(orig_req->get_rtr_family());
+    if (orig_req->get_rtr_marker() || orig_req->get_rtr_mac().size()) {
         key.set_rtr_prefix(orig_req->get_rtr_marker());
         key.set_rtr_prefix_len(orig_req->get_rtr_marker_plen());
+        key.set_rtr_mac(orig_req->get_rtr_mac());
         it = sock->rt_tree.upper_bound(key);
     } else {
-        key.set_rtr_vrf_id(orig_req->get_rtr_vrf_id());
         key.set_rtr_prefix(0);
         key.set_rtr_prefix_len(0);
         it = sock->rt_tree.lower_bound(key);
@@ -1331,8 +1333,10 @@ Sandesh* RouteDumpHandler::GetNext(Sandesh *input) {
     r = static_cast<vr_route_req *>(input);
 
     key.set_rtr_vrf_id(r->get_rtr_vrf_id());
+    key.set_rtr_family(r->get_rtr_family());
     key.set_rtr_prefix(r->get_rtr_prefix());
     key.set_rtr_prefix_len(r->get_rtr_prefix_len());
+    key.set_rtr_mac(r->get_rtr_mac());
     it = sock->rt_tree.upper_bound(key);
 
     if (it != sock->rt_tree.end()) {
@@ -58,10 +58,17 @@ struct TestRouteCmp {
         if (lhs.get_rtr_vrf_id() != rhs.get_rtr_vrf_id()) {
             return lhs.get_rtr_vrf_id() < rhs.get_rtr_vrf_id();
         }
+        if (lhs.get_rtr_family() != rhs.get_rtr_family()) {
+            return lhs.get_rtr_family() < rhs.get_rtr_family();
+        }
         if (lhs.get_rtr_prefix() != rhs.get_rtr_prefix()) {
             return lhs.get_rtr_prefix() < rhs.get_rtr_prefix();
         }
-        return lhs.get_rtr_prefix_len() < rhs.get_rtr_prefix_len();
+        if (lhs.get_rtr_prefix_len() != rhs.get_rtr_prefix_len()) {
+            return lhs.get_rtr_prefix_len() < rhs.get_rtr_prefix_len();
+        }
+        // Bridge routes are keyed by MAC
+        return lhs.get_rtr_mac() < rhs.get_rtr_mac();
     }
 };
 
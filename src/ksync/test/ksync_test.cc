@@ -17,6 +17,7 @@
 #include "ksync/ksync_index.h"
 #include "ksync/ksync_entry.h"
 #include "ksync/ksync_object.h"
+#include "ksync/ksync_sock.h"
 
 using namespace std;
 class VlanTable;
@@ -811,6 +812,43 @@ TEST_F(TestUT, add_defer_to_delete_ack) {
     EXPECT_EQ(Vlan::delete_count_, 1);
 }
 
+// Referrer moving to a new reference followed by delete of the old reference
+// (ex. route moving to a new nexthop and old nexthop deleted). With parallel
+// send, delete of the old reference goes on the KSyncSock of the referrer
+TEST_F(TestUT, parallel_send_change_then_delete) {
+    KSyncSock::SetParallelSend(true);
+
+    Vlan v2(0xF02, 0);
+    Vlan *vlan2 = static_cast<Vlan *>(vlan_table_->Create(&v2));
+    Vlan v3(0xF03, 0);
+    Vlan *vlan3 = static_cast<Vlan *>(vlan_table_->Create(&v3));
+    Vlan v1(0xF01, 0xF02);
+    Vlan *vlan1 = static_cast<Vlan *>(vlan_table_->Create(&v1));
+    EXPECT_EQ(vlan1->GetState(), KSyncEntry::IN_SYNC);
+    EXPECT_EQ(vlan1->GetDepVlan(), vlan2);
+    EXPECT_NE(vlan1->SockHash(), vlan2->SockHash());
+    EXPECT_EQ(vlan2->DeleteSockHash(), vlan2->SockHash());
+
+    vlan1->dep_tag_ = 0xF03;
+    vlan_table_->Change(vlan1);
+    EXPECT_EQ(vlan1->GetState(), KSyncEntry::IN_SYNC);
+    EXPECT_EQ(vlan1->GetDepVlan(), vlan3);
+    EXPECT_EQ(vlan2->GetRefCount(), 1);
+    EXPECT_EQ(vlan2->DeleteSockHash(), vlan1->SockHash());
+    EXPECT_EQ(vlan3->DeleteSockHash(), vlan3->SockHash());
+
+    vlan_table_->Delete(vlan2);
+    EXPECT_EQ(Vlan::delete_count_, 1);
+    EXPECT_EQ(Vlan::free_wait_count_, 1);
+
+    vlan_table_->Delete(vlan1);
+    vlan_table_->Delete(vlan3);
+    EXPECT_EQ(Vlan::delete_count_, 3);
+    EXPECT_EQ(Vlan::free_wait_count_, 3);
+
+    KSyncSock::SetParallelSend(false);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     LoggingInit();
@@ -25,31 +25,14 @@ bool PostProcessingQuery::flow_record_comparator(
     return false;
 }
 
-bool PostProcessingQuery::sort_field_comparator(
-        const QEOpServerProxy::ResultRowT& lhs,
-        const QEOpServerProxy::ResultRowT& rhs) {
-    std::map<std::string, std::string>::const_iterator lhs_it, rhs_it;
-    for (std::vector<sort_field_t>::iterator sort_it = sort_fields.begin();
-         sort_it != sort_fields.end(); sort_it++) {
-        lhs_it = lhs.first.find((*sort_it).name);
-        QE_ASSERT(lhs_it != lhs.first.end());
-        rhs_it = rhs.first.find((*sort_it).name);
-        QE_ASSERT(rhs_it != rhs.first.end());
-        if ((*sort_it).type == std::string("int") || 
-            (*sort_it).type == std::string("long") ||
-            (*sort_it).type == std::string("ipv4")) {
-            uint64_t lhs_val = 0, rhs_val = 0;
-            stringToInteger(lhs_it->second, lhs_val);
-            stringToInteger(rhs_it->second, rhs_val);
-            if (lhs_val < rhs_val) return true;
-            if (lhs_val > rhs_val) return false;
-        } else {
-            if (lhs_it->second < rhs_it->second) return true;
-            if (lhs_it->second > rhs_it->second) return false;
-        }
+ResultColumns::FieldList PostProcessingQuery::sort_columns() const {
+    ResultColumns::FieldList fields;
+    for (std::vector<sort_field_t>::const_iterator sort_it =
+         sort_fields.begin(); sort_it != sort_fields.end(); sort_it++) {
+        fields.push_back(ResultColumns::Field((*sort_it).name,
+            ResultColumns::IsNumericType((*sort_it).type)));
     }
-
-    return false;
+    return fields;
 }
 
 bool PostProcessingQuery::flowseries_merge_processing(
@@ -217,21 +200,8 @@ bool PostProcessingQuery::merge_processing(
             merged_result->reserve(merged_result_size + raw_result1->size());
             copy(raw_result1->begin(), raw_result1->end(), 
                  std::back_inserter(*merged_result));
-            if (merged_result_size) { 
-                if (sorting_type == ASCENDING) {
-                    std::inplace_merge(merged_result->begin(), 
-                        merged_result->begin() + merged_result_size,
-                        merged_result->end(),
-                        boost::bind(&PostProcessingQuery::sort_field_comparator, 
-                                    this, _1, _2));
-                } else {
-                    std::inplace_merge(merged_result->rbegin(),
-                        merged_result->rbegin() + raw_result1->size(),
-                        merged_result->rend(),
-                        boost::bind(&PostProcessingQuery::sort_field_comparator,
-                                    this, _1, _2));
-                }
-            }
+            ResultColumns::MergeTail(sort_columns(), sorting_type == ASCENDING,
+                                     merged_result_size, merged_result);
 
             goto sort_done;
         }
@@ -241,20 +211,17 @@ bool PostProcessingQuery::merge_processing(
         size_t size2 = raw_result2->size();
         QE_TRACE(DEBUG, "Merging results from vectors of size:" <<
                 size1 << " and " << size2);
-        merged_result->reserve(raw_result1->size() + raw_result2->size());
-        if (sorting_type == ASCENDING) {
-            std::merge(raw_result1->begin(), raw_result1->end(), 
-                raw_result2->begin(), raw_result2->end(),
-                std::back_inserter(*merged_result),
-                boost::bind(&PostProcessingQuery::sort_field_comparator, 
-                            this, _1, _2)); 
-        } else {
-            std::merge(raw_result1->rbegin(), raw_result1->rend(), 
-                raw_result2->rbegin(), raw_result2->rend(),
-                std::back_inserter(*merged_result),
-                boost::bind(&PostProcessingQuery::sort_field_comparator, 
-                            this, _1, _2)); 
-        }
+        size_t merged_result_size = merged_result->size();
+        merged_result->reserve(merged_result_size + size1 + size2);
+        ResultColumns::FieldList fields(sort_columns());
+        copy(raw_result1->begin(), raw_result1->end(), 
+            std::back_inserter(*merged_result));
+        ResultColumns::MergeTail(fields, sorting_type == ASCENDING,
+                                 merged_result_size, merged_result);
+        copy(raw_result2->begin(), raw_result2->end(), 
+            std::back_inserter(*merged_result));
+        ResultColumns::MergeTail(fields, sorting_type == ASCENDING,
+                                 merged_result_size + size1, merged_result);
     } 
 
 sort_done:
@@ -332,18 +299,8 @@ const std::vector<boost::shared_ptr<QEOpServerProxy::BufferT> >& inputs,
             }
 
             if (sorted) {
-                QEOpServerProxy::BufferT *merged_result = &output;
-                if (sorting_type == ASCENDING) {
-                    std::sort(merged_result->begin(), merged_result->end(), 
-                              boost::bind(
-                                &PostProcessingQuery::sort_field_comparator, 
-                                          this, _1, _2)); 
-                } else {
-                    std::sort(merged_result->rbegin(), merged_result->rend(), 
-                              boost::bind(
-                                &PostProcessingQuery::sort_field_comparator,
-                                          this, _1, _2));
-                }
+                ResultColumns::Sort(sort_columns(), sorting_type == ASCENDING,
+                                    &output);
             }
             goto limit;
         }
@@ -372,15 +329,8 @@ const std::vector<boost::shared_ptr<QEOpServerProxy::BufferT> >& inputs,
         QE_TRACE(DEBUG, "Final_Merge_Processing: Done uniquify flow records");
         // Check if the result has to be sorted
         if (sorted) {
-            if (sorting_type == ASCENDING) {
-                std::sort(merged_result->begin(), merged_result->end(), 
-                          boost::bind(&PostProcessingQuery::sort_field_comparator, 
-                                      this, _1, _2)); 
-            } else {
-                std::sort(merged_result->rbegin(), merged_result->rend(), 
-                          boost::bind(&PostProcessingQuery::sort_field_comparator,
-                                      this, _1, _2));
-            }
+            ResultColumns::Sort(sort_columns(), sorting_type == ASCENDING,
+                                merged_result);
         }
     } else {  // For non-flow-record queries
         // Check if the result has to be sorted
@@ -395,27 +345,17 @@ const std::vector<boost::shared_ptr<QEOpServerProxy::BufferT> >& inputs,
 
             merged_result->reserve(final_vector_size);
 
+            // Append the sorted inputs and merge them all at once
+            std::vector<size_t> runs;
             for (size_t i = 0; i < inputs.size(); i++)
             {
                 QEOpServerProxy::BufferT *raw_result = inputs[i].get();
-                if (sorting_type == ASCENDING) {
-                    QEOpServerProxy::BufferT::iterator
-                        current_result_end = merged_result->end();
-                    copy(raw_result->begin(), raw_result->end(), 
-                        std::back_inserter(*merged_result));
-                    std::inplace_merge(merged_result->begin(),
-                    current_result_end, merged_result->end(),
-    boost::bind(&PostProcessingQuery::sort_field_comparator, this, _1, _2)); 
-                } else {
-                    QEOpServerProxy::BufferT::reverse_iterator
-                        current_result_end = merged_result->rbegin();
-                    copy(raw_result->begin(), raw_result->end(), 
-                        std::back_inserter(*merged_result));
-                    std::inplace_merge(merged_result->rbegin(),
-                    current_result_end, merged_result->rend(),
-    boost::bind(&PostProcessingQuery::sort_field_comparator, this, _1, _2)); 
-                }
+                runs.push_back(merged_result->size());
+                copy(raw_result->begin(), raw_result->end(), 
+                    std::back_inserter(*merged_result));
             }
+            ResultColumns::Merge(sort_columns(), sorting_type == ASCENDING,
+                                 runs, merged_result);
         }
     }
    
@@ -599,15 +539,8 @@ query_status_t PostProcessingQuery::process_query() {
 
     // Check if the result has to be sorted
     if (sorted) {
-        if (sorting_type == ASCENDING) {
-            std::sort(raw_result->begin(), raw_result->end(), 
-                      boost::bind(&PostProcessingQuery::sort_field_comparator, 
-                                  this, _1, _2)); 
-        } else {
-            std::sort(raw_result->rbegin(), raw_result->rend(), 
-                      boost::bind(&PostProcessingQuery::sort_field_comparator,
-                                  this, _1, _2));
-        }
+        ResultColumns::Sort(sort_columns(), sorting_type == ASCENDING,
+                            raw_result);
     }
 
     // If the flow series query is parallelized, we should apply the limit 
@@ -72,6 +72,7 @@
 #include "../analytics/viz_message.h"
 #include "json_parse.h"
 #include "QEOpServerProxy.h"
+#include "result_columns.h"
 #include "base/logging.h"
 #include <sandesh/sandesh_types.h>
 #include <sandesh/sandesh.h>
@@ -678,8 +679,8 @@ public:
     std::auto_ptr<BufT> result_;
     std::auto_ptr<MapBufT> mresult_;
 
-    bool sort_field_comparator(const QEOpServerProxy::ResultRowT& lhs,
-                               const QEOpServerProxy::ResultRowT& rhs);
+    // sort_fields, in the form the columnar sort and merge take
+    ResultColumns::FieldList sort_columns() const;
 
     // compare flow records based on UUID
     static bool flow_record_comparator(const QEOpServerProxy::ResultRowT& lhs,
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "result_columns.h"
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+
+#include "base/util.h"
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+struct RowOrder {
+    RowOrder(const ResultColumns *columns, bool ascending) :
+        columns(columns), ascending(ascending) {
+    }
+    bool operator()(uint32_t lhs, uint32_t rhs) const {
+        int cmp = columns->Compare(lhs, rhs);
+        return ascending ? (cmp < 0) : (cmp > 0);
+    }
+    const ResultColumns *columns;
+    bool ascending;
+};
+
+// Compares the sort fields of two rows, parsing the numeric ones
+struct RowFieldOrder {
+    RowFieldOrder(const ResultColumns::FieldList *fields, bool ascending) :
+        fields(fields), ascending(ascending) {
+    }
+    bool operator()(const QEOpServerProxy::ResultRowT &lhs,
+                    const QEOpServerProxy::ResultRowT &rhs) const {
+        int cmp = Compare(lhs, rhs);
+        return ascending ? (cmp < 0) : (cmp > 0);
+    }
+    int Compare(const QEOpServerProxy::ResultRowT &lhs,
+                const QEOpServerProxy::ResultRowT &rhs) const {
+        for (ResultColumns::FieldList::const_iterator it = fields->begin();
+             it != fields->end(); ++it) {
+            QEOpServerProxy::OutRowT::const_iterator lhs_it =
+                lhs.first.find(it->name);
+            assert(lhs_it != lhs.first.end());
+            QEOpServerProxy::OutRowT::const_iterator rhs_it =
+                rhs.first.find(it->name);
+            assert(rhs_it != rhs.first.end());
+            if (it->numeric) {
+                uint64_t lhs_val = 0, rhs_val = 0;
+                stringToInteger(lhs_it->second, lhs_val);
+                stringToInteger(rhs_it->second, rhs_val);
+                if (lhs_val < rhs_val) return -1;
+                if (lhs_val > rhs_val) return 1;
+            } else {
+                int cmp = lhs_it->second.compare(rhs_it->second);
+                if (cmp != 0) return cmp < 0 ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+    const ResultColumns::FieldList *fields;
+    bool ascending;
+};
+
+}  // namespace
+
+ResultColumns::ResultColumns(const FieldList &fields, const BufferT &rows) :
+    size_(rows.size()),
+    columns_(fields.size()) {
+    for (size_t idx = 0; idx < fields.size(); ++idx) {
+        columns_[idx].reserve(size_);
+        if (fields[idx].numeric) {
+            EncodeNumeric(fields[idx].name, rows, &columns_[idx]);
+        } else {
+            EncodeString(fields[idx].name, rows, &columns_[idx]);
+        }
+    }
+}
+
+bool ResultColumns::IsNumericType(const string &type) {
+    return (type == "int" || type == "long" || type == "ipv4");
+}
+
+void ResultColumns::EncodeNumeric(const string &name, const BufferT &rows,
+                                  Column *column) {
+    for (BufferT::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+        QEOpServerProxy::OutRowT::const_iterator col = it->first.find(name);
+        assert(col != it->first.end());
+        uint64_t value = 0;
+        stringToInteger(col->second, value);
+        column->push_back(value);
+    }
+}
+
+//
+// Every distinct string is looked up once per row and copied once. The codes
+// are then handed out in the order of the dictionary.
+//
+void ResultColumns::EncodeString(const string &name, const BufferT &rows,
+                                 Column *column) {
+    typedef map<string, uint64_t> Dictionary;
+    Dictionary dictionary;
+    vector<Dictionary::iterator> entries;
+    entries.reserve(rows.size());
+    for (BufferT::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+        QEOpServerProxy::OutRowT::const_iterator col = it->first.find(name);
+        assert(col != it->first.end());
+        Dictionary::iterator entry = dictionary.lower_bound(col->second);
+        if (entry == dictionary.end() || entry->first != col->second) {
+            entry = dictionary.insert(entry, std::make_pair(col->second, 0));
+        }
+        entries.push_back(entry);
+    }
+
+    uint64_t code = 0;
+    for (Dictionary::iterator it = dictionary.begin(); it != dictionary.end();
+         ++it) {
+        it->second = code++;
+    }
+    for (vector<Dictionary::iterator>::const_iterator it = entries.begin();
+         it != entries.end(); ++it) {
+        column->push_back((*it)->second);
+    }
+}
+
+int ResultColumns::Compare(uint32_t lhs, uint32_t rhs) const {
+    for (vector<Column>::const_iterator it = columns_.begin();
+         it != columns_.end(); ++it) {
+        uint64_t lhs_value = (*it)[lhs];
+        uint64_t rhs_value = (*it)[rhs];
+        if (lhs_value < rhs_value) return -1;
+        if (lhs_value > rhs_value) return 1;
+    }
+    return 0;
+}
+
+//
+// Move every row to its position in order, which holds the index of the
+// source row for each position. Rows are swapped rather than copied.
+//
+void ResultColumns::Permute(const vector<uint32_t> &order, BufferT *rows) {
+    BufferT sorted(rows->size());
+    for (size_t idx = 0; idx < order.size(); ++idx) {
+        QEOpServerProxy::ResultRowT &row = (*rows)[order[idx]];
+        sorted[idx].first.swap(row.first);
+        sorted[idx].second.swap(row.second);
+    }
+    rows->swap(sorted);
+}
+
+void ResultColumns::Sort(const FieldList &fields, bool ascending,
+                         BufferT *rows) {
+    if (rows->size() < 2) {
+        return;
+    }
+    ResultColumns columns(fields, *rows);
+    vector<uint32_t> order(rows->size());
+    for (size_t idx = 0; idx < order.size(); ++idx) {
+        order[idx] = idx;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     RowOrder(&columns, ascending));
+    Permute(order, rows);
+}
+
+//
+// Adjacent runs are merged pairwise, so every row takes part in a number of
+// merges that is logarithmic in the number of runs.
+//
+void ResultColumns::Merge(const FieldList &fields, bool ascending,
+                          const vector<size_t> &runs, BufferT *rows) {
+    vector<size_t> bounds(1, 0);
+    for (vector<size_t>::const_iterator it = runs.begin(); it != runs.end();
+         ++it) {
+        if (*it < rows->size() && *it > bounds.back()) {
+            bounds.push_back(*it);
+        }
+    }
+    if (bounds.size() < 2) {
+        return;
+    }
+    bounds.push_back(rows->size());
+
+    ResultColumns columns(fields, *rows);
+    vector<uint32_t> order(rows->size());
+    for (size_t idx = 0; idx < order.size(); ++idx) {
+        order[idx] = idx;
+    }
+    RowOrder row_order(&columns, ascending);
+    while (bounds.size() > 2) {
+        vector<size_t> merged;
+        size_t idx = 0;
+        for (; idx + 2 < bounds.size(); idx += 2) {
+            std::inplace_merge(order.begin() + bounds[idx],
+                               order.begin() + bounds[idx + 1],
+                               order.begin() + bounds[idx + 2], row_order);
+            merged.push_back(bounds[idx]);
+        }
+        for (; idx < bounds.size(); ++idx) {
+            merged.push_back(bounds[idx]);
+        }
+        bounds.swap(merged);
+    }
+    Permute(order, rows);
+}
+
+void ResultColumns::MergeTail(const FieldList &fields, bool ascending,
+                              size_t mid, BufferT *rows) {
+    if (mid == 0 || mid >= rows->size()) {
+        return;
+    }
+    std::inplace_merge(rows->begin(), rows->begin() + mid, rows->end(),
+                       RowFieldOrder(&fields, ascending));
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef QUERY_ENGINE_RESULT_COLUMNS_H_
+#define QUERY_ENGINE_RESULT_COLUMNS_H_
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "QEOpServerProxy.h"
+
+//
+// Typed, column oriented copy of the sort fields of a result buffer.
+//
+// Numeric fields are parsed once into a column of integers. String fields
+// are dictionary encoded, and the codes follow the order of the strings,
+// so a code compares the same way as the string it stands for. Sort and
+// merge then compare integers only, on a vector of row indices, and the
+// rows are moved into place in a single pass at the end. With the sort
+// comparator working on the rows directly, every comparison looked up
+// both rows' maps and parsed or compared the strings.
+//
+class ResultColumns {
+public:
+    typedef QEOpServerProxy::BufferT BufferT;
+
+    struct Field {
+        Field(const std::string &name, bool numeric) :
+            name(name), numeric(numeric) {
+        }
+        std::string name;
+        bool numeric;
+    };
+    typedef std::vector<Field> FieldList;
+
+    // Every row must have all the fields
+    ResultColumns(const FieldList &fields, const BufferT &rows);
+
+    // Sort types that are compared as numbers
+    static bool IsNumericType(const std::string &type);
+
+    static void Sort(const FieldList &fields, bool ascending, BufferT *rows);
+
+    // Merge runs of rows that are each sorted already. runs holds the
+    // index of the first row of every run.
+    static void Merge(const FieldList &fields, bool ascending,
+                      const std::vector<size_t> &runs, BufferT *rows);
+
+    // Merge the sorted rows from mid on into the sorted rows before mid.
+    // Compares the rows directly: encoding the whole buffer costs more than
+    // a single merge, and a buffer that batches are merged into one by one
+    // would be encoded again for every batch.
+    static void MergeTail(const FieldList &fields, bool ascending, size_t mid,
+                          BufferT *rows);
+
+    size_t size() const { return size_; }
+    int Compare(uint32_t lhs, uint32_t rhs) const;
+
+private:
+    typedef std::vector<uint64_t> Column;
+
+    void EncodeNumeric(const std::string &name, const BufferT &rows,
+                       Column *column);
+    void EncodeString(const std::string &name, const BufferT &rows,
+                      Column *column);
+    static void Permute(const std::vector<uint32_t> &order, BufferT *rows);
+
+    size_t size_;
+    std::vector<Column> columns_;
+};
+
+#endif  // QUERY_ENGINE_RESULT_COLUMNS_H_
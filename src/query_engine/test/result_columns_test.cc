@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <boost/bind.hpp>
+#include <boost/random/linear_congruential.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include "base/util.h"
+#include "testing/gunit.h"
+#include "query_engine/result_columns.h"
+
+using std::string;
+using std::vector;
+
+class ResultColumnsTest : public ::testing::Test {
+protected:
+    typedef QEOpServerProxy::BufferT BufferT;
+
+    ResultColumnsTest() {
+        fields_.push_back(ResultColumns::Field("sourcevn", false));
+        fields_.push_back(ResultColumns::Field("sport", true));
+    }
+
+    static QEOpServerProxy::ResultRowT MakeRow(const string &vn, int port,
+                                               const string &uuid) {
+        QEOpServerProxy::OutRowT row;
+        row["sourcevn"] = vn;
+        row["sport"] = integerToString(port);
+        row["uuid"] = uuid;
+        row["sum(bytes)"] = integerToString(port * 100);
+        return std::make_pair(row, QEOpServerProxy::MetadataT());
+    }
+
+    // Flow-series like rows: few virtual networks, many ports
+    static void Generate(size_t count, uint32_t seed, BufferT *rows) {
+        boost::minstd_rand rng(seed);
+        boost::uniform_int<> vn_dist(0, 31);
+        boost::uniform_int<> port_dist(0, 65535);
+        rows->reserve(rows->size() + count);
+        for (size_t idx = 0; idx < count; ++idx) {
+            rows->push_back(MakeRow(
+                "default-domain:demo:network-" +
+                    integerToString(vn_dist(rng)),
+                port_dist(rng), integerToString(seed * count + idx)));
+        }
+    }
+
+    // The comparator that post-processing used on the rows directly
+    bool RowLess(const QEOpServerProxy::ResultRowT &lhs,
+                 const QEOpServerProxy::ResultRowT &rhs) const {
+        for (ResultColumns::FieldList::const_iterator it = fields_.begin();
+             it != fields_.end(); ++it) {
+            const string &lhs_str = lhs.first.find(it->name)->second;
+            const string &rhs_str = rhs.first.find(it->name)->second;
+            if (it->numeric) {
+                uint64_t lhs_val = 0, rhs_val = 0;
+                stringToInteger(lhs_str, lhs_val);
+                stringToInteger(rhs_str, rhs_val);
+                if (lhs_val < rhs_val) return true;
+                if (lhs_val > rhs_val) return false;
+            } else {
+                if (lhs_str < rhs_str) return true;
+                if (lhs_str > rhs_str) return false;
+            }
+        }
+        return false;
+    }
+
+    bool RowGreater(const QEOpServerProxy::ResultRowT &lhs,
+                    const QEOpServerProxy::ResultRowT &rhs) const {
+        return RowLess(rhs, lhs);
+    }
+
+    void ReferenceSort(bool ascending, BufferT *rows) const {
+        if (ascending) {
+            std::stable_sort(rows->begin(), rows->end(),
+                boost::bind(&ResultColumnsTest::RowLess, this, _1, _2));
+        } else {
+            std::stable_sort(rows->begin(), rows->end(),
+                boost::bind(&ResultColumnsTest::RowGreater, this, _1, _2));
+        }
+    }
+
+    // Merge the sorted runs one after the other, as post-processing did
+    void ReferenceMerge(const vector<size_t> &runs, BufferT *rows) const {
+        for (size_t idx = 1; idx < runs.size(); ++idx) {
+            size_t end = (idx + 1 < runs.size()) ? runs[idx + 1] : rows->size();
+            std::inplace_merge(rows->begin(), rows->begin() + runs[idx],
+                rows->begin() + end,
+                boost::bind(&ResultColumnsTest::RowLess, this, _1, _2));
+        }
+    }
+
+    static vector<string> Uuids(const BufferT &rows) {
+        vector<string> uuids;
+        for (BufferT::const_iterator it = rows.begin(); it != rows.end();
+             ++it) {
+            uuids.push_back(it->first.find("uuid")->second);
+        }
+        return uuids;
+    }
+
+    ResultColumns::FieldList fields_;
+};
+
+TEST_F(ResultColumnsTest, Encode) {
+    BufferT rows;
+    rows.push_back(MakeRow("vn-b", 10, "0"));
+    rows.push_back(MakeRow("vn-a", 9, "1"));
+    rows.push_back(MakeRow("vn-b", 9, "2"));
+    rows.push_back(MakeRow("vn-a", 100, "3"));
+
+    ResultColumns columns(fields_, rows);
+    EXPECT_EQ(4, columns.size());
+    EXPECT_EQ(1, columns.Compare(0, 1));
+    EXPECT_EQ(1, columns.Compare(0, 2));
+    // Numbers compare as numbers, not as strings
+    EXPECT_EQ(-1, columns.Compare(1, 3));
+    EXPECT_EQ(0, columns.Compare(3, 3));
+
+    EXPECT_TRUE(ResultColumns::IsNumericType("int"));
+    EXPECT_TRUE(ResultColumns::IsNumericType("long"));
+    EXPECT_TRUE(ResultColumns::IsNumericType("ipv4"));
+    EXPECT_FALSE(ResultColumns::IsNumericType("string"));
+}
+
+TEST_F(ResultColumnsTest, Sort) {
+    for (int ascending = 0; ascending < 2; ++ascending) {
+        BufferT rows;
+        Generate(5000, 1, &rows);
+        BufferT expected(rows);
+        ReferenceSort(ascending, &expected);
+        ResultColumns::Sort(fields_, ascending, &rows);
+        EXPECT_TRUE(Uuids(expected) == Uuids(rows));
+    }
+}
+
+TEST_F(ResultColumnsTest, Merge) {
+    for (int ascending = 0; ascending < 2; ++ascending) {
+        BufferT rows;
+        vector<size_t> runs;
+        for (uint32_t batch = 0; batch < 5; ++batch) {
+            BufferT batch_rows;
+            Generate(1000 + batch * 10, batch, &batch_rows);
+            ReferenceSort(ascending, &batch_rows);
+            runs.push_back(rows.size());
+            rows.insert(rows.end(), batch_rows.begin(), batch_rows.end());
+        }
+        // An empty run must not matter
+        runs.push_back(rows.size());
+
+        BufferT expected(rows);
+        ReferenceSort(ascending, &expected);
+        ResultColumns::Merge(fields_, ascending, runs, &rows);
+        EXPECT_TRUE(Uuids(expected) == Uuids(rows));
+    }
+}
+
+TEST_F(ResultColumnsTest, MergeTail) {
+    for (int ascending = 0; ascending < 2; ++ascending) {
+        BufferT rows;
+        for (uint32_t batch = 0; batch < 5; ++batch) {
+            BufferT batch_rows;
+            Generate(1000 + batch * 10, batch, &batch_rows);
+            ReferenceSort(ascending, &batch_rows);
+            size_t mid = rows.size();
+            rows.insert(rows.end(), batch_rows.begin(), batch_rows.end());
+            ResultColumns::MergeTail(fields_, ascending, mid, &rows);
+        }
+
+        BufferT expected(rows);
+        ReferenceSort(ascending, &expected);
+        EXPECT_TRUE(Uuids(expected) == Uuids(rows));
+    }
+}
+
+//
+// Sort and merge of flow-series like results, compared with sorting on the
+// rows with the comparator that post-processing used before.
+//
+TEST_F(ResultColumnsTest, QueryBenchmark) {
+    static const size_t kRows = 200000;
+    static const uint32_t kBatches = 8;
+
+    BufferT rows;
+    vector<size_t> runs;
+    for (uint32_t batch = 0; batch < kBatches; ++batch) {
+        BufferT batch_rows;
+        Generate(kRows / kBatches, batch, &batch_rows);
+        ReferenceSort(true, &batch_rows);
+        runs.push_back(rows.size());
+        rows.insert(rows.end(), batch_rows.begin(), batch_rows.end());
+    }
+    BufferT shuffled;
+    Generate(kRows, kBatches, &shuffled);
+
+    BufferT reference(shuffled);
+    uint64_t start = UTCTimestampUsec();
+    ReferenceSort(true, &reference);
+    uint64_t row_sort_usec = UTCTimestampUsec() - start;
+
+    BufferT columnar(shuffled);
+    start = UTCTimestampUsec();
+    ResultColumns::Sort(fields_, true, &columnar);
+    uint64_t column_sort_usec = UTCTimestampUsec() - start;
+    EXPECT_TRUE(Uuids(reference) == Uuids(columnar));
+
+    reference = rows;
+    start = UTCTimestampUsec();
+    ReferenceMerge(runs, &reference);
+    uint64_t row_merge_usec = UTCTimestampUsec() - start;
+
+    columnar = rows;
+    start = UTCTimestampUsec();
+    ResultColumns::Merge(fields_, true, runs, &columnar);
+    uint64_t column_merge_usec = UTCTimestampUsec() - start;
+    EXPECT_TRUE(Uuids(reference) == Uuids(columnar));
+
+    std::cout << kRows << " rows, sort: " << row_sort_usec << " usec by row, "
+              << column_sort_usec << " usec by column" << std::endl;
+    std::cout << kRows << " rows in " << kBatches << " batches, merge: "
+              << row_merge_usec << " usec by row, " << column_merge_usec
+              << " usec by column" << std::endl;
+}
+
+//
+// Merge of many small batches into the result one by one, the way they
+// arrive in merge_processing. Compared with encoding the accumulated result
+// and merging it by column for every batch.
+//
+TEST_F(ResultColumnsTest, IncrementalMergeBenchmark) {
+    static const size_t kRows = 100000;
+    static const uint32_t kBatches = 200;
+
+    vector<BufferT> batches(kBatches);
+    for (uint32_t batch = 0; batch < kBatches; ++batch) {
+        Generate(kRows / kBatches, batch, &batches[batch]);
+        ReferenceSort(true, &batches[batch]);
+    }
+
+    BufferT by_row;
+    uint64_t start = UTCTimestampUsec();
+    for (uint32_t batch = 0; batch < kBatches; ++batch) {
+        size_t mid = by_row.size();
+        by_row.insert(by_row.end(), batches[batch].begin(),
+                      batches[batch].end());
+        ResultColumns::MergeTail(fields_, true, mid, &by_row);
+    }
+    uint64_t row_merge_usec = UTCTimestampUsec() - start;
+
+    BufferT by_column;
+    start = UTCTimestampUsec();
+    for (uint32_t batch = 0; batch < kBatches; ++batch) {
+        size_t mid = by_column.size();
+        by_column.insert(by_column.end(), batches[batch].begin(),
+                         batches[batch].end());
+        ResultColumns::Merge(fields_, true, vector<size_t>(1, mid),
+                             &by_column);
+    }
+    uint64_t column_merge_usec = UTCTimestampUsec() - start;
+
+    BufferT expected(by_row);
+    ReferenceSort(true, &expected);
+    EXPECT_TRUE(Uuids(expected) == Uuids(by_row));
+    EXPECT_TRUE(Uuids(expected) == Uuids(by_column));
+
+    std::cout << kRows << " rows in " << kBatches << " batches, incremental "
+              << "merge: " << row_merge_usec << " usec by row, "
+              << column_merge_usec << " usec by column" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
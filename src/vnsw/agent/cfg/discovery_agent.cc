@@ -172,3 +172,22 @@ void DiscoveryClientPublisherStatsReq::HandleRequest() const {
     resp->set_more(false);
     resp->Response();
 }
+
+// sandesh discovery http client stats
+void DiscoveryClientHttpStatsReq::HandleRequest() const {
+
+    DiscoveryClientHttpStatsResponse *resp =
+        new DiscoveryClientHttpStatsResponse();
+    resp->set_context(context());
+
+    DiscoveryClientHttpStats stats;
+    DiscoveryServiceClient *ds = 
+        Agent::GetInstance()->GetDiscoveryServiceClient();
+    if (ds) {
+        ds->FillDiscoveryServiceHttpStats(stats);
+    }
+
+    resp->set_http(stats);
+    resp->set_more(false);
+    resp->Response();
+}
@@ -304,6 +304,35 @@ void AgentParam::ParseHeadlessMode() {
     }
 }
 
+void AgentParam::ParseWarmRestart() {
+    if (!GetValueFromTree<bool>(warm_restart_, "DEFAULT.warm_restart")) {
+        warm_restart_ = false;
+    }
+    if (!GetValueFromTree<uint32_t>(warm_restart_grace_period_,
+                                    "DEFAULT.warm_restart_grace_period")) {
+        warm_restart_grace_period_ = kDefaultWarmRestartGracePeriod;
+    }
+}
+
+void AgentParam::ParsePktMmap() {
+    if (!GetValueFromTree<bool>(pkt_mmap_, "DEFAULT.pkt_mmap")) {
+        pkt_mmap_ = false;
+    }
+}
+
+void AgentParam::ParseKSyncBulk() {
+    if (!GetValueFromTree<bool>(ksync_bulk_, "DEFAULT.ksync_bulk")) {
+        ksync_bulk_ = false;
+    }
+}
+
+void AgentParam::ParseKSyncParallelSend() {
+    if (!GetValueFromTree<bool>(ksync_parallel_send_,
+                                "DEFAULT.ksync_parallel_send")) {
+        ksync_parallel_send_ = false;
+    }
+}
+
 void AgentParam::ParseCollectorArguments
     (const boost::program_options::variables_map &var_map) {
     ParseIpArgument(var_map, collector_, "COLLECTOR.server");
@@ -406,6 +435,29 @@ void AgentParam::ParseHeadlessModeArguments
     (const boost::program_options::variables_map &var_map) {
     GetOptValue<bool>(var_map, headless_mode_, "DEFAULT.headless_mode");
 }
+
+void AgentParam::ParseWarmRestartArguments
+    (const boost::program_options::variables_map &var_map) {
+    GetOptValue<bool>(var_map, warm_restart_, "DEFAULT.warm_restart");
+    GetOptValue<uint32_t>(var_map, warm_restart_grace_period_,
+                          "DEFAULT.warm_restart_grace_period");
+}
+
+void AgentParam::ParsePktMmapArguments
+    (const boost::program_options::variables_map &var_map) {
+    GetOptValue<bool>(var_map, pkt_mmap_, "DEFAULT.pkt_mmap");
+}
+
+void AgentParam::ParseKSyncBulkArguments
+    (const boost::program_options::variables_map &var_map) {
+    GetOptValue<bool>(var_map, ksync_bulk_, "DEFAULT.ksync_bulk");
+}
+
+void AgentParam::ParseKSyncParallelSendArguments
+    (const boost::program_options::variables_map &var_map) {
+    GetOptValue<bool>(var_map, ksync_parallel_send_,
+                      "DEFAULT.ksync_parallel_send");
+}
 // Initialize hypervisor mode based on system information
 // If "/proc/xen" exists it means we are running in Xen dom0
 void AgentParam::InitFromSystem() {
@@ -445,6 +497,10 @@ void AgentParam::InitFromConfig() {
     ParseMetadataProxy();
     ParseFlows();
     ParseHeadlessMode();
+    ParseWarmRestart();
+    ParsePktMmap();
+    ParseKSyncBulk();
+    ParseKSyncParallelSend();
     cout << "Config file <" << config_file_ << "> parsing completed.\n";
     return;
 }
@@ -463,6 +519,10 @@ void AgentParam::InitFromArguments
     ParseDefaultSectionArguments(var_map);
     ParseMetadataProxyArguments(var_map);
     ParseHeadlessModeArguments(var_map);
+    ParseWarmRestartArguments(var_map);
+    ParsePktMmapArguments(var_map);
+    ParseKSyncBulkArguments(var_map);
+    ParseKSyncParallelSendArguments(var_map);
     return;
 }
 
@@ -622,6 +682,11 @@ void AgentParam::LogConfig() const {
     LOG(DEBUG, "Linklocal Max Vm Flows      : " << linklocal_vm_flows_);
     LOG(DEBUG, "Flow cache timeout          : " << flow_cache_timeout_);
     LOG(DEBUG, "Headless Mode               : " << headless_mode_);
+    LOG(DEBUG, "Warm Restart                : " << warm_restart_);
+    LOG(DEBUG, "Warm Restart grace period   : " << warm_restart_grace_period_);
+    LOG(DEBUG, "Packet socket mmap          : " << pkt_mmap_);
+    LOG(DEBUG, "KSync bulk messages         : " << ksync_bulk_);
+    LOG(DEBUG, "KSync parallel send         : " << ksync_parallel_send_);
     if (mode_ == MODE_KVM) {
     LOG(DEBUG, "Hypervisor mode             : kvm");
         return;
@@ -656,7 +721,10 @@ AgentParam::AgentParam(Agent *agent) :
         agent_stats_interval_(AgentStatsCollector::AgentStatsInterval), 
         flow_stats_interval_(FlowStatsCollector::FlowStatsInterval),
         vmware_physical_port_(""), test_mode_(false), debug_(false), tree_(),
-        headless_mode_(false) {
+        headless_mode_(false), warm_restart_(false),
+        warm_restart_grace_period_(kDefaultWarmRestartGracePeriod),
+        pkt_mmap_(false),
+        ksync_bulk_(false), ksync_parallel_send_(false) {
     vgw_config_table_ = std::auto_ptr<VirtualGatewayConfigTable>
         (new VirtualGatewayConfigTable(agent));
 }
@@ -35,6 +35,9 @@ public:
         Ip4Address gw_;
     };
 
+    // Seconds for which entries in vrouter are retained on warm restart
+    static const uint32_t kDefaultWarmRestartGracePeriod = 180;
+
     AgentParam(Agent *agent);
     virtual ~AgentParam();
 
@@ -72,6 +75,13 @@ public:
     uint32_t linklocal_vm_flows() const { return linklocal_vm_flows_; }
     uint32_t flow_cache_timeout() const {return flow_cache_timeout_;}
     bool headless_mode() const {return headless_mode_;}
+    bool warm_restart() const {return warm_restart_;}
+    uint32_t warm_restart_grace_period() const {
+        return warm_restart_grace_period_;
+    }
+    bool pkt_mmap() const {return pkt_mmap_;}
+    bool ksync_bulk() const {return ksync_bulk_;}
+    bool ksync_parallel_send() const {return ksync_parallel_send_;}
 
     const std::string &config_file() const { return config_file_; }
     const std::string &program_name() const { return program_name_;}
@@ -137,6 +147,10 @@ private:
     void ParseMetadataProxy();
     void ParseFlows();
     void ParseHeadlessMode();
+    void ParseWarmRestart();
+    void ParsePktMmap();
+    void ParseKSyncBulk();
+    void ParseKSyncParallelSend();
 
     void ParseCollectorArguments
         (const boost::program_options::variables_map &v);
@@ -156,6 +170,14 @@ private:
         (const boost::program_options::variables_map &v);
     void ParseHeadlessModeArguments
         (const boost::program_options::variables_map &v);
+    void ParseWarmRestartArguments
+        (const boost::program_options::variables_map &v);
+    void ParsePktMmapArguments
+        (const boost::program_options::variables_map &v);
+    void ParseKSyncBulkArguments
+        (const boost::program_options::variables_map &v);
+    void ParseKSyncParallelSendArguments
+        (const boost::program_options::variables_map &v);
 
     PortInfo vhost_;
     std::string eth_port_;
@@ -194,6 +216,11 @@ private:
     boost::property_tree::ptree tree_;
     std::auto_ptr<VirtualGatewayConfigTable> vgw_config_table_;
     bool headless_mode_;
+    bool warm_restart_;
+    uint32_t warm_restart_grace_period_;
+    bool pkt_mmap_;
+    bool ksync_bulk_;
+    bool ksync_parallel_send_;
 
     DISALLOW_COPY_AND_ASSIGN(AgentParam);
 };
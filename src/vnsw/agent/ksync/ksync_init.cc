@@ -24,6 +24,7 @@
 #include <ksync/ksync_sock.h>
 
 #include "init/agent_init.h"
+#include "init/agent_param.h"
 #include "ksync_init.h"
 #include "ksync/interface_ksync.h"
 #include "ksync/route_ksync.h"
@@ -48,7 +49,8 @@ KSync::KSync(Agent *agent)
       vxlan_ksync_obj_(new VxLanKSyncObject(this)), 
       vrf_assign_ksync_obj_(new VrfAssignKSyncObject(this)),
       interface_scanner_(new InterfaceKScan(agent)),
-      vnsw_interface_listner_(new VnswInterfaceListener(agent)) {
+      vnsw_interface_listner_(new VnswInterfaceListener(agent)),
+      restart_(new KSyncRestart(agent)) {
 }
 
 KSync::~KSync() {
@@ -71,7 +73,11 @@ void KSync::Init() {
     NetlinkInit();
     VRouterInterfaceSnapshot();
     InitFlowMem();
-    ResetVRouter();
+    if (agent_->params()->warm_restart() == false || WarmRestart() == false) {
+        ResetVRouter();
+    } else {
+        KSyncSock::Start(true);
+    }
     if (agent()->init()->create_vhost()) {
         CreateVhostIntf();
     }
@@ -88,9 +94,13 @@ void KSync::NetlinkInit() {
     event_mgr = agent_->GetEventManager();
     boost::asio::io_service &io = *event_mgr->io_service();
 
+    KSyncSock::SetParallelSend(agent_->params()->ksync_parallel_send());
     KSyncSockNetlink::Init(io, DB::PartitionCount(), NETLINK_GENERIC);
     KSyncSock::SetAgentSandeshContext(new KSyncSandeshContext(
                                             flowtable_ksync_obj_.get()));
+    for (int i = 0; i < DB::PartitionCount(); i++) {
+        KSyncSock::Get(i)->set_bulk_mode(agent_->params()->ksync_bulk());
+    }
 
     GenericNetlinkInit();
 }
@@ -142,6 +152,17 @@ void KSync::ResetVRouter() {
     KSyncSock::Start(true);
 }
 
+// Reconcile state in VROUTER instead of resetting it. Only the entries
+// changed since the previous run are programmed
+bool KSync::WarmRestart() {
+    KSyncSock *sock = KSyncSock::Get(0);
+    if (restart_.get()->Init(sock) == false) {
+        LOG(ERROR, "Error taking snapshot of VROUTER. Resetting VROUTER");
+        return false;
+    }
+    return true;
+}
+
 void KSync::VnswInterfaceListenerInit() {
     vnsw_interface_listner_->Init();
 }
@@ -211,6 +232,7 @@ void KSync::Shutdown() {
     vrf_assign_ksync_obj_.reset(NULL);
     vxlan_ksync_obj_.reset(NULL);
     KSyncSock::Shutdown();
+    restart_.reset(NULL);
     KSyncObjectManager::Shutdown();
 }
 
@@ -13,6 +13,7 @@
 #include <ksync/vxlan_ksync.h>
 #include <ksync/vrf_assign_ksync.h>
 #include <ksync/interface_scan.h>
+#include <ksync/ksync_restart.h>
 #include <ksync/vnswif_listener.h>
 
 class KSync {
@@ -48,6 +49,9 @@ public:
     VnswInterfaceListener *vnsw_interface_listner() const  {
         return vnsw_interface_listner_.get();
     }
+    KSyncRestart *restart() const {
+        return restart_.get();
+    }
 protected:
     Agent *agent_;
     boost::scoped_ptr<InterfaceKSyncObject> interface_ksync_obj_; 
@@ -60,6 +64,11 @@ protected:
     boost::scoped_ptr<VrfAssignKSyncObject> vrf_assign_ksync_obj_;
     boost::scoped_ptr<InterfaceKScan> interface_scanner_;
     boost::scoped_ptr<VnswInterfaceListener> vnsw_interface_listner_;
+    boost::scoped_ptr<KSyncRestart> restart_;
+
+    // Snapshot VROUTER and reconcile instead of reset. Returns false if
+    // VROUTER must be reset
+    bool WarmRestart();
 private:
     void InitFlowMem();
     void NetlinkInit();
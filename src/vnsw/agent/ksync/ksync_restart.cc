@@ -0,0 +1,595 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <sstream>
+#include <boost/bind.hpp>
+
+#include <base/logging.h>
+#include <base/timer.h>
+#include <io/event_manager.h>
+#include <ksync/ksync_index.h>
+#include <ksync/ksync_entry.h>
+#include <ksync/ksync_object.h>
+#include <ksync/ksync_sock.h>
+#include "ksync/ksync_restart.h"
+#include "vr_defs.h"
+#include "vr_message.h"
+#include "vr_nexthop.h"
+
+template <typename T>
+static void AppendList(std::ostringstream &str, const std::vector<T> &list) {
+    str << "[";
+    for (typename std::vector<T>::const_iterator it = list.begin();
+         it != list.end(); ++it) {
+        str << (int)(*it) << ",";
+    }
+    str << "]";
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// KSyncRestartContext routines
+/////////////////////////////////////////////////////////////////////////////
+KSyncRestartContext::KSyncRestartContext(KSyncRestart *restart, Mode mode)
+    : restart_(restart), mode_(mode), dump_vrf_(0), dump_family_(AF_INET) {
+    Reset();
+}
+
+KSyncRestartContext::~KSyncRestartContext() {
+}
+
+void KSyncRestartContext::Reset() {
+    type_ = KSyncRestart::MAX_TYPE;
+    key_ = "";
+    stable_key_ = "";
+    data_ = "";
+    id_ = -1;
+    vrf_ = -1;
+    req_.reset();
+    response_code_ = 0;
+    marker_ = -1;
+    marker_plen_ = 0;
+    marker_mac_.clear();
+    dump_done_ = false;
+}
+
+void KSyncRestartContext::Update(int type, const std::string &key,
+                                 const std::string &stable_key,
+                                 const std::string &data, int id, int vrf,
+                                 boost::shared_ptr<Sandesh> req) {
+    if (mode_ == SNAPSHOT) {
+        restart_->Record(type, key, stable_key, data, id, vrf, req);
+    } else if (mode_ == DECODE) {
+        type_ = type;
+        key_ = key;
+        stable_key_ = stable_key;
+        data_ = data;
+        id_ = id;
+        vrf_ = vrf;
+        req_ = req;
+    }
+}
+
+int KSyncRestartContext::PrevId(int id_type, int id) const {
+    if (mode_ != DECODE || id < 0) {
+        return id;
+    }
+    return restart_->PrevId(static_cast<KSyncRestart::IdType>(id_type), id);
+}
+
+void KSyncRestartContext::IfMsgHandler(vr_interface_req *r) {
+    marker_ = r->get_vifr_idx();
+    if (mode_ == SNAPSHOT && r->get_vifr_vrf() >= 0) {
+        vrf_list_.insert(r->get_vifr_vrf());
+    }
+
+    std::ostringstream key;
+    key << r->get_vifr_idx();
+
+    // Interface name is stable across restarts
+    std::string stable_key = r->get_vifr_name();
+
+    std::ostringstream data;
+    data << r->get_vifr_type() << ":" << r->get_vifr_os_idx() << ":"
+        << r->get_vifr_vrf() << ":" << r->get_vifr_ip() << ":"
+        << r->get_vifr_mtu() << ":" << r->get_vifr_flags() << ":"
+        << r->get_vifr_vlan_id() << ":" << r->get_vifr_parent_vif_idx() << ":"
+        << r->get_vifr_mir_id() << ":" << r->get_vifr_name() << ":";
+    AppendList(data, r->get_vifr_mac());
+
+    vr_interface_req *req = new vr_interface_req(*r);
+    req->set_h_op(sandesh_op::DELETE);
+    Update(KSyncRestart::INTERFACE, key.str(), stable_key, data.str(),
+           r->get_vifr_idx(), r->get_vifr_vrf(),
+           boost::shared_ptr<Sandesh>(req));
+}
+
+void KSyncRestartContext::NHMsgHandler(vr_nexthop_req *r) {
+    marker_ = r->get_nhr_id();
+    // Discard nexthop is created by vrouter itself
+    if (mode_ == SNAPSHOT && r->get_nhr_id() == NH_DISCARD_ID) {
+        return;
+    }
+    if (mode_ == SNAPSHOT && r->get_nhr_vrf() >= 0) {
+        vrf_list_.insert(r->get_nhr_vrf());
+    }
+
+    std::ostringstream key;
+    key << r->get_nhr_id();
+
+    // Contents of nexthop, with ids of previous run, identify it across
+    // restarts
+    std::ostringstream stable_key;
+    stable_key << (int)r->get_nhr_type() << ":" << (int)r->get_nhr_family()
+        << ":" << r->get_nhr_flags() << ":"
+        << PrevId(KSyncRestart::VRF_ID, r->get_nhr_vrf()) << ":"
+        << PrevId(KSyncRestart::VIF_ID, r->get_nhr_encap_oif_id()) << ":"
+        << r->get_nhr_encap_family() << ":" << r->get_nhr_tun_sip() << ":"
+        << r->get_nhr_tun_dip() << ":" << r->get_nhr_tun_sport() << ":"
+        << r->get_nhr_tun_dport() << ":";
+    AppendList(stable_key, r->get_nhr_encap());
+    stable_key << "[";
+    const std::vector<int32_t> &nh_list = r->get_nhr_nh_list();
+    for (std::vector<int32_t>::const_iterator it = nh_list.begin();
+         it != nh_list.end(); ++it) {
+        stable_key << PrevId(KSyncRestart::NH_ID, *it) << ",";
+    }
+    stable_key << "]";
+    AppendList(stable_key, r->get_nhr_label_list());
+
+    std::ostringstream data;
+    data << (int)r->get_nhr_type() << ":" << (int)r->get_nhr_family() << ":"
+        << r->get_nhr_flags() << ":" << r->get_nhr_vrf() << ":"
+        << r->get_nhr_encap_oif_id() << ":" << r->get_nhr_encap_family() << ":"
+        << r->get_nhr_tun_sip() << ":" << r->get_nhr_tun_dip() << ":"
+        << r->get_nhr_tun_sport() << ":" << r->get_nhr_tun_dport() << ":"
+        << r->get_nhr_label() << ":";
+    AppendList(data, r->get_nhr_encap());
+    AppendList(data, r->get_nhr_nh_list());
+    AppendList(data, r->get_nhr_label_list());
+
+    vr_nexthop_req *req = new vr_nexthop_req(*r);
+    req->set_h_op(sandesh_op::DELETE);
+    Update(KSyncRestart::NEXTHOP, key.str(), stable_key.str(), data.str(),
+           r->get_nhr_id(), r->get_nhr_vrf(),
+           boost::shared_ptr<Sandesh>(req));
+}
+
+void KSyncRestartContext::MplsMsgHandler(vr_mpls_req *r) {
+    marker_ = r->get_mr_label();
+
+    std::ostringstream key;
+    key << r->get_mr_label();
+
+    // Label is identified by the nexthop it points to
+    std::ostringstream stable_key;
+    stable_key << PrevId(KSyncRestart::NH_ID, r->get_mr_nhid());
+
+    std::ostringstream data;
+    data << r->get_mr_nhid();
+
+    vr_mpls_req *req = new vr_mpls_req(*r);
+    req->set_h_op(sandesh_op::DELETE);
+    Update(KSyncRestart::MPLS, key.str(), stable_key.str(), data.str(),
+           r->get_mr_label(), -1, boost::shared_ptr<Sandesh>(req));
+}
+
+void KSyncRestartContext::RouteMsgHandler(vr_route_req *r) {
+    // Routes are dumped per VRF and family. Stop the dump on first route
+    // from another VRF or family
+    if (mode_ == SNAPSHOT && (r->get_rtr_vrf_id() != dump_vrf_ ||
+                              r->get_rtr_family() != dump_family_)) {
+        dump_done_ = true;
+        return;
+    }
+    marker_ = r->get_rtr_prefix();
+    marker_plen_ = r->get_rtr_prefix_len();
+    marker_mac_ = r->get_rtr_mac();
+
+    // Route is identified by its VRF and prefix (or MAC)
+    int vrf = PrevId(KSyncRestart::VRF_ID, r->get_rtr_vrf_id());
+    std::string key;
+    std::string stable_key;
+    if (r->get_rtr_family() == AF_BRIDGE) {
+        std::ostringstream str;
+        str << r->get_rtr_vrf_id() << ":" << r->get_rtr_family() << ":";
+        AppendList(str, r->get_rtr_mac());
+        key = str.str();
+
+        std::ostringstream stable_str;
+        stable_str << vrf << ":" << r->get_rtr_family() << ":";
+        AppendList(stable_str, r->get_rtr_mac());
+        stable_key = stable_str.str();
+    } else {
+        key = KSyncRestart::RouteKey(r->get_rtr_vrf_id(), r->get_rtr_family(),
+                                     r->get_rtr_prefix(),
+                                     r->get_rtr_prefix_len());
+        stable_key = KSyncRestart::RouteKey(vrf, r->get_rtr_family(),
+                                            r->get_rtr_prefix(),
+                                            r->get_rtr_prefix_len());
+    }
+
+    std::ostringstream data;
+    data << r->get_rtr_label_flags() << ":" << r->get_rtr_label() << ":"
+        << r->get_rtr_nh_id();
+
+    vr_route_req *req = new vr_route_req(*r);
+    req->set_h_op(sandesh_op::DELETE);
+    Update(KSyncRestart::ROUTE, key, stable_key, data.str(), -1,
+           r->get_rtr_vrf_id(), boost::shared_ptr<Sandesh>(req));
+}
+
+int KSyncRestartContext::VrResponseMsgHandler(vr_response *r) {
+    response_code_ = r->get_resp_code();
+    if (response_code_ < 0) {
+        return -response_code_;
+    }
+    return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// KSyncRestart routines
+/////////////////////////////////////////////////////////////////////////////
+KSyncRestart::KSyncRestart(Agent *agent)
+    : agent_(agent), timer_(NULL),
+      snapshot_ctx_(this, KSyncRestartContext::SNAPSHOT),
+      response_ctx_(this, KSyncRestartContext::RESPONSE) {
+    reconciling_ = false;
+    delete_count_ = 0;
+    for (int i = 0; i < MAX_TYPE; i++) {
+        match_count_[i] = 0;
+        moved_count_[i] = 0;
+        stale_count_[i] = 0;
+    }
+}
+
+KSyncRestart::~KSyncRestart() {
+    // Filter is installed only by Init
+    if (timer_) {
+        KSyncObject::set_add_filter(KSyncObject::AddFilter());
+        timer_->Cancel();
+        TimerManager::DeleteTimer(timer_);
+    }
+}
+
+const char *KSyncRestart::TypeToString(int type) {
+    switch (type) {
+    case INTERFACE:
+        return "Interface";
+    case NEXTHOP:
+        return "NextHop";
+    case MPLS:
+        return "Mpls";
+    case ROUTE:
+        return "Route";
+    default:
+        break;
+    }
+    return "Invalid";
+}
+
+std::string KSyncRestart::RouteKey(int vrf, int family, uint32_t prefix,
+                                   int plen) {
+    std::ostringstream str;
+    str << vrf << ":" << family << ":" << prefix << "/" << plen;
+    return str.str();
+}
+
+bool KSyncRestart::Init(KSyncSock *sock) {
+    if (TakeSnapshot(sock) == false) {
+        tbb::mutex::scoped_lock lock(mutex_);
+        reconciling_ = false;
+        for (int i = 0; i < MAX_TYPE; i++) {
+            snapshot_[i].clear();
+            stable_index_[i].clear();
+        }
+        return false;
+    }
+
+    KSyncObject::set_add_filter(boost::bind(&KSyncRestart::FilterAdd, this,
+                                            _1, _2));
+    timer_ = TimerManager::CreateTimer
+        (*(agent_->GetEventManager())->io_service(), "KSyncRestartTimer");
+    timer_->Start(agent_->params()->warm_restart_grace_period() * 1000,
+                  boost::bind(&KSyncRestart::TimerExpiry, this));
+    return true;
+}
+
+bool KSyncRestart::Dump(KSyncSock *sock, Sandesh *req) {
+    int error = 0;
+    uint8_t msg[KSYNC_DEFAULT_MSG_SIZE];
+    int len = req->WriteBinary(msg, KSYNC_DEFAULT_MSG_SIZE, &error);
+
+    // Decode the dump response in snapshot context
+    AgentSandeshContext *ctxt = KSyncSock::GetAgentSandeshContext();
+    KSyncSock::SetAgentSandeshContext(&snapshot_ctx_);
+    sock->BlockingSend((char *)msg, len);
+    bool ret = sock->BlockingRecv();
+    KSyncSock::SetAgentSandeshContext(ctxt);
+    return (ret == false);
+}
+
+// Bridge routes are continued from the MAC of last route dumped
+bool KSyncRestart::DumpRoutes(KSyncSock *sock, int vrf, int family) {
+    snapshot_ctx_.Reset();
+    snapshot_ctx_.set_dump_route(vrf, family);
+    bool more = false;
+    do {
+        vr_route_req req;
+        req.set_h_op(sandesh_op::DUMP);
+        req.set_rtr_rid(0);
+        req.set_rtr_family(family);
+        req.set_rtr_vrf_id(vrf);
+        if (snapshot_ctx_.marker() != -1) {
+            req.set_rtr_marker(snapshot_ctx_.marker());
+            req.set_rtr_marker_plen(snapshot_ctx_.marker_plen());
+            if (family == AF_BRIDGE) {
+                req.set_rtr_mac(snapshot_ctx_.marker_mac());
+            }
+        }
+
+        // Stop if the dump does not progress
+        int marker = snapshot_ctx_.marker();
+        int marker_plen = snapshot_ctx_.marker_plen();
+        std::vector<int8_t> marker_mac = snapshot_ctx_.marker_mac();
+        if (Dump(sock, &req) == false) {
+            return false;
+        }
+        more = (snapshot_ctx_.response_code() & VR_MESSAGE_DUMP_INCOMPLETE);
+        if (marker == snapshot_ctx_.marker() &&
+            marker_plen == snapshot_ctx_.marker_plen() &&
+            marker_mac == snapshot_ctx_.marker_mac()) {
+            more = false;
+        }
+    } while (more && snapshot_ctx_.dump_done() == false);
+    return true;
+}
+
+bool KSyncRestart::TakeSnapshot(KSyncSock *sock) {
+    reconciling_ = true;
+
+    snapshot_ctx_.Reset();
+    do {
+        vr_interface_req req;
+        req.set_h_op(sandesh_op::DUMP);
+        req.set_vifr_idx(0);
+        req.set_vifr_marker(snapshot_ctx_.marker());
+        if (Dump(sock, &req) == false) {
+            return false;
+        }
+    } while (snapshot_ctx_.response_code() & VR_MESSAGE_DUMP_INCOMPLETE);
+
+    snapshot_ctx_.Reset();
+    do {
+        vr_nexthop_req req;
+        req.set_h_op(sandesh_op::DUMP);
+        req.set_nhr_id(0);
+        req.set_nhr_marker(snapshot_ctx_.marker());
+        if (Dump(sock, &req) == false) {
+            return false;
+        }
+    } while (snapshot_ctx_.response_code() & VR_MESSAGE_DUMP_INCOMPLETE);
+
+    snapshot_ctx_.Reset();
+    do {
+        vr_mpls_req req;
+        req.set_h_op(sandesh_op::DUMP);
+        req.set_mr_label(0);
+        req.set_mr_marker(snapshot_ctx_.marker());
+        if (Dump(sock, &req) == false) {
+            return false;
+        }
+    } while (snapshot_ctx_.response_code() & VR_MESSAGE_DUMP_INCOMPLETE);
+
+    // Fabric VRF may not be referred by interfaces or nexthops
+    std::set<int> vrf_list = snapshot_ctx_.vrf_list();
+    vrf_list.insert(0);
+    for (std::set<int>::const_iterator it = vrf_list.begin();
+         it != vrf_list.end(); ++it) {
+        if (DumpRoutes(sock, *it, AF_INET) == false ||
+            DumpRoutes(sock, *it, AF_BRIDGE) == false) {
+            return false;
+        }
+    }
+    snapshot_ctx_.Reset();
+
+    for (int i = 0; i < MAX_TYPE; i++) {
+        LOG(DEBUG, "VROUTER snapshot " << TypeToString(i) << " entries : "
+            << snapshot_[i].size());
+    }
+    return true;
+}
+
+void KSyncRestart::Record(int type, const std::string &key,
+                          const std::string &stable_key,
+                          const std::string &data, int id, int vrf,
+                          boost::shared_ptr<Sandesh> req) {
+    tbb::mutex::scoped_lock lock(mutex_);
+    SnapshotEntry &entry = snapshot_[type][key];
+    entry.data = data;
+    entry.id = id;
+    entry.vrf = vrf;
+    entry.req = req;
+    entry.claimed = false;
+    stable_index_[type][stable_key] = key;
+}
+
+int KSyncRestart::PrevId(IdType type, int id) const {
+    IdMap::const_iterator it = id_map_[type].find(id);
+    if (it == id_map_[type].end()) {
+        return id;
+    }
+    return it->second;
+}
+
+// Learn ids of previous run from an entry of agent matched to the snapshot
+void KSyncRestart::LearnIds(const KSyncRestartContext &ctx,
+                            const SnapshotEntry &entry) {
+    switch (ctx.type()) {
+    case INTERFACE:
+        id_map_[VIF_ID].insert(std::make_pair(ctx.id(), entry.id));
+        if (ctx.vrf() >= 0 && entry.vrf >= 0) {
+            id_map_[VRF_ID].insert(std::make_pair(ctx.vrf(), entry.vrf));
+        }
+        break;
+    case NEXTHOP:
+        id_map_[NH_ID].insert(std::make_pair(ctx.id(), entry.id));
+        break;
+    case MPLS:
+        id_map_[LABEL_ID].insert(std::make_pair(ctx.id(), entry.id));
+        break;
+    default:
+        break;
+    }
+}
+
+bool KSyncRestart::FilterAdd(const char *msg, int msg_len) {
+    if (reconciling_ == false) {
+        return false;
+    }
+
+    // Decoding translates ids using the ids learnt so far
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (reconciling_ == false) {
+        return false;
+    }
+
+    KSyncRestartContext ctx(this, KSyncRestartContext::DECODE);
+    int error = 0;
+    Sandesh::ReceiveBinaryMsgOne((uint8_t *)msg, msg_len, &error, &ctx);
+    if (error != 0 || ctx.type() == MAX_TYPE) {
+        return false;
+    }
+
+    bool same_id = false;
+    StableIndex::iterator stable_it =
+        stable_index_[ctx.type()].find(ctx.stable_key());
+    if (stable_it != stable_index_[ctx.type()].end()) {
+        Snapshot::iterator prev = snapshot_[ctx.type()].find(stable_it->second);
+        if (prev != snapshot_[ctx.type()].end()) {
+            LearnIds(ctx, prev->second);
+        }
+        same_id = (stable_it->second == ctx.key());
+        if (same_id == false) {
+            moved_count_[ctx.type()]++;
+        }
+    }
+
+    Snapshot::iterator it = snapshot_[ctx.type()].find(ctx.key());
+    if (it == snapshot_[ctx.type()].end()) {
+        return false;
+    }
+
+    // Entry in vrouter is owned by agent now, ADD overwrites it if not
+    // matched. Keep the latest request from agent, it is used as
+    // replacement while deleting more specific stale routes
+    SnapshotEntry &entry = it->second;
+    entry.claimed = true;
+    entry.req = ctx.req();
+    if (same_id == false || entry.data != ctx.data()) {
+        entry.data = ctx.data();
+        return false;
+    }
+
+    match_count_[ctx.type()]++;
+    return true;
+}
+
+// Find the longest prefix route claimed by agent to replace a stale route
+void KSyncRestart::SetRouteReplacement(vr_route_req *req) {
+    req->set_rtr_nh_id(NH_DISCARD_ID);
+    req->set_rtr_label(0);
+    req->set_rtr_label_flags(0);
+    req->set_rtr_replace_plen(0);
+    if (req->get_rtr_family() != AF_INET) {
+        return;
+    }
+
+    uint32_t prefix = req->get_rtr_prefix();
+    for (int plen = req->get_rtr_prefix_len() - 1; plen >= 0; plen--) {
+        uint32_t mask = plen ? (0xFFFFFFFF << (32 - plen)) : 0;
+        std::string key = RouteKey(req->get_rtr_vrf_id(), AF_INET,
+                                   prefix & mask, plen);
+        Snapshot::iterator it = snapshot_[ROUTE].find(key);
+        if (it == snapshot_[ROUTE].end() || it->second.claimed == false) {
+            continue;
+        }
+
+        vr_route_req *route =
+            static_cast<vr_route_req *>(it->second.req.get());
+        req->set_rtr_nh_id(route->get_rtr_nh_id());
+        req->set_rtr_label(route->get_rtr_label());
+        req->set_rtr_label_flags(route->get_rtr_label_flags());
+        req->set_rtr_replace_plen(plen);
+        return;
+    }
+}
+
+void KSyncRestart::SendDelete(KSyncSock *sock, Sandesh *req) {
+    int error = 0;
+    char *msg = (char *)malloc(KSYNC_DEFAULT_MSG_SIZE);
+    int len = req->WriteBinary((uint8_t *)msg, KSYNC_DEFAULT_MSG_SIZE,
+                               &error);
+    KSyncRestartIoContext *ioc =
+        new KSyncRestartIoContext(this, len, msg, sock->AllocSeqNo(false),
+                                  &response_ctx_);
+    sock->GenericSend(ioc);
+}
+
+uint32_t KSyncRestart::Sweep() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    reconciling_ = false;
+
+    // Delete in order of dependency. Routes refer to nexthops and
+    // mpls-labels refer to nexthops which in turn refer to interfaces
+    static const Type order[] = {ROUTE, MPLS, NEXTHOP, INTERFACE};
+    KSyncSock *sock = KSyncSock::Get(0);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        Type type = order[i];
+        for (Snapshot::iterator it = snapshot_[type].begin();
+             it != snapshot_[type].end(); ++it) {
+            if (it->second.claimed) {
+                continue;
+            }
+
+            if (type == ROUTE) {
+                SetRouteReplacement
+                    (static_cast<vr_route_req *>(it->second.req.get()));
+            }
+            SendDelete(sock, it->second.req.get());
+            stale_count_[type]++;
+            count++;
+        }
+        LOG(DEBUG, "VROUTER " << TypeToString(type) << " entries matched : "
+            << match_count_[type] << " moved : " << moved_count_[type]
+            << " stale : " << stale_count_[type]);
+    }
+
+    for (int i = 0; i < MAX_TYPE; i++) {
+        snapshot_[i].clear();
+        stable_index_[i].clear();
+    }
+    for (int i = 0; i < MAX_ID_TYPE; i++) {
+        id_map_[i].clear();
+    }
+    return count;
+}
+
+bool KSyncRestart::TimerExpiry() {
+    Sweep();
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// KSyncRestartIoContext routines
+/////////////////////////////////////////////////////////////////////////////
+void KSyncRestartIoContext::Handler() {
+    restart_->DeleteDone();
+}
+
+void KSyncRestartIoContext::ErrorHandler(int err) {
+    LOG(ERROR, "Error deleting stale entry from VROUTER. Error <" << err
+        << ": " << strerror(err) << ": Sequence No : " << GetSeqno());
+    restart_->DeleteDone();
+}
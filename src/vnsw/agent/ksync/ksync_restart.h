@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_ksync_restart_h
+#define vnsw_agent_ksync_restart_h
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+
+#include <sandesh/sandesh_types.h>
+#include <sandesh/sandesh.h>
+#include <ksync/ksync_sock.h>
+#include "vr_types.h"
+#include <cmn/agent_cmn.h>
+
+class KSyncRestart;
+
+// Sandesh context used by KSyncRestart. In SNAPSHOT mode, entries dumped
+// from vrouter are recorded in KSyncRestart. In DECODE mode, keys and data
+// of a single message from agent are stored in the context. RESPONSE mode
+// only processes vr_response for delete of stale entries
+class KSyncRestartContext : public AgentSandeshContext {
+public:
+    enum Mode {
+        SNAPSHOT,
+        DECODE,
+        RESPONSE
+    };
+
+    KSyncRestartContext(KSyncRestart *restart, Mode mode);
+    virtual ~KSyncRestartContext();
+
+    virtual void IfMsgHandler(vr_interface_req *req);
+    virtual void NHMsgHandler(vr_nexthop_req *req);
+    virtual void RouteMsgHandler(vr_route_req *req);
+    virtual void MplsMsgHandler(vr_mpls_req *req);
+    virtual int VrResponseMsgHandler(vr_response *r);
+    virtual void MirrorMsgHandler(vr_mirror_req *req) { }
+    virtual void FlowMsgHandler(vr_flow_req *req) { }
+    virtual void VrfAssignMsgHandler(vr_vrf_assign_req *req) { }
+    virtual void VrfStatsMsgHandler(vr_vrf_stats_req *req) { }
+    virtual void DropStatsMsgHandler(vr_drop_stats_req *req) { }
+    virtual void VxLanMsgHandler(vr_vxlan_req *req) { }
+
+    void Reset();
+    int type() const { return type_; }
+    const std::string &key() const { return key_; }
+    const std::string &stable_key() const { return stable_key_; }
+    const std::string &data() const { return data_; }
+    int id() const { return id_; }
+    int vrf() const { return vrf_; }
+    boost::shared_ptr<Sandesh> req() const { return req_; }
+    int response_code() const { return response_code_; }
+    int marker() const { return marker_; }
+    int marker_plen() const { return marker_plen_; }
+    const std::vector<int8_t> &marker_mac() const { return marker_mac_; }
+    bool dump_done() const { return dump_done_; }
+    void set_dump_route(int vrf, int family) {
+        dump_vrf_ = vrf;
+        dump_family_ = family;
+    }
+    const std::set<int> &vrf_list() const { return vrf_list_; }
+
+private:
+    void Update(int type, const std::string &key,
+                const std::string &stable_key, const std::string &data,
+                int id, int vrf, boost::shared_ptr<Sandesh> req);
+    // Id of previous run of agent for an id in the message. Ids in messages
+    // from agent are translated, ids dumped from vrouter are already from
+    // previous run
+    int PrevId(int id_type, int id) const;
+
+    KSyncRestart *restart_;
+    Mode mode_;
+    int type_;
+    std::string key_;
+    std::string stable_key_;
+    std::string data_;
+    int id_;
+    int vrf_;
+    boost::shared_ptr<Sandesh> req_;
+    int response_code_;
+    int marker_;
+    int marker_plen_;
+    std::vector<int8_t> marker_mac_;
+    int dump_vrf_;
+    int dump_family_;
+    bool dump_done_;
+    // VRFs seen in interface and nexthop dumps. Routes are dumped per VRF
+    std::set<int> vrf_list_;
+    DISALLOW_COPY_AND_ASSIGN(KSyncRestartContext);
+};
+
+// Warm restart of agent. Instead of resetting vrouter on start, the
+// interfaces, nexthops, MPLS labels and routes (inet and bridge) present in
+// vrouter are dumped into per-type snapshots. ADD messages of KSync entries
+// identical to the snapshot are not sent to vrouter. Changed entries are
+// re-programmed. Entries not claimed by agent till the grace period expires
+// are deleted from vrouter.
+//
+// Vif indices, nexthop ids, labels and VRF ids are allocated by agent and can
+// change across a restart. So an entry of agent is matched to the snapshot
+// on a key that is stable across restarts: interface name, contents of
+// nexthop, nexthop of MPLS label and VRF + prefix (or MAC) of route. Ids
+// inside the keys are translated to ids of the previous run, learnt as
+// interfaces, nexthops and labels are matched (VRFs are learnt from the
+// interfaces in them). An entry is not programmed only if it is also at the
+// same id in vrouter. If the id changed, agent programs the entry at the new
+// id and the entry at the old id is deleted as stale.
+//
+// Flows are not part of the snapshot. They are audited by the
+// FlowTableKSyncObject on the flow-table memory shared with vrouter.
+class KSyncRestart {
+public:
+    enum Type {
+        INTERFACE,
+        NEXTHOP,
+        MPLS,
+        ROUTE,
+        MAX_TYPE
+    };
+
+    // Ids allocated by agent that are translated across restart
+    enum IdType {
+        VIF_ID,
+        VRF_ID,
+        NH_ID,
+        LABEL_ID,
+        MAX_ID_TYPE
+    };
+
+    struct SnapshotEntry {
+        SnapshotEntry() : data(), id(-1), vrf(-1), req(), claimed(false) { }
+        // Fields of the entry programmed by agent
+        std::string data;
+        // Id and VRF of the entry in previous run
+        int id;
+        int vrf;
+        // Request to delete the entry from vrouter. Updated with request
+        // from agent once claimed
+        boost::shared_ptr<Sandesh> req;
+        bool claimed;
+    };
+    // Snapshot keyed by the key of entry in vrouter
+    typedef std::map<std::string, SnapshotEntry> Snapshot;
+    // Stable key of an entry to its key in vrouter
+    typedef std::map<std::string, std::string> StableIndex;
+    // Id allocated by agent to id of same entry in previous run
+    typedef std::map<int, int> IdMap;
+
+    KSyncRestart(Agent *agent);
+    virtual ~KSyncRestart();
+
+    // Take snapshot of vrouter, install filter for KSync ADD messages and
+    // start timer for the grace period. Returns false if snapshot failed
+    bool Init(KSyncSock *sock);
+    bool TakeSnapshot(KSyncSock *sock);
+    // Returns true if ADD message need not be sent to vrouter
+    bool FilterAdd(const char *msg, int msg_len);
+    // Delete entries not claimed by agent. Returns number of stale entries
+    uint32_t Sweep();
+    bool TimerExpiry();
+
+    void Record(int type, const std::string &key,
+                const std::string &stable_key, const std::string &data,
+                int id, int vrf, boost::shared_ptr<Sandesh> req);
+    void DeleteDone() { delete_count_++; }
+    // Id of previous run for an id allocated by agent. Returns the id itself
+    // if not learnt yet
+    int PrevId(IdType type, int id) const;
+
+    bool reconciling() const { return reconciling_; }
+    uint32_t snapshot_count(Type type) const {
+        return snapshot_[type].size();
+    }
+    uint32_t match_count(Type type) const { return match_count_[type]; }
+    // Entries found in snapshot at a different id
+    uint32_t moved_count(Type type) const { return moved_count_[type]; }
+    uint32_t stale_count(Type type) const { return stale_count_[type]; }
+    uint32_t delete_count() const { return delete_count_; }
+
+    static const char *TypeToString(int type);
+    static std::string RouteKey(int vrf, int family, uint32_t prefix,
+                                int plen);
+
+private:
+    bool Dump(KSyncSock *sock, Sandesh *req);
+    bool DumpRoutes(KSyncSock *sock, int vrf, int family);
+    void LearnIds(const KSyncRestartContext &ctx, const SnapshotEntry &entry);
+    void SetRouteReplacement(vr_route_req *req);
+    void SendDelete(KSyncSock *sock, Sandesh *req);
+
+    Agent *agent_;
+    Timer *timer_;
+    KSyncRestartContext snapshot_ctx_;
+    KSyncRestartContext response_ctx_;
+    tbb::mutex mutex_;
+    tbb::atomic<bool> reconciling_;
+    Snapshot snapshot_[MAX_TYPE];
+    StableIndex stable_index_[MAX_TYPE];
+    IdMap id_map_[MAX_ID_TYPE];
+    uint32_t match_count_[MAX_TYPE];
+    uint32_t moved_count_[MAX_TYPE];
+    uint32_t stale_count_[MAX_TYPE];
+    tbb::atomic<uint32_t> delete_count_;
+    DISALLOW_COPY_AND_ASSIGN(KSyncRestart);
+};
+
+// IoContext to delete stale entries from vrouter
+class KSyncRestartIoContext : public IoContext {
+public:
+    KSyncRestartIoContext(KSyncRestart *restart, int msg_len, char *msg,
+                          uint32_t seqno, AgentSandeshContext *ctx)
+        : IoContext(msg, msg_len, seqno, ctx), restart_(restart) { }
+    virtual ~KSyncRestartIoContext() { }
+
+    virtual void Handler();
+    virtual void ErrorHandler(int err);
+private:
+    KSyncRestart *restart_;
+    DISALLOW_COPY_AND_ASSIGN(KSyncRestartIoContext);
+};
+
+#endif // vnsw_agent_ksync_restart_h
@@ -44,6 +44,8 @@ public:
     virtual bool IsLess(const KSyncEntry &rhs) const;
     virtual std::string ToString() const;
     virtual KSyncEntry *UnresolvedReference();
+    // Routes of a VRF are programmed through same KSyncSock
+    virtual size_t SockHash() const { return vrf_id_; }
     virtual bool Sync(DBEntry *e);
     virtual int AddMsg(char *buf, int buf_len);
     virtual int ChangeMsg(char *buf, int buf_len);
@@ -46,6 +46,9 @@ void KSyncTest::Init() {
     interface_ksync_obj_.get()->InitTest();
     flowtable_ksync_obj_.get()->InitTest();
     NetlinkInitTest();
+    if (agent_->params()->warm_restart()) {
+        WarmRestart();
+    }
 }
 
 void KSyncTest::RegisterDBClients(DB *db) {
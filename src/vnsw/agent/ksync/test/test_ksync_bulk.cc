@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <io/event_manager.h>
+#include <base/task.h>
+
+#include <cmn/agent_cmn.h>
+
+#include "oper/operdb_init.h"
+#include "controller/controller_init.h"
+#include "pkt/pkt_init.h"
+#include "services/services_init.h"
+#include "ksync/ksync_init.h"
+
+#include "oper/interface_common.h"
+#include "oper/nexthop.h"
+#include "route/route.h"
+#include "oper/vrf.h"
+#include "oper/mpls.h"
+#include "oper/vm.h"
+#include "oper/vn.h"
+
+#include <ksync/ksync_sock.h>
+#include <ksync/ksync_sock_user.h>
+
+#include "vr_types.h"
+
+#include "test/test_cmn_util.h"
+
+void RouterIdDepInit(Agent *agent) {
+}
+
+struct PortInfo input[] = {
+    {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
+    {"vnet2", 2, "1.1.1.2", "00:00:00:01:01:02", 1, 2},
+    {"vnet3", 3, "1.1.1.3", "00:00:00:01:01:03", 1, 3},
+    {"vnet4", 4, "1.1.1.4", "00:00:00:01:01:04", 1, 4},
+};
+
+class KSyncBulkTest : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        sock_ = KSyncSockTypeMap::GetKSyncSockTypeMap();
+        sock_->set_bulk_mode(true);
+        if_count_ = KSyncSockTypeMap::IfCount();
+        route_count_ = KSyncSockTypeMap::RouteCount();
+    }
+
+    virtual void TearDown() {
+        sock_->set_bulk_mode(false);
+    }
+
+    KSyncSockTypeMap *sock_;
+    int if_count_;
+    int route_count_;
+};
+
+// Interfaces, nexthops and routes programmed through bulk messages
+TEST_F(KSyncBulkTest, bulk_add_delete) {
+    int bulk_msg_count = sock_->bulk_msg_count();
+    int bulk_entry_count = sock_->bulk_entry_count();
+
+    CreateVmportEnv(input, 4);
+    client->WaitForIdle();
+    EXPECT_TRUE(VmPortActive(input, 0));
+    EXPECT_TRUE(VmPortActive(input, 3));
+    WAIT_FOR(1000, 1000, (KSyncSockTypeMap::IfCount() == (if_count_ + 4)));
+    EXPECT_TRUE(KSyncSockTypeMap::RouteCount() > route_count_);
+
+    // Interfaces alone account for 4 entries sent in bulk messages
+    EXPECT_TRUE(sock_->bulk_msg_count() > bulk_msg_count);
+    EXPECT_TRUE((sock_->bulk_entry_count() - bulk_entry_count) >= 4);
+
+    DeleteVmportEnv(input, 4, true);
+    client->WaitForIdle();
+    EXPECT_FALSE(VmPortFind(input, 0));
+    WAIT_FOR(1000, 1000, (KSyncSockTypeMap::IfCount() == if_count_));
+    WAIT_FOR(1000, 1000, (KSyncSockTypeMap::RouteCount() == route_count_));
+}
+
+// Responses delayed by the datapath are mapped back to the batched entries
+TEST_F(KSyncBulkTest, bulk_delayed_response) {
+    sock_->SetBlockMsgProcessing(true);
+    CreateVmportEnv(input, 4);
+    client->WaitForIdle();
+    EXPECT_EQ(KSyncSockTypeMap::IfCount(), if_count_);
+
+    sock_->SetBlockMsgProcessing(false);
+    client->WaitForIdle();
+    EXPECT_TRUE(VmPortActive(input, 0));
+    EXPECT_TRUE(VmPortActive(input, 3));
+    WAIT_FOR(1000, 1000, (KSyncSockTypeMap::IfCount() == (if_count_ + 4)));
+
+    sock_->SetBlockMsgProcessing(true);
+    DeleteVmportEnv(input, 4, true);
+    client->WaitForIdle();
+    sock_->SetBlockMsgProcessing(false);
+    client->WaitForIdle();
+    EXPECT_FALSE(VmPortFind(input, 0));
+    WAIT_FOR(1000, 1000, (KSyncSockTypeMap::IfCount() == if_count_));
+    WAIT_FOR(1000, 1000, (KSyncSockTypeMap::RouteCount() == route_count_));
+}
+
+int main(int argc, char *argv[]) {
+    GETUSERARGS();
+
+    client = TestInit(init_file, ksync_init, true, false, false,
+                      AgentStatsCollector::AgentStatsInterval,
+                      FlowStatsCollector::FlowStatsInterval, true, false);
+
+    int ret = RUN_ALL_TESTS();
+    TestShutdown();
+    delete client;
+    return ret;
+}
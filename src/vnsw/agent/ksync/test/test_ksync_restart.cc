@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <io/event_manager.h>
+#include <base/task.h>
+
+#include <cmn/agent_cmn.h>
+
+#include "oper/operdb_init.h"
+#include "controller/controller_init.h"
+#include "pkt/pkt_init.h"
+#include "services/services_init.h"
+#include "ksync/ksync_init.h"
+#include "ksync/ksync_restart.h"
+
+#include "oper/interface_common.h"
+#include "oper/nexthop.h"
+#include "route/route.h"
+#include "oper/vrf.h"
+#include "oper/mpls.h"
+#include "oper/vm.h"
+#include "oper/vn.h"
+
+#include <ksync/ksync_sock.h>
+#include <ksync/ksync_sock_user.h>
+
+#include "vr_types.h"
+
+#include "test/test_cmn_util.h"
+
+void RouterIdDepInit(Agent *agent) {
+}
+
+struct PortInfo input[] = {
+    {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
+    {"vnet2", 2, "1.1.1.2", "00:00:00:01:01:02", 1, 2},
+};
+
+// Entries left in vrouter by previous run of agent
+static const int kStaleIf = 100;
+static const int kStaleNH = 200;
+static const int kStaleLabel = 300;
+static const int kChangedLabel = 301;
+static const uint32_t kStalePrefix = 0x0A0A0A00;
+static const int kMovedIf = 110;
+
+class KSyncRestartTest : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        sock_ = KSyncSockTypeMap::GetKSyncSockTypeMap();
+    }
+
+    virtual void TearDown() {
+    }
+
+    bool FilterAdd(KSyncRestart *restart, Sandesh &req) {
+        int error = 0;
+        uint8_t msg[KSYNC_DEFAULT_MSG_SIZE];
+        int len = req.WriteBinary(msg, KSYNC_DEFAULT_MSG_SIZE, &error);
+        return restart->FilterAdd((const char *)msg, len);
+    }
+
+    bool IsStaleRoute(const vr_route_req &req) {
+        return (req.get_rtr_vrf_id() == 0 &&
+                (uint32_t)req.get_rtr_prefix() == kStalePrefix &&
+                req.get_rtr_prefix_len() == 24);
+    }
+
+    // Agent adds entries identical to ones programmed in previous run
+    void ClaimEntries(KSyncRestart *restart) {
+        for (KSyncSockTypeMap::ksync_map_if::iterator it =
+             sock_->if_map.begin(); it != sock_->if_map.end(); ++it) {
+            if (it->first == kStaleIf)
+                continue;
+            vr_interface_req req = it->second;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+
+        for (KSyncSockTypeMap::ksync_map_nh::iterator it =
+             sock_->nh_map.begin(); it != sock_->nh_map.end(); ++it) {
+            if (it->first == kStaleNH)
+                continue;
+            vr_nexthop_req req = it->second;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+
+        for (KSyncSockTypeMap::ksync_map_mpls::iterator it =
+             sock_->mpls_map.begin(); it != sock_->mpls_map.end(); ++it) {
+            if (it->first == kStaleLabel || it->first == kChangedLabel)
+                continue;
+            vr_mpls_req req = it->second;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+
+        for (KSyncSockTypeMap::ksync_rt_tree::iterator it =
+             sock_->rt_tree.begin(); it != sock_->rt_tree.end(); ++it) {
+            if (IsStaleRoute(*it))
+                continue;
+            vr_route_req req = *it;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+    }
+
+    // Program vrouter with entries of a previous run of agent. Interface
+    // vnet2 was at vif index kMovedIf in the previous run
+    void RestoreEntries(const KSyncSockTypeMap::ksync_map_if &if_map,
+                        const KSyncSockTypeMap::ksync_map_nh &nh_map,
+                        const KSyncSockTypeMap::ksync_map_mpls &mpls_map,
+                        const KSyncSockTypeMap::ksync_rt_tree &rt_tree,
+                        int moved_if) {
+        for (KSyncSockTypeMap::ksync_map_if::const_iterator it =
+             if_map.begin(); it != if_map.end(); ++it) {
+            vr_interface_req req = it->second;
+            if (it->first == moved_if) {
+                req.set_vifr_idx(kMovedIf);
+            }
+            sock_->if_map[req.get_vifr_idx()] = req;
+        }
+
+        for (KSyncSockTypeMap::ksync_map_nh::const_iterator it =
+             nh_map.begin(); it != nh_map.end(); ++it) {
+            vr_nexthop_req req = it->second;
+            if (req.get_nhr_encap_oif_id() == moved_if) {
+                req.set_nhr_encap_oif_id(kMovedIf);
+            }
+            sock_->nh_map[it->first] = req;
+        }
+
+        for (KSyncSockTypeMap::ksync_map_mpls::const_iterator it =
+             mpls_map.begin(); it != mpls_map.end(); ++it) {
+            sock_->mpls_map[it->first] = it->second;
+        }
+
+        for (KSyncSockTypeMap::ksync_rt_tree::const_iterator it =
+             rt_tree.begin(); it != rt_tree.end(); ++it) {
+            sock_->rt_tree.erase(*it);
+            sock_->rt_tree.insert(*it);
+        }
+    }
+
+    // Agent adds again the entries it did not delete across the restart
+    void ClaimEntries(KSyncRestart *restart,
+                      const KSyncSockTypeMap::ksync_map_if &if_map,
+                      const KSyncSockTypeMap::ksync_map_nh &nh_map,
+                      const KSyncSockTypeMap::ksync_map_mpls &mpls_map,
+                      const KSyncSockTypeMap::ksync_rt_tree &rt_tree) {
+        for (KSyncSockTypeMap::ksync_map_if::const_iterator it =
+             if_map.begin(); it != if_map.end(); ++it) {
+            vr_interface_req req = it->second;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+
+        for (KSyncSockTypeMap::ksync_map_nh::const_iterator it =
+             nh_map.begin(); it != nh_map.end(); ++it) {
+            vr_nexthop_req req = it->second;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+
+        for (KSyncSockTypeMap::ksync_map_mpls::const_iterator it =
+             mpls_map.begin(); it != mpls_map.end(); ++it) {
+            vr_mpls_req req = it->second;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+
+        for (KSyncSockTypeMap::ksync_rt_tree::const_iterator it =
+             rt_tree.begin(); it != rt_tree.end(); ++it) {
+            vr_route_req req = *it;
+            req.set_h_op(sandesh_op::ADD);
+            FilterAdd(restart, req);
+        }
+    }
+
+    KSyncSockTypeMap *sock_;
+};
+
+// Agent started with warm_restart in config takes the snapshot of vrouter in
+// KSync::Init and reconciles it with the ADD messages of KSync entries. The
+// entries not claimed by agent are deleted on expiry of the grace period
+TEST_F(KSyncRestartTest, warm_restart) {
+    Agent *agent = Agent::GetInstance();
+    KSyncRestart *restart = agent->ksync()->restart();
+    EXPECT_TRUE(agent->params()->warm_restart());
+    EXPECT_EQ(agent->params()->warm_restart_grace_period(), 1U);
+    WAIT_FOR(1000, 10000, (restart->reconciling() == false));
+
+    // State of vrouter programmed by the previous run of agent
+    CreateVmportEnv(input, 2);
+    client->WaitForIdle();
+    EXPECT_TRUE(VmPortActive(input, 0));
+    EXPECT_TRUE(VmPortActive(input, 1));
+    int vnet2 = VmPortGet(2)->id();
+    int vrf = VrfGet("vrf1")->vrf_id();
+    KSyncSockTypeMap::ksync_map_if if_map = sock_->if_map;
+    KSyncSockTypeMap::ksync_map_nh nh_map = sock_->nh_map;
+    KSyncSockTypeMap::ksync_map_mpls mpls_map = sock_->mpls_map;
+    KSyncSockTypeMap::ksync_rt_tree rt_tree = sock_->rt_tree;
+    DeleteVmportEnv(input, 2, true);
+    client->WaitForIdle();
+    EXPECT_FALSE(VmPortFind(input, 0));
+    EXPECT_TRUE(sock_->if_map.find(vnet2) == sock_->if_map.end());
+    KSyncSockTypeMap::ksync_map_if if_left = sock_->if_map;
+    KSyncSockTypeMap::ksync_map_nh nh_left = sock_->nh_map;
+    KSyncSockTypeMap::ksync_map_mpls mpls_left = sock_->mpls_map;
+    KSyncSockTypeMap::ksync_rt_tree rt_left = sock_->rt_tree;
+
+    RestoreEntries(if_map, nh_map, mpls_map, rt_tree, vnet2);
+    vr_route_req bridge_rt;
+    bridge_rt.set_rtr_vrf_id(vrf);
+    bridge_rt.set_rtr_family(AF_BRIDGE);
+    std::vector<int8_t> mac(6, 0);
+    mac[3] = mac[4] = mac[5] = 0x0A;
+    bridge_rt.set_rtr_mac(mac);
+    bridge_rt.set_rtr_nh_id(kStaleNH);
+    KSyncSockTypeMap::RouteAdd(bridge_rt);
+
+    uint32_t if_match = restart->match_count(KSyncRestart::INTERFACE);
+    uint32_t rt_match = restart->match_count(KSyncRestart::ROUTE);
+    uint32_t if_moved = restart->moved_count(KSyncRestart::INTERFACE);
+    uint32_t if_stale = restart->stale_count(KSyncRestart::INTERFACE);
+    uint32_t rt_stale = restart->stale_count(KSyncRestart::ROUTE);
+    EXPECT_TRUE(restart->TakeSnapshot(KSyncSock::Get(0)));
+    EXPECT_TRUE(restart->reconciling());
+    ClaimEntries(restart, if_left, nh_left, mpls_left, rt_left);
+
+    // Unchanged entries are filtered in KSyncNetlinkEntry::Add. vnet2 is
+    // matched on its name and programmed at its new index
+    CreateVmportEnv(input, 2);
+    client->WaitForIdle();
+    EXPECT_TRUE(VmPortActive(input, 0));
+    EXPECT_TRUE(VmPortActive(input, 1));
+    EXPECT_TRUE(restart->match_count(KSyncRestart::INTERFACE) > if_match);
+    EXPECT_TRUE(restart->match_count(KSyncRestart::ROUTE) > rt_match);
+    EXPECT_EQ(restart->moved_count(KSyncRestart::INTERFACE), if_moved + 1);
+    EXPECT_TRUE(sock_->if_map.find(VmPortGet(2)->id()) !=
+                sock_->if_map.end());
+
+    // Entry at the old index of vnet2 and the stale bridge route are deleted
+    restart->Sweep();
+    EXPECT_FALSE(restart->reconciling());
+    WAIT_FOR(1000, 1000,
+             (sock_->if_map.find(kMovedIf) == sock_->if_map.end()));
+    WAIT_FOR(1000, 1000,
+             (sock_->rt_tree.find(bridge_rt) == sock_->rt_tree.end()));
+    EXPECT_EQ(restart->stale_count(KSyncRestart::INTERFACE), if_stale + 1);
+    EXPECT_TRUE(restart->stale_count(KSyncRestart::ROUTE) > rt_stale);
+    EXPECT_TRUE(sock_->if_map.find(VmPortGet(2)->id()) !=
+                sock_->if_map.end());
+
+    DeleteVmportEnv(input, 2, true);
+    client->WaitForIdle();
+    EXPECT_FALSE(VmPortFind(input, 0));
+}
+
+// Entries matching the snapshot are not reprogrammed and entries not claimed
+// by agent are deleted from vrouter
+TEST_F(KSyncRestartTest, reconcile) {
+    CreateVmportEnv(input, 2);
+    client->WaitForIdle();
+    EXPECT_TRUE(VmPortActive(input, 0));
+    EXPECT_TRUE(VmPortActive(input, 1));
+
+    KSyncSockTypeMap::InterfaceAdd(kStaleIf);
+    KSyncSockTypeMap::NHAdd(kStaleNH);
+    KSyncSockTypeMap::MplsAdd(kStaleLabel);
+    KSyncSockTypeMap::MplsAdd(kChangedLabel);
+    vr_route_req rt;
+    rt.set_rtr_vrf_id(0);
+    rt.set_rtr_family(AF_INET);
+    rt.set_rtr_prefix(kStalePrefix);
+    rt.set_rtr_prefix_len(24);
+    rt.set_rtr_nh_id(kStaleNH);
+    KSyncSockTypeMap::RouteAdd(rt);
+
+    KSyncRestart restart(Agent::GetInstance());
+    EXPECT_TRUE(restart.TakeSnapshot(KSyncSock::Get(0)));
+    EXPECT_TRUE(restart.reconciling());
+    EXPECT_EQ((int)restart.snapshot_count(KSyncRestart::INTERFACE),
+              KSyncSockTypeMap::IfCount());
+    EXPECT_TRUE(restart.snapshot_count(KSyncRestart::NEXTHOP) >= 1);
+    EXPECT_EQ((int)restart.snapshot_count(KSyncRestart::MPLS),
+              KSyncSockTypeMap::MplsCount());
+    EXPECT_TRUE(restart.snapshot_count(KSyncRestart::ROUTE) >= 1);
+
+    // Unchanged entries are filtered
+    ClaimEntries(&restart);
+    EXPECT_EQ(restart.match_count(KSyncRestart::INTERFACE),
+              restart.snapshot_count(KSyncRestart::INTERFACE) - 1);
+    EXPECT_EQ(restart.match_count(KSyncRestart::NEXTHOP),
+              restart.snapshot_count(KSyncRestart::NEXTHOP) - 1);
+    EXPECT_EQ(restart.match_count(KSyncRestart::MPLS),
+              restart.snapshot_count(KSyncRestart::MPLS) - 2);
+    EXPECT_EQ(restart.match_count(KSyncRestart::ROUTE),
+              restart.snapshot_count(KSyncRestart::ROUTE) - 1);
+
+    // Changed entry is programmed again
+    vr_mpls_req mpls = sock_->mpls_map[kChangedLabel];
+    mpls.set_h_op(sandesh_op::ADD);
+    mpls.set_mr_nhid(kStaleNH + 1);
+    EXPECT_FALSE(FilterAdd(&restart, mpls));
+
+    // Entry not present in vrouter is programmed
+    vr_interface_req intf;
+    intf.set_h_op(sandesh_op::ADD);
+    intf.set_vifr_idx(kStaleIf + 1);
+    EXPECT_FALSE(FilterAdd(&restart, intf));
+
+    EXPECT_EQ(restart.Sweep(), 4U);
+    EXPECT_FALSE(restart.reconciling());
+    WAIT_FOR(1000, 1000, (restart.delete_count() == 4));
+    EXPECT_EQ(restart.stale_count(KSyncRestart::INTERFACE), 1U);
+    EXPECT_EQ(restart.stale_count(KSyncRestart::NEXTHOP), 1U);
+    EXPECT_EQ(restart.stale_count(KSyncRestart::MPLS), 1U);
+    EXPECT_EQ(restart.stale_count(KSyncRestart::ROUTE), 1U);
+    EXPECT_TRUE(sock_->if_map.find(kStaleIf) == sock_->if_map.end());
+    EXPECT_TRUE(sock_->nh_map.find(kStaleNH) == sock_->nh_map.end());
+    EXPECT_TRUE(sock_->mpls_map.find(kStaleLabel) == sock_->mpls_map.end());
+    EXPECT_TRUE(sock_->mpls_map.find(kChangedLabel) != sock_->mpls_map.end());
+    EXPECT_TRUE(sock_->rt_tree.find(rt) == sock_->rt_tree.end());
+
+    // Filter is not applied once reconciliation is done
+    EXPECT_FALSE(FilterAdd(&restart, mpls));
+
+    KSyncSockTypeMap::MplsDelete(kChangedLabel);
+    DeleteVmportEnv(input, 2, true);
+    client->WaitForIdle();
+    EXPECT_FALSE(VmPortFind(input, 0));
+}
+
+int main(int argc, char *argv[]) {
+    GETUSERARGS();
+
+    // Config enables warm restart with a grace period of 1 second
+    client = TestInit("controller/src/vnsw/agent/ksync/test/vnswa_cfg.ini",
+                      ksync_init, true, false, false,
+                      AgentStatsCollector::AgentStatsInterval,
+                      FlowStatsCollector::FlowStatsInterval, true, false);
+
+    int ret = RUN_ALL_TESTS();
+    TestShutdown();
+    delete client;
+    return ret;
+}
@@ -99,6 +99,16 @@ int main(int argc, char *argv[]) {
         ("DEFAULT.log_local", "Enable local logging of sandesh messages")
         ("DEFAULT.tunnel_type", opt::value<string>()->default_value("MPLSoGRE"),
          "Tunnel Encapsulation type <MPLSoGRE|MPLSoUDP|VXLAN>")
+        ("DEFAULT.warm_restart", opt::value<bool>(),
+         "Reconcile vrouter state on restart instead of resetting vrouter")
+        ("DEFAULT.warm_restart_grace_period", opt::value<uint32_t>(),
+         "Seconds to retain vrouter state not claimed after warm restart")
+        ("DEFAULT.pkt_mmap", opt::value<bool>(),
+         "Read packets from pkt0 through the mmapped ring of a packet socket")
+        ("DEFAULT.ksync_bulk", opt::value<bool>(),
+         "Batch KSync messages to vrouter into bulk netlink messages")
+        ("DEFAULT.ksync_parallel_send", opt::value<bool>(),
+         "Spread KSync messages to vrouter across all netlink sockets")
         ("DISCOVERY.server", opt::value<string>(), 
          "IP address of discovery server")
         ("DISCOVERY.max_control_nodes", opt::value<uint16_t>(), 
@@ -2,6 +2,10 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <sandesh/protocol/TXMLProtocol.h>
+#include <sandesh/transport/TBufferTransports.h>
+#include <db/db_table_partition.h>
+#include <http/http_session.h>
 #include <cmn/agent_cmn.h>
 #include <cmn/agent_db.h>
 #include <init/agent_param.h>
@@ -168,6 +172,9 @@ void AgentSandesh::DoSandesh() {
     }
 
     SetResp();
+    if (StreamStart()) {
+        return;
+    }
     DBTableWalker *walker = table->database()->GetWalker();
     walkid_ = walker->WalkTable(table, NULL,
         boost::bind(&AgentSandesh::EntrySandesh, this, _2),
@@ -207,6 +214,141 @@ void AgentSandesh::SandeshDone() {
     delete this;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Streaming of responses to HTTP requests
+//
+// Pages sent with Response() are held by the sandesh HTTP layer till the
+// last one, so a large table dump was in memory as a whole before the first
+// byte went out. When the request came over HTTP, every page is instead
+// written to the session as a chunk of a chunked response as soon as it is
+// full. The table is iterated one partition after the other, in the DB task
+// of the partition. Whenever the socket has not taken the last page yet, the
+// iteration stops and resumes from the key of the next entry once the
+// session is send ready again.
+/////////////////////////////////////////////////////////////////////////////
+class AgentSandesh::StreamTask : public Task {
+public:
+    StreamTask(AgentSandesh *sandesh, int partition)
+        : Task(TaskScheduler::GetInstance()->GetTaskId("db::DBTable"),
+               partition), sandesh_(sandesh) {
+    }
+
+    virtual bool Run() {
+        sandesh_->StreamPage();
+        return true;
+    }
+
+private:
+    AgentSandesh *sandesh_;
+};
+
+static std::string SandeshXml(const Sandesh *sandesh) {
+    using contrail::sandesh::protocol::TXMLProtocol;
+    using contrail::sandesh::transport::TMemoryBuffer;
+
+    boost::shared_ptr<TMemoryBuffer> buffer(new TMemoryBuffer(4096));
+    boost::shared_ptr<TXMLProtocol> protocol(new TXMLProtocol(buffer));
+    sandesh->Write(protocol);
+    uint8_t *data;
+    uint32_t size;
+    buffer->getBuffer(&data, &size);
+    return std::string(reinterpret_cast<const char *>(data), size);
+}
+
+// Returns false if the request did not come from an HTTP session that is
+// still there. The response then goes through Response() as before.
+bool AgentSandesh::StreamStart() {
+    if (HttpSession::SendChunkedHeaderSession(context_, "text/xml") ==
+        HttpSession::SEND_CLOSED) {
+        return false;
+    }
+    std::string header("<?xml-stylesheet type=\"text/xsl\" "
+                       "href=\"/universal_parse.xsl\"?>");
+    header += "<__" + resp_->Name() + "_list type=\"slist\">";
+    if (StreamSend(header)) {
+        StreamNext();
+    }
+    return true;
+}
+
+void AgentSandesh::StreamNext() {
+    TaskScheduler::GetInstance()->Enqueue(new StreamTask(this, partition_));
+}
+
+// Deletes this and returns false if the session is gone
+bool AgentSandesh::StreamSend(const std::string &data) {
+    if (HttpSession::SendChunkSession(context_,
+            reinterpret_cast<const u_int8_t *>(data.data()), data.size()) ==
+        HttpSession::SEND_CLOSED) {
+        resp_->Release();
+        delete this;
+        return false;
+    }
+    return true;
+}
+
+void AgentSandesh::StreamPage() {
+    DBTable *table = AgentGetTable();
+    DBTablePartition *partition = NULL;
+    if (table != NULL && partition_ < table->PartitionCount()) {
+        partition = static_cast<DBTablePartition *>(
+            table->GetTablePartition(partition_));
+    }
+
+    DBEntry *entry = NULL;
+    if (partition != NULL) {
+        if (next_key_.get() != NULL) {
+            std::auto_ptr<const DBEntryBase> start =
+                table->AllocEntry(next_key_.get());
+            // Find matching or next in sort order
+            entry = partition->lower_bound(start.get());
+        } else {
+            entry = partition->GetFirst();
+        }
+    }
+
+    int added = 0;
+    for (int visited = 0; entry != NULL && added < entries_per_sandesh &&
+         visited < kEntriesPerRun; ++visited) {
+        if (UpdateResp(entry)) {
+            added++;
+        }
+        entry = partition->GetNext(entry);
+    }
+
+    bool done = false;
+    if (entry != NULL) {
+        next_key_ = entry->GetDBRequestKey();
+    } else {
+        next_key_.reset();
+        partition_++;
+        done = (table == NULL || partition_ >= table->PartitionCount());
+    }
+
+    if (added != 0 || done) {
+        std::string page = SandeshXml(resp_);
+        if (done) {
+            page += "</__" + resp_->Name() + "_list>";
+        }
+        if (!StreamSend(page)) {
+            return;
+        }
+        resp_->Release();
+        if (done) {
+            HttpSession::SendLastChunkSession(context_);
+            delete this;
+            return;
+        }
+        SetResp();
+    }
+
+    // Wait for the client to take the page before building the next one
+    if (!HttpSession::RegisterSendReadySession(context_,
+            boost::bind(&AgentSandesh::StreamNext, this))) {
+        StreamNext();
+    }
+}
+
 void AgentInitStateReq::HandleRequest() const {
     AgentInitState *resp = new AgentInitState();
     resp->set_context(context());
@@ -19,10 +19,13 @@ class AgentSandesh {
 public:
     static const uint8_t entries_per_sandesh = 100;
 
+    // Entries looked at in one run of the streaming task
+    static const int kEntriesPerRun = 1024;
+
     AgentSandesh(std::string context,
                  std::string name) : name_(name), resp_(NULL),
                    count_(0), context_(context),
-                   walkid_(DBTableWalker::kInvalidWalkerId) {}
+                   walkid_(DBTableWalker::kInvalidWalkerId), partition_(0) {}
     virtual ~AgentSandesh() {}
     void DoSandesh();
 
@@ -30,6 +33,8 @@ protected:
     std::string name_; // name coming in the sandesh request
     SandeshResponse *resp_;
 private:
+    class StreamTask;
+
     bool EntrySandesh(DBEntryBase *entry);
     void SandeshDone();
     void SetResp();
@@ -37,9 +42,18 @@ private:
     virtual void Alloc() = 0;
     virtual bool UpdateResp(DBEntryBase *entry);
 
+    // Stream the response to an HTTP session, a page per chunk
+    bool StreamStart();
+    void StreamPage();
+    void StreamNext();
+    bool StreamSend(const std::string &data);
+
     uint32_t count_;
     std::string context_;
     DBTableWalker::WalkId walkid_;
+    // Partition and key of the next entry to stream
+    int partition_;
+    std::auto_ptr<DBRequestKey> next_key_;
     DISALLOW_COPY_AND_ASSIGN(AgentSandesh);
 };
 
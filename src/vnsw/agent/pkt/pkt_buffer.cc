@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <assert.h>
+#include "pkt/pkt_buffer.h"
+
+const uint32_t PktBufferPool::kDefaultBuffers;
+
+PktBufferPool::PktBufferPool(uint32_t count, uint32_t buffer_size)
+    : memory_(new uint8_t[count * buffer_size]), count_(count),
+      buffer_size_(buffer_size), alloc_failures_(0) {
+    free_.reserve(count);
+    for (uint32_t i = count; i > 0; --i) {
+        free_.push_back(memory_ + (i - 1) * buffer_size);
+    }
+}
+
+PktBufferPool::~PktBufferPool() {
+    delete [] memory_;
+}
+
+uint8_t *PktBufferPool::Alloc() {
+    tbb::mutex::scoped_lock lock(mutex_);
+    if (free_.empty()) {
+        alloc_failures_++;
+        return NULL;
+    }
+    uint8_t *buf = free_.back();
+    free_.pop_back();
+    return buf;
+}
+
+void PktBufferPool::Free(uint8_t *buf) {
+    assert(Owns(buf) && ((buf - memory_) % buffer_size_) == 0);
+    tbb::mutex::scoped_lock lock(mutex_);
+    free_.push_back(buf);
+}
+
+uint32_t PktBufferPool::available() const {
+    tbb::mutex::scoped_lock lock(mutex_);
+    return free_.size();
+}
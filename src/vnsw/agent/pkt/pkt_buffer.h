@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_pkt_buffer_hpp
+#define vnsw_agent_pkt_buffer_hpp
+
+#include <stdint.h>
+#include <vector>
+#include <tbb/mutex.h>
+#include "base/util.h"
+
+// Buffers for the packets read from pkt0, carved out of one block allocated
+// upfront. The reader takes a buffer per packet and the PktInfo made for the
+// packet gives it back when it is destroyed, from whichever task processed
+// the packet.
+class PktBufferPool {
+public:
+    static const uint32_t kDefaultBuffers = 1024;
+
+    PktBufferPool(uint32_t count, uint32_t buffer_size);
+    ~PktBufferPool();
+
+    // NULL when every buffer is in use
+    uint8_t *Alloc();
+    void Free(uint8_t *buf);
+    bool Owns(const uint8_t *buf) const {
+        return buf >= memory_ && buf < memory_ + count_ * buffer_size_;
+    }
+
+    uint32_t count() const { return count_; }
+    uint32_t buffer_size() const { return buffer_size_; }
+    uint32_t available() const;
+    uint32_t alloc_failures() const { return alloc_failures_; }
+
+private:
+    uint8_t *memory_;
+    uint32_t count_;
+    uint32_t buffer_size_;
+    // Free buffers, the last one freed is used first while it is still warm
+    std::vector<uint8_t *> free_;
+    uint32_t alloc_failures_;
+    mutable tbb::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(PktBufferPool);
+};
+
+#endif // vnsw_agent_pkt_buffer_hpp
@@ -7,6 +7,7 @@
 #include <netinet/tcp.h>
 #include <netinet/udp.h>
 #include <netinet/ip_icmp.h>
+#include <boost/make_shared.hpp>
 
 #include "cmn/agent_cmn.h"
 #include "cmn/agent_stats.h"
@@ -90,7 +91,8 @@ void PktHandler::Send(uint8_t *msg, std::size_t len, PktModuleName mod) {
  
 // Process the packet received from tap interface
 void PktHandler::HandleRcvPkt(uint8_t *ptr, std::size_t len) {
-    boost::shared_ptr<PktInfo> pkt_info(new PktInfo(ptr, len));
+    boost::shared_ptr<PktInfo> pkt_info =
+        boost::make_shared<PktInfo>(ptr, len, tap_interface_.get());
     PktType::Type pkt_type = PktType::INVALID;
     PktModuleName mod = INVALID;
     Interface *intf = NULL;
@@ -177,6 +179,12 @@ enqueue:
             pkt_info->len, pkt_info->pkt);
 
     if (mod != INVALID) {
+        // Frames of the pkt0 RX ring are given back once read. The flow
+        // packets are done with once enqueued, the others are kept by the
+        // modules and are moved out of the ring.
+        if (mod != FLOW && tap_interface_->RxRingOwns(pkt_info->pkt)) {
+            pkt_info->Relocate(tap_interface_->AllocBuffer());
+        }
         if (!(enqueue_cb_.at(mod))(pkt_info)) {
             stats_.PktQThresholdExceeded(mod);
         }
@@ -397,7 +405,7 @@ uint8_t *PktHandler::ParseUserPkt(PktInfo *pkt_info, Interface *intf,
 // Enqueue an inter-task message to the specified module
 void PktHandler::SendMessage(PktModuleName mod, InterTaskMsg *msg) {
     if (mod < MAX_MODULES) {
-        boost::shared_ptr<PktInfo> pkt_info(new PktInfo(msg));
+        boost::shared_ptr<PktInfo> pkt_info = boost::make_shared<PktInfo>(msg);
         if (!(enqueue_cb_.at(mod))(pkt_info)) {
             PKT_TRACE(Err, "Threshold exceeded while enqueuing IPC Message <" <<
                       mod << ">");
@@ -457,24 +465,70 @@ void PktHandler::PktStats::PktQThresholdExceeded(PktModuleName mod) {
         q_threshold_exceeded[mod]++;
 }
 
+void PktHandler::PktStats::PktRateLimited(PktModuleName mod) {
+    if (mod < MAX_MODULES)
+        rate_limited[mod]++;
+}
+
+void PktHandler::PktStats::PktProcessed(PktModuleName mod,
+                                        uint64_t latency_usecs) {
+    if (mod < MAX_MODULES) {
+        processed[mod]++;
+        q_latency_usecs[mod] += latency_usecs;
+        if (latency_usecs > q_latency_max_usecs[mod])
+            q_latency_max_usecs[mod] = latency_usecs;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
-PktInfo::PktInfo(uint8_t *msg, std::size_t msg_size) : 
-    pkt(msg), len(msg_size), data(), ipc(), type(PktType::INVALID),
+PktInfo::PktInfo(uint8_t *msg, std::size_t msg_size, TapInterface *intf) :
+    pkt(msg), len(msg_size), tap(intf), data(), ipc(), type(PktType::INVALID),
     agent_hdr(), ether_type(-1), ip_saddr(), ip_daddr(), ip_proto(),
-    sport(), dport(), tcp_ack(false), tunnel(), eth(), arp(), ip() {
+    sport(), dport(), tcp_ack(false), tunnel(),
+    enqueue_usecs(ClockMonotonicUsec()), eth(), arp(), ip() {
     transp.tcp = 0;
 }
 
 PktInfo::PktInfo(InterTaskMsg *msg) :
-    pkt(), len(), data(), ipc(msg), type(PktType::MESSAGE), agent_hdr(),
+    pkt(), len(), tap(), data(), ipc(msg), type(PktType::MESSAGE), agent_hdr(),
     ether_type(-1), ip_saddr(), ip_daddr(), ip_proto(), sport(), dport(),
-    tcp_ack(false), tunnel(), eth(), arp(), ip() {
+    tcp_ack(false), tunnel(), enqueue_usecs(ClockMonotonicUsec()), eth(),
+    arp(), ip() {
     transp.tcp = 0;
 }
 
 PktInfo::~PktInfo() {
-    if (pkt) delete [] pkt;
+    FreePkt();
+}
+
+void PktInfo::FreePkt() {
+    if (pkt == NULL)
+        return;
+    if (tap) {
+        tap->FreeBuffer(pkt);
+    } else {
+        delete [] pkt;
+    }
+    pkt = NULL;
+}
+
+template <typename T>
+static void RelocatePtr(T *&ptr, const uint8_t *from, uint8_t *to) {
+    if (ptr)
+        ptr = (T *)(to + ((const uint8_t *)ptr - from));
+}
+
+void PktInfo::Relocate(uint8_t *buf) {
+    uint8_t *old = pkt;
+    memcpy(buf, old, len);
+    RelocatePtr(data, old, buf);
+    RelocatePtr(eth, old, buf);
+    RelocatePtr(arp, old, buf);
+    RelocatePtr(ip, old, buf);
+    RelocatePtr(transp.tcp, old, buf);
+    FreePkt();
+    pkt = buf;
 }
 
 const AgentHdr &PktInfo::GetAgentHdr() const {return agent_hdr;};
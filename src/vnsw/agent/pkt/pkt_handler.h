@@ -93,6 +93,9 @@ struct TunnelInfo {
 struct PktInfo {
     uint8_t             *pkt;
     uint16_t            len;
+    // Gives pkt back to where it was read into, NULL if pkt was allocated
+    // with new[]
+    TapInterface        *tap;
 
     uint8_t             *data;
     InterTaskMsg        *ipc;
@@ -110,6 +113,8 @@ struct PktInfo {
 
     bool                tcp_ack;
     TunnelInfo          tunnel;
+    // Time the packet was received, for the queueing latency
+    uint64_t            enqueue_usecs;
 
     // Pointer to different headers in user packet
     struct ethhdr       *eth;
@@ -121,10 +126,15 @@ struct PktInfo {
         struct icmphdr  *icmp;
     } transp;
 
-    PktInfo(uint8_t *msg, std::size_t msg_size);
+    PktInfo(uint8_t *msg, std::size_t msg_size, TapInterface *intf = NULL);
     PktInfo(InterTaskMsg *msg);
     virtual ~PktInfo();
 
+    // Release the packet buffer, the handlers done with the packet early
+    // call it so that the buffer can be reused
+    void FreePkt();
+    // Move the packet to buf, the header pointers are moved along
+    void Relocate(uint8_t *buf);
     const AgentHdr &GetAgentHdr() const;
     void UpdateHeaderPtr();
     std::size_t hash() const;
@@ -153,10 +163,17 @@ public:
         uint32_t sent[MAX_MODULES];
         uint32_t received[MAX_MODULES];
         uint32_t q_threshold_exceeded[MAX_MODULES];
+        uint32_t rate_limited[MAX_MODULES];
+        // Packets dequeued by the module, and the time they were queued
+        uint32_t processed[MAX_MODULES];
+        uint64_t q_latency_usecs[MAX_MODULES];
+        uint64_t q_latency_max_usecs[MAX_MODULES];
         uint32_t dropped;
         void Reset() {
             for (int i = 0; i < MAX_MODULES; ++i) {
                 sent[i] = received[i] = q_threshold_exceeded[i] = 0;
+                rate_limited[i] = processed[i] = 0;
+                q_latency_usecs[i] = q_latency_max_usecs[i] = 0;
             }
             dropped = 0;
         }
@@ -164,6 +181,8 @@ public:
         void PktRcvd(PktModuleName mod);
         void PktSent(PktModuleName mod);
         void PktQThresholdExceeded(PktModuleName mod);
+        void PktRateLimited(PktModuleName mod);
+        void PktProcessed(PktModuleName mod, uint64_t latency_usecs);
     };
 
     PktHandler(Agent *, const std::string &, boost::asio::io_service &, bool);
@@ -188,6 +207,10 @@ public:
 
     const PktStats &GetStats() const { return stats_; }
     void ClearStats() { stats_.Reset(); }
+    void PktRateLimited(PktModuleName mod) { stats_.PktRateLimited(mod); }
+    void PktProcessed(PktModuleName mod, uint64_t latency_usecs) {
+        stats_.PktProcessed(mod, latency_usecs);
+    }
     void PktTraceIterate(PktModuleName mod, PktTraceCallback cb);
     void PktTraceClear(PktModuleName mod) { pkt_trace_.at(mod).Clear(); }
     void PktTraceBuffers(PktModuleName mod, uint32_t buffers) {
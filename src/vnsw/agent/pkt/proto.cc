@@ -2,6 +2,10 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <algorithm>
+#include "base/util.h"
+#include "cmn/agent_cmn.h"
+#include "oper/interface_common.h"
 #include "pkt/proto.h"
 #include "pkt/proto_handler.h"
 #include "pkt/pkt_init.h"
@@ -10,7 +14,7 @@
 
 Proto::Proto(Agent *agent, const char *task_name, PktHandler::PktModuleName mod,
              boost::asio::io_service &io) 
-    : agent_(agent), io_(io),
+    : agent_(agent), io_(io), module_(mod),
       work_queue_(TaskScheduler::GetInstance()->GetTaskId(task_name), mod,
                   boost::bind(&Proto::ProcessProto, this, _1)) {
     agent->pkt()->pkt_handler()->Register(mod,
@@ -26,10 +30,13 @@ bool Proto::ValidateAndEnqueueMessage(boost::shared_ptr<PktInfo> msg) {
         return true;
     }
 
+    if (RateLimited(msg.get())) {
+        agent_->pkt()->pkt_handler()->PktRateLimited(module_);
+        return true;
+    }
+
     if (RemovePktBuff()) {
-        if (msg->pkt)
-            delete [] msg->pkt;
-        msg->pkt = NULL;
+        msg->FreePkt();
         msg->eth = NULL;
         msg->arp = NULL;
         msg->ip = NULL;
@@ -40,7 +47,24 @@ bool Proto::ValidateAndEnqueueMessage(boost::shared_ptr<PktInfo> msg) {
     return work_queue_.Enqueue(msg);
 }
 
+// Only the packets received from VM interfaces are limited. The fabric and
+// vhost interfaces carry the traffic of the whole network and of the host,
+// a limit sized for one VM would drop their legitimate bursts.
+bool Proto::RateLimited(const PktInfo *msg) {
+    if (msg->type == PktType::MESSAGE)
+        return false;
+
+    uint16_t ifindex = msg->GetAgentHdr().ifindex;
+    const Interface *intf = agent_->GetInterfaceTable()->FindInterface(ifindex);
+    if (intf == NULL || intf->type() != Interface::VM_INTERFACE)
+        return false;
+
+    return !rate_limiter_.Admit(ifindex, msg->enqueue_usecs);
+}
+
 bool Proto::ProcessProto(boost::shared_ptr<PktInfo> msg_info) {
+    agent_->pkt()->pkt_handler()->PktProcessed(module_,
+        ClockMonotonicUsec() - msg_info->enqueue_usecs);
     ProtoHandler *handler = AllocProtoHandler(msg_info, io_);
     if (handler->Run())
         delete handler;
@@ -48,3 +72,41 @@ bool Proto::ProcessProto(boost::shared_ptr<PktInfo> msg_info) {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+
+const uint64_t ProtoRateLimiter::kTokenScale;
+
+void ProtoRateLimiter::Set(uint32_t rate, uint32_t burst) {
+    rate_ = rate;
+    burst_ = burst ? burst : 1;
+    buckets_.clear();
+}
+
+bool ProtoRateLimiter::Admit(uint16_t ifindex, uint64_t now_usecs) {
+    if (rate_ == 0)
+        return true;
+
+    uint64_t max_tokens = burst_ * kTokenScale;
+    std::pair<BucketMap::iterator, bool> ret =
+        buckets_.insert(std::make_pair(ifindex, Bucket()));
+    Bucket &bucket = ret.first->second;
+    if (ret.second) {
+        bucket.tokens = max_tokens;
+        bucket.last_usecs = now_usecs;
+    } else if (now_usecs > bucket.last_usecs) {
+        // rate millionths of a packet every usec
+        uint64_t elapsed = now_usecs - bucket.last_usecs;
+        if (elapsed >= max_tokens / rate_)
+            bucket.tokens = max_tokens;
+        else
+            bucket.tokens = std::min(max_tokens,
+                                     bucket.tokens + elapsed * rate_);
+        bucket.last_usecs = now_usecs;
+    }
+
+    if (bucket.tokens < kTokenScale)
+        return false;
+    bucket.tokens -= kTokenScale;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -5,11 +5,45 @@
 #ifndef vnsw_agent_proto_hpp
 #define vnsw_agent_proto_hpp
 
+#include <map>
 #include "pkt_handler.h"
 
 class Agent;
 class ProtoHandler;
 
+// Token bucket per interface, in front of the work queue of a protocol, so
+// that a burst of packets from one VM interface (DHCP discovers after a host
+// reboot, an ARP storm) is dropped before it reaches the protocol task.
+// Used from the packet receive path only.
+class ProtoRateLimiter {
+public:
+    ProtoRateLimiter() : rate_(0), burst_(0) {}
+
+    // A rate of 0 disables the limit
+    void Set(uint32_t rate, uint32_t burst);
+    bool Admit(uint16_t ifindex, uint64_t now_usecs);
+    void Clear() { buckets_.clear(); }
+
+    uint32_t rate() const { return rate_; }
+    uint32_t burst() const { return burst_; }
+
+private:
+    // Tokens are counted in millionths of a packet
+    static const uint64_t kTokenScale = 1000000;
+
+    struct Bucket {
+        uint64_t tokens;
+        uint64_t last_usecs;
+    };
+    typedef std::map<uint16_t, Bucket> BucketMap;
+
+    uint32_t rate_;     // packets per second
+    uint32_t burst_;    // packets
+    BucketMap buckets_;
+
+    DISALLOW_COPY_AND_ASSIGN(ProtoRateLimiter);
+};
+
 // Protocol task (work queue for each protocol)
 class Proto {
 public:
@@ -32,11 +66,22 @@ public:
     virtual bool ValidateAndEnqueueMessage(boost::shared_ptr<PktInfo> msg);
     bool ProcessProto(boost::shared_ptr<PktInfo> msg_info);
 
+    // Limit the packets from each VM interface to rate per second, with
+    // bursts of up to burst packets
+    void SetRateLimit(uint32_t rate, uint32_t burst) {
+        rate_limiter_.Set(rate, burst);
+    }
+    ProtoRateLimiter *rate_limiter() { return &rate_limiter_; }
+
 protected:
     Agent *agent_;
     boost::asio::io_service &io_;
 
 private:
+    bool RateLimited(const PktInfo *msg);
+
+    PktHandler::PktModuleName module_;
+    ProtoRateLimiter rate_limiter_;
     WorkQueue<boost::shared_ptr<PktInfo> > work_queue_;
     DISALLOW_COPY_AND_ASSIGN(Proto);
 };
@@ -35,7 +35,7 @@ void ProtoHandler::Send(uint16_t len, uint16_t itf, uint16_t vrf,
     if (agent_->pkt()->pkt_handler()) {
         agent_->pkt()->pkt_handler()->Send(pkt_info_->pkt, len, mod);
     } else {
-        delete [] pkt_info_->pkt;
+        pkt_info_->FreePkt();
     }
 
     pkt_info_->pkt = NULL;
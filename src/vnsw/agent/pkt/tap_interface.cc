@@ -7,15 +7,18 @@
 #include <fcntl.h>
 #include <assert.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 
 #include <net/if.h>
+#include <linux/filter.h>
 #include <linux/if_ether.h>
 #include <linux/if_tun.h>
 #include <linux/if_packet.h>
 
 #include "base/logging.h"
 #include "cmn/agent_cmn.h"
+#include "init/agent_param.h"
 #include "tap_interface.h"
 #include "sandesh/sandesh_types.h"
 #include "sandesh/sandesh.h"
@@ -30,18 +33,33 @@ do {                                                                     \
     Tap##obj::TraceMsg(PacketTraceBuf, __FILE__, __LINE__, __VA_ARGS__); \
 } while (false)                                                          \
 
+// Set on the status of the RX ring frames given to the callback, so that a
+// frame is not read again before it is released. The kernel only fills
+// frames with status TP_STATUS_KERNEL.
+#define TAP_RX_FRAME_HELD (1U << 31)
+
+const uint32_t TapInterface::kMaxPacketSize;
+const uint32_t TapInterface::kMaxReadBatch;
+const uint32_t TapInterface::kRxRingFrames;
+const uint32_t TapInterface::kRxFrameSize;
+const uint32_t TapInterface::kRxBlockSize;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 TapInterface::TapInterface(Agent *agent,
                            const std::string &name, 
                            boost::asio::io_service &io,
                            PktReadCallback cb) 
-                         : tap_fd_(-1), agent_(agent), name_(name),
-                           read_buf_(NULL), pkt_handler_(cb), input_(io) {
+                         : tap_fd_(-1), agent_(agent), io_(io), name_(name),
+                           pkt_handler_(cb), input_(io), rx_fd_(-1),
+                           rx_ring_(NULL), rx_frame_(0), rx_input_(io) {
     memset(mac_address_, 0, sizeof(mac_address_));
 }
 
 TapInterface::~TapInterface() { 
+    if (rx_ring_) {
+        munmap(rx_ring_, kRxRingFrames * kRxFrameSize);
+    }
 }
 
 void TapInterface::Init() { 
@@ -50,12 +68,28 @@ void TapInterface::Init() {
     input_.assign(tap_fd_, ec);
     assert(ec == 0);
 
+    buffer_pool_.reset(new PktBufferPool(PktBufferPool::kDefaultBuffers,
+                                         kMaxPacketSize));
+    if (rx_fd_ >= 0) {
+        rx_input_.assign(rx_fd_, ec);
+        assert(ec == 0);
+    } else {
+        // Reads are done till the tap is drained, they must not block
+        if (fcntl(tap_fd_, F_SETFL, fcntl(tap_fd_, F_GETFL) | O_NONBLOCK) < 0) {
+            LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+                strerror(errno) << "> setting " << name_ << " non-blocking");
+            assert(0);
+        }
+    }
+
     AsyncRead();
 }
 
 void TapInterface::Shutdown() { 
-    if (read_buf_) {
-        delete [] read_buf_;
+    if (rx_fd_ >= 0) {
+        boost::system::error_code ec;
+        rx_input_.close(ec);
+        rx_fd_ = -1;
     }
     close(tap_fd_);
 }
@@ -145,6 +179,107 @@ void TapInterface::SetupTap() {
         }
 
         close(raw_);
+
+        if (agent_->params() && agent_->params()->pkt_mmap()) {
+            SetupRxRing();
+        }
+    }
+}
+
+// Read the packets sent to pkt0 from a TPACKET_V2 RX ring. Only the packets
+// going out of pkt0 are let into the ring, not the ones written to the tap.
+// The tap drops the packets sent to it, they were seen on the ring already.
+void TapInterface::SetupRxRing() {
+    if ((rx_fd_ = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL))) == -1) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> creating packet socket");
+        assert(0);
+    }
+
+    if (fcntl(rx_fd_, F_SETFD, FD_CLOEXEC) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> setting fcntl on packet socket");
+        assert(0);
+    }
+
+    struct sock_filter outgoing[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS,
+                 static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_PKTTYPE)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, kMaxPacketSize),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct sock_fprog outgoing_prog;
+    outgoing_prog.len = sizeof(outgoing) / sizeof(outgoing[0]);
+    outgoing_prog.filter = outgoing;
+    if (setsockopt(rx_fd_, SOL_SOCKET, SO_ATTACH_FILTER, &outgoing_prog,
+                   sizeof(outgoing_prog)) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> attaching filter to packet socket");
+        assert(0);
+    }
+
+    int version = TPACKET_V2;
+    if (setsockopt(rx_fd_, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version)) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> setting TPACKET_V2 on packet socket");
+        assert(0);
+    }
+
+    struct tpacket_req req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = kRxBlockSize;
+    req.tp_frame_size = kRxFrameSize;
+    req.tp_frame_nr = kRxRingFrames;
+    req.tp_block_nr = kRxRingFrames * kRxFrameSize / kRxBlockSize;
+    if (setsockopt(rx_fd_, SOL_PACKET, PACKET_RX_RING, &req,
+                   sizeof(req)) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> setting up RX ring on packet socket");
+        assert(0);
+    }
+
+    void *ring = mmap(NULL, kRxRingFrames * kRxFrameSize,
+                      PROT_READ | PROT_WRITE, MAP_SHARED, rx_fd_, 0);
+    if (ring == MAP_FAILED) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> mapping RX ring of packet socket");
+        assert(0);
+    }
+    rx_ring_ = (uint8_t *)ring;
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, name_.data(), IF_NAMESIZE);
+    if (ioctl(rx_fd_, SIOCGIFINDEX, (void *)&ifr) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> getting ifindex of the tap interface");
+        assert(0);
+    }
+
+    struct sockaddr_ll sll;
+    memset(&sll, 0, sizeof(struct sockaddr_ll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_ifindex = ifr.ifr_ifindex;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    if (bind(rx_fd_, (struct sockaddr *)&sll,
+             sizeof(struct sockaddr_ll)) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> binding packet socket to the tap interface");
+        assert(0);
+    }
+
+    struct sock_filter drop[] = {
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct sock_fprog drop_prog;
+    drop_prog.len = sizeof(drop) / sizeof(drop[0]);
+    drop_prog.filter = drop;
+    if (ioctl(tap_fd_, TUNATTACHFILTER, &drop_prog) < 0) {
+        LOG(ERROR, "Packet Tap Error <" << errno << ": " <<
+            strerror(errno) << "> attaching filter to the tap interface");
+        assert(0);
     }
 }
 
@@ -161,13 +296,36 @@ void TapInterface::WriteHandler(const boost::system::error_code &error,
     if (error)
         TAP_TRACE(Err, 
                   "Packet Tap Error <" + error.message() + "> sending packet");
-    delete [] buf;
+    FreeBuffer(buf);
+}
+
+uint8_t *TapInterface::AllocBuffer() {
+    uint8_t *buf = buffer_pool_->Alloc();
+    if (buf == NULL) {
+        buf = new uint8_t[kMaxPacketSize];
+    }
+    return buf;
+}
+
+void TapInterface::FreeBuffer(uint8_t *buf) {
+    if (buffer_pool_.get() && buffer_pool_->Owns(buf)) {
+        buffer_pool_->Free(buf);
+    } else if (RxRingOwns(buf)) {
+        ReleaseRxFrame(buf);
+    } else {
+        delete [] buf;
+    }
 }
 
-void TapInterface::ReadHandler(const boost::system::error_code &error,
-                              std::size_t length) {
+void TapInterface::ReadHandler(const boost::system::error_code &error) {
     if (!error) {
-        pkt_handler_(read_buf_, length);
+        bool more = rx_ring_ ? ReadRxRing() : ReadBatch();
+        if (more) {
+            // Read the rest after the handlers ready meanwhile
+            io_.post(boost::bind(&TapInterface::ReadHandler, this,
+                                 boost::system::error_code()));
+            return;
+        }
     } else  {
         TAP_TRACE(Err, 
                   "Packet Tap Error <" + error.message() + "> reading packet");
@@ -180,12 +338,62 @@ void TapInterface::ReadHandler(const boost::system::error_code &error,
 }
 
 void TapInterface::AsyncRead() {
-    read_buf_ = new uint8_t[kMaxPacketSize];
-    input_.async_read_some(
-            boost::asio::buffer(read_buf_, kMaxPacketSize), 
+    boost::asio::posix::stream_descriptor &input =
+        rx_ring_ ? rx_input_ : input_;
+    input.async_read_some(boost::asio::null_buffers(),
             boost::bind(&TapInterface::ReadHandler, this,
-                        boost::asio::placeholders::error,
-                        boost::asio::placeholders::bytes_transferred));
+                        boost::asio::placeholders::error));
+}
+
+// Read what is queued on the tap. The batch is bounded to let the other
+// handlers on the io_service run, returns true if it was filled.
+bool TapInterface::ReadBatch() {
+    for (uint32_t count = 0; count < kMaxReadBatch; ++count) {
+        uint8_t *buf = AllocBuffer();
+        ssize_t length = read(tap_fd_, buf, kMaxPacketSize);
+        if (length <= 0) {
+            if (length < 0 && errno != EAGAIN && errno != EINTR) {
+                TAP_TRACE(Err, "Packet Tap Error <" +
+                          std::string(strerror(errno)) + "> reading packet");
+            }
+            FreeBuffer(buf);
+            return false;
+        }
+        pkt_handler_(buf, length);
+    }
+    return true;
+}
+
+bool TapInterface::ReadRxRing() {
+    for (uint32_t count = 0; count < kMaxReadBatch; ++count) {
+        struct tpacket2_hdr *hdr =
+            (struct tpacket2_hdr *)(rx_ring_ + rx_frame_ * kRxFrameSize);
+        uint32_t status = hdr->tp_status;
+        if ((status & TP_STATUS_USER) == 0 || (status & TAP_RX_FRAME_HELD)) {
+            return false;
+        }
+        __sync_synchronize();
+
+        rx_frame_ = (rx_frame_ + 1) % kRxRingFrames;
+        hdr->tp_status = status | TAP_RX_FRAME_HELD;
+        uint8_t *buf = (uint8_t *)hdr + hdr->tp_mac;
+        if (hdr->tp_snaplen < hdr->tp_len) {
+            TAP_TRACE(Err,
+                      "Packet Tap Error <truncated packet> reading packet");
+            ReleaseRxFrame(buf);
+            continue;
+        }
+        pkt_handler_(buf, hdr->tp_snaplen);
+    }
+    return true;
+}
+
+void TapInterface::ReleaseRxFrame(uint8_t *buf) {
+    uint32_t frame = (buf - rx_ring_) / kRxFrameSize;
+    struct tpacket2_hdr *hdr =
+        (struct tpacket2_hdr *)(rx_ring_ + frame * kRxFrameSize);
+    __sync_synchronize();
+    hdr->tp_status = TP_STATUS_KERNEL;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -9,13 +9,30 @@
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 #include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include "pkt/pkt_buffer.h"
 
 // Tap Interface handler to read or write to the "pkt0" interface.
 // Packets reads from the tap are given to the registered callback.
 // Write to the tap interface using AsyncWrite.
+//
+// Packets are read, up to kMaxReadBatch at a time, into buffers from a
+// preallocated pool. With pkt_mmap set, packets sent to pkt0 are instead
+// read from the RX ring of a packet socket bound to it, mapped in the agent,
+// and the tap is only written to. Either way the callback gets a pointer
+// into that memory, which must be given back with FreeBuffer once the packet
+// is done with. FreeBuffer also takes buffers allocated with new[].
+//
+// The packet socket is readable as long as the last frame filled is not
+// given back, the frames of the RX ring must be given back before the
+// callback returns. Packets kept longer are moved to a buffer of the pool.
 class TapInterface {
 public:
     static const uint32_t kMaxPacketSize = 9060;
+    static const uint32_t kMaxReadBatch = 64;
+    static const uint32_t kRxRingFrames = 1024;
+    static const uint32_t kRxFrameSize = 16384;
+    static const uint32_t kRxBlockSize = 4 * kRxFrameSize;
     typedef boost::function<void(uint8_t*, std::size_t)> PktReadCallback;
 
     TapInterface(Agent *agent, const std::string &name,
@@ -28,22 +45,42 @@ public:
     const unsigned char *mac_address() const { return mac_address_; }
     virtual void SetupTap();
     virtual void AsyncWrite(uint8_t *buf, std::size_t len);
+    // Buffer of kMaxPacketSize from the pool, or allocated with new[] when
+    // the pool is exhausted
+    uint8_t *AllocBuffer();
+    // Give back a buffer passed to the callback or to AsyncWrite
+    void FreeBuffer(uint8_t *buf);
+    bool RxRingOwns(const uint8_t *buf) const {
+        return rx_ring_ && buf >= rx_ring_ &&
+            buf < rx_ring_ + kRxRingFrames * kRxFrameSize;
+    }
+    const PktBufferPool *buffer_pool() const { return buffer_pool_.get(); }
 
 protected:
     void SetupAsio();
     void SetupTap(const std::string& name);
+    void SetupRxRing();
     void AsyncRead();
-    void ReadHandler(const boost::system::error_code &err, std::size_t length);
+    void ReadHandler(const boost::system::error_code &err);
+    bool ReadBatch();
+    bool ReadRxRing();
+    void ReleaseRxFrame(uint8_t *buf);
     void WriteHandler(const boost::system::error_code &err, std::size_t length,
 		              uint8_t *buf);
 
     int tap_fd_;
     Agent *agent_;
+    boost::asio::io_service &io_;
     std::string name_;
-    uint8_t *read_buf_;
     PktReadCallback pkt_handler_;
     unsigned char mac_address_[ETH_ALEN];
     boost::asio::posix::stream_descriptor input_;
+    boost::scoped_ptr<PktBufferPool> buffer_pool_;
+    // Packet socket and its RX ring, when reading with pkt_mmap
+    int rx_fd_;
+    uint8_t *rx_ring_;
+    uint32_t rx_frame_;
+    boost::asio::posix::stream_descriptor rx_input_;
     DISALLOW_COPY_AND_ASSIGN(TapInterface);
 };
 
@@ -27,12 +27,16 @@
 #include "oper/vm.h"
 #include "oper/vn.h"
 #include "pkt/pkt_handler.h"
+#include "pkt/proto.h"
+#include "pkt/tap_interface.h"
+#include "pkt/test_tap_interface.h"
 
 #include "vr_interface.h"
 #include "vr_types.h"
 
 #include "test/test_cmn_util.h"
 #include "test/pkt_gen.h"
+#include "xmpp/test/xmpp_test_util.h"
 #include <controller/controller_vrf_export.h>
 
 void RouterIdDepInit(Agent *agent) {
@@ -129,6 +133,81 @@ TEST_F(PktTest, FlowAdd_1) {
     sand->Release();
 }
 
+TEST_F(PktTest, RateLimiter) {
+    ProtoRateLimiter limiter;
+    EXPECT_TRUE(limiter.Admit(1, 0));
+
+    // 10 packets a second, in bursts of up to 5
+    limiter.Set(10, 5);
+    uint64_t now = 1000000;
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(limiter.Admit(1, now));
+    }
+    EXPECT_FALSE(limiter.Admit(1, now));
+    // Interfaces have their own bucket
+    EXPECT_TRUE(limiter.Admit(2, now));
+
+    // One packet every 100 msec
+    EXPECT_FALSE(limiter.Admit(1, now + 99999));
+    EXPECT_TRUE(limiter.Admit(1, now + 100000));
+    EXPECT_FALSE(limiter.Admit(1, now + 100000));
+
+    // Refilled up to the burst
+    now += 10 * 1000000;
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(limiter.Admit(1, now));
+    }
+    EXPECT_FALSE(limiter.Admit(1, now));
+}
+
+TEST_F(PktTest, BufferPool) {
+    PktBufferPool pool(4, 64);
+    uint8_t *buf[4];
+    for (int i = 0; i < 4; ++i) {
+        buf[i] = pool.Alloc();
+        ASSERT_TRUE(buf[i] != NULL);
+        EXPECT_TRUE(pool.Owns(buf[i]));
+    }
+    EXPECT_EQ(0U, pool.available());
+    EXPECT_TRUE(pool.Alloc() == NULL);
+    EXPECT_EQ(1U, pool.alloc_failures());
+
+    uint8_t other[64];
+    EXPECT_FALSE(pool.Owns(other));
+
+    // The last buffer freed is the next one used
+    pool.Free(buf[1]);
+    pool.Free(buf[2]);
+    EXPECT_EQ(2U, pool.available());
+    EXPECT_EQ(buf[2], pool.Alloc());
+    pool.Free(buf[0]);
+    pool.Free(buf[2]);
+    pool.Free(buf[3]);
+    EXPECT_EQ(4U, pool.available());
+}
+
+// Packets read from the tap in batches are given back to the pool once
+// processed
+TEST_F(PktTest, TapReadBatch) {
+    static const int kPackets = 2 * TapInterface::kMaxReadBatch;
+    TestTapInterface *tap = (TestTapInterface *)
+        (Agent::GetInstance()->pkt()->pkt_handler()->tap_interface());
+    const PktBufferPool *pool = tap->buffer_pool();
+    ASSERT_TRUE(pool != NULL);
+    uint32_t available = pool->available();
+    uint64_t dropped = Agent::GetInstance()->stats()->pkt_dropped();
+
+    // Too short to have an agent header, dropped once parsed
+    uint8_t buf[sizeof(ethhdr)];
+    memset(buf, 0, sizeof(buf));
+    for (int i = 0; i < kPackets; ++i) {
+        tap->GetTestPktHandler()->TestPktSend(buf, sizeof(buf));
+    }
+    WAIT_FOR(1000, 1000, (Agent::GetInstance()->stats()->pkt_dropped() ==
+                          dropped + kPackets));
+    client->WaitForIdle();
+    EXPECT_EQ(available, pool->available());
+}
 
 int main(int argc, char *argv[]) {
     GETUSERARGS();
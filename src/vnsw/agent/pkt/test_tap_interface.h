@@ -136,7 +136,7 @@ private:
                 err.message() << "> sending packet");
             assert(0);
         }
-        delete [] buf;
+        FreeBuffer(buf);
     }
 
     Agent *agent_;
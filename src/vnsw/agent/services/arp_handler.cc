@@ -133,8 +133,7 @@ bool ArpHandler::HandlePacket() {
             } else {
                 entry = new ArpEntry(io_, this, key, ArpEntry::INITING);
                 arp_proto->AddArpEntry(entry);
-                delete[] pkt_info_->pkt;
-                pkt_info_->pkt = NULL;
+                pkt_info_->FreePkt();
                 entry->HandleArpRequest();
                 return false;
             }
@@ -149,8 +148,7 @@ bool ArpHandler::HandlePacket() {
                 entry = new ArpEntry(io_, this, key, ArpEntry::INITING);
                 arp_proto->AddArpEntry(entry);
                 entry->HandleArpReply(arp_->arp_sha);
-                delete[] pkt_info_->pkt;
-                pkt_info_->pkt = NULL;
+                pkt_info_->FreePkt();
                 arp_ = NULL;
                 return false;
             }
@@ -165,8 +163,7 @@ bool ArpHandler::HandlePacket() {
                 entry = new ArpEntry(io_, this, key, ArpEntry::INITING);
                 entry->HandleArpReply(arp_->arp_sha);
                 arp_proto->AddArpEntry(entry);
-                delete[] pkt_info_->pkt;
-                pkt_info_->pkt = NULL;
+                pkt_info_->FreePkt();
                 arp_ = NULL;
                 return false;
             }
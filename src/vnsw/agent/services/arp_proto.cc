@@ -23,6 +23,7 @@ ArpProto::ArpProto(Agent *agent, boost::asio::io_service &io,
     max_retries_(kMaxRetries), retry_timeout_(kRetryTimeout),
     aging_timeout_(kAgingTimeout) {
 
+    SetRateLimit(kRateLimit, kRateLimitBurst);
     memset(ip_fabric_interface_mac_, 0, ETH_ALEN);
     vrf_table_listener_id_ = agent->GetVrfTable()->Register(
                              boost::bind(&ArpProto::VrfNotify, this, _1, _2));
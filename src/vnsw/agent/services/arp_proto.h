@@ -21,6 +21,8 @@ public:
     static const uint16_t kMaxRetries = 8;
     static const uint32_t kRetryTimeout = 2000;            // milli seconds
     static const uint32_t kAgingTimeout = (5 * 60 * 1000); // milli seconds
+    static const uint32_t kRateLimit = 500;                // packets/sec
+    static const uint32_t kRateLimitBurst = 200;
 
     typedef std::map<ArpKey, ArpEntry *> ArpCache;
     typedef std::pair<ArpKey, ArpEntry *> ArpCachePair;
@@ -13,6 +13,7 @@ DhcpProto::DhcpProto(Agent *agent, boost::asio::io_service &io,
     Proto(agent, "Agent::Services", PktHandler::DHCP, io),
     run_with_vrouter_(run_with_vrouter), ip_fabric_interface_(NULL),
     ip_fabric_interface_index_(-1) {
+    SetRateLimit(kRateLimit, kRateLimitBurst);
     memset(ip_fabric_interface_mac_, 0, ETH_ALEN);
     iid_ = agent->GetInterfaceTable()->Register(
                   boost::bind(&DhcpProto::ItfNotify, this, _2));
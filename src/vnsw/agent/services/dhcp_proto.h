@@ -12,6 +12,9 @@ class Interface;
 
 class DhcpProto : public Proto {
 public:
+    static const uint32_t kRateLimit = 100;     // packets/sec
+    static const uint32_t kRateLimitBurst = 50;
+
     struct DhcpStats {
         DhcpStats() { Reset(); }
         void Reset() {
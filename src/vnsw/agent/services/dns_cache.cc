@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "services/dns_cache.h"
+
+#include <algorithm>
+
+const uint32_t DnsCache::kMaxEntries;
+const uint32_t DnsCache::kMaxNegativeTtl;
+
+bool DnsCache::Key::operator<(const Key &rhs) const {
+    if (vdns != rhs.vdns)
+        return vdns < rhs.vdns;
+    if (name != rhs.name)
+        return name < rhs.name;
+    if (type != rhs.type)
+        return type < rhs.type;
+    return eclass < rhs.eclass;
+}
+
+uint64_t DnsCache::Now() {
+    return ClockMonotonicUsec() / 1000000;
+}
+
+// The TTL of a negative answer is the smaller of the TTL of the SOA record
+// and its minimum field (RFC 2308).
+bool DnsCache::NegativeTtl(const Answer &answer, uint32_t *ttl) {
+    const std::vector<DnsItem> *sections[] = { &answer.auth, &answer.add };
+    for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+        for (std::vector<DnsItem>::const_iterator it = sections[i]->begin();
+             it != sections[i]->end(); ++it) {
+            if (it->type == DNS_TYPE_SOA) {
+                *ttl = std::min(std::min(it->ttl, it->soa.ttl),
+                                kMaxNegativeTtl);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool DnsCache::Lookup(const Key &key, Answer *answer) {
+    EntryMap::iterator it = entries_.find(key);
+    if (it == entries_.end()) {
+        stats_.misses++;
+        return false;
+    }
+
+    uint64_t now = Now();
+    Entry &entry = it->second;
+    if (now >= entry.expiry) {
+        Erase(it);
+        stats_.misses++;
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, entry.lru);
+    *answer = entry.answer;
+    uint32_t elapsed = now - entry.added;
+    std::vector<DnsItem> *sections[] = {
+        &answer->ans, &answer->auth, &answer->add
+    };
+    for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+        for (std::vector<DnsItem>::iterator item = sections[i]->begin();
+             item != sections[i]->end(); ++item) {
+            item->ttl = item->ttl > elapsed ? item->ttl - elapsed : 0;
+        }
+    }
+
+    if (entry.negative)
+        stats_.negative_hits++;
+    else
+        stats_.hits++;
+    return true;
+}
+
+void DnsCache::Add(const Key &key, const Answer &answer) {
+    uint32_t ttl = 0;
+    bool negative = (answer.flags.ret == DNS_ERR_NO_SUCH_NAME ||
+                     (answer.flags.ret == DNS_ERR_NO_ERROR &&
+                      answer.ans.empty()));
+    if (negative) {
+        if (!NegativeTtl(answer, &ttl))
+            return;
+    } else if (answer.flags.ret == DNS_ERR_NO_ERROR) {
+        // The answer is replayed as a whole, it expires with its first record
+        ttl = answer.ans.front().ttl;
+        const std::vector<DnsItem> *sections[] = {
+            &answer.ans, &answer.auth, &answer.add
+        };
+        for (size_t i = 0; i < sizeof(sections) / sizeof(sections[0]); ++i) {
+            for (std::vector<DnsItem>::const_iterator it =
+                 sections[i]->begin(); it != sections[i]->end(); ++it) {
+                ttl = std::min(ttl, it->ttl);
+            }
+        }
+    } else {
+        return;
+    }
+    if (ttl == 0)
+        return;
+
+    EntryMap::iterator it = entries_.find(key);
+    if (it != entries_.end()) {
+        Erase(it);
+    } else if (entries_.size() >= kMaxEntries) {
+        Erase(lru_.back());
+        stats_.evictions++;
+    }
+
+    uint64_t now = Now();
+    it = entries_.insert(std::make_pair(key, Entry())).first;
+    Entry &entry = it->second;
+    entry.answer = answer;
+    entry.added = now;
+    entry.expiry = now + ttl;
+    entry.negative = negative;
+    lru_.push_front(it);
+    entry.lru = lru_.begin();
+    stats_.inserts++;
+}
+
+void DnsCache::Invalidate(const std::string &vdns) {
+    EntryMap::iterator it = entries_.lower_bound(Key(vdns, "", 0, 0));
+    while (it != entries_.end() && it->first.vdns == vdns) {
+        Erase(it++);
+        stats_.invalidations++;
+    }
+}
+
+void DnsCache::Clear() {
+    entries_.clear();
+    lru_.clear();
+}
+
+void DnsCache::Erase(EntryMap::iterator it) {
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
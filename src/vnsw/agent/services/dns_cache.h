@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef vnsw_agent_dns_cache_hpp
+#define vnsw_agent_dns_cache_hpp
+
+#include <string.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "base/util.h"
+#include "bind/bind_util.h"
+
+// Answers to single question DNS queries, kept for their TTL. Entries are
+// keyed by the virtual DNS server that answered them; answers from the
+// default DNS servers use an empty virtual DNS name.
+//
+// Negative answers (NXDOMAIN or no data) are kept for the TTL of the SOA
+// record returned with them, bounded by kMaxNegativeTtl, and are not kept
+// if there is no SOA record.
+//
+// The cache is used from the Agent::Services task only.
+class DnsCache {
+public:
+    static const uint32_t kMaxEntries = 8192;
+    static const uint32_t kMaxNegativeTtl = 300;    // seconds
+
+    struct Key {
+        Key(const std::string &v, const std::string &n, uint16_t t,
+            uint16_t c) : vdns(v), name(n), type(t), eclass(c) {}
+        bool operator<(const Key &rhs) const;
+
+        std::string vdns;
+        std::string name;
+        uint16_t type;
+        uint16_t eclass;
+    };
+
+    struct Answer {
+        Answer() { memset(&flags, 0, sizeof(flags)); }
+
+        dns_flags flags;
+        std::vector<DnsItem> ans;
+        std::vector<DnsItem> auth;
+        std::vector<DnsItem> add;
+    };
+
+    struct Stats {
+        Stats() { Reset(); }
+        void Reset() {
+            hits = negative_hits = misses = inserts = evictions =
+                invalidations = 0;
+        }
+
+        uint32_t hits;
+        uint32_t negative_hits;
+        uint32_t misses;
+        uint32_t inserts;
+        uint32_t evictions;
+        uint32_t invalidations;
+    };
+
+    DnsCache() {}
+
+    // Copy the answer, with the TTLs reduced by the time spent in the cache
+    bool Lookup(const Key &key, Answer *answer);
+    // Keep the answer if it can be cached
+    void Add(const Key &key, const Answer &answer);
+    // Drop the answers of a virtual DNS server, when its records change
+    void Invalidate(const std::string &vdns);
+    void Clear();
+
+    size_t size() const { return entries_.size(); }
+    const Stats &stats() const { return stats_; }
+    void ClearStats() { stats_.Reset(); }
+
+private:
+    struct Entry;
+    typedef std::map<Key, Entry> EntryMap;
+    typedef std::list<EntryMap::iterator> LruList;
+
+    struct Entry {
+        Answer answer;
+        uint64_t added;     // seconds
+        uint64_t expiry;    // seconds
+        bool negative;
+        LruList::iterator lru;
+    };
+
+    static uint64_t Now();
+    static bool NegativeTtl(const Answer &answer, uint32_t *ttl);
+    void Erase(EntryMap::iterator it);
+
+    EntryMap entries_;
+    // Most recently used first
+    LruList lru_;
+    Stats stats_;
+
+    DISALLOW_COPY_AND_ASSIGN(DnsCache);
+};
+
+#endif // vnsw_agent_dns_cache_hpp
@@ -133,6 +133,17 @@ bool DnsHandler::HandleDefaultDnsRequest(const VmInterface *vmitf) {
     BindUtil::BuildDnsHeader(dns_, ntohs(dns_->xid), DNS_QUERY_RESPONSE, 
                              DNS_OPCODE_QUERY, 0, 1, DNS_ERR_NO_ERROR, 
                              ntohs(dns_->ques_rrcount));
+    DnsCache::Answer answer;
+    if (items_.size() == 1 &&
+        dns_proto->dns_cache()->Lookup(CacheKey(), &answer)) {
+        items_[0].ttl = answer.ans[0].ttl;
+        items_[0].data = answer.ans[0].data;
+        resp_ptr_ = BindUtil::AddAnswerSection(resp_ptr_, items_[0],
+                                               dns_resp_size_);
+        dns_->ans_rrcount = htons(1);
+        DefaultDnsSendResponse();
+        return true;
+    }
     for (uint32_t i = 0; i < items_.size(); i++) {
         ResolveHandler resolv_handler = 
             boost::bind(&DnsHandler::DefaultDnsResolveHandler, this, _1, _2, i);
@@ -259,6 +270,18 @@ void DnsHandler::DefaultDnsSendResponse() {
     SendDnsResponse();
 }
 
+// The default DNS servers are reached through the system resolver, which
+// doesn't give the TTL or tell a missing name from a failure; only the
+// resolved answers are kept, for DEFAULT_DNS_TTL.
+void DnsHandler::DefaultDnsCacheAdd() {
+    if (dns_->flags.ret || items_.size() != 1 || ntohs(dns_->ans_rrcount) != 1)
+        return;
+
+    DnsCache::Answer answer;
+    answer.ans.push_back(items_[0]);
+    agent()->GetDnsProto()->dns_cache()->Add(CacheKey(), answer);
+}
+
 bool DnsHandler::HandleVirtualDnsRequest(const VmInterface *vmitf) {
     rkey_ = new QueryKey(vmitf, dns_->xid);
     DnsProto *dns_proto = agent()->GetDnsProto();
@@ -281,11 +304,19 @@ bool DnsHandler::HandleVirtualDnsRequest(const VmInterface *vmitf) {
             dns_resp_size_ = BindUtil::ParseDnsQuery((uint8_t *)dns_, items_);
             resp_ptr_ = (uint8_t *)dns_ + dns_resp_size_;
             UpdateQueryNames();
-            xid_ = dns_proto->GetTransId();
             action_ = DnsHandler::DNS_QUERY;
             BindUtil::BuildDnsHeader(dns_, ntohs(dns_->xid), DNS_QUERY_RESPONSE, 
                                      DNS_OPCODE_QUERY, 0, 1, ret, 
                                      ntohs(dns_->ques_rrcount));
+            DnsCache::Answer answer;
+            if (items_.size() == 1 &&
+                dns_proto->dns_cache()->Lookup(CacheKey(), &answer)) {
+                std::vector<DnsItem> ques;
+                Resolve(answer.flags, ques, answer.ans, answer.auth,
+                        answer.add);
+                break;
+            }
+            xid_ = dns_proto->GetTransId();
             if (SendDnsQuery())
                 return false;
             break;
@@ -395,6 +426,7 @@ bool DnsHandler::HandleMessage() {
 
 bool DnsHandler::HandleDefaultDnsResponse() {
     DnsProto::DnsIpc *ipc = static_cast<DnsProto::DnsIpc *>(pkt_info_->ipc);
+    ipc->handler->DefaultDnsCacheAdd();
     ipc->handler->DefaultDnsSendResponse();
     delete ipc;
     return true;
@@ -411,6 +443,15 @@ bool DnsHandler::HandleBindResponse() {
         BindUtil::ParseDnsQuery(ipc->resp, xid, flags, ques, ans, auth, add);
         switch(handler->action_) {
             case DnsHandler::DNS_QUERY:
+                // Resolve() rewrites the records for this VM, keep them first
+                if (handler->items_.size() == 1) {
+                    DnsCache::Answer answer;
+                    answer.flags = flags;
+                    answer.ans = ans;
+                    answer.auth = auth;
+                    answer.add = add;
+                    dns_proto->dns_cache()->Add(handler->CacheKey(), answer);
+                }
                 handler->Resolve(flags, ques, ans, auth, add);
                 if (flags.ret) {
                     DNS_BIND_TRACE(DnsBindError, "Query failed : " << 
@@ -475,6 +516,7 @@ bool DnsHandler::HandleModifyVdns() {
         static_cast<DnsProto::DnsUpdateIpc *>(pkt_info_->ipc);
     DnsProto *dns_proto = agent()->GetDnsProto();
     std::vector<DnsProto::DnsUpdateIpc *> change_list;
+    dns_proto->dns_cache()->Invalidate(ipc->old_vdns);
     const DnsProto::DnsUpdateSet &update_set = dns_proto->update_set();
     for (DnsProto::DnsUpdateSet::const_iterator it = update_set.begin();
          it != update_set.end(); ++it) {
@@ -705,6 +747,7 @@ void DnsHandler::Update(InterTaskMsg *msg) {
     DnsProto::DnsUpdateIpc *update = static_cast<DnsProto::DnsUpdateIpc *>(msg);
     bool free_update = true;
     DnsProto *dns_proto = agent()->GetDnsProto();
+    dns_proto->dns_cache()->Invalidate(update->xmpp_data->virtual_dns);
     DnsProto::DnsUpdateIpc *update_req = dns_proto->FindUpdateRequest(update);
     if (update_req) {
         DnsUpdateData *data = update_req->xmpp_data;
@@ -754,6 +797,7 @@ void DnsHandler::DelUpdate(InterTaskMsg *msg) {
             (*item).eclass = DNS_CLASS_NONE;
             (*item).ttl = 0;
         }
+        dns_proto->dns_cache()->Invalidate(update_req->xmpp_data->virtual_dns);
         for (int i = 0; i < MAX_XMPP_SERVERS; i++) {
             AgentDnsXmppChannel *channel = 
                         agent()->GetAgentDnsXmppChannel(i);
@@ -787,6 +831,20 @@ void DnsHandler::UpdateStats() {
     }
 }
 
+// Cached answers are copied into the response built on the question of the
+// VM, so they are keyed on the name as the VM asked it. Answers from the
+// default DNS servers are kept under an empty virtual DNS name.
+DnsCache::Key DnsHandler::CacheKey() const {
+    std::string vdns;
+    std::string name = items_[0].name;
+    if (ipam_type_.ipam_dns_method == "virtual-dns-server") {
+        vdns = ipam_type_.ipam_dns_server.virtual_dns_server_name;
+        if (query_name_update_)
+            name.resize(name.size() - vdns_type_.domain_name.size() - 1);
+    }
+    return DnsCache::Key(vdns, name, items_[0].type, items_[0].eclass);
+}
+
 bool DnsHandler::TimerExpiry(uint16_t xid) {
     agent()->GetDnsProto()->SendDnsIpc(DnsProto::DNS_TIMER_EXPIRED, xid,
                                        NULL, NULL);
@@ -8,6 +8,7 @@
 #include "pkt/proto_handler.h"
 #include "vnc_cfg_types.h"
 #include "bind/bind_util.h"
+#include "services/dns_cache.h"
 
 #define DEFAULT_DNS_TTL 120
 
@@ -57,6 +58,7 @@ private:
     bool HandleRequest();
     bool HandleDefaultDnsRequest(const VmInterface *vmitf);
     void DefaultDnsSendResponse();
+    void DefaultDnsCacheAdd();
     bool HandleVirtualDnsRequest(const VmInterface *vmitf);
     bool HandleMessage();
     bool HandleDefaultDnsResponse();
@@ -79,6 +81,7 @@ private:
     void Update(InterTaskMsg *msg);
     void DelUpdate(InterTaskMsg *msg);
     void UpdateStats();
+    DnsCache::Key CacheKey() const;
     std::string DnsItemsToString(std::vector<DnsItem> &items);
 
     dnshdr  *dns_;
@@ -28,6 +28,7 @@ void DnsProto::ConfigInit() {
 DnsProto::DnsProto(Agent *agent, boost::asio::io_service &io) :
     Proto(agent, "Agent::Services", PktHandler::DNS, io),
     xid_(0), timeout_(kDnsTimeout), max_retries_(kDnsMaxRetries) {
+    SetRateLimit(kRateLimit, kRateLimitBurst);
     lid_ = agent->GetInterfaceTable()->Register(
                   boost::bind(&DnsProto::InterfaceNotify, this, _2));
     Vnlid_ = agent->GetVnTable()->Register(
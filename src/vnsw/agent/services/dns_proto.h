@@ -6,6 +6,7 @@
 #define vnsw_agent_dns_proto_hpp
 
 #include "pkt/proto.h"
+#include "services/dns_cache.h"
 #include "services/dns_handler.h"
 #include "vnc_cfg_types.h"
 
@@ -17,6 +18,8 @@ public:
     static const uint32_t kDnsTimeout = 2000;   // milli seconds
     static const uint32_t kDnsMaxRetries = 2;
     static const uint32_t kDnsDefaultTtl = 84600;
+    static const uint32_t kRateLimit = 200;     // packets/sec
+    static const uint32_t kRateLimitBurst = 100;
 
     enum InterTaskMessage {
         DNS_NONE,
@@ -179,7 +182,13 @@ public:
     void IncrStatsFail() { stats_.fail++; }
     void IncrStatsDrop() { stats_.drop++; }
     const DnsStats &GetStats() const { return stats_; }
-    void ClearStats() { stats_.Reset(); }
+    void ClearStats() {
+        stats_.Reset();
+        dns_cache_.ClearStats();
+    }
+
+    DnsCache *dns_cache() { return &dns_cache_; }
+    const DnsCache *dns_cache() const { return &dns_cache_; }
 
 private:
     void InterfaceNotify(DBEntryBase *entry);
@@ -205,6 +214,7 @@ private:
     DnsBindQueryMap dns_query_map_;
     DnsVmRequestSet curr_vm_requests_;
     DnsStats stats_;
+    DnsCache dns_cache_;
     uint32_t timeout_;   // milli seconds
     uint32_t max_retries_;
 
@@ -71,6 +71,8 @@ MetadataProxy::MetadataProxy(ServicesModule *module,
     http_server_->Initialize(0);
     services_->agent()->SetMetadataServerPort(http_server_->GetPort());
 
+    // Requests from the VMs are all GETs to the same Nova API server
+    http_client_->set_pipelining(true);
     http_client_->Init();
 }
 
@@ -85,6 +87,17 @@ MetadataProxy::Shutdown() {
     http_client_ = NULL;
 }
 
+const HttpClient::Stats &
+MetadataProxy::nova_stats() const {
+    return http_client_->stats();
+}
+
+void
+MetadataProxy::ClearStats() {
+    metadata_stats_.Reset();
+    http_client_->ClearStats();
+}
+
 void 
 MetadataProxy::HandleMetadataRequest(HttpSession *session, const HttpRequest *request) {
     bool conn_close = false;
@@ -52,7 +52,9 @@ public:
     void OnClientSessionEvent(HttpClientSession *session, TcpSession::Event event);
 
     const MetadataStats &metadatastats() const { return metadata_stats_; }
-    void ClearStats() { metadata_stats_.Reset(); }
+    // Requests proxied to the Nova API server
+    const HttpClient::Stats &nova_stats() const;
+    void ClearStats();
 
 private:
     HttpConnection *GetProxyConnection(HttpSession *session, bool conn_close);
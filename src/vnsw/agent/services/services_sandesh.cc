@@ -3,6 +3,7 @@
  */
 
 #include <boost/assign/list_of.hpp>
+#include <http/client/http_client.h>
 #include <pkt/pkt_handler.h>
 #include <oper/mirror_table.h>
 #include <pkt/pkt_init.h>
@@ -85,6 +86,13 @@ std::string &ServicesSandesh::DhcpMsgType(uint32_t msg_type) {
     return it->second;
 }
 
+static uint32_t QueueLatencyAvg(const PktHandler::PktStats &stats,
+                                PktHandler::PktModuleName mod) {
+    if (stats.processed[mod] == 0)
+        return 0;
+    return stats.q_latency_usecs[mod] / stats.processed[mod];
+}
+
 void ServicesSandesh::PktStatsSandesh(std::string ctxt, bool more) {
     PktStats *resp = new PktStats();
     const PktHandler::PktStats &stats = Agent::GetInstance()->pkt()->pkt_handler()->GetStats();
@@ -111,6 +119,19 @@ void ServicesSandesh::PktStatsSandesh(std::string ctxt, bool more) {
     resp->set_dns_q_threshold_exceeded(stats.q_threshold_exceeded[PktHandler::DNS]);
     resp->set_icmp_q_threshold_exceeded(stats.q_threshold_exceeded[PktHandler::ICMP]);
     resp->set_flow_q_threshold_exceeded(stats.q_threshold_exceeded[PktHandler::FLOW]);
+    resp->set_dhcp_rate_limited(stats.rate_limited[PktHandler::DHCP]);
+    resp->set_arp_rate_limited(stats.rate_limited[PktHandler::ARP]);
+    resp->set_dns_rate_limited(stats.rate_limited[PktHandler::DNS]);
+    resp->set_dhcp_q_latency_avg_usecs(QueueLatencyAvg(stats, PktHandler::DHCP));
+    resp->set_dhcp_q_latency_max_usecs(stats.q_latency_max_usecs[PktHandler::DHCP]);
+    resp->set_arp_q_latency_avg_usecs(QueueLatencyAvg(stats, PktHandler::ARP));
+    resp->set_arp_q_latency_max_usecs(stats.q_latency_max_usecs[PktHandler::ARP]);
+    resp->set_dns_q_latency_avg_usecs(QueueLatencyAvg(stats, PktHandler::DNS));
+    resp->set_dns_q_latency_max_usecs(stats.q_latency_max_usecs[PktHandler::DNS]);
+    resp->set_icmp_q_latency_avg_usecs(QueueLatencyAvg(stats, PktHandler::ICMP));
+    resp->set_icmp_q_latency_max_usecs(stats.q_latency_max_usecs[PktHandler::ICMP]);
+    resp->set_flow_q_latency_avg_usecs(QueueLatencyAvg(stats, PktHandler::FLOW));
+    resp->set_flow_q_latency_max_usecs(stats.q_latency_max_usecs[PktHandler::FLOW]);
     resp->set_context(ctxt);
     resp->set_more(more);
     resp->Response();
@@ -165,6 +186,13 @@ void ServicesSandesh::DnsStatsSandesh(std::string ctxt, bool more) {
     dns->set_dns_unsupported(nstats.unsupported);
     dns->set_dns_failures(nstats.fail);
     dns->set_dns_drops(nstats.drop);
+    const DnsCache *cache = Agent::GetInstance()->GetDnsProto()->dns_cache();
+    dns->set_dns_cache_hits(cache->stats().hits);
+    dns->set_dns_cache_negative_hits(cache->stats().negative_hits);
+    dns->set_dns_cache_misses(cache->stats().misses);
+    dns->set_dns_cache_entries(cache->size());
+    dns->set_dns_cache_evictions(cache->stats().evictions);
+    dns->set_dns_cache_invalidations(cache->stats().invalidations);
     dns->set_context(ctxt);
     dns->set_more(more);
     dns->Response();
@@ -642,6 +670,18 @@ void ServicesSandesh::MetadataHandleRequest(std::string ctxt, bool more = false)
     resp->set_metadata_responses(stats.responses);
     resp->set_metadata_proxy_sessions(stats.proxy_sessions);
     resp->set_metadata_internal_errors(stats.internal_errors);
+    const HttpClient::Stats &nova_stats =
+          Agent::GetInstance()->services()->metadataproxy()->nova_stats();
+    resp->set_nova_requests(nova_stats.requests);
+    resp->set_nova_errors(nova_stats.errors);
+    resp->set_nova_queued_requests(nova_stats.queued);
+    resp->set_nova_new_connections(nova_stats.new_connections);
+    resp->set_nova_reused_connections(nova_stats.reused_connections);
+    if (nova_stats.responses) {
+        resp->set_nova_latency_avg_usecs(nova_stats.latency_total_usecs /
+                                         nova_stats.responses);
+    }
+    resp->set_nova_latency_max_usecs(nova_stats.latency_max_usecs);
     resp->set_context(ctxt);
     resp->set_more(more);
     resp->Response();
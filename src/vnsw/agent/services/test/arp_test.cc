@@ -313,6 +313,32 @@ TEST_F(ArpTest, ArpReqTest) {
     arp_cache_sandesh->Release();
 }
 
+// The fabric interface carries the ARPs of the whole network, a burst on it
+// is not rate limited like one from a VM interface
+TEST_F(ArpTest, ArpFabricRateLimitTest) {
+    Agent *agent = Agent::GetInstance();
+    Interface *intf = agent->GetInterfaceTable()->FindInterface(req_ifindex);
+    EXPECT_TRUE(intf == NULL || intf->type() != Interface::VM_INTERFACE);
+
+    PktHandler *pkt_handler = agent->pkt()->pkt_handler();
+    pkt_handler->ClearStats();
+    uint32_t count = ArpProto::kRateLimitBurst + 50;
+    for (uint32_t i = 0; i < count; ++i) {
+        SendArpReq(req_ifindex, 0, src_ip, target_ip);
+    }
+    client->WaitForIdle();
+    EXPECT_EQ(count, pkt_handler->GetStats().received[PktHandler::ARP]);
+    EXPECT_EQ(0U, pkt_handler->GetStats().rate_limited[PktHandler::ARP]);
+    EXPECT_LE(count, pkt_handler->GetStats().processed[PktHandler::ARP]);
+
+    SendArpMessage(ArpProto::AGING_TIMER_EXPIRED, target_ip);
+    usleep(175000); // wait for retry timer to expire
+    client->WaitForIdle();
+    EXPECT_EQ(1U, agent->GetArpProto()->GetArpCacheSize());
+    EXPECT_FALSE(FindArpRoute(target_ip, agent->GetDefaultVrf()));
+    pkt_handler->ClearStats();
+}
+
 TEST_F(ArpTest, ArpGratuitousTest) {
     for (int i = 0; i < 2; i++) {
         SendArpReq(req_ifindex, 0, ntohl(inet_addr(GRAT_IP)), 
@@ -849,6 +849,50 @@ TEST_F(DhcpTest, DhcpHostRoutesTest) {
     Agent::GetInstance()->GetDhcpProto()->ClearStats();
 }
 
+// A burst of discovers from one interface beyond the burst size of the
+// DHCP rate limit is dropped before it reaches the DHCP task
+TEST_F(DhcpTest, DhcpRateLimitTest) {
+    struct PortInfo input[] = {
+        {"vnet5", 5, "9.6.7.8", "00:00:00:05:05:05", 1, 5},
+    };
+    uint8_t options[] = {
+        DHCP_OPTION_MSG_TYPE,
+        DHCP_OPTION_HOST_NAME,
+        DHCP_OPTION_END
+    };
+    DhcpProto::DhcpStats stats;
+    PktHandler *pkt_handler = Agent::GetInstance()->pkt()->pkt_handler();
+
+    IntfCfgAdd(input, 0);
+    WaitForItfUpdate(1);
+    pkt_handler->ClearStats();
+
+    static const uint32_t kBurst = 150;
+    for (uint32_t i = 0; i < kBurst; ++i) {
+        SendDhcp(GetItfId(0), 0x8000, DHCP_DISCOVER, options, 3);
+    }
+    int count = 0;
+    DHCP_CHECK (stats.discover +
+                pkt_handler->GetStats().rate_limited[PktHandler::DHCP] <
+                kBurst);
+    uint32_t rate_limited =
+        pkt_handler->GetStats().rate_limited[PktHandler::DHCP];
+    EXPECT_GT(rate_limited, 0U);
+    uint32_t rate_limit_burst = DhcpProto::kRateLimitBurst;
+    EXPECT_GE(stats.discover, rate_limit_burst);
+    EXPECT_EQ(kBurst, stats.discover + rate_limited);
+    EXPECT_EQ(stats.discover, pkt_handler->GetStats().processed[PktHandler::DHCP]);
+    EXPECT_LE(pkt_handler->GetStats().q_latency_max_usecs[PktHandler::DHCP],
+              pkt_handler->GetStats().q_latency_usecs[PktHandler::DHCP]);
+
+    IntfCfgDel(input, 0);
+    WaitForItfUpdate(0);
+
+    Agent::GetInstance()->GetDhcpProto()->rate_limiter()->Clear();
+    Agent::GetInstance()->GetDhcpProto()->ClearStats();
+    pkt_handler->ClearStats();
+}
+
 void RouterIdDepInit(Agent *agent) {
 }
 
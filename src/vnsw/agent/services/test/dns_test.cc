@@ -458,6 +458,8 @@ TEST_F(DnsTest, VirtualDnsReqTest) {
     client->WaitForIdle();
     sand->Release();
 
+    // a_items[0] was answered above, don't answer it from the cache
+    Agent::GetInstance()->GetDnsProto()->dns_cache()->Clear();
     Agent::GetInstance()->GetDnsProto()->set_timeout(30);
     Agent::GetInstance()->GetDnsProto()->set_max_retries(1);
     SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
@@ -493,6 +495,120 @@ TEST_F(DnsTest, VirtualDnsReqTest) {
     Agent::GetInstance()->GetDnsProto()->ClearStats();
 }
 
+TEST_F(DnsTest, VirtualDnsCacheTest) {
+    struct PortInfo input[] = {
+        {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
+    };
+    IpamInfo ipam_info[] = {
+        {"1.2.3.128", 27, "1.2.3.129"},
+        {"7.8.9.0", 24, "7.8.9.12"},
+        {"1.1.1.0", 24, "1.1.1.200"},
+    };
+
+    char vdns_attr[] = 
+        "<virtual-DNS-data>\
+            <domain-name>test.contrail.juniper.net</domain-name>\
+            <dynamic-records-from-client>true</dynamic-records-from-client>\
+            <record-order>fixed</record-order>\
+            <default-ttl-seconds>120</default-ttl-seconds>\
+        </virtual-DNS-data>\n";
+    char ipam_attr[] = "<network-ipam-mgmt>\n <ipam-dns-method>virtual-dns-server</ipam-dns-method>\n <ipam-dns-server><virtual-dns-server-name>vdns1</virtual-dns-server-name></ipam-dns-server>\n </network-ipam-mgmt>\n";
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+    IntfCfgAdd(input, 0);
+    WaitForItfUpdate(1);
+
+    AddVDNS("vdns1", vdns_attr);
+    client->WaitForIdle();
+    AddIPAM("vn1", ipam_info, 3, ipam_attr, "vdns1");
+    client->WaitForIdle();
+
+    DnsProto *dns_proto = Agent::GetInstance()->GetDnsProto();
+    DnsCache *cache = dns_proto->dns_cache();
+    cache->Clear();
+    dns_proto->ClearStats();
+
+    DnsProto::DnsStats stats;
+    int count = 0;
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    SendDnsResp(1, a_items, 1, auth_items, 1, add_items);
+    CHECK_CONDITION(stats.resolved < 1);
+    CHECK_STATS(stats, 1, 1, 0, 0, 0, 0);
+    EXPECT_EQ(1U, cache->size());
+    EXPECT_EQ(1U, cache->stats().misses);
+
+    // Answered from the cache, without a query to the server
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    CHECK_CONDITION(stats.resolved < 2);
+    CHECK_STATS(stats, 2, 2, 0, 0, 0, 0);
+    EXPECT_EQ(1U, cache->stats().hits);
+
+    // Negative answer, kept for the TTL of the SOA record
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[1]);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    SendDnsResp(1, &a_items[1], 0, NULL, 1, add_items, true);
+    CHECK_CONDITION(stats.fail < 1);
+    CHECK_STATS(stats, 3, 2, 0, 0, 1, 0);
+    EXPECT_EQ(2U, cache->size());
+
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, &a_items[1]);
+    CHECK_CONDITION(stats.fail < 2);
+    CHECK_STATS(stats, 4, 2, 0, 0, 2, 0);
+    EXPECT_EQ(1U, cache->stats().negative_hits);
+
+    // Multiple questions are not cached
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 2, a_items);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    SendDnsResp(2, a_items, 2, auth_items, 2, add_items);
+    CHECK_CONDITION(stats.resolved < 3);
+    CHECK_STATS(stats, 5, 3, 0, 0, 2, 0);
+    EXPECT_EQ(2U, cache->size());
+
+    // An update of the records of the virtual DNS drops its answers
+    SendDnsReq(DNS_OPCODE_UPDATE, GetItfId(0), 1, a_items, default_flags, true);
+    CHECK_CONDITION(stats.resolved < 4);
+    CHECK_STATS(stats, 6, 4, 0, 0, 2, 0);
+    EXPECT_EQ(0U, cache->size());
+    EXPECT_EQ(2U, cache->stats().invalidations);
+
+    SendDnsReq(DNS_OPCODE_QUERY, GetItfId(0), 1, a_items);
+    g_xid++;
+    usleep(1000);
+    client->WaitForIdle();
+    EXPECT_EQ(1U, cache->stats().hits);
+    SendDnsResp(1, a_items, 1, auth_items, 1, add_items);
+    CHECK_CONDITION(stats.resolved < 5);
+    CHECK_STATS(stats, 7, 5, 0, 0, 2, 0);
+
+    SendDnsReq(DNS_OPCODE_UPDATE, GetItfId(0), 1, a_items);
+    CHECK_CONDITION(stats.resolved < 6);
+    EXPECT_EQ(0U, cache->size());
+
+    client->Reset();
+    DelIPAM("vn1", "vdns1"); 
+    client->WaitForIdle();
+    DelVDNS("vdns1"); 
+    client->WaitForIdle();
+
+    client->Reset();
+    DeleteVmportEnv(input, 1, 1, 0); 
+    client->WaitForIdle();
+
+    IntfCfgDel(input, 0);
+    WaitForItfUpdate(0);
+    cache->Clear();
+    dns_proto->ClearStats();
+}
+
 TEST_F(DnsTest, DnsXmppTest) {
     struct PortInfo input[] = {
         {"vnet1", 1, "1.1.1.1", "00:00:00:01:01:01", 1, 1},
@@ -298,6 +298,55 @@ TEST_F(MetadataTest, MetadataReqTest) {
     Agent::GetInstance()->services()->metadataproxy()->ClearStats();
 }
 
+// Requests proxied one after the other go over the same connection to the
+// nova api server
+TEST_F(MetadataTest, MetadataReqReuseTest) {
+    int count = 0;
+    MetadataProxy::MetadataStats stats;
+    struct PortInfo input[] = {
+        {"vnet1", 1, vm1_ip, "00:00:00:01:01:01", 1, 1},
+    };
+
+    StartNovaApiProxy();
+    SetupLinkLocalConfig();
+
+    CreateVmportEnv(input, 1, 0);
+    client->WaitForIdle();
+    client->Reset();
+
+    StartHttpClient();
+
+    InterfaceTable *intf_table = Agent::GetInstance()->GetInterfaceTable();
+    TestInterfaceTable *interface_table = new TestInterfaceTable();
+    Agent::GetInstance()->SetInterfaceTable(static_cast<InterfaceTable *>(interface_table));
+    for (uint32_t i = 1; i <= 3; ++i) {
+        SendHttpClientRequest();
+        METADATA_CHECK (stats.responses < i);
+    }
+    Agent::GetInstance()->SetInterfaceTable(intf_table);
+    EXPECT_EQ(3U, stats.requests);
+    EXPECT_EQ(3U, stats.proxy_sessions);
+
+    const HttpClient::Stats &nova_stats =
+        Agent::GetInstance()->services()->metadataproxy()->nova_stats();
+    EXPECT_EQ(3U, nova_stats.requests);
+    EXPECT_EQ(3U, nova_stats.responses);
+    EXPECT_EQ(0U, nova_stats.errors);
+    EXPECT_EQ(1U, nova_stats.new_connections);
+    EXPECT_EQ(2U, nova_stats.reused_connections);
+    EXPECT_GE(nova_stats.latency_total_usecs, nova_stats.latency_max_usecs);
+
+    client->Reset();
+    StopHttpClient();
+    DeleteVmportEnv(input, 1, 1, 0); 
+    client->WaitForIdle();
+
+    StopNovaApiProxy();
+    client->WaitForIdle();
+
+    Agent::GetInstance()->services()->metadataproxy()->ClearStats();
+}
+
 void RouterIdDepInit(Agent *agent) {
 }
 
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include <iostream>
+#include <boost/regex.hpp>
+
+#include "base/util.h"
+#include "xmpp/xmpp_framer.h"
+#include "xmpp/xmpp_str.h"
+
+#include "testing/gunit.h"
+
+using namespace std;
+
+//
+// Frames stanzas the way the session did before XmppFramer: the data is
+// appended to a string, and the start and end tags are searched for with
+// regular expressions, the end tag one compiled for every stanza.
+//
+class XmppRegexFramer {
+public:
+    XmppRegexFramer() : patt_(rXMPP_MESSAGE), tag_known_(false) {
+        offset_ = buf_.begin();
+    }
+
+    void Read(const uint8_t *data, size_t size, vector<string> *frames) {
+        string str(data, data + size);
+        if (buf_.empty()) {
+            ReplaceBuf(str);
+        } else {
+            size_t pos = offset_ - buf_.begin();
+            buf_ += str;
+            offset_ = buf_.begin() + pos;
+        }
+        while (Match()) {
+            string::const_iterator st = buf_.begin();
+            frames->push_back(string(st, offset_));
+            if (offset_ == buf_.end()) {
+                buf_.clear();
+                break;
+            }
+            string::const_iterator end = buf_.end();
+            ReplaceBuf(string(offset_, end));
+        }
+    }
+
+private:
+    void ReplaceBuf(const string &str) {
+        buf_ = str;
+        offset_ = buf_.begin();
+    }
+
+    int MatchRegex(const boost::regex &patt) {
+        string::const_iterator end = buf_.end();
+        if (regex_search(offset_, end, res_, patt,
+                         boost::match_default | boost::match_partial) == 0) {
+            return -1;
+        }
+        if (res_[0].matched == false) {
+            offset_ = res_[0].first;
+            return 1;
+        }
+        begin_tag_ = string(res_[0].first, res_[0].second);
+        offset_ = res_[0].second;
+        return 0;
+    }
+
+    bool Match() {
+        while (true) {
+            if (!tag_known_) {
+                size_t pos = buf_.find_first_not_of(sXMPP_VALIDWS);
+                if (pos != 0) {
+                    if (pos == string::npos) pos = buf_.size();
+                    offset_ = buf_.begin() + pos;
+                    return true;
+                }
+            }
+            int m;
+            if (tag_known_) {
+                string token("</");
+                token += begin_tag_.c_str() + 1;
+                token += "[\\s\\t\\r\\n]*>";
+                m = MatchRegex(boost::regex(token));
+            } else {
+                m = MatchRegex(patt_);
+            }
+            if (m != 0) {
+                return false;
+            }
+            tag_known_ = !tag_known_;
+            if (!tag_known_) {
+                return true;
+            }
+        }
+    }
+
+    boost::regex patt_;
+    string buf_;
+    string::const_iterator offset_;
+    string begin_tag_;
+    bool tag_known_;
+    boost::match_results<string::const_iterator> res_;
+};
+
+class XmppFramerTest : public ::testing::Test {
+protected:
+    // Feed data to the framer in reads of at most read_size bytes
+    void Read(XmppFramer::Mode mode, const string &data, size_t read_size) {
+        const uint8_t *cp = reinterpret_cast<const uint8_t *>(data.data());
+        for (size_t offset = 0; offset < data.size(); offset += read_size) {
+            ReadOnce(mode, cp + offset,
+                     std::min(read_size, data.size() - offset));
+        }
+    }
+
+    void ReadOnce(XmppFramer::Mode mode, const uint8_t *data, size_t size) {
+        while (size > 0) {
+            size_t consumed = 0;
+            if (!framer_.Next(mode, data, size, &consumed, &frame_)) {
+                EXPECT_EQ(size, consumed);
+                break;
+            }
+            EXPECT_LT(0U, consumed);
+            frames_.push_back(frame_);
+            data += consumed;
+            size -= consumed;
+        }
+    }
+
+    // A pubsub update with the given number of items
+    static string PubSubIq(int items) {
+        string iq("<iq type=\"set\" from=\"agent@vnsw.contrailsystems.com\" "
+                  "to=\"network-control@contrailsystems.com/bgp-peer\" "
+                  "id=\"pubsub1\">\n<pubsub "
+                  "xmlns=\"http://jabber.org/protocol/pubsub\">\n"
+                  "<publish node=\"1/1/default-domain:demo:vn1\">\n");
+        for (int idx = 0; idx < items; ++idx) {
+            iq += "<item id=\"10.1.1." + integerToString(idx % 254 + 1) +
+                "/32\"><entry xmlns=\"http://www.contrailsystems.com/"
+                "bgp-l3vpn-unicast-cfg.xsd\"><nlri><af>1</af>"
+                "<address>10.1.1." + integerToString(idx % 254 + 1) +
+                "/32</address></nlri><next-hops><next-hop><af>1</af>"
+                "<address>192.168.1.1</address><label>16</label>"
+                "</next-hop></next-hops><version>1</version>"
+                "<virtual-network>default-domain:demo:vn1</virtual-network>"
+                "</entry></item>\n";
+        }
+        iq += "</publish>\n</pubsub>\n</iq>";
+        return iq;
+    }
+
+    XmppFramer framer_;
+    string frame_;
+    vector<string> frames_;
+};
+
+TEST_F(XmppFramerTest, Stanza) {
+    string iq("<iq type='set' id='a>b'><pubsub><item id=\"x/\"/>"
+              "<item><entry>text</entry></item></pubsub></iq>");
+    string message("<message type='chat'><body> msg </body></message>");
+
+    // Every split of the data in two reads
+    string data = iq + message;
+    for (size_t split = 1; split < data.size(); ++split) {
+        frames_.clear();
+        ReadOnce(XmppFramer::STANZA,
+                 reinterpret_cast<const uint8_t *>(data.data()), split);
+        ReadOnce(XmppFramer::STANZA,
+                 reinterpret_cast<const uint8_t *>(data.data()) + split,
+                 data.size() - split);
+        ASSERT_EQ(2U, frames_.size());
+        EXPECT_EQ(iq, frames_[0]);
+        EXPECT_EQ(message, frames_[1]);
+        EXPECT_EQ(0U, framer_.pending());
+    }
+
+    // One byte at a time
+    frames_.clear();
+    Read(XmppFramer::STANZA, data, 1);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ(iq, frames_[0]);
+    EXPECT_EQ(message, frames_[1]);
+}
+
+TEST_F(XmppFramerTest, Partial) {
+    Read(XmppFramer::STANZA, "<iq> blah blah </iq><i", 64);
+    ASSERT_EQ(1U, frames_.size());
+    EXPECT_EQ("<iq> blah blah </iq>", frames_[0]);
+    EXPECT_EQ(2U, framer_.pending());
+
+    Read(XmppFramer::STANZA, "q> Rest of the messsage is here ", 64);
+    EXPECT_EQ(1U, frames_.size());
+    Read(XmppFramer::STANZA, "more messsage is here </iq>", 64);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ("<iq> Rest of the messsage is here more messsage is here </iq>",
+              frames_[1]);
+    EXPECT_EQ(0U, framer_.pending());
+}
+
+TEST_F(XmppFramerTest, EmptyElement) {
+    Read(XmppFramer::STANZA, "<iq type='result' id='1'/><iq/>", 64);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ("<iq type='result' id='1'/>", frames_[0]);
+    EXPECT_EQ("<iq/>", frames_[1]);
+}
+
+TEST_F(XmppFramerTest, Whitespace) {
+    Read(XmppFramer::STANZA, "<iq> blah </iq>  \n<iq> blah </iq> ", 64);
+    ASSERT_EQ(4U, frames_.size());
+    EXPECT_EQ("  \n", frames_[1]);
+    EXPECT_EQ(" ", frames_[3]);
+
+    // Keepalive
+    frames_.clear();
+    Read(XmppFramer::STANZA, sXMPP_WHITESPACE, 64);
+    ASSERT_EQ(1U, frames_.size());
+    EXPECT_EQ(sXMPP_WHITESPACE, frames_[0]);
+
+    // Whitespace after garbage is part of the next stanza
+    frames_.clear();
+    Read(XmppFramer::STANZA, "   abc   <iq> blah </iq>", 64);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ("   ", frames_[0]);
+    EXPECT_EQ("abc   <iq> blah </iq>", frames_[1]);
+}
+
+TEST_F(XmppFramerTest, StreamHeader) {
+    string header("<?xml version='1.0'?>\n<stream:stream from='agent' "
+                  "to='network-control' version='1.0' xml:lang='en' "
+                  "xmlns='jabber:client' "
+                  "xmlns:stream='http://etherx.jabber.org/streams' >");
+    string iq("<iq> blah </iq>");
+    Read(XmppFramer::STREAM_HEADER, header + iq.substr(0, 3), 16);
+    ASSERT_EQ(1U, frames_.size());
+    EXPECT_EQ(header, frames_[0]);
+
+    // Stanzas are framed relative to the open stream element
+    Read(XmppFramer::STANZA, iq.substr(3), 16);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ(iq, frames_[1]);
+
+    // So is the stream close
+    Read(XmppFramer::STANZA, "</stream:stream>", 16);
+    ASSERT_EQ(3U, frames_.size());
+    EXPECT_EQ("</stream:stream>", frames_[2]);
+    EXPECT_EQ(0U, framer_.pending());
+}
+
+TEST_F(XmppFramerTest, MultipleStanzasPerRead) {
+    string iq("<iq a = '2'> <item> blah blah </item></iq>");
+    string message("<message a = '2'> <item> blah blah </item></message>");
+    Read(XmppFramer::STANZA, iq + message + iq, 1024);
+    ASSERT_EQ(3U, frames_.size());
+    EXPECT_EQ(iq, frames_[0]);
+    EXPECT_EQ(message, frames_[1]);
+    EXPECT_EQ(iq, frames_[2]);
+    EXPECT_EQ(0U, framer_.pending());
+}
+
+TEST_F(XmppFramerTest, PartialEndTag) {
+    // The read ends in the middle of the end tag
+    Read(XmppFramer::STANZA,
+         "<message a = '2'> <item> blah blah </item></mess", 1024);
+    EXPECT_EQ(0U, frames_.size());
+
+    // The rest of it comes with the start of the next stanza
+    Read(XmppFramer::STANZA, "age><iq a = '2'> <item>", 1024);
+    ASSERT_EQ(1U, frames_.size());
+    EXPECT_EQ("<message a = '2'> <item> blah blah </item></message>",
+              frames_[0]);
+    EXPECT_EQ(strlen("<iq a = '2'> <item>"), framer_.pending());
+
+    Read(XmppFramer::STANZA, " blah </item></iq>", 1024);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ("<iq a = '2'> <item> blah </item></iq>", frames_[1]);
+    EXPECT_EQ(0U, framer_.pending());
+}
+
+TEST_F(XmppFramerTest, PartialStanza) {
+    // No end tag yet
+    Read(XmppFramer::STANZA, "<message a = '2'> ", 1024);
+    Read(XmppFramer::STANZA, "<item> blah blah ", 1024);
+    EXPECT_EQ(0U, frames_.size());
+
+    // The end tag, followed by the start of the next stanza
+    Read(XmppFramer::STANZA, "</item></message><somejunk>", 1024);
+    ASSERT_EQ(1U, frames_.size());
+    EXPECT_EQ("<message a = '2'> <item> blah blah </item></message>",
+              frames_[0]);
+    EXPECT_EQ(strlen("<somejunk>"), framer_.pending());
+}
+
+TEST_F(XmppFramerTest, StreamHeaderAndStanzas) {
+    // The header and the first stanzas in one read
+    string header("<?xml version='1.0'?><stream:stream from='agent' "
+                  "xmlns:stream='http://etherx.jabber.org/streams'>");
+    string iq("<iq a = '2'> <item> blah blah </item></iq>");
+    string data = header + iq + iq;
+    const uint8_t *cp = reinterpret_cast<const uint8_t *>(data.data());
+    size_t consumed = 0;
+    ASSERT_TRUE(framer_.Next(XmppFramer::STREAM_HEADER, cp, data.size(),
+                             &consumed, &frame_));
+    EXPECT_EQ(header, frame_);
+    EXPECT_EQ(header.size(), consumed);
+
+    ReadOnce(XmppFramer::STANZA, cp + consumed, data.size() - consumed);
+    ASSERT_EQ(2U, frames_.size());
+    EXPECT_EQ(iq, frames_[0]);
+    EXPECT_EQ(iq, frames_[1]);
+    EXPECT_EQ(0U, framer_.pending());
+}
+
+//
+// Frame a stream of large pubsub updates, read in chunks the size of the
+// socket reads, with the framer and with the regular expressions.
+//
+TEST_F(XmppFramerTest, ThroughputBenchmark) {
+    static const size_t kReadSize = 4096;
+    static const int kStanzas = 200;
+
+    vector<string> expected;
+    string stream;
+    for (int idx = 0; idx < kStanzas; ++idx) {
+        expected.push_back(PubSubIq(64 + idx % 64));
+        expected.push_back(" ");
+        stream += expected[2 * idx] + expected[2 * idx + 1];
+    }
+
+    uint64_t start = UTCTimestampUsec();
+    Read(XmppFramer::STANZA, stream, kReadSize);
+    uint64_t framer_usec = UTCTimestampUsec() - start;
+
+    XmppRegexFramer regex_framer;
+    vector<string> regex_frames;
+    const uint8_t *cp = reinterpret_cast<const uint8_t *>(stream.data());
+    start = UTCTimestampUsec();
+    for (size_t offset = 0; offset < stream.size(); offset += kReadSize) {
+        regex_framer.Read(cp + offset,
+                          std::min(kReadSize, stream.size() - offset),
+                          &regex_frames);
+    }
+    uint64_t regex_usec = UTCTimestampUsec() - start;
+
+    ASSERT_EQ(expected.size(), frames_.size());
+    EXPECT_TRUE(expected == frames_);
+    EXPECT_EQ(0U, framer_.pending());
+    EXPECT_TRUE(regex_frames == frames_);
+
+    double mbytes = stream.size() / (1024.0 * 1024.0);
+    cout << stream.size() << " bytes, " << kStanzas << " stanzas: "
+         << "framer " << framer_usec << " usec ("
+         << mbytes * 1000000 / std::max(framer_usec, uint64_t(1))
+         << " MB/s), regex " << regex_usec << " usec ("
+         << mbytes * 1000000 / std::max(regex_usec, uint64_t(1))
+         << " MB/s)" << endl;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,10 +2,11 @@
  * Copyright (c) 2013 Juniper Networks, Inc. All rights reserved.
  */
 
+#include <boost/regex.hpp>
+
 #include "control-node/control_node.h"
 #include "base/test/task_test_util.h"
 #include "xmpp/xmpp_state_machine.h"
-#include "xmpp/xmpp_session.h"
 #include "xmpp/xmpp_str.h"
 
 #include "base/logging.h"
@@ -16,10 +17,13 @@
 
 using namespace std;
 
-class XmppRegexMock : public XmppSession {
+//
+// The session frames the stream with XmppFramer. The regular expressions
+// in xmpp_str.h are still matched here the way the session used to.
+//
+class XmppRegexMock {
 public:
-    XmppRegexMock(TcpServer *server, Socket *sock) : 
-                  XmppSession(server, sock), p1("<(iq|message)"), bufx_("") { }
+    XmppRegexMock() : p1("<(iq|message)"), bufx_("") { }
     ~XmppRegexMock() { }
 
     //boost::regex Regex() { return p1; }
@@ -58,15 +62,48 @@ public:
     }
 
 private:
+    void SetBuf(const string &str) {
+        if (buf_.empty()) {
+            ReplaceBuf(str);
+        } else {
+            int pos = offset_ - buf_.begin();
+            buf_ += str;
+            offset_ = buf_.begin() + pos;
+        }
+    }
+
+    void ReplaceBuf(const string &str) {
+        buf_ = str;
+        offset_ = buf_.begin();
+    }
+
+    int MatchRegex(const boost::regex &patt) {
+        string::const_iterator end = buf_.end();
+        if (regex_search(offset_, end, res_, patt,
+                         boost::match_default | boost::match_partial) == 0) {
+            return -1;
+        }
+        if (res_[0].matched == false) {
+            // partial match
+            offset_ = res_[0].first;
+            return 1;
+        }
+        offset_ = res_[0].second;
+        return 0;
+    }
+
     boost::regex p1;
     string bufx_;
     string tag_;
+    string buf_;
+    string::const_iterator offset_;
+    boost::match_results<string::const_iterator> res_;
 };
 
 class XmppRegexTest : public ::testing::Test {
 protected:
     virtual void SetUp() {
-        regex_.reset(new XmppRegexMock(NULL, NULL));
+        regex_.reset(new XmppRegexMock());
     }
 
     virtual void TearDown() {
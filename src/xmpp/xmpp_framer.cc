@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#include "xmpp/xmpp_framer.h"
+
+#include <cstring>
+
+#include "xmpp/xmpp_str.h"
+
+using namespace std;
+
+XmppFramer::XmppFramer()
+    : state_(FRAME_START), depth_(0), quote_(0), empty_tag_(false) {
+}
+
+// Byte wise, the same way as the whitespace stanza is matched when decoding.
+bool XmppFramer::IsWhitespace(uint8_t c) {
+    return (c != 0 && strchr(sXMPP_VALIDWS, c) != NULL);
+}
+
+// Returns the number of bytes of data that belong to the current frame.
+size_t XmppFramer::Scan(Mode mode, const uint8_t *data, size_t size,
+                        bool *complete) {
+    *complete = false;
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t c = data[i];
+        switch (state_) {
+        case FRAME_START:
+            if (IsWhitespace(c)) {
+                state_ = WHITESPACE;
+            } else if (c == '<') {
+                state_ = TAG_OPEN;
+            } else {
+                state_ = TEXT;
+            }
+            break;
+        case WHITESPACE:
+            if (!IsWhitespace(c)) {
+                state_ = FRAME_START;
+                *complete = true;
+                return i;
+            }
+            break;
+        case TEXT:
+            if (c == '<') {
+                state_ = TAG_OPEN;
+            }
+            break;
+        case TAG_OPEN:
+            if (c == '/') {
+                state_ = END_TAG;
+            } else if (c == '?' || c == '!') {
+                state_ = SKIP_TAG;
+            } else {
+                state_ = START_TAG;
+                empty_tag_ = false;
+            }
+            break;
+        case START_TAG:
+            if (c == '"' || c == '\'') {
+                quote_ = c;
+                state_ = QUOTED;
+            } else if (c == '>') {
+                state_ = TEXT;
+                if (!empty_tag_) {
+                    if (mode == STREAM_HEADER && depth_ == 0) {
+                        // The stream element stays open, stanzas are
+                        // framed relative to it.
+                        state_ = FRAME_START;
+                        *complete = true;
+                        return i + 1;
+                    }
+                    depth_++;
+                } else if (depth_ == 0) {
+                    state_ = FRAME_START;
+                    *complete = true;
+                    return i + 1;
+                }
+            } else {
+                empty_tag_ = (c == '/');
+            }
+            break;
+        case QUOTED:
+            if (c == quote_) {
+                state_ = START_TAG;
+                empty_tag_ = false;
+            }
+            break;
+        case END_TAG:
+            if (c == '>') {
+                state_ = TEXT;
+                // A stray end tag, e.g. the stream close, is a frame too
+                if (depth_ <= 1) {
+                    depth_ = 0;
+                    state_ = FRAME_START;
+                    *complete = true;
+                    return i + 1;
+                }
+                depth_--;
+            }
+            break;
+        case SKIP_TAG:
+            if (c == '>') {
+                state_ = TEXT;
+            }
+            break;
+        }
+    }
+
+    // Whitespace up to the end of the read is delivered right away
+    if (state_ == WHITESPACE) {
+        state_ = FRAME_START;
+        *complete = true;
+    }
+    return size;
+}
+
+bool XmppFramer::Next(Mode mode, const uint8_t *data, size_t size,
+                      size_t *consumed, string *frame) {
+    bool complete;
+    *consumed = Scan(mode, data, size, &complete);
+    if (!complete) {
+        pending_.append(reinterpret_cast<const char *>(data), *consumed);
+        return false;
+    }
+
+    if (pending_.empty()) {
+        frame->assign(reinterpret_cast<const char *>(data), *consumed);
+    } else {
+        pending_.append(reinterpret_cast<const char *>(data), *consumed);
+        frame->swap(pending_);
+        pending_.clear();
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2014 Juniper Networks, Inc. All rights reserved.
+ */
+
+#ifndef __XMPP_FRAMER_H__
+#define __XMPP_FRAMER_H__
+
+#include <string>
+#include <stdint.h>
+
+#include "base/util.h"
+
+//
+// Incremental framer for the xmpp byte stream.
+//
+// Bytes are scanned once, as they are read. The state of the scan (element
+// depth, whether we are inside a tag or a quoted attribute value) is kept
+// across reads, so a stanza split across several reads is never rescanned.
+// Only the bytes of a stanza that is not complete at the end of a read are
+// copied and kept until the rest of it arrives.
+//
+// A frame is one of:
+// - a run of whitespace between stanzas (keepalive).
+// - in STREAM_HEADER mode, everything up to and including the first start
+//   tag, i.e. the xml declaration and the stream:stream open tag.
+// - in STANZA mode, a top level element, from its start tag up to and
+//   including its end tag.
+//
+// Comments, processing instructions and DTDs must not be used in xmpp, so
+// "<!" and "<?" constructs are only skipped up to the next '>'.
+//
+class XmppFramer {
+public:
+    enum Mode {
+        STREAM_HEADER,
+        STANZA
+    };
+
+    XmppFramer();
+
+    // Scan data for the end of the current frame. Returns true if the frame
+    // is complete, in which case frame holds the whole frame and consumed
+    // the number of bytes of data it took from data. Otherwise all of data
+    // is consumed and kept until the next call.
+    bool Next(Mode mode, const uint8_t *data, size_t size, size_t *consumed,
+              std::string *frame);
+
+    // Bytes of an incomplete frame that are kept across reads
+    size_t pending() const { return pending_.size(); }
+
+private:
+    enum State {
+        FRAME_START,
+        WHITESPACE,
+        TEXT,
+        TAG_OPEN,
+        START_TAG,
+        QUOTED,
+        END_TAG,
+        SKIP_TAG
+    };
+
+    static bool IsWhitespace(uint8_t c);
+    size_t Scan(Mode mode, const uint8_t *data, size_t size, bool *complete);
+
+    State state_;
+    int depth_;
+    uint8_t quote_;
+    bool empty_tag_;
+    std::string pending_;
+
+    DISALLOW_COPY_AND_ASSIGN(XmppFramer);
+};
+
+#endif // __XMPP_FRAMER_H__
@@ -67,8 +67,11 @@ do {                                                                           \
     obj::TraceMsg(XmppTraceBuf, __FILE__, __LINE__, ##__VA_ARGS__);            \
 } while (0);
 
+// The payload is only copied for the traces that are kept.
 #define XMPP_MESSAGE_TRACE(obj, ...) do {                                      \
     if (LoggingDisabled()) break;                                              \
+    if (!XmppMessageTraceBuf->IsTraceOn()) break;                              \
+    if (!XmppMessageTraceBuf->TraceSample()) break;                            \
     obj::TraceMsg(XmppMessageTraceBuf, __FILE__, __LINE__, ##__VA_ARGS__);     \
 } while (0);
 